@@ -7,6 +7,8 @@
 #define GB_BASE_TYPE_INFO_H_
 
 #include <any>
+#include <cstddef>
+#include <new>
 #include <type_traits>
 
 #include "absl/synchronization/mutex.h"
@@ -90,6 +92,11 @@ class TypeInfo {
   // this key.
   void SetTypeName(const char* name) { Key()->SetTypeName(name); }
 
+  // Returns the size and alignment of the type. These are zero if the type is
+  // void, or for placeholder types.
+  virtual size_t GetSize() = 0;
+  virtual size_t GetAlign() = 0;
+
   // Returns true if the type has a public destructor.
   virtual bool CanDestroy() = 0;
 
@@ -105,6 +112,17 @@ class TypeInfo {
   virtual void* Clone(const std::any& value) = 0;
   virtual void* Clone(const void* value) = 0;
 
+  // In-place variants of Destroy and Clone, which do not allocate or free any
+  // memory.
+  //
+  // CloneAt copy constructs the value into "memory", which must be at least
+  // GetSize() bytes and aligned to GetAlign(). It returns the constructed
+  // value, or nullptr if the type has no public copy constructor. DestroyAt
+  // runs the destructor only, and must only be called on values constructed
+  // with CloneAt.
+  virtual void DestroyAt(void* value) = 0;
+  virtual void* CloneAt(void* memory, const void* value) = 0;
+
  protected:
   TypeInfo() = default;
   virtual ~TypeInfo() = default;
@@ -119,6 +137,18 @@ class TypeInfo {
                              int> = 0>
   static void DoDestroy(void* value) {}
 
+  template <typename Type,
+            std::enable_if_t<std::is_destructible<Type>::value, int> = 0>
+  static void DoDestroyAt(void* value) {
+    if (value != nullptr) {
+      static_cast<Type*>(value)->~Type();
+    }
+  }
+  template <typename Type,
+            std::enable_if_t<std::negation<std::is_destructible<Type>>::value,
+                             int> = 0>
+  static void DoDestroyAt(void* value) {}
+
   template <typename Type,
             std::enable_if_t<std::is_copy_constructible<Type>::value, int> = 0>
   static void* DoCreate(const std::any& any_value) {
@@ -159,6 +189,39 @@ class TypeInfo {
     return nullptr;
   }
 
+  template <typename Type,
+            std::enable_if_t<std::is_copy_constructible<Type>::value, int> = 0>
+  static void* DoCreateAt(void* memory, const void* value) {
+    if (memory == nullptr || value == nullptr) {
+      return nullptr;
+    }
+    return new (memory) Type(*static_cast<const Type*>(value));
+  }
+  template <
+      typename Type,
+      std::enable_if_t<std::negation<std::is_copy_constructible<Type>>::value,
+                       int> = 0>
+  static void* DoCreateAt(void* memory, const void* value) {
+    return nullptr;
+  }
+
+  template <typename Type>
+  static constexpr size_t DoGetSize() {
+    if constexpr (std::is_void_v<Type>) {
+      return 0;
+    } else {
+      return sizeof(Type);
+    }
+  }
+  template <typename Type>
+  static constexpr size_t DoGetAlign() {
+    if constexpr (std::is_void_v<Type>) {
+      return 0;
+    } else {
+      return alignof(Type);
+    }
+  }
+
  private:
   template <typename Type>
   class Impl;
@@ -225,11 +288,17 @@ class TypeInfo::Impl : public TypeInfo {
   ~Impl() override = default;
 
   TypeKey* Key() override { return TypeKey::Get<Type>(); }
+  size_t GetSize() override { return DoGetSize<Type>(); }
+  size_t GetAlign() override { return DoGetAlign<Type>(); }
   bool CanDestroy() override { return std::is_destructible<Type>::value; }
   void Destroy(void* value) override { DoDestroy<Type>(value); }
   bool CanClone() override { return std::is_copy_constructible<Type>::value; }
   void* Clone(const std::any& value) override { return DoCreate<Type>(value); }
   void* Clone(const void* value) override { return DoCreate<Type>(value); }
+  void DestroyAt(void* value) override { DoDestroyAt<Type>(value); }
+  void* CloneAt(void* memory, const void* value) override {
+    return DoCreateAt<Type>(memory, value);
+  }
 };
 
 template <typename Type>
@@ -248,11 +317,15 @@ class TypeInfo::PlaceholderImpl : public TypeInfo {
   ~PlaceholderImpl() override = default;
 
   TypeKey* Key() override { return TypeKey::Get<Type>(); }
+  size_t GetSize() override { return 0; }
+  size_t GetAlign() override { return 0; }
   bool CanDestroy() override { return false; }
   void Destroy(void* value) override {}
   bool CanClone() override { return false; }
   void* Clone(const std::any& value) override { return nullptr; }
   void* Clone(const void* value) override { return nullptr; }
+  void DestroyAt(void* value) override {}
+  void* CloneAt(void* memory, const void* value) override { return nullptr; }
 };
 
 template <typename Type>
@@ -423,5 +423,49 @@ TEST(TypeInfoTest, PlaceholderAnyCloneInvalidType) {
   EXPECT_EQ(TypeInfo::GetPlaceholder<Item>()->Clone(any_item), nullptr);
 }
 
+TEST(TypeInfoTest, InfoSizeAndAlign) {
+  EXPECT_EQ(TypeInfo::Get<int>()->GetSize(), sizeof(int));
+  EXPECT_EQ(TypeInfo::Get<int>()->GetAlign(), alignof(int));
+  EXPECT_EQ(TypeInfo::Get<Item>()->GetSize(), sizeof(Item));
+  EXPECT_EQ(TypeInfo::Get<Item>()->GetAlign(), alignof(Item));
+  EXPECT_EQ(TypeInfo::Get<void>()->GetSize(), 0);
+  EXPECT_EQ(TypeInfo::Get<void>()->GetAlign(), 0);
+  EXPECT_EQ(TypeInfo::GetPlaceholder<Item>()->GetSize(), 0);
+  EXPECT_EQ(TypeInfo::GetPlaceholder<Item>()->GetAlign(), 0);
+}
+
+TEST(TypeInfoTest, InfoCloneAtAndDestroyAt) {
+  Counts counts = {};
+  Item item(&counts);
+  alignas(Item) std::byte memory[sizeof(Item)];
+  void* cloned_item = TypeInfo::Get<Item>()->CloneAt(memory, &item);
+  EXPECT_EQ(cloned_item, memory);
+  EXPECT_EQ(counts.copy_construct, 1);
+  TypeInfo::Get<Item>()->DestroyAt(cloned_item);
+  EXPECT_EQ(counts.destruct, 1);
+}
+
+TEST(TypeInfoTest, InfoCloneAtNull) {
+  alignas(Item) std::byte memory[sizeof(Item)];
+  EXPECT_EQ(TypeInfo::Get<Item>()->CloneAt(memory, nullptr), nullptr);
+  TypeInfo::Get<Item>()->DestroyAt(nullptr);
+}
+
+TEST(TypeInfoTest, InfoNoCopyCloneAt) {
+  Counts counts = {};
+  NoCopyItem item(&counts);
+  alignas(NoCopyItem) std::byte memory[sizeof(NoCopyItem)];
+  EXPECT_EQ(TypeInfo::Get<NoCopyItem>()->CloneAt(memory, &item), nullptr);
+  EXPECT_EQ(counts.copy_construct, 0);
+}
+
+TEST(TypeInfoTest, PlaceholderCloneAt) {
+  Counts counts = {};
+  Item item(&counts);
+  alignas(Item) std::byte memory[sizeof(Item)];
+  EXPECT_EQ(TypeInfo::GetPlaceholder<Item>()->CloneAt(memory, &item), nullptr);
+  EXPECT_EQ(counts.copy_construct, 0);
+}
+
 }  // namespace
 }  // namespace gb
@@ -0,0 +1,382 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_CONTAINER_CONCURRENT_HASH_MAP_H_
+#define GB_CONTAINER_CONCURRENT_HASH_MAP_H_
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+
+namespace gb {
+
+// This is a thread-safe hash map optimized for read-mostly use, like a registry
+// of names or IDs that is looked up from many threads but modified rarely.
+//
+// Lookups never take a lock. The map is split into a power of two number of
+// shards, each of which holds an immutable absl::flat_hash_map snapshot. A
+// lookup pins the current snapshot of the key's shard with two atomic
+// operations, performs a normal flat_hash_map lookup, and releases it.
+//
+// Modifications lock the shard mutex, copy the shard snapshot, apply the change
+// and publish the new snapshot. The old snapshot is deleted once all readers
+// that may still be using it have released it. As a result, each modification
+// costs O(n / shard_count) and writers to the same shard are serialized. This
+// is the right tradeoff only if lookups vastly outnumber modifications: with
+// the default shard count and 1024 entries, the map is already about 3x slower
+// than a mutex guarded absl::flat_hash_map when 1 in 10 operations is a write
+// (see MixedReadWriteBenchmark). Write-heavy maps should use a mutex instead.
+//
+// Keys and values must be copyable, as every modification copies the shard.
+//
+// Since entries may be erased or replaced at any time by another thread, there
+// are no iterators or references to values. Lookups instead either return a
+// copy of the value (get) or call a function with the value while the snapshot
+// is pinned (visit). The map is consistent per shard, but not across shards:
+// for_each and size() may observe concurrent modifications partially.
+//
+// Key lookups support heterogeneous keys in the same way as
+// absl::flat_hash_map, if both Hash and Eq are transparent. The default Eq is
+// transparent, so only a transparent Hash needs to be provided (for instance,
+// to look up std::string keys with std::string_view).
+//
+// This class is thread-safe.
+template <typename Key, typename Value, typename Hash = absl::Hash<Key>,
+          typename Eq = std::equal_to<>>
+class ConcurrentHashMap {
+ public:
+  static_assert(std::is_copy_constructible_v<Key> &&
+                    std::is_copy_constructible_v<Value>,
+                "ConcurrentHashMap keys and values must be copyable");
+
+  //----------------------------------------------------------------------------
+  // Types and constants
+  //----------------------------------------------------------------------------
+
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<const Key, Value>;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = Eq;
+
+  static inline constexpr size_type kDefaultShardCount = 16;
+
+  //----------------------------------------------------------------------------
+  // Construction / Destruction
+  //----------------------------------------------------------------------------
+
+  // Constructs an empty map with the specified number of shards. The shard
+  // count must be a power of two.
+  explicit ConcurrentHashMap(size_type shard_count = kDefaultShardCount);
+  ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+  ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+  ~ConcurrentHashMap();
+
+  //----------------------------------------------------------------------------
+  // Properties
+  //----------------------------------------------------------------------------
+
+  size_type shard_count() const { return shard_count_; }
+
+  // Returns the number of entries in the map. If there are concurrent
+  // modifications, this is only a snapshot.
+  bool empty() const { return size() == 0; }
+  size_type size() const { return size_.load(std::memory_order_relaxed); }
+
+  //----------------------------------------------------------------------------
+  // Lookup (lock-free)
+  //----------------------------------------------------------------------------
+
+  template <typename K>
+  bool contains(const K& key) const;
+  template <typename K>
+  size_type count(const K& key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  // Returns a copy of the value for the specified key, or std::nullopt if it
+  // is not in the map.
+  template <typename K>
+  std::optional<Value> get(const K& key) const;
+
+  // Calls func(const Value&) with the value for the specified key, and returns
+  // true. If the key is not in the map, func is not called and this returns
+  // false.
+  //
+  // The function must not modify this map, and should be short, as it delays
+  // the deletion of the snapshot it is reading from.
+  template <typename K, typename Func>
+  bool visit(const K& key, Func&& func) const;
+
+  // Calls func(const Key&, const Value&) for every entry in the map. Each shard
+  // is iterated from a consistent snapshot, but modifications made while
+  // iterating may or may not be seen in shards not yet visited.
+  //
+  // The function must not modify this map.
+  template <typename Func>
+  void for_each(Func&& func) const;
+
+  //----------------------------------------------------------------------------
+  // Modifiers
+  //----------------------------------------------------------------------------
+
+  // Inserts the value if the key does not already exist. Returns true if the
+  // value was inserted.
+  bool insert(const value_type& value) {
+    return try_emplace(value.first, value.second);
+  }
+  bool insert(value_type&& value) {
+    return try_emplace(std::move(const_cast<Key&>(value.first)),
+                       std::move(value.second));
+  }
+
+  // Constructs the value in place if the key does not already exist. Returns
+  // true if the value was inserted.
+  template <typename K, typename... Args>
+  bool try_emplace(K&& key, Args&&... args);
+
+  // Inserts the value, or assigns it if the key already exists. Returns true if
+  // the value was inserted, and false if it was assigned.
+  template <typename K, typename V>
+  bool insert_or_assign(K&& key, V&& value);
+
+  // Removes the entry for the specified key, and returns the number of entries
+  // removed (0 or 1).
+  template <typename K>
+  size_type erase(const K& key);
+
+  // Removes all entries.
+  void clear();
+
+ private:
+  using Map = absl::flat_hash_map<Key, Value, Hash, Eq>;
+
+  // Each shard is on its own cache line, so readers of different shards do not
+  // contend on the reader counts.
+  struct alignas(64) Shard {
+    Shard() = default;
+
+    // Guards modifications to the shard. Readers never take this.
+    absl::Mutex mutex;
+
+    // Current snapshot. This is never null.
+    std::atomic<const Map*> map = nullptr;
+
+    // Readers register in the reader count of the current epoch. A writer flips
+    // the epoch after publishing a new snapshot, and then waits for the reader
+    // count of the previous epoch to drain to zero before deleting the old
+    // snapshot. New readers register under the new epoch, so the wait is
+    // bounded.
+    std::atomic<int> epoch = 0;
+    std::atomic<int> readers[2] = {0, 0};
+  };
+
+  // Pins the current snapshot of a shard while in scope.
+  class ReadLock {
+   public:
+    explicit ReadLock(Shard* shard);
+    ReadLock(const ReadLock&) = delete;
+    ReadLock& operator=(const ReadLock&) = delete;
+    ~ReadLock() { shard_->readers[epoch_].fetch_sub(1); }
+
+    const Map& map() const { return *map_; }
+
+   private:
+    Shard* const shard_;
+    int epoch_;
+    const Map* map_;
+  };
+
+  template <typename K>
+  Shard* GetShard(const K& key) const {
+    const uint64_t hash = static_cast<uint64_t>(Hash()(key));
+    // The flat_hash_map within the shard uses the low bits of the hash, so the
+    // shard is selected from the high bits to keep them independent.
+    return &shards_[shard_shift_ < 64 ? hash >> shard_shift_ : 0];
+  }
+
+  // Replaces the current snapshot of the shard with the new map, and deletes
+  // the old snapshot once there are no more readers of it. The shard mutex
+  // must be held.
+  void Publish(Shard* shard, std::unique_ptr<Map> map);
+
+  const size_type shard_count_;
+  const int shard_shift_;
+  std::unique_ptr<Shard[]> shards_;
+  std::atomic<size_type> size_ = 0;
+};
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+ConcurrentHashMap<Key, Value, Hash, Eq>::ReadLock::ReadLock(Shard* shard)
+    : shard_(shard) {
+  while (true) {
+    epoch_ = shard_->epoch.load();
+    shard_->readers[epoch_].fetch_add(1);
+    // If the epoch changed before the reader count was incremented, a writer
+    // may have already stopped waiting on this epoch, so try again.
+    if (shard_->epoch.load() == epoch_) {
+      break;
+    }
+    shard_->readers[epoch_].fetch_sub(1);
+  }
+  map_ = shard_->map.load();
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+ConcurrentHashMap<Key, Value, Hash, Eq>::ConcurrentHashMap(
+    size_type shard_count)
+    : shard_count_(shard_count),
+      shard_shift_(64 - std::countr_zero(static_cast<uint64_t>(shard_count))),
+      shards_(std::make_unique<Shard[]>(shard_count)) {
+  CHECK(shard_count > 0 && std::has_single_bit(shard_count))
+      << "Shard count must be a power of two";
+  for (size_type i = 0; i < shard_count_; ++i) {
+    shards_[i].map.store(new Map);
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+ConcurrentHashMap<Key, Value, Hash, Eq>::~ConcurrentHashMap() {
+  for (size_type i = 0; i < shard_count_; ++i) {
+    delete shards_[i].map.load();
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+void ConcurrentHashMap<Key, Value, Hash, Eq>::Publish(Shard* shard,
+                                                      std::unique_ptr<Map> map) {
+  const Map* old_map = shard->map.exchange(map.release());
+  const int old_epoch = shard->epoch.load();
+  shard->epoch.store(1 - old_epoch);
+  while (shard->readers[old_epoch].load() != 0) {
+    std::this_thread::yield();
+  }
+  delete old_map;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+template <typename K>
+bool ConcurrentHashMap<Key, Value, Hash, Eq>::contains(const K& key) const {
+  ReadLock lock(GetShard(key));
+  return lock.map().contains(key);
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+template <typename K>
+std::optional<Value> ConcurrentHashMap<Key, Value, Hash, Eq>::get(
+    const K& key) const {
+  ReadLock lock(GetShard(key));
+  auto it = lock.map().find(key);
+  if (it == lock.map().end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+template <typename K, typename Func>
+bool ConcurrentHashMap<Key, Value, Hash, Eq>::visit(const K& key,
+                                                    Func&& func) const {
+  ReadLock lock(GetShard(key));
+  auto it = lock.map().find(key);
+  if (it == lock.map().end()) {
+    return false;
+  }
+  func(static_cast<const Value&>(it->second));
+  return true;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+template <typename Func>
+void ConcurrentHashMap<Key, Value, Hash, Eq>::for_each(Func&& func) const {
+  for (size_type i = 0; i < shard_count_; ++i) {
+    ReadLock lock(&shards_[i]);
+    for (const auto& [key, value] : lock.map()) {
+      func(key, value);
+    }
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+template <typename K, typename... Args>
+bool ConcurrentHashMap<Key, Value, Hash, Eq>::try_emplace(K&& key,
+                                                         Args&&... args) {
+  Shard* shard = GetShard(key);
+  absl::MutexLock lock(&shard->mutex);
+  const Map* map = shard->map.load();
+  if (map->contains(key)) {
+    return false;
+  }
+  auto new_map = std::make_unique<Map>(*map);
+  new_map->try_emplace(std::forward<K>(key), std::forward<Args>(args)...);
+  Publish(shard, std::move(new_map));
+  size_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+template <typename K, typename V>
+bool ConcurrentHashMap<Key, Value, Hash, Eq>::insert_or_assign(K&& key,
+                                                              V&& value) {
+  Shard* shard = GetShard(key);
+  absl::MutexLock lock(&shard->mutex);
+  auto new_map = std::make_unique<Map>(*shard->map.load());
+  const bool inserted =
+      new_map->insert_or_assign(std::forward<K>(key), std::forward<V>(value))
+          .second;
+  Publish(shard, std::move(new_map));
+  if (inserted) {
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return inserted;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+template <typename K>
+typename ConcurrentHashMap<Key, Value, Hash, Eq>::size_type
+ConcurrentHashMap<Key, Value, Hash, Eq>::erase(const K& key) {
+  Shard* shard = GetShard(key);
+  absl::MutexLock lock(&shard->mutex);
+  const Map* map = shard->map.load();
+  if (!map->contains(key)) {
+    return 0;
+  }
+  auto new_map = std::make_unique<Map>(*map);
+  new_map->erase(key);
+  Publish(shard, std::move(new_map));
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  return 1;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+void ConcurrentHashMap<Key, Value, Hash, Eq>::clear() {
+  for (size_type i = 0; i < shard_count_; ++i) {
+    Shard* shard = &shards_[i];
+    absl::MutexLock lock(&shard->mutex);
+    const size_type shard_size = shard->map.load()->size();
+    if (shard_size == 0) {
+      continue;
+    }
+    Publish(shard, std::make_unique<Map>());
+    size_.fetch_sub(shard_size, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace gb
+
+#endif  // GB_CONTAINER_CONCURRENT_HASH_MAP_H_
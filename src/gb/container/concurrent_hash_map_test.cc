@@ -0,0 +1,315 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/container/concurrent_hash_map.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "gb/base/context_builder.h"
+#include "gb/job/fiber_job_system.h"
+#include "gb/job/job_counter.h"
+#include "gb/test/thread_tester.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(ConcurrentHashMapTest, DefaultConstruct) {
+  ConcurrentHashMap<int, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0);
+  EXPECT_EQ(map.shard_count(),
+            (ConcurrentHashMap<int, int>::kDefaultShardCount));
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_EQ(map.get(1), std::nullopt);
+}
+
+TEST(ConcurrentHashMapTest, SingleShard) {
+  ConcurrentHashMap<int, int> map(1);
+  EXPECT_EQ(map.shard_count(), 1);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(map.insert({i, i * 2}));
+  }
+  EXPECT_EQ(map.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(map.get(i), i * 2);
+  }
+}
+
+TEST(ConcurrentHashMapTest, Insert) {
+  ConcurrentHashMap<int, std::string> map;
+  EXPECT_TRUE(map.insert({1, "one"}));
+  EXPECT_TRUE(map.try_emplace(2, "two"));
+  EXPECT_FALSE(map.insert({1, "uno"}));
+  EXPECT_FALSE(map.try_emplace(2, "dos"));
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_TRUE(map.contains(1));
+  EXPECT_EQ(map.count(2), 1);
+  EXPECT_EQ(map.count(3), 0);
+  EXPECT_EQ(map.get(1), "one");
+  EXPECT_EQ(map.get(2), "two");
+}
+
+TEST(ConcurrentHashMapTest, InsertOrAssign) {
+  ConcurrentHashMap<int, std::string> map;
+  EXPECT_TRUE(map.insert_or_assign(1, "one"));
+  EXPECT_FALSE(map.insert_or_assign(1, "uno"));
+  EXPECT_EQ(map.size(), 1);
+  EXPECT_EQ(map.get(1), "uno");
+}
+
+TEST(ConcurrentHashMapTest, Erase) {
+  ConcurrentHashMap<int, std::string> map;
+  map.insert({1, "one"});
+  map.insert({2, "two"});
+  EXPECT_EQ(map.erase(3), 0);
+  EXPECT_EQ(map.erase(1), 1);
+  EXPECT_EQ(map.erase(1), 0);
+  EXPECT_EQ(map.size(), 1);
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_TRUE(map.contains(2));
+}
+
+TEST(ConcurrentHashMapTest, Clear) {
+  ConcurrentHashMap<int, int> map;
+  for (int i = 0; i < 100; ++i) {
+    map.insert({i, i});
+  }
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_FALSE(map.contains(i));
+  }
+}
+
+TEST(ConcurrentHashMapTest, Visit) {
+  ConcurrentHashMap<int, std::vector<int>> map;
+  map.try_emplace(1, 10, 5);
+  int sum = 0;
+  EXPECT_TRUE(map.visit(1, [&sum](const std::vector<int>& values) {
+    for (int value : values) {
+      sum += value;
+    }
+  }));
+  EXPECT_EQ(sum, 50);
+  EXPECT_FALSE(map.visit(2, [](const std::vector<int>&) {
+    ADD_FAILURE() << "Visit called for missing key";
+  }));
+}
+
+TEST(ConcurrentHashMapTest, ForEach) {
+  ConcurrentHashMap<int, std::string> map;
+  map.insert({1, "one"});
+  map.insert({2, "two"});
+  map.insert({3, "three"});
+  std::vector<std::pair<int, std::string>> entries;
+  map.for_each([&entries](int key, const std::string& value) {
+    entries.emplace_back(key, value);
+  });
+  EXPECT_THAT(entries, UnorderedElementsAre(Pair(1, "one"), Pair(2, "two"),
+                                            Pair(3, "three")));
+}
+
+// Transparent hash, which allows std::string keys to be looked up with any
+// string-like type.
+struct StringHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view str) const {
+    return absl::Hash<std::string_view>()(str);
+  }
+};
+
+TEST(ConcurrentHashMapTest, HeterogeneousLookup) {
+  ConcurrentHashMap<std::string, int, StringHash> map;
+  map.insert({"one", 1});
+  std::string_view key = "one";
+  EXPECT_TRUE(map.contains(key));
+  EXPECT_EQ(map.get(key), 1);
+  EXPECT_EQ(map.erase(key), 1);
+  EXPECT_FALSE(map.contains("one"));
+}
+
+TEST(ConcurrentHashMapTest, ConcurrentReadWrite) {
+  static constexpr int kStableCount = 100;
+  static constexpr int kChurnCount = 100;
+
+  // Stable keys always map to their own value, while churn keys are
+  // continuously inserted, reassigned and erased.
+  ConcurrentHashMap<int, std::string> map(4);
+  for (int i = 0; i < kStableCount; ++i) {
+    map.insert({i, absl::StrCat(i)});
+  }
+
+  ThreadTester tester;
+  tester.RunLoop(
+      1, "reader",
+      [&map] {
+        for (int i = 0; i < kStableCount; ++i) {
+          auto value = map.get(i);
+          if (!value.has_value() || *value != absl::StrCat(i)) {
+            return false;
+          }
+        }
+        for (int i = kStableCount; i < kStableCount + kChurnCount; ++i) {
+          bool valid = true;
+          map.visit(i, [i, &valid](const std::string& value) {
+            valid = (value == absl::StrCat(i) || value == absl::StrCat(-i));
+          });
+          if (!valid) {
+            return false;
+          }
+        }
+        return true;
+      },
+      ThreadTester::MaxConcurrency());
+  tester.RunLoop(1, "writer", [&map] {
+    for (int i = kStableCount; i < kStableCount + kChurnCount; ++i) {
+      map.insert({i, absl::StrCat(i)});
+      map.insert_or_assign(i, absl::StrCat(-i));
+    }
+    for (int i = kStableCount; i < kStableCount + kChurnCount; ++i) {
+      map.erase(i);
+    }
+    return true;
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  EXPECT_TRUE(tester.Complete()) << tester.GetResultString();
+  EXPECT_EQ(map.size(), kStableCount);
+}
+
+//------------------------------------------------------------------------------
+// Benchmark
+//------------------------------------------------------------------------------
+
+// Mutex guarded absl::flat_hash_map, which is the pattern ConcurrentHashMap is
+// intended to replace for registries.
+class MutexHashMap {
+ public:
+  bool Get(int key, int* value) const {
+    absl::MutexLock lock(&mutex_);
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+      return false;
+    }
+    *value = it->second;
+    return true;
+  }
+  void Set(int key, int value) {
+    absl::MutexLock lock(&mutex_);
+    map_[key] = value;
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<int, int> map_ ABSL_GUARDED_BY(mutex_);
+};
+
+class ConcurrentHashMapAdapter {
+ public:
+  bool Get(int key, int* value) const {
+    return map_.visit(key, [value](int found) { *value = found; });
+  }
+  void Set(int key, int value) { map_.insert_or_assign(key, value); }
+
+ private:
+  ConcurrentHashMap<int, int> map_;
+};
+
+// Runs the specified number of operations on each of the specified number of
+// jobs, where one in every write_period operations is a write and the rest are
+// reads. Returns the total time taken.
+template <typename MapType>
+absl::Duration RunMixedBenchmark(int job_count, int op_count, int write_period) {
+  static constexpr int kKeyCount = 1024;
+
+  MapType map;
+  for (int i = 0; i < kKeyCount; ++i) {
+    map.Set(i, i);
+  }
+
+  std::atomic<int> found_count = 0;
+  auto job_main = [&map, &found_count, op_count, write_period](int job_index) {
+    int found = 0;
+    uint32_t key = static_cast<uint32_t>(job_index) * 7919;
+    for (int i = 0; i < op_count; ++i) {
+      key = key * 1664525 + 1013904223;
+      const int index = static_cast<int>(key >> 22) % kKeyCount;
+      if (i % write_period == 0) {
+        map.Set(index, i);
+      } else if (int value; map.Get(index, &value)) {
+        ++found;
+      }
+    }
+    found_count += found;
+  };
+
+  absl::Time start_time;
+  absl::Time end_time;
+  if (SupportsFibers()) {
+    auto job_system = FiberJobSystem::Create(
+        ContextBuilder()
+            .SetValue<int>(FiberJobSystem::kKeyThreadCount, 0)
+            .Build());
+    absl::Notification done;
+    start_time = absl::Now();
+    job_system->Run([&] {
+      JobCounter counter;
+      for (int i = 0; i < job_count; ++i) {
+        JobSystem::Get()->Run(&counter, [&job_main, i] { job_main(i); });
+      }
+      JobSystem::Wait(&counter);
+      done.Notify();
+    });
+    done.WaitForNotification();
+    end_time = absl::Now();
+  } else {
+    std::atomic<int> job_index = 0;
+    ThreadTester tester;
+    start_time = absl::Now();
+    tester.Run(
+        "job",
+        [&job_main, &job_index] {
+          job_main(job_index++);
+          return true;
+        },
+        job_count);
+    EXPECT_TRUE(tester.Complete());
+    end_time = absl::Now();
+  }
+  EXPECT_GT(found_count.load(), 0);
+  return end_time - start_time;
+}
+
+TEST(ConcurrentHashMapTest, MixedReadWriteBenchmark) {
+  const int job_count = ThreadTester::MaxConcurrency();
+  static constexpr int kOpCount = 100000;
+  for (int write_period : {1000, 100, 10}) {
+    const absl::Duration mutex_time =
+        RunMixedBenchmark<MutexHashMap>(job_count, kOpCount, write_period);
+    const absl::Duration concurrent_time =
+        RunMixedBenchmark<ConcurrentHashMapAdapter>(job_count, kOpCount,
+                                                    write_period);
+    LOG(INFO) << job_count << " jobs x " << kOpCount << " ops, 1 write per "
+              << write_period << " ops: mutex=" << mutex_time
+              << ", concurrent=" << concurrent_time;
+  }
+}
+
+}  // namespace
+}  // namespace gb
@@ -0,0 +1,349 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_CONTAINER_SOA_VECTOR_H_
+#define GB_CONTAINER_SOA_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+
+namespace gb {
+
+// This is a resizable "structure of arrays" container.
+//
+// Conceptually, an SoaVector<A, B, C> holds a sequence of elements just like a
+// std::vector<std::tuple<A, B, C>> would. However, each field is stored in its
+// own contiguous array, so that loops which only touch one (or a few) fields
+// of every element walk densely packed memory, and can be trivially vectorized.
+//
+// Fields are referred to by their index in the template parameter list, and
+// the contents of any field can be accessed as an absl::Span via field<N>():
+//
+//   SoaVector<glm::vec3, glm::vec3, float> particles;
+//   particles.push_back(position, velocity, lifetime);
+//   ...
+//   auto positions = particles.field<0>();
+//   auto velocities = particles.field<1>();
+//   for (size_t i = 0; i < particles.size(); ++i) {
+//     positions[i] += velocities[i] * dt;
+//   }
+//
+// All fields always have the same size (which is the size of the SoaVector).
+// Spans and pointers into a field are invalidated by any operation that changes
+// the size or capacity of the container, exactly like std::vector iterators.
+//
+// This class is thread-compatible.
+template <typename... Fields>
+class SoaVector {
+ public:
+  static_assert(sizeof...(Fields) > 0, "SoaVector requires at least one field");
+  static_assert((!std::is_same_v<Fields, bool> && ...),
+                "bool fields cannot be spanned, use uint8_t instead");
+
+  //----------------------------------------------------------------------------
+  // Types and constants
+  //----------------------------------------------------------------------------
+
+  using size_type = size_t;
+
+  // Type of the field at the specified index.
+  template <size_t Index>
+  using field_type = std::tuple_element_t<Index, std::tuple<Fields...>>;
+
+  // Tuple of references to all fields of an element.
+  using reference = std::tuple<Fields&...>;
+  using const_reference = std::tuple<const Fields&...>;
+
+  // Number of fields in each element.
+  static inline constexpr size_type kFieldCount = sizeof...(Fields);
+
+  //----------------------------------------------------------------------------
+  // Construction / Destruction
+  //----------------------------------------------------------------------------
+
+  SoaVector() = default;
+  explicit SoaVector(size_type size) { resize(size); }
+  SoaVector(const SoaVector&) = default;
+  SoaVector(SoaVector&& other) noexcept
+      : size_(std::exchange(other.size_, 0)),
+        fields_(std::move(other.fields_)) {}
+  SoaVector& operator=(const SoaVector&) = default;
+  SoaVector& operator=(SoaVector&& other) noexcept {
+    if (&other != this) {
+      size_ = std::exchange(other.size_, 0);
+      fields_ = std::move(other.fields_);
+    }
+    return *this;
+  }
+  ~SoaVector() = default;
+
+  //----------------------------------------------------------------------------
+  // Capacity
+  //----------------------------------------------------------------------------
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+
+  // Returns the number of elements that can be held without reallocating any
+  // field.
+  size_type capacity() const;
+
+  // Ensures all fields have room for at least the specified number of elements.
+  void reserve(size_type capacity);
+
+  // Frees any excess capacity in all fields.
+  void shrink_to_fit();
+
+  //----------------------------------------------------------------------------
+  // Field and element access
+  //----------------------------------------------------------------------------
+
+  // Returns a span over all values of the specified field.
+  template <size_t Index>
+  absl::Span<field_type<Index>> field() {
+    return absl::MakeSpan(std::get<Index>(fields_));
+  }
+  template <size_t Index>
+  absl::Span<const field_type<Index>> field() const {
+    return absl::MakeConstSpan(std::get<Index>(fields_));
+  }
+
+  // Returns a pointer to the start of the specified field. This is null if the
+  // field has never had any capacity.
+  template <size_t Index>
+  field_type<Index>* data() {
+    return std::get<Index>(fields_).data();
+  }
+  template <size_t Index>
+  const field_type<Index>* data() const {
+    return std::get<Index>(fields_).data();
+  }
+
+  // Returns the value of a single field of the element at the specified index.
+  template <size_t Index>
+  field_type<Index>& get(size_type index) {
+    DCHECK(index < size_);
+    return std::get<Index>(fields_)[index];
+  }
+  template <size_t Index>
+  const field_type<Index>& get(size_type index) const {
+    DCHECK(index < size_);
+    return std::get<Index>(fields_)[index];
+  }
+
+  // Returns a tuple of references to all fields of the element at the specified
+  // index. These can be used with structured bindings:
+  //
+  //   auto [position, velocity, lifetime] = particles[i];
+  reference operator[](size_type index);
+  const_reference operator[](size_type index) const;
+
+  //----------------------------------------------------------------------------
+  // Modifiers
+  //----------------------------------------------------------------------------
+
+  // Removes all elements. Capacity is not changed.
+  void clear();
+
+  // Adds a new element to the end. Exactly one value must be passed in for
+  // each field, and each value is forwarded to the constructor of its field.
+  template <typename... Values>
+  void push_back(Values&&... values);
+
+  // Removes the last element. The SoaVector must not be empty.
+  void pop_back();
+
+  // Inserts a new element before the specified index (which may be equal to
+  // size()). This is O(n) as all following elements in every field are moved.
+  template <typename... Values>
+  void insert(size_type index, Values&&... values);
+
+  // Removes the element at the specified index, preserving the order of the
+  // remaining elements. This is O(n).
+  void erase(size_type index);
+
+  // Removes elements in the range [first, last), preserving the order of the
+  // remaining elements.
+  void erase(size_type first, size_type last);
+
+  // Removes the element at the specified index by moving the last element into
+  // its place. This is O(1) but does not preserve element order.
+  void swap_erase(size_type index);
+
+  // Resizes all fields to the specified size. New elements are value
+  // initialized, or copy constructed from the specified values.
+  void resize(size_type size);
+  void resize(size_type size, const Fields&... values);
+
+  void swap(SoaVector& other) noexcept;
+  friend void swap(SoaVector& a, SoaVector& b) noexcept { a.swap(b); }
+
+ private:
+  using Indices = std::index_sequence_for<Fields...>;
+
+  template <size_t... I>
+  reference GetElement(size_type index, std::index_sequence<I...>) {
+    return reference(std::get<I>(fields_)[index]...);
+  }
+  template <size_t... I>
+  const_reference GetElement(size_type index, std::index_sequence<I...>) const {
+    return const_reference(std::get<I>(fields_)[index]...);
+  }
+
+  template <typename Tuple, size_t... I>
+  void PushBack(Tuple&& values, std::index_sequence<I...>) {
+    (std::get<I>(fields_).emplace_back(
+         std::get<I>(std::forward<Tuple>(values))),
+     ...);
+  }
+
+  template <typename Tuple, size_t... I>
+  void Insert(size_type index, Tuple&& values, std::index_sequence<I...>) {
+    (std::get<I>(fields_).emplace(std::get<I>(fields_).begin() + index,
+                                  std::get<I>(std::forward<Tuple>(values))),
+     ...);
+  }
+
+  template <typename Tuple, size_t... I>
+  void Resize(size_type size, const Tuple& values, std::index_sequence<I...>) {
+    (std::get<I>(fields_).resize(size, std::get<I>(values)), ...);
+  }
+
+  template <typename Func>
+  void ForEachField(Func&& func) {
+    std::apply([&func](auto&... field) { (func(field), ...); }, fields_);
+  }
+
+  size_type size_ = 0;
+  std::tuple<std::vector<Fields>...> fields_;
+};
+
+template <typename... Fields>
+typename SoaVector<Fields...>::size_type SoaVector<Fields...>::capacity()
+    const {
+  size_type result = std::get<0>(fields_).capacity();
+  std::apply(
+      [&result](const auto&... field) {
+        ((result = std::min(result, field.capacity())), ...);
+      },
+      fields_);
+  return result;
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::reserve(size_type capacity) {
+  ForEachField([capacity](auto& field) { field.reserve(capacity); });
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::shrink_to_fit() {
+  ForEachField([](auto& field) { field.shrink_to_fit(); });
+}
+
+template <typename... Fields>
+typename SoaVector<Fields...>::reference SoaVector<Fields...>::operator[](
+    size_type index) {
+  DCHECK(index < size_);
+  return GetElement(index, Indices{});
+}
+
+template <typename... Fields>
+typename SoaVector<Fields...>::const_reference SoaVector<Fields...>::operator[](
+    size_type index) const {
+  DCHECK(index < size_);
+  return GetElement(index, Indices{});
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::clear() {
+  ForEachField([](auto& field) { field.clear(); });
+  size_ = 0;
+}
+
+template <typename... Fields>
+template <typename... Values>
+void SoaVector<Fields...>::push_back(Values&&... values) {
+  static_assert(sizeof...(Values) == sizeof...(Fields),
+                "push_back requires exactly one value per field");
+  PushBack(std::forward_as_tuple(std::forward<Values>(values)...), Indices{});
+  ++size_;
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::pop_back() {
+  DCHECK(size_ > 0);
+  ForEachField([](auto& field) { field.pop_back(); });
+  --size_;
+}
+
+template <typename... Fields>
+template <typename... Values>
+void SoaVector<Fields...>::insert(size_type index, Values&&... values) {
+  static_assert(sizeof...(Values) == sizeof...(Fields),
+                "insert requires exactly one value per field");
+  DCHECK(index <= size_);
+  Insert(index, std::forward_as_tuple(std::forward<Values>(values)...),
+         Indices{});
+  ++size_;
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::erase(size_type index) {
+  erase(index, index + 1);
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::erase(size_type first, size_type last) {
+  DCHECK(first <= last && last <= size_);
+  if (first == last) {
+    return;
+  }
+  ForEachField([first, last](auto& field) {
+    field.erase(field.begin() + first, field.begin() + last);
+  });
+  size_ -= last - first;
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::swap_erase(size_type index) {
+  DCHECK(index < size_);
+  const size_type last = size_ - 1;
+  ForEachField([index, last](auto& field) {
+    if (index != last) {
+      field[index] = std::move(field[last]);
+    }
+    field.pop_back();
+  });
+  --size_;
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::resize(size_type size) {
+  ForEachField([size](auto& field) { field.resize(size); });
+  size_ = size;
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::resize(size_type size, const Fields&... values) {
+  Resize(size, std::forward_as_tuple(values...), Indices{});
+  size_ = size;
+}
+
+template <typename... Fields>
+void SoaVector<Fields...>::swap(SoaVector& other) noexcept {
+  std::swap(size_, other.size_);
+  std::swap(fields_, other.fields_);
+}
+
+}  // namespace gb
+
+#endif  // GB_CONTAINER_SOA_VECTOR_H_
@@ -0,0 +1,229 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/container/soa_vector.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+using ::testing::ElementsAre;
+
+using TestVector = SoaVector<int, float, std::string>;
+
+TestVector MakeTestVector() {
+  TestVector vec;
+  vec.push_back(1, 1.5f, "one");
+  vec.push_back(2, 2.5f, "two");
+  vec.push_back(3, 3.5f, "three");
+  vec.push_back(4, 4.5f, "four");
+  return vec;
+}
+
+TEST(SoaVectorTest, DefaultConstruct) {
+  TestVector vec;
+  EXPECT_TRUE(vec.empty());
+  EXPECT_EQ(vec.size(), 0);
+  EXPECT_EQ(vec.capacity(), 0);
+  EXPECT_TRUE(vec.field<0>().empty());
+  EXPECT_TRUE(vec.field<1>().empty());
+  EXPECT_TRUE(vec.field<2>().empty());
+}
+
+TEST(SoaVectorTest, ConstructWithSize) {
+  TestVector vec(3);
+  EXPECT_FALSE(vec.empty());
+  EXPECT_EQ(vec.size(), 3);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(0, 0, 0));
+  EXPECT_THAT(vec.field<1>(), ElementsAre(0.0f, 0.0f, 0.0f));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("", "", ""));
+}
+
+TEST(SoaVectorTest, PushBack) {
+  TestVector vec = MakeTestVector();
+  EXPECT_EQ(vec.size(), 4);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 2, 3, 4));
+  EXPECT_THAT(vec.field<1>(), ElementsAre(1.5f, 2.5f, 3.5f, 4.5f));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "two", "three", "four"));
+}
+
+TEST(SoaVectorTest, PushBackMoveOnly) {
+  SoaVector<int, std::unique_ptr<int>> vec;
+  vec.push_back(1, std::make_unique<int>(10));
+  auto ptr = std::make_unique<int>(20);
+  vec.push_back(2, std::move(ptr));
+  EXPECT_EQ(ptr, nullptr);
+  ASSERT_EQ(vec.size(), 2);
+  EXPECT_EQ(*vec.get<1>(0), 10);
+  EXPECT_EQ(*vec.get<1>(1), 20);
+}
+
+TEST(SoaVectorTest, FieldsAreContiguous) {
+  TestVector vec = MakeTestVector();
+  EXPECT_EQ(vec.field<0>().data(), vec.data<0>());
+  EXPECT_EQ(vec.field<1>().data(), vec.data<1>());
+  EXPECT_EQ(vec.field<2>().data(), vec.data<2>());
+  for (size_t i = 0; i < vec.size(); ++i) {
+    EXPECT_EQ(&vec.get<0>(i), vec.data<0>() + i);
+    EXPECT_EQ(&vec.get<1>(i), vec.data<1>() + i);
+  }
+}
+
+TEST(SoaVectorTest, ModifyThroughField) {
+  TestVector vec = MakeTestVector();
+  for (int& value : vec.field<0>()) {
+    value *= 10;
+  }
+  EXPECT_THAT(vec.field<0>(), ElementsAre(10, 20, 30, 40));
+  EXPECT_THAT(vec.field<1>(), ElementsAre(1.5f, 2.5f, 3.5f, 4.5f));
+}
+
+TEST(SoaVectorTest, ConstField) {
+  const TestVector vec = MakeTestVector();
+  absl::Span<const int> ints = vec.field<0>();
+  EXPECT_THAT(ints, ElementsAre(1, 2, 3, 4));
+  EXPECT_EQ(vec.get<2>(1), "two");
+}
+
+TEST(SoaVectorTest, ElementAccess) {
+  TestVector vec = MakeTestVector();
+  auto [i, f, s] = vec[2];
+  EXPECT_EQ(i, 3);
+  EXPECT_EQ(f, 3.5f);
+  EXPECT_EQ(s, "three");
+  i = 30;
+  s = "thirty";
+  EXPECT_EQ(vec.get<0>(2), 30);
+  EXPECT_EQ(vec.get<2>(2), "thirty");
+
+  const TestVector& const_vec = vec;
+  EXPECT_EQ(std::get<1>(const_vec[0]), 1.5f);
+}
+
+TEST(SoaVectorTest, PopBack) {
+  TestVector vec = MakeTestVector();
+  vec.pop_back();
+  EXPECT_EQ(vec.size(), 3);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 2, 3));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "two", "three"));
+}
+
+TEST(SoaVectorTest, Insert) {
+  TestVector vec = MakeTestVector();
+  vec.insert(0, 0, 0.5f, "zero");
+  vec.insert(3, 5, 5.5f, "five");
+  vec.insert(vec.size(), 6, 6.5f, "six");
+  EXPECT_THAT(vec.field<0>(), ElementsAre(0, 1, 2, 5, 3, 4, 6));
+  EXPECT_THAT(vec.field<1>(),
+              ElementsAre(0.5f, 1.5f, 2.5f, 5.5f, 3.5f, 4.5f, 6.5f));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("zero", "one", "two", "five",
+                                          "three", "four", "six"));
+}
+
+TEST(SoaVectorTest, Erase) {
+  TestVector vec = MakeTestVector();
+  vec.erase(1);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 3, 4));
+  EXPECT_THAT(vec.field<1>(), ElementsAre(1.5f, 3.5f, 4.5f));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "three", "four"));
+  vec.erase(2);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 3));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "three"));
+}
+
+TEST(SoaVectorTest, EraseRange) {
+  TestVector vec = MakeTestVector();
+  vec.erase(1, 1);
+  EXPECT_EQ(vec.size(), 4);
+  vec.erase(1, 3);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 4));
+  EXPECT_THAT(vec.field<1>(), ElementsAre(1.5f, 4.5f));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "four"));
+  vec.erase(0, vec.size());
+  EXPECT_TRUE(vec.empty());
+}
+
+TEST(SoaVectorTest, SwapErase) {
+  TestVector vec = MakeTestVector();
+  vec.swap_erase(1);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 4, 3));
+  EXPECT_THAT(vec.field<1>(), ElementsAre(1.5f, 4.5f, 3.5f));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "four", "three"));
+  vec.swap_erase(2);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 4));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "four"));
+}
+
+TEST(SoaVectorTest, Resize) {
+  TestVector vec = MakeTestVector();
+  vec.resize(2);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 2));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "two"));
+  vec.resize(3);
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 2, 0));
+  EXPECT_THAT(vec.field<1>(), ElementsAre(1.5f, 2.5f, 0.0f));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "two", ""));
+  vec.resize(5, 7, 7.5f, "seven");
+  EXPECT_THAT(vec.field<0>(), ElementsAre(1, 2, 0, 7, 7));
+  EXPECT_THAT(vec.field<1>(), ElementsAre(1.5f, 2.5f, 0.0f, 7.5f, 7.5f));
+  EXPECT_THAT(vec.field<2>(), ElementsAre("one", "two", "", "seven", "seven"));
+}
+
+TEST(SoaVectorTest, ReserveAndClear) {
+  TestVector vec;
+  vec.reserve(10);
+  EXPECT_GE(vec.capacity(), 10);
+  const int* data = vec.data<0>();
+  for (int i = 0; i < 10; ++i) {
+    vec.push_back(i, 0.0f, "");
+  }
+  EXPECT_EQ(vec.data<0>(), data);
+  vec.clear();
+  EXPECT_TRUE(vec.empty());
+  EXPECT_GE(vec.capacity(), 10);
+  vec.shrink_to_fit();
+  EXPECT_EQ(vec.capacity(), 0);
+}
+
+TEST(SoaVectorTest, CopyAndMove) {
+  TestVector vec = MakeTestVector();
+  TestVector copy(vec);
+  EXPECT_THAT(copy.field<0>(), ElementsAre(1, 2, 3, 4));
+  EXPECT_THAT(copy.field<2>(), ElementsAre("one", "two", "three", "four"));
+  EXPECT_NE(copy.data<0>(), vec.data<0>());
+
+  const int* data = vec.data<0>();
+  TestVector moved(std::move(vec));
+  EXPECT_EQ(moved.size(), 4);
+  EXPECT_EQ(moved.data<0>(), data);
+  EXPECT_EQ(vec.size(), 0);
+
+  TestVector assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.size(), 4);
+  EXPECT_EQ(assigned.data<0>(), data);
+  EXPECT_EQ(moved.size(), 0);
+
+  assigned = copy;
+  EXPECT_THAT(assigned.field<0>(), ElementsAre(1, 2, 3, 4));
+}
+
+TEST(SoaVectorTest, Swap) {
+  TestVector a = MakeTestVector();
+  TestVector b;
+  b.push_back(10, 10.5f, "ten");
+  using std::swap;
+  swap(a, b);
+  EXPECT_THAT(a.field<0>(), ElementsAre(10));
+  EXPECT_THAT(b.field<0>(), ElementsAre(1, 2, 3, 4));
+}
+
+}  // namespace
+}  // namespace gb
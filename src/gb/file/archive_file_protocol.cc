@@ -0,0 +1,388 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/archive_file_protocol.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "gb/file/chunk_reader.h"
+#include "gb/file/chunk_writer.h"
+#include "gb/file/file_system.h"
+#include "gb/file/path.h"
+#include "gb/file/raw_file.h"
+
+namespace gb {
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Archive writing
+//------------------------------------------------------------------------------
+
+struct ArchiveItem {
+  std::string source;  // Full path in the source file system.
+  std::string path;    // Path in the archive.
+  PathInfo info;
+};
+
+bool AddArchiveItems(FileSystem* file_system, std::string_view folder,
+                     std::string_view archive_folder,
+                     std::vector<ArchiveItem>* items) {
+  for (std::string& source : file_system->List(folder)) {
+    const PathInfo info = file_system->GetPathInfo(source);
+    if (info.type == PathType::kInvalid) {
+      LOG(ERROR) << "Failed to get path info for " << source;
+      return false;
+    }
+    std::string path = JoinPath(archive_folder, RemoveFolder(source));
+    if (info.type == PathType::kFolder &&
+        !AddArchiveItems(file_system, source, path, items)) {
+      return false;
+    }
+    items->push_back({std::move(source), std::move(path), info});
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// ArchiveFile
+//------------------------------------------------------------------------------
+
+// Raw file for a single file within an archive.
+class ArchiveFile : public RawFile {
+ public:
+  ArchiveFile(File* archive, int64_t offset, int64_t size,
+              absl::Span<const uint8_t> view)
+      : archive_(archive), offset_(offset), size_(size), view_(view) {}
+
+  // Constructs a file over decompressed contents, which were allocated with
+  // std::malloc. The ArchiveFile takes ownership of the data.
+  ArchiveFile(int64_t size, uint8_t* data)
+      : archive_(nullptr),
+        offset_(0),
+        size_(size),
+        view_(data, static_cast<size_t>(size)),
+        data_(data) {}
+
+  ~ArchiveFile() override { std::free(data_); }
+
+  int64_t SeekEnd() override;
+  int64_t SeekTo(int64_t position) override;
+  int64_t Write(const void* buffer, int64_t size) override;
+  int64_t Read(void* buffer, int64_t size) override;
+  int64_t ReadAt(int64_t offset, void* buffer, int64_t size) override;
+  absl::Span<const uint8_t> GetMappedView() override { return view_; }
+
+ private:
+  File* const archive_;
+  const int64_t offset_;
+  const int64_t size_;
+  const absl::Span<const uint8_t> view_;
+  uint8_t* const data_ = nullptr;
+  int64_t position_ = 0;
+};
+
+int64_t ArchiveFile::SeekEnd() {
+  position_ = size_;
+  return position_;
+}
+
+int64_t ArchiveFile::SeekTo(int64_t position) {
+  position_ = std::clamp<int64_t>(position, 0, size_);
+  return position_;
+}
+
+int64_t ArchiveFile::Write(const void* buffer, int64_t size) { return 0; }
+
+int64_t ArchiveFile::Read(void* buffer, int64_t size) {
+  const int64_t bytes_read = ReadAt(position_, buffer, size);
+  if (bytes_read > 0) {
+    position_ += bytes_read;
+  }
+  return std::max<int64_t>(bytes_read, 0);
+}
+
+int64_t ArchiveFile::ReadAt(int64_t offset, void* buffer, int64_t size) {
+  size = std::min(size, size_ - offset);
+  if (size <= 0) {
+    return 0;
+  }
+  if (!view_.empty()) {
+    std::memcpy(buffer, view_.data() + offset, static_cast<size_t>(size));
+    return size;
+  }
+  return archive_->ReadAt(offset_ + offset, buffer, size);
+}
+
+}  // namespace
+
+bool WriteArchiveFile(FileSystem* file_system, std::string_view folder,
+                      File* archive, ArchiveCompression compression) {
+  if (!file_system->IsValidFolder(folder)) {
+    LOG(ERROR) << "Archive source is not a folder: " << folder;
+    return false;
+  }
+  std::vector<ArchiveItem> items;
+  if (!AddArchiveItems(file_system, folder, "/", &items)) {
+    return false;
+  }
+  std::sort(items.begin(), items.end(),
+            [](const ArchiveItem& a, const ArchiveItem& b) {
+              return a.path < b.path;
+            });
+
+  auto index = ChunkWriter::New<ArchiveEntry>(
+      kChunkTypeArchiveIndex, 1, static_cast<int32_t>(items.size()));
+  auto* entries = index.GetChunkData<ArchiveEntry>();
+  for (size_t i = 0; i < items.size(); ++i) {
+    const ArchiveItem& item = items[i];
+    if (item.info.type == PathType::kFile &&
+        item.info.size > std::numeric_limits<int32_t>::max()) {
+      LOG(ERROR) << "File is too large for an archive: " << item.source;
+      return false;
+    }
+    entries[i].path = index.AddString(item.path);
+    entries[i].type = static_cast<int32_t>(item.info.type);
+    entries[i].compression = ArchiveCompression::kNone;
+  }
+
+  // The index precedes the data chunks in the archive, but where the file
+  // contents are located is only known once they are written (as compression
+  // changes their size). So it is written now to reserve its space, and then
+  // written again once all the entries are complete.
+  if (!WriteChunkFile(archive, kChunkTypeArchive, {})) {
+    LOG(ERROR) << "Failed to write archive header";
+    return false;
+  }
+  const int64_t index_position = archive->GetPosition();
+  if (!index.Write(archive)) {
+    LOG(ERROR) << "Failed to write archive index";
+    return false;
+  }
+  std::string contents;
+  for (size_t i = 0; i < items.size(); ++i) {
+    const ArchiveItem& item = items[i];
+    ArchiveEntry& entry = entries[i];
+    if (item.info.type != PathType::kFile || item.info.size == 0) {
+      continue;
+    }
+    if (!file_system->ReadFile(item.source, &contents) ||
+        static_cast<int64_t>(contents.size()) != item.info.size) {
+      LOG(ERROR) << "Failed to read file for archive: " << item.source;
+      return false;
+    }
+    auto data =
+        ChunkWriter::New(kChunkTypeArchiveData, 1, contents.data(),
+                         static_cast<int32_t>(contents.size()));
+    if (compression == ArchiveCompression::kLz4) {
+      data.SetCompression(ChunkCompression::kLz4);
+    }
+    const int64_t data_position = archive->GetPosition();
+    if (!data.Write(archive)) {
+      LOG(ERROR) << "Failed to write archive data for " << item.source;
+      return false;
+    }
+
+    // ChunkWriter only compresses the chunk if it makes it smaller.
+    entry.size = item.info.size;
+    if (archive->GetPosition() - data_position <
+        static_cast<int64_t>(sizeof(ChunkHeader)) + data.GetSize()) {
+      entry.offset = data_position;
+      entry.compression = compression;
+    } else {
+      entry.offset = data_position + sizeof(ChunkHeader);
+    }
+  }
+
+  const int64_t archive_end = archive->GetPosition();
+  if (archive->SeekTo(index_position) != index_position ||
+      !index.Write(archive) || archive->SeekTo(archive_end) != archive_end) {
+    LOG(ERROR) << "Failed to update archive index";
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<ArchiveFileProtocol> ArchiveFileProtocol::Create(
+    std::unique_ptr<File> archive) {
+  if (archive == nullptr || !archive->GetFlags().IsSet(FileFlag::kRead)) {
+    LOG(ERROR) << "Archive is not open for reading";
+    return nullptr;
+  }
+  ChunkType file_type = {};
+  if (!ReadChunkFile(archive.get(), &file_type, nullptr) ||
+      file_type != kChunkTypeArchive) {
+    LOG(ERROR) << "File is not an archive";
+    return nullptr;
+  }
+  auto index = ChunkReader::Read(archive.get());
+  if (!index.has_value() || index->GetType() != kChunkTypeArchiveIndex) {
+    LOG(ERROR) << "Archive has no index";
+    return nullptr;
+  }
+  if (index->GetVersion() != 1) {
+    LOG(ERROR) << "Unsupported archive index version: "
+               << index->GetVersion();
+    return nullptr;
+  }
+  const int64_t index_size = index->GetSize();
+  if (index->GetCount() * static_cast<int64_t>(sizeof(ArchiveEntry)) >
+      index_size) {
+    LOG(ERROR) << "Corrupt archive index";
+    return nullptr;
+  }
+  const int64_t archive_size = archive->SeekEnd();
+
+  std::vector<Entry> entries;
+  entries.reserve(index->GetCount());
+  const char* index_data =
+      static_cast<const char*>(index->GetChunkData<void>());
+  auto* archive_entries = index->GetChunkData<ArchiveEntry>();
+  for (int32_t i = 0; i < index->GetCount(); ++i) {
+    ArchiveEntry& archive_entry = archive_entries[i];
+    const int64_t path_offset = archive_entry.path.offset;
+    if (path_offset < 0 || path_offset >= index_size) {
+      LOG(ERROR) << "Corrupt archive index";
+      return nullptr;
+    }
+    const size_t path_size = strnlen(index_data + path_offset,
+                                     static_cast<size_t>(index_size -
+                                                         path_offset));
+    Entry entry = {
+        .path = std::string(index_data + path_offset, path_size),
+        .type = static_cast<PathType>(archive_entry.type),
+        .offset = archive_entry.offset,
+        .size = archive_entry.size,
+        .compression = archive_entry.compression,
+    };
+    int64_t stored_size = entry.size;
+    if (entry.compression == ArchiveCompression::kLz4) {
+      stored_size = sizeof(ChunkHeader);
+    } else if (entry.compression != ArchiveCompression::kNone) {
+      LOG(ERROR) << "Unsupported archive compression for " << entry.path;
+      return nullptr;
+    }
+    if ((entry.type != PathType::kFile && entry.type != PathType::kFolder) ||
+        !IsPathAbsolute(entry.path, {}) || IsRootPath(entry.path, {}) ||
+        NormalizePath(entry.path) != entry.path || entry.offset < 0 ||
+        entry.size < 0 || entry.offset > archive_size - stored_size) {
+      LOG(ERROR) << "Corrupt archive entry: " << entry.path;
+      return nullptr;
+    }
+    entries.emplace_back(std::move(entry));
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.path < b.path; });
+  for (size_t i = 1; i < entries.size(); ++i) {
+    if (entries[i - 1].path == entries[i].path) {
+      LOG(ERROR) << "Duplicate archive entry: " << entries[i].path;
+      return nullptr;
+    }
+  }
+  return absl::WrapUnique(
+      new ArchiveFileProtocol(std::move(archive), std::move(entries)));
+}
+
+ArchiveFileProtocol::ArchiveFileProtocol(std::unique_ptr<File> archive,
+                                         std::vector<Entry> entries)
+    : archive_(std::move(archive)), entries_(std::move(entries)) {
+  entry_map_.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    entry_map_[entry.path] = &entry;
+  }
+}
+
+ArchiveFileProtocol::~ArchiveFileProtocol() = default;
+
+FileProtocolFlags ArchiveFileProtocol::GetFlags() const {
+  return kReadOnlyFileProtocolFlags;
+}
+
+const ArchiveFileProtocol::Entry* ArchiveFileProtocol::Find(
+    std::string_view path) const {
+  auto it = entry_map_.find(path);
+  if (it == entry_map_.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+PathInfo ArchiveFileProtocol::DoGetPathInfo(std::string_view protocol_name,
+                                            std::string_view path) {
+  if (path == "/") {
+    return {PathType::kFolder};
+  }
+  const Entry* entry = Find(path);
+  if (entry == nullptr) {
+    return {};
+  }
+  if (entry->type == PathType::kFolder) {
+    return {PathType::kFolder};
+  }
+  return {PathType::kFile, entry->size};
+}
+
+std::vector<std::string> ArchiveFileProtocol::BasicList(
+    std::string_view protocol_name, std::string_view path) {
+  std::string prefix;
+  if (path == "/") {
+    prefix = "/";
+  } else {
+    prefix = absl::StrCat(path, "/");
+  }
+  std::vector<std::string> paths;
+  auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), prefix,
+      [](const Entry& entry, const std::string& prefix) {
+        return entry.path < prefix;
+      });
+  for (; it != entries_.end() && absl::StartsWith(it->path, prefix); ++it) {
+    std::string_view item_path = it->path;
+    item_path.remove_prefix(prefix.size());
+    if (item_path.empty() ||
+        item_path.find_first_of('/') != std::string_view::npos) {
+      continue;
+    }
+    paths.emplace_back(absl::StrCat(protocol_name, ":", prefix, item_path));
+  }
+  return paths;
+}
+
+std::unique_ptr<RawFile> ArchiveFileProtocol::BasicOpenFile(
+    std::string_view protocol_name, std::string_view path, FileFlags flags) {
+  const Entry* entry = Find(path);
+  if (entry == nullptr || entry->type != PathType::kFile) {
+    return nullptr;
+  }
+  if (entry->compression == ArchiveCompression::kLz4) {
+    auto data = ChunkReader::ReadAt(archive_.get(), entry->offset);
+    if (!data.has_value() || data->GetType() != kChunkTypeArchiveData ||
+        data->GetSize() < entry->size) {
+      LOG(ERROR) << "Corrupt archive data for " << path;
+      return nullptr;
+    }
+    return std::make_unique<ArchiveFile>(entry->size,
+                                         data->ReleaseChunkData<uint8_t>());
+  }
+  absl::Span<const uint8_t> view;
+  if (flags.IsSet(FileFlag::kMapped)) {
+    view = archive_->GetMappedView();
+    if (!view.empty()) {
+      view = view.subspan(static_cast<size_t>(entry->offset),
+                          static_cast<size_t>(entry->size));
+    }
+  }
+  return std::make_unique<ArchiveFile>(archive_.get(), entry->offset,
+                                       entry->size, view);
+}
+
+}  // namespace gb
@@ -0,0 +1,133 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_FILE_ARCHIVE_FILE_PROTOCOL_H_
+#define GB_FILE_ARCHIVE_FILE_PROTOCOL_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "gb/file/chunk_types.h"
+#include "gb/file/file.h"
+#include "gb/file/file_protocol.h"
+
+namespace gb {
+
+//==============================================================================
+// Archive file format
+//==============================================================================
+
+// An archive is a chunk file that packs the contents of a folder into a single
+// file, so that it can be read with one open file. It is laid out as follows:
+//    Chunk "GBFI"
+//      file: "GBAR"
+//    Chunk "GBAI"    <-- Archive index: list of ArchiveEntry, sorted by path.
+//    Chunk "GBAD"    <-- Archive data: contents of one file in the archive.
+//    Chunk "GBAD"
+//    ... and so on, for each non-empty file in the archive ...
+//
+// Archive data chunks may be stored compressed (see ArchiveCompression), in
+// which case they are wrapped in a "GBCZ" chunk (see ChunkCompression).
+inline constexpr ChunkType kChunkTypeArchive = {'G', 'B', 'A', 'R'};
+inline constexpr ChunkType kChunkTypeArchiveIndex = {'G', 'B', 'A', 'I'};
+inline constexpr ChunkType kChunkTypeArchiveData = {'G', 'B', 'A', 'D'};
+
+// Compression applied to a file in an archive.
+enum class ArchiveCompression : int32_t {
+  kNone,  // File contents are stored as-is.
+  kLz4,   // File contents are stored in an LZ4 compressed data chunk.
+};
+
+// Entry in the archive index chunk (version 1).
+struct ArchiveEntry {
+  ChunkPtr<const char> path;  // Normalized absolute path (without protocol).
+  int64_t offset;             // Offset of the contents in the archive file,
+                              // or of the data chunk if it is compressed.
+  int64_t size;               // Size in bytes of the file contents.
+  int32_t type;               // PathType::kFile or PathType::kFolder.
+  ArchiveCompression compression;
+};
+static_assert(sizeof(ArchiveEntry) == 32);
+
+// Writes all files and folders under a folder in a file system to an archive.
+//
+// Paths in the archive are relative to the folder (which becomes the root of
+// the archive). If compression is requested, it is only applied to files that
+// it makes smaller. The archive file must support seeking, as the index is
+// updated after all file contents are written.
+//
+// Returns false if any file or folder could not be read, or the archive could
+// not be written completely.
+bool WriteArchiveFile(
+    FileSystem* file_system, std::string_view folder, File* archive,
+    ArchiveCompression compression = ArchiveCompression::kNone);
+
+//==============================================================================
+// ArchiveFileProtocol
+//==============================================================================
+
+// This class implements a read-only FileProtocol over a single archive file.
+//
+// The archive index is read when the protocol is created, and path lookups are
+// done against an in-memory hash table. Files are read directly from the open
+// archive file (with File::ReadAt), so no files are opened in the underlying
+// file system after creation. If the archive file was opened with
+// FileFlag::kMapped, then files opened with FileFlag::kMapped are views into
+// the archive's mapping. Compressed files are instead decompressed in full
+// into memory when they are opened.
+//
+// As archives are often registered under different names, this protocol has no
+// default protocol names.
+//
+// This class is thread-safe.
+class ArchiveFileProtocol : public FileProtocol {
+ public:
+  // Creates a new ArchiveFileProtocol from an archive file opened for reading.
+  //
+  // The file system the archive was opened from must outlive the protocol.
+  // Returns null if the archive is not valid.
+  static std::unique_ptr<ArchiveFileProtocol> Create(
+      std::unique_ptr<File> archive);
+
+  ~ArchiveFileProtocol() override;
+
+  // Public overrides for FileProtocol.
+  FileProtocolFlags GetFlags() const override;
+
+ protected:
+  // Protected overrides for FileProtocol.
+  PathInfo DoGetPathInfo(std::string_view protocol_name,
+                         std::string_view path) override;
+  std::vector<std::string> BasicList(std::string_view protocol_name,
+                                     std::string_view path) override;
+  std::unique_ptr<RawFile> BasicOpenFile(std::string_view protocol_name,
+                                         std::string_view path,
+                                         FileFlags flags) override;
+
+ private:
+  struct Entry {
+    std::string path;
+    PathType type;
+    int64_t offset;
+    int64_t size;
+    ArchiveCompression compression;
+  };
+
+  ArchiveFileProtocol(std::unique_ptr<File> archive,
+                      std::vector<Entry> entries);
+
+  const Entry* Find(std::string_view path) const;
+
+  const std::unique_ptr<File> archive_;
+  const std::vector<Entry> entries_;
+  absl::flat_hash_map<std::string_view, const Entry*> entry_map_;
+};
+
+}  // namespace gb
+
+#endif  // GB_FILE_ARCHIVE_FILE_PROTOCOL_H_
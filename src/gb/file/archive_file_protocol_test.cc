@@ -0,0 +1,319 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/archive_file_protocol.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gb/file/chunk_writer.h"
+#include "gb/file/common_protocol_test.h"
+#include "gb/file/file_system.h"
+#include "gb/file/local_file_protocol.h"
+#include "gb/file/memory_file_protocol.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+using ::testing::Values;
+
+std::unique_ptr<FileProtocol> CreateArchiveProtocol(
+    const CommonProtocolTestInit& init, ArchiveCompression compression) {
+  // Archives are written to a file system that must outlive all protocols
+  // created by this factory.
+  static FileSystem* const archive_file_system = [] {
+    auto* file_system = new FileSystem;
+    file_system->Register(std::make_unique<MemoryFileProtocol>());
+    return file_system;
+  }();
+  static int archive_count = 0;
+
+  FileSystem source_file_system;
+  auto source = init.DefaultInit(std::make_unique<MemoryFileProtocol>());
+  if (source == nullptr ||
+      !source_file_system.Register(std::move(source), "src")) {
+    return nullptr;
+  }
+  const std::string path = absl::StrCat("mem:/archive-", ++archive_count);
+  auto archive = archive_file_system->OpenFile(path, kNewFileFlags);
+  if (archive == nullptr ||
+      !WriteArchiveFile(&source_file_system, "src:/", archive.get(),
+                        compression)) {
+    return nullptr;
+  }
+  archive.reset();
+  return ArchiveFileProtocol::Create(
+      archive_file_system->OpenFile(path, kReadFileFlags));
+}
+
+std::unique_ptr<FileProtocol> ArchiveFileProtocolFactory(
+    const CommonProtocolTestInit& init) {
+  return CreateArchiveProtocol(init, ArchiveCompression::kNone);
+}
+
+std::unique_ptr<FileProtocol> CompressedArchiveFileProtocolFactory(
+    const CommonProtocolTestInit& init) {
+  return CreateArchiveProtocol(init, ArchiveCompression::kLz4);
+}
+
+INSTANTIATE_TEST_SUITE_P(ArchiveFileProtocolTest, CommonProtocolTest,
+                         Values(ArchiveFileProtocolFactory,
+                                CompressedArchiveFileProtocolFactory));
+
+class ArchiveFileProtocolTest : public ::testing::Test {
+ protected:
+  ArchiveFileProtocolTest() {
+    file_system_.Register(std::make_unique<MemoryFileProtocol>());
+    file_system_.Register(std::make_unique<MemoryFileProtocol>(), "src");
+  }
+
+  bool WriteArchive(
+      std::string_view path,
+      ArchiveCompression compression = ArchiveCompression::kNone) {
+    auto archive = file_system_.OpenFile(path, kNewFileFlags);
+    return archive != nullptr && WriteArchiveFile(&file_system_, "src:/",
+                                                  archive.get(), compression);
+  }
+
+  std::unique_ptr<ArchiveFileProtocol> CreateArchive(std::string_view path) {
+    return ArchiveFileProtocol::Create(
+        file_system_.OpenFile(path, kReadFileFlags));
+  }
+
+  FileSystem file_system_;
+};
+
+TEST_F(ArchiveFileProtocolTest, Construct) {
+  ASSERT_TRUE(WriteArchive("mem:/archive"));
+  auto protocol = CreateArchive("mem:/archive");
+  ASSERT_NE(protocol, nullptr);
+  EXPECT_EQ(protocol->GetFlags(), kReadOnlyFileProtocolFlags);
+  EXPECT_THAT(protocol->GetDefaultNames(), IsEmpty());
+}
+
+TEST_F(ArchiveFileProtocolTest, ReadArchive) {
+  const std::string large(100000, 'x');
+  ASSERT_TRUE(file_system_.CreateFolder("src:/a/b", FolderMode::kRecursive));
+  ASSERT_TRUE(file_system_.CreateFolder("src:/empty"));
+  ASSERT_TRUE(file_system_.WriteFile("src:/root", "root file"));
+  ASSERT_TRUE(file_system_.WriteFile("src:/a/one", "1"));
+  ASSERT_TRUE(file_system_.WriteFile("src:/a/b/large", large));
+  ASSERT_TRUE(file_system_.WriteFile("src:/a/b/zero", ""));
+  ASSERT_TRUE(file_system_.WriteFile("src:/a-b", "not in a"));
+  ASSERT_TRUE(WriteArchive("mem:/archive"));
+  auto protocol = CreateArchive("mem:/archive");
+  ASSERT_NE(protocol, nullptr);
+
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(std::move(protocol), "pak"));
+  EXPECT_THAT(file_system.List("pak:/"),
+              UnorderedElementsAre("pak:/a", "pak:/a-b", "pak:/empty",
+                                   "pak:/root"));
+  EXPECT_THAT(file_system.List("pak:/a"),
+              UnorderedElementsAre("pak:/a/b", "pak:/a/one"));
+  EXPECT_THAT(file_system.List("pak:/empty"), IsEmpty());
+  EXPECT_THAT(file_system.ListFiles("pak:/", FolderMode::kRecursive),
+              UnorderedElementsAre("pak:/a-b", "pak:/root", "pak:/a/one",
+                                   "pak:/a/b/large", "pak:/a/b/zero"));
+  EXPECT_EQ(file_system.GetPathInfo("pak:/a/b").type, PathType::kFolder);
+  EXPECT_EQ(file_system.GetPathInfo("pak:/a/b/large").size, large.size());
+  EXPECT_EQ(file_system.GetPathInfo("pak:/a/b/zero").type, PathType::kFile);
+  EXPECT_EQ(file_system.GetPathInfo("pak:/missing").type, PathType::kInvalid);
+
+  std::string contents;
+  EXPECT_TRUE(file_system.ReadFile("pak:/root", &contents));
+  EXPECT_EQ(contents, "root file");
+  EXPECT_TRUE(file_system.ReadFile("pak:/a/one", &contents));
+  EXPECT_EQ(contents, "1");
+  EXPECT_TRUE(file_system.ReadFile("pak:/a/b/large", &contents));
+  EXPECT_EQ(contents, large);
+  EXPECT_TRUE(file_system.ReadFile("pak:/a/b/zero", &contents));
+  EXPECT_EQ(contents, "");
+  EXPECT_TRUE(file_system.ReadFile("pak:/a-b", &contents));
+  EXPECT_EQ(contents, "not in a");
+  EXPECT_FALSE(file_system.ReadFile("pak:/a", &contents));
+
+  auto file = file_system.OpenFile("pak:/root", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->SeekTo(5), 5);
+  EXPECT_EQ(file->ReadRemainingString(), "file");
+  EXPECT_EQ(file->SeekTo(100), 9);
+  EXPECT_EQ(file->ReadString(1), "");
+  char buffer[4] = {};
+  EXPECT_EQ(file->ReadAt(2, buffer, 4), 4);
+  EXPECT_EQ(std::string_view(buffer, 4), "ot f");
+  EXPECT_EQ(file->ReadAt(7, buffer, 4), 2);
+  EXPECT_EQ(std::string_view(buffer, 2), "le");
+  EXPECT_EQ(file_system.OpenFile("pak:/root", kWriteFileFlags), nullptr);
+  EXPECT_FALSE(file_system.WriteFile("pak:/new", "new"));
+}
+
+TEST_F(ArchiveFileProtocolTest, InvalidSource) {
+  ASSERT_TRUE(file_system_.WriteFile("src:/file", "file"));
+  auto archive = file_system_.OpenFile("mem:/archive", kNewFileFlags);
+  ASSERT_NE(archive, nullptr);
+  EXPECT_FALSE(WriteArchiveFile(&file_system_, "src:/file", archive.get()));
+  EXPECT_FALSE(WriteArchiveFile(&file_system_, "src:/missing", archive.get()));
+}
+
+TEST_F(ArchiveFileProtocolTest, InvalidArchive) {
+  EXPECT_EQ(ArchiveFileProtocol::Create(nullptr), nullptr);
+
+  ASSERT_TRUE(file_system_.WriteFile("mem:/text", "not an archive"));
+  EXPECT_EQ(CreateArchive("mem:/text"), nullptr);
+
+  auto file = file_system_.OpenFile("mem:/chunk", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(WriteChunkFile(file.get(), {'T', 'E', 'S', 'T'}, {}));
+  file.reset();
+  EXPECT_EQ(CreateArchive("mem:/chunk"), nullptr);
+
+  file = file_system_.OpenFile("mem:/no-index", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeArchive, {}));
+  file.reset();
+  EXPECT_EQ(CreateArchive("mem:/no-index"), nullptr);
+
+  // Entry contents are past the end of the archive.
+  file = file_system_.OpenFile("mem:/bad-entry", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  auto index = ChunkWriter::New<ArchiveEntry>(kChunkTypeArchiveIndex, 1, 1);
+  auto* entry = index.GetChunkData<ArchiveEntry>();
+  entry->path = index.AddString("/file");
+  entry->offset = 1000;
+  entry->size = 10;
+  entry->type = static_cast<int32_t>(PathType::kFile);
+  entry->compression = ArchiveCompression::kNone;
+  std::vector<ChunkWriter> chunks;
+  chunks.emplace_back(std::move(index));
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeArchive, chunks));
+  file.reset();
+  EXPECT_EQ(CreateArchive("mem:/bad-entry"), nullptr);
+
+  // Paths must be normalized absolute paths.
+  file = file_system_.OpenFile("mem:/bad-path", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  index = ChunkWriter::New<ArchiveEntry>(kChunkTypeArchiveIndex, 1, 1);
+  entry = index.GetChunkData<ArchiveEntry>();
+  entry->path = index.AddString("relative/../file");
+  entry->type = static_cast<int32_t>(PathType::kFolder);
+  entry->compression = ArchiveCompression::kNone;
+  chunks.clear();
+  chunks.emplace_back(std::move(index));
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeArchive, chunks));
+  file.reset();
+  EXPECT_EQ(CreateArchive("mem:/bad-path"), nullptr);
+
+  // Compression must be supported.
+  file = file_system_.OpenFile("mem:/bad-compression", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  index = ChunkWriter::New<ArchiveEntry>(kChunkTypeArchiveIndex, 1, 1);
+  entry = index.GetChunkData<ArchiveEntry>();
+  entry->path = index.AddString("/folder");
+  entry->type = static_cast<int32_t>(PathType::kFolder);
+  entry->compression = static_cast<ArchiveCompression>(100);
+  chunks.clear();
+  chunks.emplace_back(std::move(index));
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeArchive, chunks));
+  file.reset();
+  EXPECT_EQ(CreateArchive("mem:/bad-compression"), nullptr);
+}
+
+TEST_F(ArchiveFileProtocolTest, CompressedArchive) {
+  std::string text;
+  for (int i = 0; i < 10000; ++i) {
+    absl::StrAppend(&text, "line ", i % 100, "\n");
+  }
+  ASSERT_TRUE(file_system_.CreateFolder("src:/folder"));
+  ASSERT_TRUE(file_system_.WriteFile("src:/folder/text", text));
+  ASSERT_TRUE(file_system_.WriteFile("src:/short", "abc"));
+  ASSERT_TRUE(WriteArchive("mem:/archive"));
+  ASSERT_TRUE(WriteArchive("mem:/compressed", ArchiveCompression::kLz4));
+  EXPECT_LT(file_system_.GetPathInfo("mem:/compressed").size,
+            file_system_.GetPathInfo("mem:/archive").size / 2);
+
+  auto protocol = CreateArchive("mem:/compressed");
+  ASSERT_NE(protocol, nullptr);
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(std::move(protocol), "pak"));
+  EXPECT_EQ(file_system.GetPathInfo("pak:/folder/text").size, text.size());
+  std::string contents;
+  ASSERT_TRUE(file_system.ReadFile("pak:/folder/text", &contents));
+  EXPECT_EQ(contents, text);
+  ASSERT_TRUE(file_system.ReadFile("pak:/short", &contents));
+  EXPECT_EQ(contents, "abc");
+
+  auto file = file_system.OpenFile("pak:/folder/text", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  char buffer[8] = {};
+  EXPECT_EQ(file->ReadAt(text.size() - 8, buffer, 100), 8);
+  EXPECT_EQ(std::string_view(buffer, 8), text.substr(text.size() - 8));
+  EXPECT_EQ(file->ReadRemainingString(), text);
+}
+
+TEST_F(ArchiveFileProtocolTest, CorruptCompressedArchive) {
+  ASSERT_TRUE(file_system_.WriteFile("src:/text", std::string(1000, 'x')));
+  ASSERT_TRUE(WriteArchive("mem:/archive", ArchiveCompression::kLz4));
+  std::string archive;
+  ASSERT_TRUE(file_system_.ReadFile("mem:/archive", &archive));
+  const size_t data_offset = archive.find("GBCZ");
+  ASSERT_NE(data_offset, std::string::npos);
+
+  // Corrupt the data chunk type, then the block size. The index is still
+  // valid, so the failure is found when the file is opened.
+  for (size_t offset : {data_offset + 16, data_offset + 32}) {
+    SCOPED_TRACE(absl::StrCat("offset=", offset));
+    std::string corrupt = archive;
+    corrupt[offset] ^= 0x7F;
+    ASSERT_TRUE(file_system_.WriteFile("mem:/corrupt", corrupt));
+    auto protocol = CreateArchive("mem:/corrupt");
+    ASSERT_NE(protocol, nullptr);
+    FileSystem file_system;
+    ASSERT_TRUE(file_system.Register(std::move(protocol), "pak"));
+    EXPECT_TRUE(file_system.IsValidFile("pak:/text"));
+    EXPECT_EQ(file_system.OpenFile("pak:/text", kReadFileFlags), nullptr);
+  }
+}
+
+TEST_F(ArchiveFileProtocolTest, MappedArchive) {
+  ASSERT_TRUE(
+      file_system_.Register(LocalFileProtocol::CreateTemp("gbtest"), "local"));
+  ASSERT_TRUE(file_system_.WriteFile("src:/file-1", "1234567890"));
+  ASSERT_TRUE(file_system_.WriteFile("src:/file-2", "abcdefghij"));
+  ASSERT_TRUE(WriteArchive("local:/archive"));
+  auto archive = file_system_.OpenFile("local:/archive",
+                                       kReadFileFlags + FileFlag::kMapped);
+  ASSERT_NE(archive, nullptr);
+  const bool is_mapped = !archive->GetMappedView().empty();
+  auto protocol = ArchiveFileProtocol::Create(std::move(archive));
+  ASSERT_NE(protocol, nullptr);
+
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(std::move(protocol), "pak"));
+  auto file =
+      file_system.OpenFile("pak:/file-2", kReadFileFlags + FileFlag::kMapped);
+  ASSERT_NE(file, nullptr);
+  if (is_mapped) {
+    absl::Span<const uint8_t> view = file->GetMappedView();
+    EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(view.data()),
+                               view.size()),
+              "abcdefghij");
+  }
+  EXPECT_EQ(file->ReadRemainingString(), "abcdefghij");
+
+  file = file_system.OpenFile("pak:/file-1", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_TRUE(file->GetMappedView().empty());
+  EXPECT_EQ(file->ReadRemainingString(), "1234567890");
+}
+
+}  // namespace
+}  // namespace gb
@@ -0,0 +1,418 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/caching_file_protocol.h"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/synchronization/mutex.h"
+#include "gb/file/raw_file.h"
+
+namespace gb {
+
+namespace {
+
+using Contents = std::shared_ptr<const std::vector<uint8_t>>;
+
+bool IsInFolder(std::string_view path, std::string_view folder) {
+  if (folder == "/") {
+    return true;
+  }
+  return absl::StartsWith(path, folder) &&
+         (path.size() == folder.size() || path[folder.size()] == '/');
+}
+
+}  // namespace
+
+//==============================================================================
+// CachingFileProtocol::Cache
+//==============================================================================
+
+// Cached file contents, shared with open files so they can outlive the
+// protocol.
+class CachingFileProtocol::Cache {
+ public:
+  Cache(int64_t max_cache_size, int64_t max_file_size)
+      : max_cache_size_(max_cache_size),
+        max_file_size_(std::min(max_file_size, max_cache_size)) {}
+
+  int64_t GetMaxFileSize() const { return max_file_size_; }
+
+  // Returns the cached contents of the file, or null if it is not cached. This
+  // updates the hit or miss count.
+  Contents Find(std::string_view path);
+
+  // Returns the current generation, which changes whenever the cache is
+  // invalidated.
+  int64_t GetGeneration();
+
+  // Adds file contents read when the cache was at "generation". The contents
+  // are discarded if the cache was invalidated since then, or the file is open
+  // for writing, as they may be out of date.
+  void Add(std::string_view path, Contents contents, int64_t generation);
+
+  // Removes a file, or all files within a folder from the cache.
+  void Invalidate(std::string_view path);
+  void InvalidateFolder(std::string_view path);
+
+  // Tracks files open for writing, which are never cached.
+  void BeginWrite(std::string_view path);
+  void EndWrite(std::string_view path);
+
+  Stats GetStats();
+  void ResetStats();
+  void Clear();
+
+ private:
+  struct Entry {
+    std::string path;
+    Contents contents;
+  };
+  using Entries = std::list<Entry>;
+
+  void Remove(Entries::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int64_t max_cache_size_;
+  const int64_t max_file_size_;
+
+  absl::Mutex mutex_;
+  Entries lru_ ABSL_GUARDED_BY(mutex_);  // Most recently used first.
+  absl::flat_hash_map<std::string_view, Entries::iterator> entries_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, int> writers_ ABSL_GUARDED_BY(mutex_);
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+Contents CachingFileProtocol::Cache::Find(std::string_view path) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(path);
+  if (it == entries_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  ++stats_.hits;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->contents;
+}
+
+int64_t CachingFileProtocol::Cache::GetGeneration() {
+  absl::MutexLock lock(&mutex_);
+  return generation_;
+}
+
+void CachingFileProtocol::Cache::Add(std::string_view path, Contents contents,
+                                     int64_t generation) {
+  const int64_t size = static_cast<int64_t>(contents->size());
+  absl::MutexLock lock(&mutex_);
+  if (generation != generation_ || writers_.contains(path) ||
+      entries_.contains(path)) {
+    return;
+  }
+  while (!lru_.empty() && stats_.size + size > max_cache_size_) {
+    Remove(std::prev(lru_.end()));
+    ++stats_.evictions;
+  }
+  lru_.push_front({std::string(path), std::move(contents)});
+  entries_[lru_.front().path] = lru_.begin();
+  stats_.size += size;
+  ++stats_.count;
+}
+
+void CachingFileProtocol::Cache::Invalidate(std::string_view path) {
+  absl::MutexLock lock(&mutex_);
+  ++generation_;
+  auto it = entries_.find(path);
+  if (it != entries_.end()) {
+    Remove(it->second);
+  }
+}
+
+void CachingFileProtocol::Cache::InvalidateFolder(std::string_view path) {
+  absl::MutexLock lock(&mutex_);
+  ++generation_;
+  for (auto it = lru_.begin(); it != lru_.end();) {
+    auto next = std::next(it);
+    if (IsInFolder(it->path, path)) {
+      Remove(it);
+    }
+    it = next;
+  }
+}
+
+void CachingFileProtocol::Cache::BeginWrite(std::string_view path) {
+  absl::MutexLock lock(&mutex_);
+  ++generation_;
+  ++writers_[path];
+  auto it = entries_.find(path);
+  if (it != entries_.end()) {
+    Remove(it->second);
+  }
+}
+
+void CachingFileProtocol::Cache::EndWrite(std::string_view path) {
+  absl::MutexLock lock(&mutex_);
+  ++generation_;
+  auto it = writers_.find(path);
+  if (it != writers_.end() && --it->second == 0) {
+    writers_.erase(it);
+  }
+}
+
+CachingFileProtocol::Stats CachingFileProtocol::Cache::GetStats() {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+void CachingFileProtocol::Cache::ResetStats() {
+  absl::MutexLock lock(&mutex_);
+  stats_.hits = 0;
+  stats_.misses = 0;
+  stats_.evictions = 0;
+}
+
+void CachingFileProtocol::Cache::Clear() {
+  absl::MutexLock lock(&mutex_);
+  ++generation_;
+  entries_.clear();
+  lru_.clear();
+  stats_.size = 0;
+  stats_.count = 0;
+}
+
+void CachingFileProtocol::Cache::Remove(Entries::iterator it) {
+  stats_.size -= static_cast<int64_t>(it->contents->size());
+  --stats_.count;
+  entries_.erase(it->path);
+  lru_.erase(it);
+}
+
+//==============================================================================
+// CachingFileProtocol::CachedFile
+//==============================================================================
+
+// Read-only file over cached contents.
+class CachingFileProtocol::CachedFile : public RawFile {
+ public:
+  explicit CachedFile(Contents contents) : contents_(std::move(contents)) {}
+  ~CachedFile() override = default;
+
+  int64_t SeekEnd() override {
+    position_ = GetSize();
+    return position_;
+  }
+  int64_t SeekTo(int64_t position) override {
+    position_ = std::clamp<int64_t>(position, 0, GetSize());
+    return position_;
+  }
+  int64_t Write(const void* buffer, int64_t size) override { return 0; }
+  int64_t Read(void* buffer, int64_t size) override {
+    size = ReadAt(position_, buffer, size);
+    position_ += size;
+    return size;
+  }
+  int64_t ReadAt(int64_t offset, void* buffer, int64_t size) override {
+    size = std::min(size, GetSize() - offset);
+    if (size <= 0) {
+      return 0;
+    }
+    std::memcpy(buffer, contents_->data() + offset, static_cast<size_t>(size));
+    return size;
+  }
+  absl::Span<const uint8_t> GetMappedView() override { return *contents_; }
+
+ private:
+  int64_t GetSize() const { return static_cast<int64_t>(contents_->size()); }
+
+  const Contents contents_;
+  int64_t position_ = 0;
+};
+
+//==============================================================================
+// CachingFileProtocol::WriteFile
+//==============================================================================
+
+// File opened for writing, which keeps the file out of the cache until it is
+// closed.
+class CachingFileProtocol::WriteFile : public RawFile {
+ public:
+  WriteFile(std::unique_ptr<RawFile> file, std::shared_ptr<Cache> cache,
+            std::string_view path)
+      : file_(std::move(file)), cache_(std::move(cache)), path_(path) {}
+  ~WriteFile() override {
+    file_.reset();
+    cache_->EndWrite(path_);
+  }
+
+  int64_t SeekEnd() override { return file_->SeekEnd(); }
+  int64_t SeekTo(int64_t position) override { return file_->SeekTo(position); }
+  int64_t Write(const void* buffer, int64_t size) override {
+    return file_->Write(buffer, size);
+  }
+  int64_t WriteV(
+      absl::Span<const absl::Span<const uint8_t>> buffers) override {
+    return file_->WriteV(buffers);
+  }
+  int64_t Read(void* buffer, int64_t size) override {
+    return file_->Read(buffer, size);
+  }
+  int64_t ReadAt(int64_t offset, void* buffer, int64_t size) override {
+    return file_->ReadAt(offset, buffer, size);
+  }
+  absl::Span<const uint8_t> GetMappedView() override {
+    return file_->GetMappedView();
+  }
+
+ private:
+  std::unique_ptr<RawFile> file_;
+  const std::shared_ptr<Cache> cache_;
+  const std::string path_;
+};
+
+//==============================================================================
+// CachingFileProtocol
+//==============================================================================
+
+CachingFileProtocol::CachingFileProtocol(std::unique_ptr<FileProtocol> protocol,
+                                         int64_t max_cache_size,
+                                         int64_t max_file_size)
+    : protocol_(std::move(protocol)),
+      cache_(std::make_shared<Cache>(max_cache_size, max_file_size)) {}
+
+CachingFileProtocol::~CachingFileProtocol() = default;
+
+CachingFileProtocol::Stats CachingFileProtocol::GetStats() const {
+  return cache_->GetStats();
+}
+
+void CachingFileProtocol::ResetStats() { cache_->ResetStats(); }
+
+void CachingFileProtocol::Clear() { cache_->Clear(); }
+
+FileProtocolFlags CachingFileProtocol::GetFlags() const {
+  // Watches are not forwarded to the wrapped protocol.
+  return protocol_->GetFlags() - FileProtocolFlag::kWatch;
+}
+
+std::vector<std::string> CachingFileProtocol::GetDefaultNames() const {
+  return protocol_->GetDefaultNames();
+}
+
+PathInfo CachingFileProtocol::DoGetPathInfo(std::string_view protocol_name,
+                                            std::string_view path) {
+  return protocol_->GetPathInfo(protocol_name, path);
+}
+
+std::vector<std::string> CachingFileProtocol::DoList(
+    std::string_view protocol_name, std::string_view path,
+    std::string_view pattern, FolderMode mode, PathTypes types) {
+  return protocol_->List(protocol_name, path, pattern, mode, types);
+}
+
+bool CachingFileProtocol::DoCreateFolder(std::string_view protocol_name,
+                                         std::string_view path,
+                                         FolderMode mode) {
+  return protocol_->CreateFolder(protocol_name, path, mode);
+}
+
+bool CachingFileProtocol::DoCopyFolder(std::string_view protocol_name,
+                                       std::string_view from_path,
+                                       std::string_view to_path) {
+  const bool result = protocol_->CopyFolder(protocol_name, from_path, to_path);
+  cache_->InvalidateFolder(to_path);
+  return result;
+}
+
+bool CachingFileProtocol::DoDeleteFolder(std::string_view protocol_name,
+                                         std::string_view path,
+                                         FolderMode mode) {
+  const bool result = protocol_->DeleteFolder(protocol_name, path, mode);
+  cache_->InvalidateFolder(path);
+  return result;
+}
+
+bool CachingFileProtocol::DoCopyFile(std::string_view protocol_name,
+                                     std::string_view from_path,
+                                     std::string_view to_path) {
+  const bool result = protocol_->CopyFile(protocol_name, from_path, to_path);
+  cache_->Invalidate(to_path);
+  return result;
+}
+
+bool CachingFileProtocol::DoDeleteFile(std::string_view protocol_name,
+                                       std::string_view path) {
+  const bool result = protocol_->DeleteFile(protocol_name, path);
+  cache_->Invalidate(path);
+  return result;
+}
+
+std::unique_ptr<RawFile> CachingFileProtocol::DoOpenFile(
+    std::string_view protocol_name, std::string_view path, FileFlags flags) {
+  if (flags.IsSet(FileFlag::kWrite)) {
+    cache_->BeginWrite(path);
+    auto file = protocol_->OpenFile(protocol_name, path, flags);
+    if (file == nullptr) {
+      cache_->EndWrite(path);
+      return nullptr;
+    }
+    return std::make_unique<WriteFile>(std::move(file), cache_, path);
+  }
+
+  if (Contents contents = cache_->Find(path)) {
+    return std::make_unique<CachedFile>(std::move(contents));
+  }
+  const int64_t generation = cache_->GetGeneration();
+  auto file = protocol_->OpenFile(protocol_name, path, flags);
+  if (file == nullptr) {
+    return nullptr;
+  }
+  const int64_t size = file->SeekEnd();
+  if (size < 0 || size > cache_->GetMaxFileSize()) {
+    file->SeekTo(0);
+    return file;
+  }
+  auto contents = std::make_shared<std::vector<uint8_t>>(size);
+  if (file->SeekTo(0) != 0 || file->Read(contents->data(), size) != size) {
+    file->SeekTo(0);
+    return file;
+  }
+  cache_->Add(path, contents, generation);
+  return std::make_unique<CachedFile>(std::move(contents));
+}
+
+void CachingFileProtocol::DoReadFileAsync(std::string_view protocol_name,
+                                          std::string_view path,
+                                          int64_t offset, void* buffer,
+                                          int64_t size,
+                                          ReadFileCallback callback) {
+  Contents contents = cache_->Find(path);
+  if (contents == nullptr) {
+    protocol_->ReadFileAsync(protocol_name, path, offset, buffer, size,
+                             std::move(callback));
+    return;
+  }
+  size = std::max<int64_t>(
+      std::min(size, static_cast<int64_t>(contents->size()) - offset), 0);
+  if (size > 0) {
+    std::memcpy(buffer, contents->data() + offset, static_cast<size_t>(size));
+  }
+  callback(size);
+}
+
+std::string CachingFileProtocol::DoGetCurrentPath(
+    std::string_view protocol_name) {
+  return protocol_->GetCurrentPath(protocol_name);
+}
+
+bool CachingFileProtocol::DoSetCurrentPath(std::string_view protocol_name,
+                                           std::string_view path) {
+  return protocol_->SetCurrentPath(protocol_name, path);
+}
+
+}  // namespace gb
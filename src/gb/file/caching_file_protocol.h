@@ -0,0 +1,114 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_FILE_CACHING_FILE_PROTOCOL_H_
+#define GB_FILE_CACHING_FILE_PROTOCOL_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gb/file/file_protocol.h"
+
+namespace gb {
+
+// This class wraps another FileProtocol, caching the contents of small files
+// that are opened for reading, so repeated reads of the same files come from
+// memory.
+//
+// Cached files are evicted in least-recently-used order to keep the total size
+// of cached contents within a byte budget. Any operation through this protocol
+// that may modify a file (opening it for writing, copying over it, or deleting
+// it or its folder) removes it from the cache. Modifications made directly to
+// the wrapped protocol (or externally) are not detected, so the wrapped
+// protocol should only be accessed through this protocol.
+//
+// Files opened for reading from the cache support FileFlag::kMapped, returning
+// a view of the cached contents, even if the wrapped protocol does not.
+//
+// The wrapped protocol's flags are supported, except for watching
+// (FileProtocolFlag::kWatch).
+//
+// This class is thread-safe if the wrapped protocol is thread-safe.
+class CachingFileProtocol : public FileProtocol {
+ public:
+  // Default total size in bytes of all cached file contents.
+  inline static constexpr int64_t kDefaultMaxCacheSize = 16 * 1024 * 1024;
+
+  // Default size in bytes of the largest file that will be cached.
+  inline static constexpr int64_t kDefaultMaxFileSize = 256 * 1024;
+
+  // Cache statistics, see GetStats.
+  struct Stats {
+    int64_t hits = 0;       // Reads served from the cache.
+    int64_t misses = 0;     // Reads not served from the cache.
+    int64_t evictions = 0;  // Files evicted to stay within the budget.
+    int64_t size = 0;       // Total size of cached file contents in bytes.
+    int count = 0;          // Number of cached files.
+  };
+
+  // Creates a caching protocol that wraps "protocol".
+  //
+  // Files larger than "max_file_size" bytes are never cached, and the total
+  // size of all cached files is kept within "max_cache_size" bytes.
+  explicit CachingFileProtocol(std::unique_ptr<FileProtocol> protocol,
+                               int64_t max_cache_size = kDefaultMaxCacheSize,
+                               int64_t max_file_size = kDefaultMaxFileSize);
+  ~CachingFileProtocol() override;
+
+  // Returns the current cache statistics.
+  Stats GetStats() const;
+
+  // Resets the hit, miss, and eviction counters to zero.
+  void ResetStats();
+
+  // Removes all files from the cache.
+  void Clear();
+
+  // Public overrides for FileProtocol.
+  FileProtocolFlags GetFlags() const override;
+  std::vector<std::string> GetDefaultNames() const override;
+
+ protected:
+  // Protected overrides for FileProtocol.
+  PathInfo DoGetPathInfo(std::string_view protocol_name,
+                         std::string_view path) override;
+  std::vector<std::string> DoList(std::string_view protocol_name,
+                                  std::string_view path,
+                                  std::string_view pattern, FolderMode mode,
+                                  PathTypes types) override;
+  bool DoCreateFolder(std::string_view protocol_name, std::string_view path,
+                      FolderMode mode) override;
+  bool DoCopyFolder(std::string_view protocol_name, std::string_view from_path,
+                    std::string_view to_path) override;
+  bool DoDeleteFolder(std::string_view protocol_name, std::string_view path,
+                      FolderMode mode) override;
+  bool DoCopyFile(std::string_view protocol_name, std::string_view from_path,
+                  std::string_view to_path) override;
+  bool DoDeleteFile(std::string_view protocol_name,
+                    std::string_view path) override;
+  std::unique_ptr<RawFile> DoOpenFile(std::string_view protocol_name,
+                                      std::string_view path,
+                                      FileFlags flags) override;
+  void DoReadFileAsync(std::string_view protocol_name, std::string_view path,
+                       int64_t offset, void* buffer, int64_t size,
+                       ReadFileCallback callback) override;
+  std::string DoGetCurrentPath(std::string_view protocol_name) override;
+  bool DoSetCurrentPath(std::string_view protocol_name,
+                        std::string_view path) override;
+
+ private:
+  class Cache;
+  class CachedFile;
+  class WriteFile;
+
+  const std::unique_ptr<FileProtocol> protocol_;
+  const std::shared_ptr<Cache> cache_;
+};
+
+}  // namespace gb
+
+#endif  // GB_FILE_CACHING_FILE_PROTOCOL_H_
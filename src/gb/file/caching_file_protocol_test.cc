@@ -0,0 +1,221 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/caching_file_protocol.h"
+
+#include <string>
+
+#include "gb/file/common_protocol_test.h"
+#include "gb/file/file_system.h"
+#include "gb/file/memory_file_protocol.h"
+#include "gb/file/raw_file.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Values;
+
+std::unique_ptr<FileProtocol> CachingFileProtocolFactory(
+    const CommonProtocolTestInit& init) {
+  return init.DefaultInit(std::make_unique<CachingFileProtocol>(
+      std::make_unique<MemoryFileProtocol>(), 1024, 512));
+}
+
+INSTANTIATE_TEST_SUITE_P(CachingFileProtocolTest, CommonProtocolTest,
+                         Values(CachingFileProtocolFactory));
+
+class CachingFileProtocolTest : public ::testing::Test {
+ protected:
+  void Init(int64_t max_cache_size = CachingFileProtocol::kDefaultMaxCacheSize,
+            int64_t max_file_size = CachingFileProtocol::kDefaultMaxFileSize) {
+    auto memory = std::make_unique<MemoryFileProtocol>();
+    memory_ = memory.get();
+    auto protocol = std::make_unique<CachingFileProtocol>(
+        std::move(memory), max_cache_size, max_file_size);
+    protocol_ = protocol.get();
+    ASSERT_TRUE(file_system_.Register(std::move(protocol)));
+  }
+
+  // Changes a file directly in the wrapped protocol, bypassing the cache.
+  void WriteUncached(std::string_view path, std::string_view contents) {
+    auto file = memory_->OpenFile(
+        "mem", path, kWriteFileFlags + FileFlag::kReset + FileFlag::kCreate);
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(file->Write(contents.data(), contents.size()), contents.size());
+  }
+
+  std::string Read(std::string_view path) {
+    std::string contents;
+    EXPECT_TRUE(file_system_.ReadFile(path, &contents));
+    return contents;
+  }
+
+  FileSystem file_system_;
+  MemoryFileProtocol* memory_ = nullptr;
+  CachingFileProtocol* protocol_ = nullptr;
+};
+
+TEST_F(CachingFileProtocolTest, Construct) {
+  Init();
+  EXPECT_EQ(protocol_->GetFlags(), kReadWriteFileProtocolFlags);
+  EXPECT_THAT(protocol_->GetDefaultNames(), ElementsAre("mem"));
+  const CachingFileProtocol::Stats stats = protocol_->GetStats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+  EXPECT_EQ(stats.evictions, 0);
+  EXPECT_EQ(stats.size, 0);
+  EXPECT_EQ(stats.count, 0);
+}
+
+TEST_F(CachingFileProtocolTest, ReadFromCache) {
+  Init();
+  ASSERT_TRUE(file_system_.WriteFile("mem:/file", "cached"));
+  EXPECT_EQ(Read("mem:/file"), "cached");
+  EXPECT_EQ(protocol_->GetStats().misses, 1);
+  EXPECT_EQ(protocol_->GetStats().hits, 0);
+  EXPECT_EQ(protocol_->GetStats().count, 1);
+  EXPECT_EQ(protocol_->GetStats().size, 6);
+
+  // Changes made behind the cache's back are not seen, which shows reads are
+  // served from the cache.
+  WriteUncached("/file", "changed");
+  EXPECT_EQ(Read("mem:/file"), "cached");
+  EXPECT_EQ(Read("mem:/file"), "cached");
+  EXPECT_EQ(protocol_->GetStats().misses, 1);
+  EXPECT_EQ(protocol_->GetStats().hits, 2);
+
+  protocol_->ResetStats();
+  EXPECT_EQ(protocol_->GetStats().hits, 0);
+  EXPECT_EQ(protocol_->GetStats().count, 1);
+  protocol_->Clear();
+  EXPECT_EQ(protocol_->GetStats().count, 0);
+  EXPECT_EQ(protocol_->GetStats().size, 0);
+  EXPECT_EQ(Read("mem:/file"), "changed");
+}
+
+TEST_F(CachingFileProtocolTest, MappedView) {
+  Init();
+  ASSERT_TRUE(file_system_.WriteFile("mem:/file", "0123456789"));
+  EXPECT_EQ(Read("mem:/file"), "0123456789");
+  auto file = file_system_.OpenFile("mem:/file", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->SeekTo(4), 4);
+  EXPECT_EQ(file->ReadString(3), "456");
+  char buffer[4] = {};
+  EXPECT_EQ(file->ReadAt(8, buffer, 4), 2);
+  EXPECT_EQ(std::string_view(buffer, 2), "89");
+  EXPECT_EQ(file->WriteString("abc"), 0);
+
+  // Cached files are mapped directly, without opening the wrapped file.
+  auto raw_file =
+      protocol_->OpenFile("mem", "/file", kReadFileFlags + FileFlag::kMapped);
+  ASSERT_NE(raw_file, nullptr);
+  auto view = raw_file->GetMappedView();
+  EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(view.data()),
+                             view.size()),
+            "0123456789");
+}
+
+TEST_F(CachingFileProtocolTest, InvalidateOnWrite) {
+  Init();
+  ASSERT_TRUE(file_system_.WriteFile("mem:/file", "old"));
+  EXPECT_EQ(Read("mem:/file"), "old");
+  EXPECT_EQ(protocol_->GetStats().count, 1);
+
+  auto file = file_system_.OpenFile("mem:/file", kWriteFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(protocol_->GetStats().count, 0);
+  EXPECT_EQ(file->WriteString("new"), 3);
+  file.reset();
+
+  EXPECT_EQ(Read("mem:/file"), "new");
+  EXPECT_EQ(protocol_->GetStats().count, 1);
+  ASSERT_TRUE(file_system_.WriteFile("mem:/file", "newer"));
+  EXPECT_EQ(Read("mem:/file"), "newer");
+}
+
+TEST_F(CachingFileProtocolTest, InvalidateOnDeleteAndCopy) {
+  Init();
+  ASSERT_TRUE(file_system_.CreateFolder("mem:/folder"));
+  ASSERT_TRUE(file_system_.WriteFile("mem:/folder/a", "a"));
+  ASSERT_TRUE(file_system_.WriteFile("mem:/folder/b", "b"));
+  ASSERT_TRUE(file_system_.WriteFile("mem:/folder2", "2"));
+  ASSERT_TRUE(file_system_.WriteFile("mem:/file", "file"));
+  for (std::string_view path :
+       {"mem:/folder/a", "mem:/folder/b", "mem:/folder2", "mem:/file"}) {
+    Read(path);
+  }
+  EXPECT_EQ(protocol_->GetStats().count, 4);
+
+  ASSERT_TRUE(file_system_.CopyFile("mem:/folder2", "mem:/file"));
+  EXPECT_EQ(protocol_->GetStats().count, 3);
+  EXPECT_EQ(Read("mem:/file"), "2");
+
+  ASSERT_TRUE(file_system_.DeleteFile("mem:/file"));
+  EXPECT_EQ(protocol_->GetStats().count, 3);
+  EXPECT_FALSE(file_system_.IsValidPath("mem:/file"));
+
+  ASSERT_TRUE(file_system_.DeleteFolder("mem:/folder", FolderMode::kRecursive));
+  EXPECT_EQ(protocol_->GetStats().count, 1);
+  EXPECT_EQ(Read("mem:/folder2"), "2");
+}
+
+TEST_F(CachingFileProtocolTest, EvictLeastRecentlyUsed) {
+  Init(/*max_cache_size=*/10, /*max_file_size=*/6);
+  ASSERT_TRUE(file_system_.WriteFile("mem:/a", "aaaa"));
+  ASSERT_TRUE(file_system_.WriteFile("mem:/b", "bbbb"));
+  ASSERT_TRUE(file_system_.WriteFile("mem:/c", "cccc"));
+  ASSERT_TRUE(file_system_.WriteFile("mem:/large", "0123456"));
+  EXPECT_EQ(Read("mem:/a"), "aaaa");
+  EXPECT_EQ(Read("mem:/b"), "bbbb");
+  EXPECT_EQ(Read("mem:/a"), "aaaa");
+  EXPECT_EQ(protocol_->GetStats().size, 8);
+
+  // "b" is the least recently used, so it is evicted.
+  EXPECT_EQ(Read("mem:/c"), "cccc");
+  EXPECT_EQ(protocol_->GetStats().evictions, 1);
+  EXPECT_EQ(protocol_->GetStats().count, 2);
+  EXPECT_EQ(protocol_->GetStats().size, 8);
+  protocol_->ResetStats();
+  Read("mem:/a");
+  Read("mem:/c");
+  Read("mem:/b");
+  EXPECT_EQ(protocol_->GetStats().hits, 2);
+  EXPECT_EQ(protocol_->GetStats().misses, 1);
+
+  // Files larger than the maximum file size are never cached.
+  protocol_->ResetStats();
+  EXPECT_EQ(Read("mem:/large"), "0123456");
+  EXPECT_EQ(Read("mem:/large"), "0123456");
+  EXPECT_EQ(protocol_->GetStats().misses, 2);
+  EXPECT_EQ(protocol_->GetStats().evictions, 0);
+}
+
+TEST_F(CachingFileProtocolTest, ReadFileAsync) {
+  Init();
+  ASSERT_TRUE(file_system_.WriteFile("mem:/file", "0123456789"));
+  std::string buffer(4, '\0');
+  int64_t result = -2;
+  file_system_.ReadFileAsync("mem:/file", 2, buffer.data(), 4,
+                             [&result](int64_t bytes) { result = bytes; });
+  EXPECT_EQ(result, 4);
+  EXPECT_EQ(buffer, "2345");
+  EXPECT_EQ(protocol_->GetStats().misses, 1);
+
+  Read("mem:/file");
+  WriteUncached("/file", "changed");
+  result = -2;
+  file_system_.ReadFileAsync("mem:/file", 8, buffer.data(), 4,
+                             [&result](int64_t bytes) { result = bytes; });
+  EXPECT_EQ(result, 2);
+  EXPECT_EQ(buffer.substr(0, 2), "89");
+  EXPECT_EQ(protocol_->GetStats().hits, 1);
+}
+
+}  // namespace
+}  // namespace gb
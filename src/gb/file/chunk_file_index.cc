@@ -0,0 +1,121 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/chunk_file_index.h"
+
+#include "absl/log/log.h"
+#include "gb/file/file.h"
+
+namespace gb {
+
+namespace {
+
+inline constexpr int64_t kHeaderSize = sizeof(ChunkHeader);
+inline constexpr int64_t kEntrySize = sizeof(ChunkTocEntry);
+inline constexpr int64_t kFooterSize = sizeof(ChunkTocFooter);
+
+bool IsValidEntry(const ChunkTocEntry& entry, int64_t toc_offset) {
+  return entry.offset >= kHeaderSize &&
+         entry.offset <= toc_offset - kHeaderSize && entry.version > 0 &&
+         entry.size >= 0 && entry.count >= 0 && entry.type != kChunkTypeFile &&
+         entry.type != kChunkTypeToc && entry.type != kChunkTypeCompressed;
+}
+
+}  // namespace
+
+std::optional<ChunkFileIndex> ChunkFileIndex::Read(File* file) {
+  const int64_t start = file->GetPosition();
+  const int64_t size = file->SeekEnd() - start;
+  ChunkHeader file_header = {};
+  ChunkTocFooter footer = {};
+  if (start < 0 || size < 2 * kHeaderSize + kFooterSize ||
+      file->SeekTo(start) != start || file->Read(&file_header) != 1 ||
+      file_header.type != kChunkTypeFile ||
+      file->SeekTo(start + size - kFooterSize) != start + size - kFooterSize ||
+      file->Read(&footer) != 1 || footer.type != kChunkTypeToc) {
+    file->SeekTo(start);
+    return std::nullopt;
+  }
+
+  // The file claims to have a table of contents from here on, so any
+  // inconsistency is reported as an error.
+  std::vector<ChunkTocEntry> entries;
+  std::optional<ChunkReader> toc;
+  bool valid = (footer.count >= 0 && footer.offset >= kHeaderSize &&
+                footer.offset < size &&
+                footer.offset + kHeaderSize + footer.count * kEntrySize +
+                        kFooterSize ==
+                    size &&
+                file->SeekTo(start + footer.offset) == start + footer.offset);
+  if (valid) {
+    toc = ChunkReader::Read(file);
+    valid = (toc.has_value() && toc->GetType() == kChunkTypeToc &&
+             toc->GetVersion() == 1 && toc->GetCount() == footer.count);
+  }
+  if (valid && footer.count > 0) {
+    const ChunkTocEntry* toc_entries = toc->GetChunkData<ChunkTocEntry>();
+    entries.assign(toc_entries, toc_entries + footer.count);
+    for (const ChunkTocEntry& entry : entries) {
+      if (!IsValidEntry(entry, footer.offset)) {
+        valid = false;
+        break;
+      }
+    }
+  }
+  if (!valid) {
+    LOG(ERROR) << "Corrupt chunk file table of contents";
+    file->SeekTo(start);
+    return std::nullopt;
+  }
+
+  file->SeekTo(start + kHeaderSize);
+  return ChunkFileIndex(file, start, file_header.file, std::move(entries));
+}
+
+bool ChunkFileIndex::HasChunk(const ChunkType& type) const {
+  for (const ChunkTocEntry& entry : entries_) {
+    if (entry.type == type) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::optional<ChunkReader> ChunkFileIndex::ReadChunk(int index) {
+  if (index < 0 || index >= static_cast<int>(entries_.size())) {
+    return std::nullopt;
+  }
+  const ChunkTocEntry& entry = entries_[index];
+  const int64_t position = start_ + entry.offset;
+  std::optional<ChunkReader> chunk;
+  if (file_->SeekTo(position) == position) {
+    chunk = ChunkReader::Read(file_);
+  }
+  if (!chunk.has_value() || chunk->GetType() != entry.type ||
+      chunk->GetVersion() != entry.version ||
+      chunk->GetSize() != entry.size || chunk->GetCount() != entry.count) {
+    LOG(ERROR) << "Chunk " << entry.type.ToString()
+               << " does not match the chunk file table of contents";
+    return std::nullopt;
+  }
+  return chunk;
+}
+
+bool ChunkFileIndex::ReadChunks(const ChunkType& type,
+                                std::vector<ChunkReader>* chunks) {
+  for (int i = 0; i < static_cast<int>(entries_.size()); ++i) {
+    if (entries_[i].type != type) {
+      continue;
+    }
+    auto chunk = ReadChunk(i);
+    if (!chunk.has_value()) {
+      return false;
+    }
+    chunks->emplace_back(std::move(chunk.value()));
+  }
+  return true;
+}
+
+}  // namespace gb
@@ -0,0 +1,106 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_FILE_CHUNK_FILE_INDEX_H_
+#define GB_FILE_CHUNK_FILE_INDEX_H_
+
+#include <optional>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "gb/file/chunk_reader.h"
+#include "gb/file/chunk_types.h"
+#include "gb/file/file_types.h"
+
+namespace gb {
+
+// This class provides random access to the chunks in a chunk file that was
+// written with a table of contents (see WriteChunkFile).
+//
+// Only the file header and table of contents are read when the index is
+// created. Chunks are then read on demand by seeking directly to them, so
+// chunks that are not needed are never read.
+//
+// Example:
+//
+// ```
+//  auto index = ChunkFileIndex::Read(file.get());
+//  if (index.has_value()) {
+//    std::vector<ChunkReader> meshes;
+//    if (!index->ReadChunks(kChunkTypeMesh, &meshes)) { /* handle error */ }
+//  }
+// ```
+//
+// This class is thread-compatible.
+class ChunkFileIndex final {
+ public:
+  //----------------------------------------------------------------------------
+  // Construction / Destruction
+  //----------------------------------------------------------------------------
+
+  ChunkFileIndex(const ChunkFileIndex&) = delete;
+  ChunkFileIndex(ChunkFileIndex&&) = default;
+  ChunkFileIndex& operator=(const ChunkFileIndex&) = delete;
+  ChunkFileIndex& operator=(ChunkFileIndex&&) = default;
+  ~ChunkFileIndex() = default;
+
+  // Reads the index of a chunk file.
+  //
+  // The file must be positioned at the start of the chunk file, and the chunk
+  // file must extend to the end of the file. The file must outlive the index.
+  //
+  // Returns the index if this is a chunk file with a table of contents.
+  // On success, the file is positioned after the chunk file header. Otherwise,
+  // this returns no value and the file position is left unchanged, so the file
+  // can still be read sequentially with ReadChunkFile.
+  static std::optional<ChunkFileIndex> Read(File* file);
+
+  //----------------------------------------------------------------------------
+  // Properties
+  //----------------------------------------------------------------------------
+
+  // Returns the file type from the chunk file header.
+  const ChunkType& GetFileType() const { return file_type_; }
+
+  // Returns the table of contents entries for all chunks in the file, in the
+  // order they are in the file.
+  absl::Span<const ChunkTocEntry> GetEntries() const { return entries_; }
+
+  // Returns true if the file contains at least one chunk of the type.
+  bool HasChunk(const ChunkType& type) const;
+
+  //----------------------------------------------------------------------------
+  // Operations
+  //----------------------------------------------------------------------------
+
+  // Reads the chunk at the specified index in GetEntries().
+  //
+  // Returns no value if the index is out of range, or the chunk could not be
+  // read or does not match its table of contents entry.
+  std::optional<ChunkReader> ReadChunk(int index);
+
+  // Reads all chunks of the specified type, in file order, appending them to
+  // "chunks".
+  //
+  // Returns false if any chunk of the type could not be read.
+  bool ReadChunks(const ChunkType& type, std::vector<ChunkReader>* chunks);
+
+ private:
+  ChunkFileIndex(File* file, int64_t start, const ChunkType& file_type,
+                 std::vector<ChunkTocEntry> entries)
+      : file_(file),
+        start_(start),
+        file_type_(file_type),
+        entries_(std::move(entries)) {}
+
+  File* file_;
+  int64_t start_;
+  ChunkType file_type_;
+  std::vector<ChunkTocEntry> entries_;
+};
+
+}  // namespace gb
+
+#endif  // GB_FILE_CHUNK_FILE_INDEX_H_
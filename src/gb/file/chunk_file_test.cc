@@ -3,7 +3,11 @@
 // Use of this source code is governed by an MIT-style License that can be found
 // in the LICENSE file or at https://opensource.org/licenses/MIT.
 
+#include <cstring>
+
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
+#include "gb/file/chunk_file_index.h"
 #include "gb/file/chunk_reader.h"
 #include "gb/file/chunk_types.h"
 #include "gb/file/chunk_writer.h"
@@ -777,6 +781,417 @@ TEST_F(ChunkFileTest, ChunkReaderRelease) {
   std::free(released_chunk);
 }
 
+TEST_F(ChunkFileTest, ChunkStreamWriterMatchesChunkWriter) {
+  auto chunk_writer = ChunkWriter::New<Example>(kChunkTypeExample, 1);
+  auto* chunk = chunk_writer.GetChunkData<Example>();
+  ASSERT_NE(chunk, nullptr);
+  chunk->name = chunk_writer.AddString("1234");
+  chunk->value = 42;
+  chunk->foo_count = 2;
+  chunk->foos = chunk_writer.AddData<const Foo>({Foo{1, 2, 3}, Foo{4, 5, 6}});
+  auto file = file_system_->OpenFile("mem:/expected", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(chunk_writer.Write(file.get()));
+  file.reset();
+
+  file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  auto stream_writer =
+      ChunkStreamWriter::New<Example>(file.get(), kChunkTypeExample, 1);
+  EXPECT_EQ(stream_writer.GetCount(), 1);
+  Example example = {};
+  example.name = stream_writer.AddString("1234");
+  example.value = 42;
+  example.foo_count = 2;
+  example.foos =
+      stream_writer.AddData<const Foo>({Foo{1, 2, 3}, Foo{4, 5, 6}});
+  EXPECT_TRUE(stream_writer.IsValid());
+  EXPECT_EQ(stream_writer.AddEntries<Example>({}), false);
+  EXPECT_TRUE(stream_writer.Finish(example));
+  EXPECT_FALSE(stream_writer.Finish());
+  EXPECT_EQ(stream_writer.GetSize(), chunk_writer.GetSize());
+  EXPECT_EQ(file->GetPosition(), sizeof(ChunkHeader) + chunk_writer.GetSize());
+  file.reset();
+
+  std::vector<uint8_t> expected;
+  ASSERT_TRUE(file_system_->ReadFile("mem:/expected", &expected));
+  std::vector<uint8_t> contents;
+  ASSERT_TRUE(file_system_->ReadFile("mem:/test", &contents));
+  EXPECT_EQ(contents, expected);
+}
+
+TEST_F(ChunkFileTest, ChunkStreamWriterListChunk) {
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  auto stream_writer =
+      ChunkStreamWriter::NewList<Bar>(file.get(), kChunkTypeBar, 4);
+  EXPECT_EQ(stream_writer.GetCount(), 0);
+  EXPECT_TRUE(stream_writer.AddEntries<Bar>({Bar{1, 2, 3}, Bar{4, 5, 6}}));
+  EXPECT_TRUE(stream_writer.AddEntries<Bar>({}));
+  EXPECT_TRUE(stream_writer.AddEntries<Bar>({Bar{7, 8, 9}}));
+  EXPECT_FALSE(stream_writer.AddEntries<Example>({Example{}}));
+  EXPECT_EQ(stream_writer.GetCount(), 3);
+  EXPECT_EQ(stream_writer.GetSize(), 3 * sizeof(Bar));
+  EXPECT_TRUE(stream_writer.IsValid());
+  EXPECT_TRUE(stream_writer.Finish());
+  EXPECT_EQ(stream_writer.GetSize(), 40);
+  file.reset();
+
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  bool has_error = true;
+  auto chunk_reader = ChunkReader::Read(file.get(), &has_error);
+  ASSERT_TRUE(chunk_reader);
+  EXPECT_FALSE(has_error);
+  EXPECT_EQ(chunk_reader->GetType(), kChunkTypeBar);
+  EXPECT_EQ(chunk_reader->GetVersion(), 4);
+  EXPECT_EQ(chunk_reader->GetSize(), 40);
+  EXPECT_EQ(chunk_reader->GetCount(), 3);
+  auto* read_chunks = chunk_reader->GetChunkData<Bar>();
+  ASSERT_NE(read_chunks, nullptr);
+  EXPECT_EQ(read_chunks[0].a, 1);
+  EXPECT_EQ(read_chunks[1].b, 5);
+  EXPECT_EQ(read_chunks[2].c, 9);
+}
+
+TEST_F(ChunkFileTest, ChunkStreamWriterChunkFile) {
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeExample, {}));
+  auto bar_writer =
+      ChunkStreamWriter::NewList<Bar>(file.get(), kChunkTypeBar, 1);
+  EXPECT_TRUE(bar_writer.AddEntries<Bar>({Bar{1, 2, 3}}));
+  EXPECT_TRUE(bar_writer.Finish());
+  auto example_writer =
+      ChunkStreamWriter::New<Example>(file.get(), kChunkTypeExample, 2);
+  Example example = {};
+  example.name = example_writer.AddString("name");
+  EXPECT_TRUE(example_writer.Finish(example));
+  file.reset();
+
+  ChunkType file_type;
+  std::vector<ChunkReader> read_chunks;
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_TRUE(ReadChunkFile(file.get(), &file_type, &read_chunks));
+  EXPECT_EQ(file_type, kChunkTypeExample);
+  ASSERT_EQ(read_chunks.size(), 2);
+  EXPECT_EQ(read_chunks[0].GetType(), kChunkTypeBar);
+  EXPECT_EQ(read_chunks[0].GetCount(), 1);
+  EXPECT_EQ(read_chunks[1].GetType(), kChunkTypeExample);
+  EXPECT_EQ(read_chunks[1].GetVersion(), 2);
+  auto* read_example = read_chunks[1].GetChunkData<Example>();
+  ASSERT_NE(read_example, nullptr);
+  read_chunks[1].ConvertToPtr(&read_example->name);
+  EXPECT_STREQ(read_example->name.ptr, "name");
+}
+
+TEST_F(ChunkFileTest, ChunkStreamWriterUnfinished) {
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  {
+    auto stream_writer =
+        ChunkStreamWriter::NewList<Bar>(file.get(), kChunkTypeBar, 1);
+    EXPECT_TRUE(stream_writer.AddEntries<Bar>({Bar{1, 2, 3}}));
+  }
+  file.reset();
+
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  bool has_error = false;
+  EXPECT_FALSE(ChunkReader::Read(file.get(), &has_error));
+  EXPECT_TRUE(has_error);
+}
+
+TEST_F(ChunkFileTest, CompressedChunk) {
+  // Large enough to span several compression blocks.
+  static constexpr int32_t kBarCount = 20000;
+  auto chunk_writer = ChunkWriter::New<Bar>(kChunkTypeBar, 2, kBarCount);
+  auto* chunks = chunk_writer.GetChunkData<Bar>();
+  ASSERT_NE(chunks, nullptr);
+  for (int32_t i = 0; i < kBarCount; ++i) {
+    chunks[i] = {static_cast<float>(i % 10), 1, 2};
+  }
+  chunk_writer.AddString("extra data");
+  chunk_writer.SetCompression(ChunkCompression::kLz4);
+  EXPECT_EQ(chunk_writer.GetCompression(), ChunkCompression::kLz4);
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(chunk_writer.Write(file.get()));
+  ASSERT_TRUE(ChunkWriter::New<Foo>(kChunkTypeExample, 1).Write(file.get()));
+  file.reset();
+
+  ASSERT_TRUE(file_system_->ReadFile("mem:/test", &file_contents_));
+  EXPECT_LT(file_contents_.size(), chunk_writer.GetSize() / 4);
+  auto* header = reinterpret_cast<ChunkHeader*>(file_contents_.data());
+  EXPECT_EQ(header->type, kChunkTypeCompressed);
+  EXPECT_EQ(header->count, static_cast<int32_t>(ChunkCompression::kLz4));
+
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  bool has_error = true;
+  auto chunk_reader = ChunkReader::Read(file.get(), &has_error);
+  ASSERT_TRUE(chunk_reader);
+  EXPECT_FALSE(has_error);
+  EXPECT_EQ(file->GetPosition(), sizeof(ChunkHeader) + header->size);
+  EXPECT_EQ(chunk_reader->GetType(), kChunkTypeBar);
+  EXPECT_EQ(chunk_reader->GetSize(), chunk_writer.GetSize());
+  EXPECT_EQ(chunk_reader->GetVersion(), 2);
+  EXPECT_EQ(chunk_reader->GetCount(), kBarCount);
+  auto* read_chunks = chunk_reader->GetChunkData<Bar>();
+  ASSERT_NE(read_chunks, nullptr);
+  for (int32_t i = 0; i < kBarCount; ++i) {
+    ASSERT_EQ(read_chunks[i].a, i % 10) << "Index " << i;
+  }
+  ChunkPtr<const char> extra;
+  extra.offset = kBarCount * sizeof(Bar);
+  chunk_reader->ConvertToPtr(&extra);
+  EXPECT_STREQ(extra.ptr, "extra data");
+
+  chunk_reader = ChunkReader::Read(file.get(), &has_error);
+  ASSERT_TRUE(chunk_reader);
+  EXPECT_FALSE(has_error);
+  EXPECT_EQ(chunk_reader->GetType(), kChunkTypeExample);
+}
+
+TEST_F(ChunkFileTest, IncompressibleChunkIsNotCompressed) {
+  auto chunk_writer = ChunkWriter::New<Example>(kChunkTypeExample, 1);
+  chunk_writer.GetChunkData<Example>()->name = chunk_writer.AddString("1234");
+  chunk_writer.SetCompression(ChunkCompression::kLz4);
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(chunk_writer.Write(file.get()));
+  file.reset();
+
+  auto* chunk = ReadSingleChunkFile<Example>("mem:/test", chunk_writer);
+  ASSERT_NE(chunk, nullptr);
+  EXPECT_EQ(chunk->name.offset, sizeof(Example));
+}
+
+TEST_F(ChunkFileTest, ReadWriteCompressedChunkFile) {
+  std::vector<int32_t> values(50000);
+  for (int32_t i = 0; i < static_cast<int32_t>(values.size()); ++i) {
+    values[i] = i / 7;
+  }
+  std::vector<ChunkWriter> write_chunks;
+  write_chunks.emplace_back(ChunkWriter::New(
+      kChunkTypeBar, 1, values.data(),
+      static_cast<int32_t>(values.size() * sizeof(int32_t))));
+  write_chunks.back().SetCompression(ChunkCompression::kLz4);
+  write_chunks.emplace_back(ChunkWriter::New<Foo>(kChunkTypeExample, 1));
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeBar, write_chunks));
+  file.reset();
+
+  std::vector<ChunkReader> read_chunks;
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_TRUE(ReadChunkFile(file.get(), nullptr, &read_chunks));
+  ASSERT_EQ(read_chunks.size(), 2);
+  EXPECT_EQ(read_chunks[0].GetType(), kChunkTypeBar);
+  EXPECT_EQ(read_chunks[0].GetSize(), write_chunks[0].GetSize());
+  ASSERT_NE(read_chunks[0].GetChunkData<int32_t>(), nullptr);
+  EXPECT_EQ(std::memcmp(read_chunks[0].GetChunkData<int32_t>(), values.data(),
+                        values.size() * sizeof(int32_t)),
+            0);
+  EXPECT_EQ(read_chunks[1].GetType(), kChunkTypeExample);
+}
+
+TEST_F(ChunkFileTest, ChunkReaderCorruptCompressedChunk) {
+  std::vector<int32_t> values(1000, 5);
+  auto chunk_writer = ChunkWriter::New(
+      kChunkTypeBar, 1, values.data(),
+      static_cast<int32_t>(values.size() * sizeof(int32_t)));
+  chunk_writer.SetCompression(ChunkCompression::kLz4);
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(chunk_writer.Write(file.get()));
+  file.reset();
+  ASSERT_TRUE(file_system_->ReadFile("mem:/test", &file_contents_));
+  const std::vector<uint8_t> contents = file_contents_;
+
+  // Corrupt the block size, then the compressed data, then the compression.
+  for (int64_t offset : {32, 36, 12}) {
+    SCOPED_TRACE(absl::StrCat("offset=", offset));
+    std::vector<uint8_t> corrupt = contents;
+    corrupt[offset] ^= 0xFF;
+    ASSERT_TRUE(file_system_->WriteFile("mem:/test", corrupt));
+    file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+    ASSERT_NE(file, nullptr);
+    bool has_error = false;
+    EXPECT_FALSE(ChunkReader::Read(file.get(), &has_error));
+    EXPECT_TRUE(has_error);
+    file.reset();
+  }
+}
+
+TEST_F(ChunkFileTest, ChunkReaderReadAt) {
+  std::vector<int32_t> values(50000);
+  for (int32_t i = 0; i < static_cast<int32_t>(values.size()); ++i) {
+    values[i] = i / 7;
+  }
+  auto example_writer = ChunkWriter::New<Example>(kChunkTypeExample, 1);
+  example_writer.GetChunkData<Example>()->name =
+      example_writer.AddString("name");
+  auto bar_writer = ChunkWriter::New(
+      kChunkTypeBar, 2, values.data(),
+      static_cast<int32_t>(values.size() * sizeof(int32_t)));
+  bar_writer.SetCompression(ChunkCompression::kLz4);
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(example_writer.Write(file.get()));
+  const int64_t bar_offset = file->GetPosition();
+  ASSERT_TRUE(bar_writer.Write(file.get()));
+  const int64_t file_size = file->GetPosition();
+  file.reset();
+
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  bool has_error = true;
+  auto chunk_reader = ChunkReader::ReadAt(file.get(), bar_offset, &has_error);
+  ASSERT_TRUE(chunk_reader);
+  EXPECT_FALSE(has_error);
+  EXPECT_EQ(file->GetPosition(), 0);
+  EXPECT_EQ(chunk_reader->GetType(), kChunkTypeBar);
+  EXPECT_EQ(chunk_reader->GetVersion(), 2);
+  EXPECT_EQ(chunk_reader->GetSize(), bar_writer.GetSize());
+  ASSERT_NE(chunk_reader->GetChunkData<int32_t>(), nullptr);
+  EXPECT_EQ(std::memcmp(chunk_reader->GetChunkData<int32_t>(), values.data(),
+                        values.size() * sizeof(int32_t)),
+            0);
+
+  chunk_reader = ChunkReader::ReadAt(file.get(), 0, &has_error);
+  ASSERT_TRUE(chunk_reader);
+  EXPECT_FALSE(has_error);
+  EXPECT_EQ(chunk_reader->GetType(), kChunkTypeExample);
+  auto* example = chunk_reader->GetChunkData<Example>();
+  ASSERT_NE(example, nullptr);
+  chunk_reader->ConvertToPtr(&example->name);
+  EXPECT_STREQ(example->name.ptr, "name");
+
+  EXPECT_FALSE(ChunkReader::ReadAt(file.get(), file_size, &has_error));
+  EXPECT_FALSE(has_error);
+  EXPECT_FALSE(ChunkReader::ReadAt(file.get(), bar_offset + 8, &has_error));
+  EXPECT_TRUE(has_error);
+}
+
+TEST_F(ChunkFileTest, ChunkFileIndex) {
+  std::vector<ChunkWriter> write_chunks;
+  write_chunks.emplace_back(ChunkWriter::New<Bar>(kChunkTypeBar, 4, 3));
+  write_chunks.back().GetChunkData<Bar>()[1] = {4, 5, 6};
+  write_chunks.emplace_back(ChunkWriter::New<Example>(kChunkTypeExample, 1));
+  auto* example_chunk = write_chunks.back().GetChunkData<Example>();
+  example_chunk->name = write_chunks.back().AddString("1234");
+  example_chunk->value = 42;
+  write_chunks.emplace_back(ChunkWriter::New<Bar>(kChunkTypeBar, 4, 1000));
+  write_chunks.back().GetChunkData<Bar>()[999] = {7, 8, 9};
+  write_chunks.back().SetCompression(ChunkCompression::kLz4);
+
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeExample, write_chunks,
+                             /*write_toc=*/true));
+  file.reset();
+
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  auto index = ChunkFileIndex::Read(file.get());
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(file->GetPosition(), sizeof(ChunkHeader));
+  EXPECT_EQ(index->GetFileType(), kChunkTypeExample);
+  ASSERT_EQ(index->GetEntries().size(), 3);
+  EXPECT_TRUE(index->HasChunk(kChunkTypeBar));
+  EXPECT_FALSE(index->HasChunk({'N', 'O', 'N', 'E'}));
+  for (int i = 0; i < 3; ++i) {
+    const ChunkTocEntry& entry = index->GetEntries()[i];
+    EXPECT_EQ(entry.type, write_chunks[i].GetType());
+    EXPECT_EQ(entry.version, write_chunks[i].GetVersion());
+    EXPECT_EQ(entry.size, write_chunks[i].GetSize());
+    EXPECT_EQ(entry.count, write_chunks[i].GetCount());
+  }
+  EXPECT_EQ(index->GetEntries()[0].offset, sizeof(ChunkHeader));
+
+  auto chunk_reader = index->ReadChunk(1);
+  ASSERT_TRUE(chunk_reader.has_value());
+  auto* read_example = chunk_reader->GetChunkData<Example>();
+  chunk_reader->ConvertToPtr(&read_example->name);
+  EXPECT_STREQ(read_example->name.ptr, "1234");
+  EXPECT_EQ(read_example->value, 42);
+  EXPECT_FALSE(index->ReadChunk(3).has_value());
+  EXPECT_FALSE(index->ReadChunk(-1).has_value());
+
+  std::vector<ChunkReader> bars;
+  ASSERT_TRUE(index->ReadChunks(kChunkTypeBar, &bars));
+  ASSERT_EQ(bars.size(), 2);
+  EXPECT_EQ(bars[0].GetCount(), 3);
+  EXPECT_EQ(bars[0].GetChunkData<Bar>()[1].b, 5);
+  EXPECT_EQ(bars[1].GetCount(), 1000);
+  EXPECT_EQ(bars[1].GetChunkData<Bar>()[999].c, 9);
+
+  // The table of contents is not returned as a chunk when reading
+  // sequentially.
+  std::vector<ChunkReader> read_chunks;
+  file->SeekBegin();
+  ASSERT_TRUE(ReadChunkFile(file.get(), nullptr, &read_chunks));
+  ASSERT_EQ(read_chunks.size(), 3);
+  EXPECT_EQ(read_chunks[2].GetType(), kChunkTypeBar);
+}
+
+TEST_F(ChunkFileTest, ChunkFileIndexEmptyFile) {
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeExample, {}, true));
+  file.reset();
+
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  auto index = ChunkFileIndex::Read(file.get());
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(index->GetFileType(), kChunkTypeExample);
+  EXPECT_TRUE(index->GetEntries().empty());
+}
+
+TEST_F(ChunkFileTest, ChunkFileIndexWithoutToc) {
+  std::vector<ChunkWriter> write_chunks;
+  write_chunks.emplace_back(ChunkWriter::New<Bar>(kChunkTypeBar, 4, 3));
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeBar, write_chunks));
+  file.reset();
+
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_FALSE(ChunkFileIndex::Read(file.get()).has_value());
+  EXPECT_EQ(file->GetPosition(), 0);
+  std::vector<ChunkReader> read_chunks;
+  ASSERT_TRUE(ReadChunkFile(file.get(), nullptr, &read_chunks));
+  EXPECT_EQ(read_chunks.size(), 1);
+}
+
+TEST_F(ChunkFileTest, ChunkFileIndexCorruptToc) {
+  std::vector<ChunkWriter> write_chunks;
+  write_chunks.emplace_back(ChunkWriter::New<Bar>(kChunkTypeBar, 4, 3));
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeBar, write_chunks, true));
+  file.reset();
+  ASSERT_TRUE(file_system_->ReadFile("mem:/test", &file_contents_));
+  const std::vector<uint8_t> contents = file_contents_;
+
+  // Corrupt the footer offset, then the footer count, then the chunk offset
+  // in the table of contents entry.
+  const int64_t size = static_cast<int64_t>(contents.size());
+  for (int64_t offset : {size - 16, size - 4, size - 24}) {
+    SCOPED_TRACE(absl::StrCat("offset=", offset));
+    std::vector<uint8_t> corrupt = contents;
+    corrupt[offset] ^= 0x40;
+    ASSERT_TRUE(file_system_->WriteFile("mem:/test", corrupt));
+    file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+    ASSERT_NE(file, nullptr);
+    EXPECT_FALSE(ChunkFileIndex::Read(file.get()).has_value());
+    EXPECT_EQ(file->GetPosition(), 0);
+    file.reset();
+  }
+}
+
 TEST_F(ChunkFileTest, ReadWriteMultiChunkFile) {
   std::vector<ChunkWriter> write_chunks;
 
@@ -852,5 +1267,156 @@ TEST_F(ChunkFileTest, ReadWriteMultiChunkFile) {
   EXPECT_EQ(example_chunk->foos.ptr[1].z, 6);
 }
 
+TEST_F(ChunkFileTest, ReadChunkFileInPlace) {
+  std::vector<ChunkWriter> write_chunks;
+  write_chunks.emplace_back(ChunkWriter::New<Bar>(kChunkTypeBar, 4, 2));
+  auto* bar_chunks = write_chunks.back().GetChunkData<Bar>();
+  ASSERT_NE(bar_chunks, nullptr);
+  bar_chunks[0] = {1, 2, 3};
+  bar_chunks[1] = {4, 5, 6};
+  write_chunks.emplace_back(ChunkWriter::New<Example>(kChunkTypeExample, 1));
+  auto* example_chunk = write_chunks.back().GetChunkData<Example>();
+  ASSERT_NE(example_chunk, nullptr);
+  example_chunk->name = write_chunks.back().AddString("1234");
+  example_chunk->foos =
+      write_chunks.back().AddData<const Foo>({Foo{1, 2, 3}, Foo{4, 5, 6}});
+  write_chunks.emplace_back(ChunkWriter::New<Foo>(kChunkTypeExample, 2, 0));
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeExample, write_chunks,
+                             /*write_toc=*/true));
+  file.reset();
+
+  ChunkType file_type;
+  std::vector<ChunkReader> read_chunks;
+  std::unique_ptr<uint64_t[]> buffer;
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_TRUE(
+      ReadChunkFileInPlace(file.get(), &file_type, &read_chunks, &buffer));
+  file.reset();
+  EXPECT_EQ(file_type, kChunkTypeExample);
+  ASSERT_NE(buffer, nullptr);
+
+  // The table of contents is skipped, and all chunks are views into the
+  // buffer.
+  ASSERT_EQ(read_chunks.size(), 3);
+  const uint64_t* begin = buffer.get();
+  EXPECT_FALSE(read_chunks[0].OwnsChunkData());
+  EXPECT_EQ(read_chunks[0].GetType(), kChunkTypeBar);
+  EXPECT_EQ(read_chunks[0].GetVersion(), 4);
+  EXPECT_EQ(read_chunks[0].GetCount(), 2);
+  EXPECT_EQ(read_chunks[0].GetChunkData<uint64_t>(), begin + 2);
+  bar_chunks = read_chunks[0].GetChunkData<Bar>();
+  EXPECT_EQ(bar_chunks[1].a, 4);
+  EXPECT_EQ(bar_chunks[1].c, 6);
+
+  EXPECT_FALSE(read_chunks[1].OwnsChunkData());
+  EXPECT_EQ(read_chunks[1].GetType(), kChunkTypeExample);
+  EXPECT_EQ(read_chunks[1].GetSize(), write_chunks[1].GetSize());
+  example_chunk = read_chunks[1].GetChunkData<Example>();
+  ASSERT_NE(example_chunk, nullptr);
+  EXPECT_EQ(reinterpret_cast<uint64_t*>(example_chunk),
+            begin + 2 + (sizeof(ChunkHeader) + sizeof(Bar) * 2 + 7) / 8);
+  read_chunks[1].ConvertToPtr(&example_chunk->name);
+  read_chunks[1].ConvertToPtr(&example_chunk->foos);
+  EXPECT_STREQ(example_chunk->name.ptr, "1234");
+  EXPECT_EQ(example_chunk->foos.ptr[1].y, 5);
+
+  EXPECT_EQ(read_chunks[2].GetType(), kChunkTypeExample);
+  EXPECT_EQ(read_chunks[2].GetVersion(), 2);
+  EXPECT_EQ(read_chunks[2].GetChunkData<Foo>(), nullptr);
+}
+
+TEST_F(ChunkFileTest, ReadChunkFileInPlaceRelease) {
+  std::vector<ChunkWriter> write_chunks;
+  write_chunks.emplace_back(ChunkWriter::New<Example>(kChunkTypeExample, 1));
+  auto* example_chunk = write_chunks.back().GetChunkData<Example>();
+  ASSERT_NE(example_chunk, nullptr);
+  example_chunk->name = write_chunks.back().AddString("1234");
+  example_chunk->foos =
+      write_chunks.back().AddData<const Foo>({Foo{1, 2, 3}, Foo{4, 5, 6}});
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeExample, write_chunks));
+  file.reset();
+
+  std::vector<ChunkReader> read_chunks;
+  std::unique_ptr<uint64_t[]> buffer;
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_TRUE(
+      ReadChunkFileInPlace(file.get(), nullptr, &read_chunks, &buffer));
+  file.reset();
+  ASSERT_EQ(read_chunks.size(), 1);
+  auto* read_chunk = read_chunks[0].GetChunkData<Example>();
+  ASSERT_NE(read_chunk, nullptr);
+  read_chunks[0].ConvertToPtr(&read_chunk->name);
+  read_chunks[0].ConvertToPtr(&read_chunk->foos);
+
+  // Releasing a view returns a copy with the converted pointers rebased, which
+  // remains valid after the buffer is freed.
+  auto* released_chunk = read_chunks[0].ReleaseChunkData<Example>();
+  ASSERT_NE(released_chunk, nullptr);
+  EXPECT_NE(released_chunk, read_chunk);
+  EXPECT_EQ(read_chunks[0].GetChunkData<Example>(), nullptr);
+  read_chunks.clear();
+  buffer.reset();
+
+  EXPECT_STREQ(released_chunk->name.ptr, "1234");
+  EXPECT_EQ(released_chunk->foos.ptr[0].x, 1);
+  EXPECT_EQ(released_chunk->foos.ptr[1].z, 6);
+  std::free(released_chunk);
+}
+
+TEST_F(ChunkFileTest, ReadChunkFileInPlaceCompressed) {
+  std::vector<int32_t> values(50000);
+  for (int32_t i = 0; i < static_cast<int32_t>(values.size()); ++i) {
+    values[i] = i / 7;
+  }
+  std::vector<ChunkWriter> write_chunks;
+  write_chunks.emplace_back(ChunkWriter::New(
+      kChunkTypeBar, 1, values.data(),
+      static_cast<int32_t>(values.size() * sizeof(int32_t))));
+  write_chunks.back().SetCompression(ChunkCompression::kLz4);
+  write_chunks.emplace_back(ChunkWriter::New<Foo>(kChunkTypeExample, 1));
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeBar, write_chunks));
+  file.reset();
+
+  std::vector<ChunkReader> read_chunks;
+  std::unique_ptr<uint64_t[]> buffer;
+  file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+  ASSERT_TRUE(
+      ReadChunkFileInPlace(file.get(), nullptr, &read_chunks, &buffer));
+  ASSERT_EQ(read_chunks.size(), 2);
+  EXPECT_TRUE(read_chunks[0].OwnsChunkData());
+  EXPECT_EQ(read_chunks[0].GetType(), kChunkTypeBar);
+  ASSERT_NE(read_chunks[0].GetChunkData<int32_t>(), nullptr);
+  EXPECT_EQ(std::memcmp(read_chunks[0].GetChunkData<int32_t>(), values.data(),
+                        values.size() * sizeof(int32_t)),
+            0);
+  EXPECT_FALSE(read_chunks[1].OwnsChunkData());
+  EXPECT_EQ(read_chunks[1].GetType(), kChunkTypeExample);
+}
+
+TEST_F(ChunkFileTest, ReadChunkFileInPlaceInvalid) {
+  std::vector<ChunkWriter> write_chunks;
+  write_chunks.emplace_back(ChunkWriter::New<Bar>(kChunkTypeBar, 1, 4));
+  auto file = file_system_->OpenFile("mem:/test", kNewFileFlags);
+  ASSERT_TRUE(WriteChunkFile(file.get(), kChunkTypeBar, write_chunks));
+  file.reset();
+  ASSERT_TRUE(file_system_->ReadFile("mem:/test", &file_contents_));
+  const std::vector<uint8_t> contents = file_contents_;
+
+  std::vector<ChunkReader> read_chunks;
+  std::unique_ptr<uint64_t[]> buffer;
+  for (int64_t size : {0, 8, 24, 40}) {
+    SCOPED_TRACE(absl::StrCat("size=", size));
+    ASSERT_TRUE(file_system_->WriteFile("mem:/test", contents.data(), size));
+    file = file_system_->OpenFile("mem:/test", kReadFileFlags);
+    ASSERT_NE(file, nullptr);
+    EXPECT_FALSE(
+        ReadChunkFileInPlace(file.get(), nullptr, &read_chunks, &buffer));
+    file.reset();
+  }
+}
+
 }  // namespace
 }  // namespace gb
@@ -5,8 +5,14 @@
 
 #include "gb/file/chunk_reader.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
 #include "absl/log/log.h"
 #include "gb/file/file.h"
+#include "gb/file/lz4.h"
 
 namespace gb {
 
@@ -14,17 +20,147 @@ ChunkReader& ChunkReader::operator=(ChunkReader&& other) {
   if (&other == this) {
     return *this;
   }
+  if (owns_data_) {
+    std::free(data_);
+  }
   header_ = other.header_;
   data_ = std::exchange(other.data_, nullptr);
+  owns_data_ = other.owns_data_;
+  converted_ptrs_ = std::move(other.converted_ptrs_);
   return *this;
 }
 
-ChunkReader::~ChunkReader() { std::free(data_); }
+ChunkReader::~ChunkReader() {
+  if (owns_data_) {
+    std::free(data_);
+  }
+}
 
-std::optional<ChunkReader> ChunkReader::Read(File* file, bool* has_error) {
+uint64_t* ChunkReader::ReleaseData() {
+  uint64_t* data = std::exchange(data_, nullptr);
+  if (owns_data_ || data == nullptr) {
+    return data;
+  }
+
+  // The chunk data is a view into a shared buffer, so the caller gets a copy.
+  // Pointers already converted by ConvertToPtr are rebased into the copy.
+  auto* copy = static_cast<uint8_t*>(std::malloc(header_.size));
+  std::memcpy(copy, data, header_.size);
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+  const uintptr_t end = begin + header_.size;
+  for (int32_t offset : converted_ptrs_) {
+    uintptr_t ptr = 0;
+    std::memcpy(&ptr, copy + offset, sizeof(ptr));
+    if (ptr >= begin && ptr <= end) {
+      ptr = reinterpret_cast<uintptr_t>(copy) + (ptr - begin);
+      std::memcpy(copy + offset, &ptr, sizeof(ptr));
+    }
+  }
+  converted_ptrs_.clear();
+  return reinterpret_cast<uint64_t*>(copy);
+}
+
+void ChunkReader::AddConvertedPtr(const void* ptr) {
+  const intptr_t offset = reinterpret_cast<intptr_t>(ptr) -
+                          reinterpret_cast<intptr_t>(data_);
+  if (offset >= 0 && offset <= header_.size - 8) {
+    converted_ptrs_.push_back(static_cast<int32_t>(offset));
+  }
+}
+
+namespace {
+
+bool IsValidChunkHeader(const ChunkHeader& chunk_header) {
+  return chunk_header.version > 0 && chunk_header.size >= 0 &&
+         chunk_header.size % 8 == 0 && chunk_header.count >= 0 &&
+         chunk_header.count <= chunk_header.size;
+}
+
+// Decompresses the contents of a "GBCZ" chunk, one block at a time.
+//
+// The compressed contents are provided in order by "read", which is called
+// with the number of bytes needed, and returns a pointer to them (or null if
+// they could not be read). On success, this returns the header and data of
+// the uncompressed chunk.
+template <typename ReadFn>
+bool DecompressChunk(const ChunkHeader& compressed_header, ReadFn read,
+                     ChunkHeader* chunk_header, uint64_t** data) {
+  if (compressed_header.version != 1 ||
+      compressed_header.count !=
+          static_cast<int32_t>(ChunkCompression::kLz4)) {
+    LOG(ERROR) << "Unsupported chunk compression";
+    return false;
+  }
+  int64_t remaining = compressed_header.size;
+  const uint8_t* in = nullptr;
+  if (remaining < static_cast<int64_t>(sizeof(ChunkHeader)) ||
+      (in = read(sizeof(ChunkHeader))) == nullptr) {
+    LOG(ERROR) << "Compressed chunk is not complete";
+    return false;
+  }
+  std::memcpy(chunk_header, in, sizeof(ChunkHeader));
+  remaining -= sizeof(ChunkHeader);
+  if (!IsValidChunkHeader(*chunk_header) ||
+      chunk_header->type == kChunkTypeCompressed ||
+      chunk_header->type == kChunkTypeFile) {
+    LOG(ERROR) << "Corrupt compressed chunk in chunk file";
+    return false;
+  }
+
+  uint8_t* chunk_data = nullptr;
+  if (chunk_header->size > 0) {
+    chunk_data = static_cast<uint8_t*>(std::malloc(chunk_header->size));
+  }
+  const int64_t max_block_size = Lz4CompressBound(kChunkCompressionBlockSize);
+  for (int64_t offset = 0; offset < chunk_header->size;
+       offset += kChunkCompressionBlockSize) {
+    const int64_t block_size = std::min<int64_t>(
+        chunk_header->size - offset, kChunkCompressionBlockSize);
+    int32_t stored_size = 0;
+    bool valid = (remaining >= static_cast<int64_t>(sizeof(int32_t)) &&
+                  (in = read(sizeof(int32_t))) != nullptr);
+    if (valid) {
+      std::memcpy(&stored_size, in, sizeof(int32_t));
+    }
+    remaining -= sizeof(int32_t);
+    if (valid && stored_size < 0) {
+      valid = (-static_cast<int64_t>(stored_size) == block_size &&
+               block_size <= remaining && (in = read(block_size)) != nullptr);
+      if (valid) {
+        std::memcpy(chunk_data + offset, in, block_size);
+      }
+      remaining -= block_size;
+    } else if (valid) {
+      valid = (stored_size > 0 && stored_size <= remaining &&
+               stored_size <= max_block_size &&
+               (in = read(stored_size)) != nullptr &&
+               Lz4Decompress(in, stored_size, chunk_data + offset,
+                             block_size) == block_size);
+      remaining -= stored_size;
+    }
+    if (!valid) {
+      LOG(ERROR) << "Corrupt compressed chunk in chunk file";
+      std::free(chunk_data);
+      return false;
+    }
+  }
+
+  // Skip the padding at the end of the compressed chunk.
+  if (remaining >= 8 || (remaining > 0 && read(remaining) == nullptr)) {
+    LOG(ERROR) << "Corrupt compressed chunk in chunk file";
+    std::free(chunk_data);
+    return false;
+  }
+  *data = reinterpret_cast<uint64_t*>(chunk_data);
+  return true;
+}
+
+}  // namespace
+
+template <typename ReadFn>
+std::optional<ChunkReader> ChunkReader::DoRead(ReadFn read, bool* has_error) {
   ChunkHeader chunk_header = {};
-  int64_t read_size =
-      file->Read(static_cast<void*>(&chunk_header), sizeof(chunk_header));
+  int64_t read_size = read(&chunk_header, sizeof(chunk_header));
   if (read_size != sizeof(chunk_header)) {
     if (has_error != nullptr) {
       *has_error = (read_size != 0);
@@ -32,9 +168,7 @@ std::optional<ChunkReader> ChunkReader::Read(File* file, bool* has_error) {
     return {};
   }
 
-  if (chunk_header.version <= 0 || chunk_header.size < 0 ||
-      chunk_header.size % 8 != 0 || chunk_header.count < 0 ||
-      chunk_header.count > chunk_header.size) {
+  if (!IsValidChunkHeader(chunk_header)) {
     LOG(ERROR) << "Corrupt chunk in chunk file";
     if (has_error != nullptr) {
       *has_error = true;
@@ -43,10 +177,29 @@ std::optional<ChunkReader> ChunkReader::Read(File* file, bool* has_error) {
   }
 
   uint64_t* data = nullptr;
-  const int64_t chunk_size = chunk_header.size / 8;
-  if (chunk_size > 0) {
+  if (chunk_header.type == kChunkTypeCompressed) {
+    ChunkHeader compressed_header = chunk_header;
+    std::vector<uint8_t> buffer;
+    auto read_compressed = [&read, &buffer](int64_t size) -> const uint8_t* {
+      if (static_cast<int64_t>(buffer.size()) < size) {
+        buffer.resize(size);
+      }
+      return read(buffer.data(), size) == size ? buffer.data() : nullptr;
+    };
+    const bool success = DecompressChunk(compressed_header, read_compressed,
+                                         &chunk_header, &data);
+    if (has_error != nullptr) {
+      *has_error = !success;
+    }
+    if (!success) {
+      return {};
+    }
+    return ChunkReader(chunk_header, data);
+  }
+
+  if (chunk_header.size > 0) {
     data = static_cast<uint64_t*>(std::malloc(chunk_header.size));
-    if (file->Read(data, chunk_size) != chunk_size) {
+    if (read(data, chunk_header.size) != chunk_header.size) {
       LOG(ERROR) << "Chunk " << chunk_header.type.ToString()
                  << " is not complete";
       if (has_error != nullptr) {
@@ -63,6 +216,25 @@ std::optional<ChunkReader> ChunkReader::Read(File* file, bool* has_error) {
   return ChunkReader(chunk_header, data);
 }
 
+std::optional<ChunkReader> ChunkReader::Read(File* file, bool* has_error) {
+  return DoRead(
+      [file](void* buffer, int64_t size) { return file->Read(buffer, size); },
+      has_error);
+}
+
+std::optional<ChunkReader> ChunkReader::ReadAt(File* file, int64_t offset,
+                                               bool* has_error) {
+  return DoRead(
+      [file, &offset](void* buffer, int64_t size) {
+        const int64_t bytes_read = file->ReadAt(offset, buffer, size);
+        if (bytes_read > 0) {
+          offset += bytes_read;
+        }
+        return bytes_read;
+      },
+      has_error);
+}
+
 bool ReadChunkFile(File* file, ChunkType* file_type,
                    std::vector<ChunkReader>* chunks) {
   ChunkHeader file_header = {};
@@ -97,9 +269,82 @@ bool ReadChunkFile(File* file, ChunkType* file_type,
     if (!chunk.has_value()) {
       break;
     }
+    if (chunk->GetType() == kChunkTypeToc) {
+      continue;
+    }
     chunks->emplace_back(std::move(chunk.value()));
   }
   return true;
 }
 
+bool ReadChunkFileInPlace(File* file, ChunkType* file_type,
+                          std::vector<ChunkReader>* chunks,
+                          std::unique_ptr<uint64_t[]>* buffer) {
+  if (!ReadChunkFile(file, file_type, nullptr)) {
+    return false;
+  }
+  const int64_t start = file->GetPosition();
+  const int64_t size = file->SeekEnd() - start;
+  if (start < 0 || size < 0 || file->SeekTo(start) != start) {
+    LOG(ERROR) << "Failed to read chunk file";
+    return false;
+  }
+
+  // Chunk sizes are always a multiple of 8, so every chunk in the buffer is
+  // 8-byte aligned.
+  buffer->reset(size > 0 ? new uint64_t[(size + 7) / 8] : nullptr);
+  uint8_t* const bytes = reinterpret_cast<uint8_t*>(buffer->get());
+  if (size > 0 && file->Read(static_cast<void*>(bytes), size) != size) {
+    LOG(ERROR) << "Failed to read chunk file";
+    return false;
+  }
+
+  int64_t offset = 0;
+  while (offset < size) {
+    ChunkHeader chunk_header = {};
+    if (size - offset < static_cast<int64_t>(sizeof(chunk_header))) {
+      LOG(ERROR) << "Corrupt chunk in chunk file";
+      return false;
+    }
+    std::memcpy(&chunk_header, bytes + offset, sizeof(chunk_header));
+    offset += sizeof(chunk_header);
+    if (!IsValidChunkHeader(chunk_header)) {
+      LOG(ERROR) << "Corrupt chunk in chunk file";
+      return false;
+    }
+    if (chunk_header.size > size - offset) {
+      LOG(ERROR) << "Chunk " << chunk_header.type.ToString()
+                 << " is not complete";
+      return false;
+    }
+    uint8_t* chunk_data = bytes + offset;
+    offset += chunk_header.size;
+
+    if (chunk_header.type == kChunkTypeToc) {
+      continue;
+    }
+    if (chunk_header.type == kChunkTypeCompressed) {
+      ChunkHeader compressed_header = chunk_header;
+      const uint8_t* in = chunk_data;
+      auto read = [&in](int64_t size) {
+        const uint8_t* result = in;
+        in += size;
+        return result;
+      };
+      uint64_t* data = nullptr;
+      if (!DecompressChunk(compressed_header, read, &chunk_header, &data)) {
+        return false;
+      }
+      chunks->push_back(ChunkReader(chunk_header, data));
+      continue;
+    }
+    chunks->push_back(ChunkReader(
+        chunk_header,
+        chunk_header.size > 0 ? reinterpret_cast<uint64_t*>(chunk_data)
+                              : nullptr,
+        /*owns_data=*/false));
+  }
+  return true;
+}
+
 }  // namespace gb
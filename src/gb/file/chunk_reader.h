@@ -8,6 +8,10 @@
 
 #include <stdint.h>
 
+#include <memory>
+#include <optional>
+#include <vector>
+
 #include "gb/file/chunk_types.h"
 #include "gb/file/file_types.h"
 
@@ -90,6 +94,11 @@ namespace gb {
 //    // Unhandled chunk will just get ignored.
 //  }
 // ```
+//
+// ChunkReaders returned from ReadChunkFileInPlace do not own their chunk data,
+// and are instead views into a single buffer holding the whole chunk file. The
+// API is the same, except that ReleaseChunkData returns a copy of the chunk
+// data (see ReleaseChunkData).
 class ChunkReader final {
  public:
   //----------------------------------------------------------------------------
@@ -108,8 +117,19 @@ class ChunkReader final {
   // will not return a chunk. If an error occurred (end of file is not
   // considered an error), then *has_error will be set to true if it is not
   // null.
+  //
+  // Compressed chunks are decompressed as they are read, and are returned as
+  // the original uncompressed chunk.
   static std::optional<ChunkReader> Read(File* file, bool* has_error = nullptr);
 
+  // Reads a chunk from the file at the specified offset.
+  //
+  // This behaves like Read, except it reads with File::ReadAt, so it does not
+  // use or change the file position and may be called concurrently on a
+  // shared file.
+  static std::optional<ChunkReader> ReadAt(File* file, int64_t offset,
+                                           bool* has_error = nullptr);
+
   //----------------------------------------------------------------------------
   // Chunk header
   //----------------------------------------------------------------------------
@@ -119,6 +139,10 @@ class ChunkReader final {
   int32_t GetSize() const { return header_.size; }
   int32_t GetCount() const { return header_.count; }
 
+  // Returns true if the chunk data is owned by this ChunkReader, and false if
+  // it is a view into a buffer owned by the caller (see ReadChunkFileInPlace).
+  bool OwnsChunkData() const { return owns_data_; }
+
   //----------------------------------------------------------------------------
   // Chunk data
   //----------------------------------------------------------------------------
@@ -143,6 +167,10 @@ class ChunkReader final {
   // larger than sizeof(Type), which is where any data for ChunkPtr<> members is
   // stored.
   //
+  // If the ChunkReader does not own its chunk data (see OwnsChunkData), this
+  // returns a newly allocated copy of the chunk data instead, with any ChunkPtr
+  // members already converted by ConvertToPtr pointing into the copy.
+  //
   // It is up to the caller to ensure the type is correct! If this is cast to
   // the wrong type, it is undefined behavior.
   template <typename Type>
@@ -160,11 +188,28 @@ class ChunkReader final {
   void ConvertToPtr(ChunkPtr<Type>* ptr);
 
  private:
-  ChunkReader(const ChunkHeader& header, uint64_t* data)
-      : header_(header), data_(data) {}
+  friend bool ReadChunkFileInPlace(File*, ChunkType*,
+                                   std::vector<ChunkReader>*,
+                                   std::unique_ptr<uint64_t[]>*);
+
+  ChunkReader(const ChunkHeader& header, uint64_t* data, bool owns_data = true)
+      : header_(header), data_(data), owns_data_(owns_data) {}
+
+  // Reads a chunk with "read", which is called with a buffer and the number of
+  // bytes to read into it, and returns the number of bytes actually read.
+  template <typename ReadFn>
+  static std::optional<ChunkReader> DoRead(ReadFn read, bool* has_error);
+
+  uint64_t* ReleaseData();
+  void AddConvertedPtr(const void* ptr);
 
   ChunkHeader header_;
   uint64_t* data_ = nullptr;
+  bool owns_data_ = true;
+
+  // Byte offsets of ChunkPtr members converted by ConvertToPtr, tracked only
+  // when the ChunkReader does not own its chunk data.
+  std::vector<int32_t> converted_ptrs_;
 };
 
 //==============================================================================
@@ -177,19 +222,40 @@ class ChunkReader final {
 // copied into it. If "chunks" is null, then only the file header will be read,
 // leaving any additional chunk reading to the caller (the file will be
 // positioned immediately after the file header, in this case). If "chunks" is
-// not null, then all chunks in the file will be read into the provided vector.
+// not null, then all chunks in the file will be read into the provided vector
+// (except for any table of contents chunk, see ChunkFileIndex).
 //
 // Returns true if the chunk file header and all chunks (if requested) were
 // successfully read.
 bool ReadChunkFile(File* file, ChunkType* file_type,
                    std::vector<ChunkReader>* chunks);
 
+// Helper to read the entirety of a chunk file with a single allocation.
+//
+// This behaves like ReadChunkFile, except the remainder of the file is read
+// into "buffer" with one read and the returned ChunkReaders are views into it,
+// so no per-chunk allocation is done (except for compressed chunks, which are
+// decompressed into their own allocation). ConvertToPtr patches the ChunkPtr
+// members in place within the buffer.
+//
+// The buffer must outlive all returned ChunkReaders and any chunk data acquired
+// via GetChunkData. It is replaced by this call, so it should not be shared
+// between calls while chunks from a previous call are still in use.
+//
+// Returns true if the chunk file header and all chunks were successfully read.
+bool ReadChunkFileInPlace(File* file, ChunkType* file_type,
+                          std::vector<ChunkReader>* chunks,
+                          std::unique_ptr<uint64_t[]>* buffer);
+
 //==============================================================================
 // Template / inline implementation
 //==============================================================================
 
 inline ChunkReader::ChunkReader(ChunkReader&& other)
-    : header_(other.header_), data_(std::exchange(other.data_, nullptr)) {}
+    : header_(other.header_),
+      data_(std::exchange(other.data_, nullptr)),
+      owns_data_(other.owns_data_),
+      converted_ptrs_(std::move(other.converted_ptrs_)) {}
 
 template <typename Type>
 inline Type* ChunkReader::GetChunkData() {
@@ -202,7 +268,7 @@ template <typename Type>
 Type* ChunkReader::ReleaseChunkData() {
   static_assert(IsValidChunkType<Type>(),
                 "Chunk type must be trivially copyable or void");
-  return reinterpret_cast<Type*>(std::exchange(data_, nullptr));
+  return reinterpret_cast<Type*>(ReleaseData());
 }
 
 template <typename Type>
@@ -211,6 +277,9 @@ inline void ChunkReader::ConvertToPtr(ChunkPtr<Type>* ptr) {
     ptr->ptr = nullptr;
   } else {
     ptr->ptr = reinterpret_cast<Type*>(data_ + (ptr->offset / 8));
+    if (!owns_data_) {
+      AddConvertedPtr(ptr);
+    }
   }
 }
 
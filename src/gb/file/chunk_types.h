@@ -69,6 +69,8 @@ static_assert(std::is_trivially_copyable_v<ChunkType>);
 
 inline constexpr ChunkType kChunkTypeNone = {0, 0, 0, 0};
 inline constexpr ChunkType kChunkTypeFile = {'G', 'B', 'F', 'I'};
+inline constexpr ChunkType kChunkTypeCompressed = {'G', 'B', 'C', 'Z'};
+inline constexpr ChunkType kChunkTypeToc = {'G', 'B', 'T', 'C'};
 
 //==============================================================================
 // ChunkHeader
@@ -103,6 +105,29 @@ inline constexpr ChunkType kChunkTypeFile = {'G', 'B', 'F', 'I'};
 //    Chunk "YYYY"    <-- Multiple chunks of the same type are allowed.
 //    Chunk "ZZZZ"
 //    ... and so on, until end-of-file ...
+//
+// Any chunk other than the file chunk may also be stored compressed (see
+// ChunkCompression), in which case it is wrapped in a "GBCZ" chunk:
+//    Chunk "GBCZ"
+//      version: 1
+//      count: ChunkCompression used.
+//    ChunkHeader     <-- Header of the uncompressed chunk.
+//    Blocks          <-- Each block is an int32_t size followed by the block
+//                        data. Positive sizes are compressed blocks, and
+//                        negative sizes are blocks stored uncompressed. Every
+//                        block except the last is kChunkCompressionBlockSize
+//                        bytes when uncompressed.
+//
+// ChunkReader transparently decompresses these, so readers only ever see the
+// uncompressed chunk.
+//
+// A chunk file may optionally end with a table of contents chunk, which allows
+// chunks to be found without reading the whole file (see ChunkFileIndex):
+//    Chunk "GBTC"
+//      version: 1
+//      count: Number of chunks in the file (not including "GBTC").
+//    ChunkTocEntry   <-- One entry for each chunk in the file, in file order.
+//    ChunkTocFooter  <-- Always the last 16 bytes of the file.
 struct ChunkHeader {
   ChunkType type;   // Unique chunk type. All game bits chunks start with "GB".
   int32_t size;     // Size in bytes of the chunk, not including the header.
@@ -121,6 +146,36 @@ struct ChunkHeader {
 static_assert(sizeof(ChunkHeader) == 16);
 static_assert(std::is_trivially_copyable_v<ChunkHeader>);
 
+// Compression used for a chunk (see ChunkWriter::SetCompression).
+enum class ChunkCompression : int32_t {
+  kNone,  // Chunk is stored as-is.
+  kLz4,   // Chunk is stored in LZ4 compressed blocks.
+};
+
+// Size of uncompressed data in each block of a compressed chunk.
+inline constexpr int32_t kChunkCompressionBlockSize = 64 * 1024;
+
+// Entry in the table of contents chunk for one chunk in the file.
+struct ChunkTocEntry {
+  ChunkType type;   // Type of the chunk.
+  int32_t version;  // Version of the chunk.
+  int32_t size;     // Size of the chunk (uncompressed, if it is compressed).
+  int32_t count;    // Count of entries in the chunk.
+  int64_t offset;   // Offset of the chunk header from the start of the file.
+};
+static_assert(sizeof(ChunkTocEntry) == 24);
+static_assert(std::is_trivially_copyable_v<ChunkTocEntry>);
+
+// Footer at the end of the table of contents chunk, so it can be found from the
+// end of the file.
+struct ChunkTocFooter {
+  int64_t offset;  // Offset of the "GBTC" chunk from the start of the file.
+  ChunkType type;  // Always kChunkTypeToc.
+  int32_t count;   // Number of ChunkTocEntry in the table of contents.
+};
+static_assert(sizeof(ChunkTocFooter) == 16);
+static_assert(std::is_trivially_copyable_v<ChunkTocFooter>);
+
 //==============================================================================
 // ChunkPtr
 //==============================================================================
@@ -5,12 +5,27 @@
 
 #include "gb/file/chunk_writer.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <vector>
+
 #include "absl/log/log.h"
 #include "gb/base/allocator.h"
 #include "gb/file/file.h"
+#include "gb/file/lz4.h"
 
 namespace gb {
 
+namespace {
+
+// Zero padding to align chunk data to 8 bytes.
+inline constexpr uint64_t kPadding = 0;
+
+}  // namespace
+
 ChunkWriter::ChunkWriter(const ChunkType& type, int32_t version, int32_t count,
                          int32_t item_size, void* chunk_data) {
   header_.type = type;
@@ -35,6 +50,7 @@ ChunkWriter::ChunkWriter(const ChunkType& type, int32_t version, int32_t count,
 
 ChunkWriter::ChunkWriter(ChunkWriter&& other)
     : header_(other.header_),
+      compression_(other.compression_),
       chunk_buffer_(std::exchange(other.chunk_buffer_, nullptr)),
       chunk_buffer_size_(std::exchange(other.chunk_buffer_size_, 0)),
       owns_chunk_buffer_(std::exchange(other.owns_chunk_buffer_, false)),
@@ -46,6 +62,7 @@ ChunkWriter& ChunkWriter::operator=(ChunkWriter&& other) {
       GetDefaultAllocator()->Free(chunk_buffer_);
     }
     header_ = other.header_;
+    compression_ = other.compression_;
     chunk_buffer_ = std::exchange(other.chunk_buffer_, nullptr);
     chunk_buffer_size_ = std::exchange(other.chunk_buffer_size_, 0);
     owns_chunk_buffer_ = std::exchange(other.owns_chunk_buffer_, false);
@@ -60,48 +77,237 @@ ChunkWriter::~ChunkWriter() {
   }
 }
 
-bool ChunkWriter::Write(File* file) const {
-  if (file->Write(&header_) != 1) {
-    return false;
+void ChunkWriter::AddWriteBuffers(WriteBuffers* write_buffers) const {
+  if (compression_ != ChunkCompression::kNone && header_.size > 0) {
+    std::vector<uint8_t> compressed = Compress();
+    if (!compressed.empty()) {
+      const ChunkHeader header = {kChunkTypeCompressed,
+                                  static_cast<int32_t>(compressed.size()), 1,
+                                  static_cast<int32_t>(compression_)};
+      auto& storage = write_buffers->storage;
+      storage.emplace_back(sizeof(header));
+      std::memcpy(storage.back().data(), &header, sizeof(header));
+      write_buffers->Add(storage.back().data(), sizeof(header));
+      storage.emplace_back(std::move(compressed));
+      write_buffers->Add(storage.back().data(), storage.back().size());
+      return;
+    }
   }
+
+  write_buffers->Add(&header_, sizeof(header_));
   if (chunk_buffer_size_ > 0) {
-    if (file->Write(chunk_buffer_, chunk_buffer_size_) != chunk_buffer_size_) {
-      return false;
-    }
+    write_buffers->Add(chunk_buffer_, chunk_buffer_size_);
     const int32_t remainder = chunk_buffer_size_ % 8;
     if (remainder != 0) {
-      const uint64_t padding = 0;
-      const int32_t padding_size = 8 - remainder;
-      if (file->Write(static_cast<const void*>(&padding), padding_size) !=
-          padding_size) {
-        return false;
-      }
+      write_buffers->Add(&kPadding, 8 - remainder);
     }
   }
-  if (!extra_buffer_.empty() &&
-      file->Write(extra_buffer_) != extra_buffer_.size()) {
+  if (!extra_buffer_.empty()) {
+    write_buffers->Add(extra_buffer_.data(), extra_buffer_.size() * 8);
+  }
+}
+
+bool ChunkWriter::Write(File* file) const {
+  WriteBuffers write_buffers;
+  AddWriteBuffers(&write_buffers);
+  return file->WriteV(write_buffers.buffers) == write_buffers.size;
+}
+
+ChunkStreamWriter::ChunkStreamWriter(File* file, const ChunkType& type,
+                                     int32_t version, int32_t item_size,
+                                     bool is_list)
+    : file_(file),
+      header_position_(file->GetPosition()),
+      item_size_(item_size),
+      is_list_(is_list) {
+  // The placeholder header has an invalid size, in case it is never finished.
+  header_.type = type;
+  header_.version = version;
+  header_.size = -1;
+  header_.count = 0;
+  if (file_->Write(&header_) != 1) {
+    valid_ = false;
+  }
+  if (!is_list_) {
+    count_ = 1;
+    WriteExtra(nullptr, 0, item_size_);
+  }
+}
+
+int64_t ChunkStreamWriter::WriteExtra(const void* data, int64_t data_size,
+                                      int64_t padded_size) {
+  if (finished_ || is_list_) {
+    LOG(ERROR) << "Cannot add data to chunk " << header_.type.ToString();
+    return 0;
+  }
+  const int64_t remainder = padded_size % 8;
+  if (remainder != 0) {
+    padded_size += 8 - remainder;
+  }
+
+  // Padding is written from a zero buffer, which is also used to zero-fill the
+  // chunk data in the placeholder.
+  static constexpr uint64_t kZeros[8] = {};
+  std::vector<absl::Span<const uint8_t>> buffers;
+  if (data_size > 0) {
+    buffers.emplace_back(static_cast<const uint8_t*>(data), data_size);
+  }
+  for (int64_t zero_size = padded_size - data_size; zero_size > 0;) {
+    const int64_t size = std::min<int64_t>(zero_size, sizeof(kZeros));
+    buffers.emplace_back(reinterpret_cast<const uint8_t*>(kZeros), size);
+    zero_size -= size;
+  }
+  const int64_t offset = size_;
+  if (file_->WriteV(buffers) != padded_size) {
+    valid_ = false;
+    return 0;
+  }
+  size_ += padded_size;
+  return offset;
+}
+
+bool ChunkStreamWriter::WriteEntries(const void* entries, int64_t count,
+                                     int32_t item_size) {
+  if (finished_ || !is_list_ || item_size != item_size_) {
+    LOG(ERROR) << "Cannot add entries to chunk " << header_.type.ToString();
+    return false;
+  }
+  const int64_t size = count * item_size;
+  if (size > 0 && file_->Write(entries, size) != size) {
+    valid_ = false;
     return false;
   }
+  size_ += size;
+  count_ += count;
   return true;
 }
 
+bool ChunkStreamWriter::DoFinish(const void* chunk_data,
+                                 int32_t chunk_data_size) {
+  if (finished_ || (chunk_data != nullptr &&
+                    (is_list_ || chunk_data_size != item_size_))) {
+    LOG(ERROR) << "Cannot finish chunk " << header_.type.ToString();
+    return false;
+  }
+  finished_ = true;
+  const int64_t remainder = size_ % 8;
+  if (remainder != 0) {
+    if (file_->Write(static_cast<const void*>(&kPadding), 8 - remainder) !=
+        8 - remainder) {
+      valid_ = false;
+    }
+    size_ += 8 - remainder;
+  }
+  if (size_ > std::numeric_limits<int32_t>::max() ||
+      count_ > std::numeric_limits<int32_t>::max()) {
+    LOG(ERROR) << "Chunk " << header_.type.ToString() << " is too large";
+    valid_ = false;
+  }
+  if (!valid_) {
+    return false;
+  }
+
+  const int64_t end_position = file_->GetPosition();
+  header_.size = static_cast<int32_t>(size_);
+  header_.count = static_cast<int32_t>(count_);
+  std::vector<absl::Span<const uint8_t>> buffers;
+  buffers.emplace_back(reinterpret_cast<const uint8_t*>(&header_),
+                       sizeof(header_));
+  if (chunk_data != nullptr && chunk_data_size > 0) {
+    buffers.emplace_back(static_cast<const uint8_t*>(chunk_data),
+                         chunk_data_size);
+  }
+  const int64_t patch_size = sizeof(header_) + chunk_data_size;
+  if (file_->SeekTo(header_position_) != header_position_ ||
+      file_->WriteV(buffers) != patch_size ||
+      file_->SeekTo(end_position) != end_position) {
+    valid_ = false;
+  }
+  return valid_;
+}
+
 bool WriteChunkFile(File* file, const ChunkType& file_type,
-                    absl::Span<const ChunkWriter> chunks) {
+                    absl::Span<const ChunkWriter> chunks, bool write_toc) {
   ChunkHeader file_header = {kChunkTypeFile, 0, 1};
   file_header.file = file_type;
-  if (file->Write(&file_header) != 1) {
-    LOG(ERROR) << "Failed to write chunk file header";
-    return false;
+  ChunkWriter::WriteBuffers write_buffers;
+  write_buffers.Add(&file_header, sizeof(file_header));
+  std::vector<ChunkTocEntry> toc;
+  if (write_toc) {
+    toc.reserve(chunks.size());
   }
   for (const ChunkWriter& chunk : chunks) {
-    if (!chunk.Write(file)) {
-      LOG(ERROR) << "Failed to write chunk " << chunk.GetType().ToString();
-      return false;
+    if (write_toc) {
+      toc.push_back({chunk.GetType(), chunk.GetVersion(), chunk.GetSize(),
+                     chunk.GetCount(), write_buffers.size});
     }
+    chunk.AddWriteBuffers(&write_buffers);
+  }
+
+  std::optional<ChunkWriter> toc_chunk;
+  if (write_toc) {
+    const int32_t toc_count = static_cast<int32_t>(toc.size());
+    toc_chunk = ChunkWriter::New<ChunkTocEntry>(kChunkTypeToc, 1, toc_count);
+    if (toc_count > 0) {
+      std::memcpy(toc_chunk->GetChunkData<ChunkTocEntry>(), toc.data(),
+                  toc.size() * sizeof(ChunkTocEntry));
+    }
+    const ChunkTocFooter footer = {write_buffers.size, kChunkTypeToc,
+                                   toc_count};
+    toc_chunk->AddData(&footer);
+    toc_chunk->AddWriteBuffers(&write_buffers);
+  }
+
+  if (file->WriteV(write_buffers.buffers) != write_buffers.size) {
+    LOG(ERROR) << "Failed to write chunk file";
+    return false;
   }
   return true;
 }
 
+std::vector<uint8_t> ChunkWriter::Compress() const {
+  // Compression works on the chunk as it would be written uncompressed.
+  std::vector<uint8_t> chunk(header_.size, 0);
+  std::memcpy(chunk.data(), chunk_buffer_, chunk_buffer_size_);
+  if (!extra_buffer_.empty()) {
+    const int64_t extra_size = extra_buffer_.size() * 8;
+    std::memcpy(chunk.data() + chunk.size() - extra_size, extra_buffer_.data(),
+                extra_size);
+  }
+
+  std::vector<uint8_t> compressed(sizeof(ChunkHeader));
+  std::memcpy(compressed.data(), &header_, sizeof(ChunkHeader));
+  for (int64_t offset = 0; offset < header_.size;
+       offset += kChunkCompressionBlockSize) {
+    const int64_t block_size =
+        std::min<int64_t>(header_.size - offset, kChunkCompressionBlockSize);
+    const int64_t block_offset = compressed.size();
+    compressed.resize(block_offset + sizeof(int32_t) +
+                      Lz4CompressBound(block_size));
+    uint8_t* block = compressed.data() + block_offset + sizeof(int32_t);
+    int32_t stored_size = static_cast<int32_t>(
+        Lz4Compress(chunk.data() + offset, block_size, block,
+                    std::min<int64_t>(Lz4CompressBound(block_size),
+                                      block_size - 1)));
+    if (stored_size <= 0) {
+      std::memcpy(block, chunk.data() + offset, block_size);
+      stored_size = static_cast<int32_t>(-block_size);
+    }
+    std::memcpy(compressed.data() + block_offset, &stored_size,
+                sizeof(int32_t));
+    compressed.resize(block_offset + sizeof(int32_t) + std::abs(stored_size));
+  }
+
+  const int64_t remainder = compressed.size() % 8;
+  if (remainder != 0) {
+    compressed.resize(compressed.size() + 8 - remainder, 0);
+  }
+  if (static_cast<int64_t>(compressed.size()) >= header_.size) {
+    return {};
+  }
+  return compressed;
+}
+
 std::tuple<int64_t, void*> ChunkWriter::ReserveExtra(int64_t total_size) {
   int64_t remainder = (total_size % 8);
   if (remainder != 0) {
@@ -134,11 +134,22 @@ class ChunkWriter final {
   // Chunk header
   //----------------------------------------------------------------------------
 
+  // Note that GetSize() is always the uncompressed size of the chunk.
   const ChunkType& GetType() const { return header_.type; }
   int32_t GetVersion() const { return header_.version; }
   int32_t GetSize() const { return header_.size; }
   int32_t GetCount() const { return header_.count; }
 
+  // Sets the compression used when the chunk is written.
+  //
+  // Compression is only applied if it makes the chunk smaller, otherwise the
+  // chunk is written uncompressed. Compressed chunks are transparently
+  // decompressed by ChunkReader. By default, chunks are not compressed.
+  void SetCompression(ChunkCompression compression) {
+    compression_ = compression;
+  }
+  ChunkCompression GetCompression() const { return compression_; }
+
   //----------------------------------------------------------------------------
   // Chunk data access
   //----------------------------------------------------------------------------
@@ -184,25 +195,198 @@ class ChunkWriter final {
   // Operations
   //----------------------------------------------------------------------------
 
-  // Writes this chunk to a file.
+  // Writes this chunk to a file, with a single vectored write.
   //
   // Returns false if the chunk could not be completely written. It is possible
   // the chunk may be partially written in this case (the file may be modified).
   bool Write(File* file) const;
 
  private:
+  friend bool WriteChunkFile(File*, const ChunkType&,
+                             absl::Span<const ChunkWriter>, bool);
+
+  // Buffers for a vectored write of one or more chunks. Buffers may point into
+  // the ChunkWriters being written, which must outlive the write.
+  struct WriteBuffers {
+    void Add(const void* data, int64_t data_size) {
+      buffers.emplace_back(static_cast<const uint8_t*>(data), data_size);
+      size += data_size;
+    }
+
+    std::vector<absl::Span<const uint8_t>> buffers;
+    std::vector<std::vector<uint8_t>> storage;  // Compressed chunk data.
+    int64_t size = 0;
+  };
+
   ChunkWriter(const ChunkType& type, int32_t version, int32_t count,
               int32_t item_size, void* chunk_data = nullptr);
 
+  // Adds the buffers to write this chunk (including its header).
+  void AddWriteBuffers(WriteBuffers* write_buffers) const;
+
   std::tuple<int64_t, void*> ReserveExtra(int64_t total_size);
 
+  // Returns the contents of a "GBCZ" chunk for this chunk (not including its
+  // header), or an empty vector if compression does not reduce its size.
+  std::vector<uint8_t> Compress() const;
+
   ChunkHeader header_;
+  ChunkCompression compression_ = ChunkCompression::kNone;
   void* chunk_buffer_ = nullptr;
   int32_t chunk_buffer_size_ = 0;
   bool owns_chunk_buffer_ = false;
   std::vector<uint64_t> extra_buffer_;
 };
 
+//==============================================================================
+// ChunkStreamWriter
+//==============================================================================
+
+// This class writes a chunk directly to a file as it is built, so large chunks
+// can be written without holding the whole chunk in memory.
+//
+// A ChunkStreamWriter is constructed via one of the New factory methods, which
+// writes a placeholder chunk header to the file (followed by zero-filled space
+// for the chunk data, for a single chunk). Extra data and list entries are then
+// written to the file as they are added, and Finish back-patches the header
+// (and chunk data) once the final size and count are known.
+//
+// The file must support seeking, and must not be written by anything else until
+// the chunk is finished. The placeholder header has an invalid size, so a chunk
+// that is never finished cannot be read. Unlike ChunkWriter, chunks cannot be
+// compressed, as that requires the whole chunk.
+//
+// Example:
+//
+// ```
+//  // Writes an ExampleChunk (see ChunkWriter) without copying the foos.
+//  bool WriteExampleChunk(File* file, std::string_view name, float value,
+//                         absl::Span<const Foo> foos) {
+//    auto chunk_writer =
+//        ChunkStreamWriter::New<ExampleChunk>(file, kChunkTypeExample, 1);
+//    ExampleChunk chunk = {};
+//    chunk.name = chunk_writer.AddString(name);
+//    chunk.value = value;
+//    chunk.foo_count = static_cast<int32_t>(foos.size());
+//    chunk.foos = chunk_writer.AddData(foos);
+//    return chunk_writer.Finish(chunk);
+//  }
+//
+//  // Writes a list chunk of Bars, which are generated in batches.
+//  bool WriteBarChunk(File* file, BarGenerator* generator) {
+//    auto chunk_writer =
+//        ChunkStreamWriter::NewList<Bar>(file, kChunkTypeBar, 1);
+//    while (!generator->IsDone()) {
+//      chunk_writer.AddEntries<Bar>(generator->NextBatch());
+//    }
+//    return chunk_writer.Finish();
+//  }
+// ```
+class ChunkStreamWriter final {
+ public:
+  //----------------------------------------------------------------------------
+  // Construction / Destruction
+  //----------------------------------------------------------------------------
+
+  ChunkStreamWriter(const ChunkStreamWriter&) = delete;
+  ChunkStreamWriter(ChunkStreamWriter&&) = default;
+  ChunkStreamWriter& operator=(const ChunkStreamWriter&) = delete;
+  ChunkStreamWriter& operator=(ChunkStreamWriter&&) = default;
+  ~ChunkStreamWriter() = default;
+
+  // Starts a chunk with one Type of chunk data at the current file position.
+  //
+  // Type must be trivially copyable. The chunk data is passed to Finish, and
+  // extra data it refers to can be added with AddData and AddString.
+  template <typename Type>
+  static ChunkStreamWriter New(File* file, const ChunkType& type,
+                               int32_t version);
+
+  // Starts a list chunk of Type entries at the current file position.
+  //
+  // Type must be trivially copyable. Entries are added with AddEntries, and the
+  // count is determined by how many entries are added before Finish is called.
+  template <typename Type>
+  static ChunkStreamWriter NewList(File* file, const ChunkType& type,
+                                   int32_t version);
+
+  //----------------------------------------------------------------------------
+  // Chunk header
+  //----------------------------------------------------------------------------
+
+  // Note that GetSize() is the size of the chunk written so far, and does not
+  // include padding until the chunk is finished.
+  const ChunkType& GetType() const { return header_.type; }
+  int32_t GetVersion() const { return header_.version; }
+  int64_t GetSize() const { return size_; }
+  int64_t GetCount() const { return count_; }
+
+  // Returns true if everything written so far was written successfully.
+  bool IsValid() const { return valid_; }
+
+  //----------------------------------------------------------------------------
+  // Chunk data
+  //----------------------------------------------------------------------------
+
+  // Writes data of the specified type to the chunk returning an
+  // offset-initialized ChunkPtr to the data (see ChunkWriter::AddData).
+  //
+  // This is only valid for chunks started with New (not NewList).
+  template <typename Type>
+  ChunkPtr<Type> AddData(const Type* data, int32_t count = 1);
+  template <typename Type>
+  ChunkPtr<Type> AddData(absl::Span<const Type> data);
+
+  // Writes a string to the chunk returning an offset-initialized ChunkPtr to
+  // the string (see ChunkWriter::AddString).
+  //
+  // This is only valid for chunks started with New (not NewList).
+  ChunkPtr<const char> AddString(std::string_view str);
+
+  // Writes entries to a list chunk.
+  //
+  // Type must be the same as what was passed to NewList. Returns false if the
+  // entries could not be written.
+  template <typename Type>
+  bool AddEntries(absl::Span<const Type> entries);
+
+  //----------------------------------------------------------------------------
+  // Operations
+  //----------------------------------------------------------------------------
+
+  // Finishes the chunk, writing the final chunk header and chunk data.
+  //
+  // Type must be the same as what was passed to New. Finish() without chunk
+  // data is used for list chunks, or to leave the chunk data zero-filled. The
+  // file is positioned after the chunk when this returns.
+  //
+  // Returns false if any part of the chunk could not be written, or it is too
+  // large to be a chunk. No further data may be added after this is called.
+  template <typename Type>
+  bool Finish(const Type& chunk_data);
+  bool Finish() { return DoFinish(nullptr, 0); }
+
+ private:
+  ChunkStreamWriter(File* file, const ChunkType& type, int32_t version,
+                    int32_t item_size, bool is_list);
+
+  // Writes extra data padded with zeros to an 8-byte aligned 'padded_size',
+  // returning its offset from the start of the chunk data (or 0 on error).
+  int64_t WriteExtra(const void* data, int64_t data_size, int64_t padded_size);
+  bool WriteEntries(const void* entries, int64_t count, int32_t item_size);
+  bool DoFinish(const void* chunk_data, int32_t chunk_data_size);
+
+  File* file_ = nullptr;
+  ChunkHeader header_;
+  int64_t header_position_ = 0;
+  int32_t item_size_ = 0;
+  bool is_list_ = false;
+  bool valid_ = true;
+  bool finished_ = false;
+  int64_t size_ = 0;
+  int64_t count_ = 0;
+};
+
 //==============================================================================
 // Chunk file helpers
 //==============================================================================
@@ -210,14 +394,22 @@ class ChunkWriter final {
 // Helper to write a complete chunk file, including chunk file header.
 //
 // If "chunks" are empty, this will only write out the chunk header, leaving any
-// additional chunk writing to the caller. The file will be positioned after the
-// last requested chunk is written (or after the file header, if no chunks were
-// specified).
+// additional chunk writing to the caller (for instance, via ChunkStreamWriter).
+// The file will be positioned after the last requested chunk is written (or
+// after the file header, if no chunks were specified).
+//
+// If "write_toc" is true, a table of contents chunk is written after all the
+// chunks, so they can be read selectively with ChunkFileIndex. In this case,
+// the caller must not write any additional chunks.
+//
+// The whole chunk file is written with a single vectored write (see
+// File::WriteV), so writing many chunks does not cost a write per chunk.
 //
 // Returns true if the chunk file header and all chunks were successfully
 // written.
 bool WriteChunkFile(File* file, const ChunkType& file_type,
-                    absl::Span<const ChunkWriter> chunks);
+                    absl::Span<const ChunkWriter> chunks,
+                    bool write_toc = false);
 
 //==============================================================================
 // Template / inline implementation
@@ -283,6 +475,69 @@ inline ChunkPtr<const char> ChunkWriter::AddString(std::string_view str) {
   return chunk_ptr;
 }
 
+template <typename Type>
+inline ChunkStreamWriter ChunkStreamWriter::New(File* file,
+                                                const ChunkType& type,
+                                                int32_t version) {
+  static_assert(std::is_trivially_copyable_v<Type>,
+                "Chunk type must be trivially copyable (void is not allowed)");
+  return ChunkStreamWriter(file, type, version, GetChunkTypeSize<Type>(),
+                           false);
+}
+
+template <typename Type>
+inline ChunkStreamWriter ChunkStreamWriter::NewList(File* file,
+                                                    const ChunkType& type,
+                                                    int32_t version) {
+  static_assert(std::is_trivially_copyable_v<Type>,
+                "Chunk type must be trivially copyable (void is not allowed)");
+  return ChunkStreamWriter(file, type, version, GetChunkTypeSize<Type>(),
+                           true);
+}
+
+template <typename Type>
+ChunkPtr<Type> ChunkStreamWriter::AddData(const Type* data, int32_t count) {
+  static_assert(IsValidChunkType<Type>(),
+                "Chunk type must be trivially copyable or void");
+  ChunkPtr<Type> chunk_ptr;
+  chunk_ptr.offset = 0;
+  if (data == nullptr || count == 0) {
+    return chunk_ptr;
+  }
+  const int64_t size = int64_t{GetChunkTypeSize<Type>()} * count;
+  chunk_ptr.offset = WriteExtra(data, size, size);
+  return chunk_ptr;
+}
+
+template <typename Type>
+inline ChunkPtr<Type> ChunkStreamWriter::AddData(absl::Span<const Type> data) {
+  static_assert(std::is_trivially_copyable_v<Type>,
+                "Chunk type must be trivially copyable (void is not allowed)");
+  return AddData<Type>(data.data(), static_cast<int32_t>(data.size()));
+}
+
+inline ChunkPtr<const char> ChunkStreamWriter::AddString(
+    std::string_view str) {
+  ChunkPtr<const char> chunk_ptr;
+  chunk_ptr.offset = WriteExtra(str.data(), str.size(), str.size() + 1);
+  return chunk_ptr;
+}
+
+template <typename Type>
+inline bool ChunkStreamWriter::AddEntries(absl::Span<const Type> entries) {
+  static_assert(std::is_trivially_copyable_v<Type>,
+                "Chunk type must be trivially copyable (void is not allowed)");
+  return WriteEntries(entries.data(), static_cast<int64_t>(entries.size()),
+                      GetChunkTypeSize<Type>());
+}
+
+template <typename Type>
+inline bool ChunkStreamWriter::Finish(const Type& chunk_data) {
+  static_assert(std::is_trivially_copyable_v<Type>,
+                "Chunk type must be trivially copyable (void is not allowed)");
+  return DoFinish(&chunk_data, GetChunkTypeSize<Type>());
+}
+
 }  // namespace gb
 
 #endif  // GB_FILE_CHUNK_WRITER_H_
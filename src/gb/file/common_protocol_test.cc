@@ -5,7 +5,11 @@
 
 #include "gb/file/common_protocol_test.h"
 
+#include <thread>
+#include <utility>
+
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "gb/file/file_system.h"
 #include "gb/file/raw_file.h"
 #include "gb/test/test_util.h"
@@ -648,6 +652,117 @@ TEST_P(CommonProtocolTest, ReadFilePastEnd) {
   EXPECT_EQ(file->GetPosition(), kFileSize);
 }
 
+TEST_P(CommonProtocolTest, ReadFileAsync) {
+  CommonProtocolTestInit init;
+  static constexpr int64_t kFileSize = 100000;
+  init.folders = {"/folder"};
+  init.files = {{"/file", GenerateTestString(kFileSize)}};
+  const std::string& file_contents = std::get<1>(init.files[0]);
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(NewProtocol(init), "test"));
+  if (!file_system.GetFlags("test").IsSet(FileProtocolFlag::kFileRead)) {
+    return;
+  }
+
+  struct AsyncRead {
+    AsyncRead(std::string path, int64_t offset, int64_t size)
+        : path(std::move(path)),
+          offset(offset),
+          size(size),
+          buffer(static_cast<size_t>(size), '\0') {}
+
+    std::string path;
+    int64_t offset;
+    int64_t size;
+    std::string buffer;
+    int64_t result = -2;
+  };
+  std::vector<AsyncRead> reads = {
+      {"test:/file", 0, 100},
+      {"test:/file", kFileSize / 4, kFileSize / 2},
+      {"test:/file", kFileSize - 50, 100},
+      {"test:/file", kFileSize + 10, 10},
+      {"test:/file", 0, 0},
+      {"test:/missing", 0, 10},
+      {"test:/folder", 0, 10},
+  };
+  absl::Mutex mutex;
+  int pending = static_cast<int>(reads.size());
+  for (AsyncRead& read : reads) {
+    EXPECT_TRUE(file_system.ReadFileAsync(
+        read.path, read.offset, read.buffer.data(), read.size,
+        [&mutex, &pending, &read](int64_t bytes_read) {
+          absl::MutexLock lock(&mutex);
+          read.result = bytes_read;
+          --pending;
+        }));
+  }
+  {
+    absl::MutexLock lock(&mutex);
+    mutex.Await(absl::Condition(
+        +[](int* pending) { return *pending == 0; }, &pending));
+  }
+
+  EXPECT_EQ(reads[0].result, 100);
+  EXPECT_EQ(reads[0].buffer, file_contents.substr(0, 100));
+  EXPECT_EQ(reads[1].result, kFileSize / 2);
+  EXPECT_EQ(reads[1].buffer,
+            file_contents.substr(kFileSize / 4, kFileSize / 2));
+  EXPECT_EQ(reads[2].result, 50);
+  EXPECT_EQ(reads[2].buffer.substr(0, 50),
+            file_contents.substr(kFileSize - 50));
+  EXPECT_EQ(reads[3].result, 0);
+  EXPECT_EQ(reads[4].result, 0);
+  EXPECT_EQ(reads[5].result, -1);
+  EXPECT_EQ(reads[6].result, -1);
+}
+
+TEST_P(CommonProtocolTest, ReadFileAtFromThreads) {
+  CommonProtocolTestInit init;
+  static constexpr int64_t kFileSize = 100000;
+  init.files = {{"/file", GenerateTestString(kFileSize)}};
+  const std::string& file_contents = std::get<1>(init.files[0]);
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(NewProtocol(init), "test"));
+  if (!file_system.GetFlags("test").IsSet(FileProtocolFlag::kFileRead)) {
+    return;
+  }
+  std::unique_ptr<File> file =
+      file_system.OpenFile("test:/file", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->SeekTo(10), 10);
+
+  static constexpr int kThreadCount = 4;
+  static constexpr int64_t kReadSize = 1000;
+  std::vector<std::string> results(kThreadCount);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&file, &result = results[i], i] {
+      std::string buffer(kReadSize, '\0');
+      for (int64_t offset = i * kReadSize; offset < kFileSize;
+           offset += kThreadCount * kReadSize) {
+        const int64_t size = file->ReadAt(offset, buffer.data(), kReadSize);
+        result.append(buffer.data(), static_cast<size_t>(size));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kThreadCount; ++i) {
+    std::string expected;
+    for (int64_t offset = i * kReadSize; offset < kFileSize;
+         offset += kThreadCount * kReadSize) {
+      expected += file_contents.substr(offset, kReadSize);
+    }
+    EXPECT_EQ(results[i], expected) << "Thread " << i;
+  }
+  EXPECT_EQ(file->GetPosition(), 10);
+  EXPECT_EQ(file->ReadString(10), file_contents.substr(10, 10));
+  EXPECT_EQ(file->ReadAt(kFileSize - 5, results[0].data(), 10), 5);
+}
+
 TEST_P(CommonProtocolTest, WriteFile) {
   CommonProtocolTestInit init;
   init.files = {{"/file", "1234567890"}};
@@ -695,5 +810,40 @@ TEST_P(CommonProtocolTest, WriteFile) {
               CheckContents(file_system, "test:/file", expected_contents));
 }
 
+TEST_P(CommonProtocolTest, WriteFileV) {
+  CommonProtocolTestInit init;
+  init.files = {{"/file", "1234567890"}};
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(NewProtocol(init), "test"));
+  if (!file_system.GetFlags("test").IsSet(FileProtocolFlag::kFileWrite)) {
+    return;
+  }
+  const bool check_contents =
+      file_system.GetFlags("test").IsSet(FileProtocolFlag::kFileRead);
+  static constexpr int64_t kFileSize = 200000;
+  const std::string contents = GenerateTestString(kFileSize);
+
+  // Mix of small and large buffers, including empty ones.
+  std::vector<absl::Span<const uint8_t>> buffers;
+  const auto* data = reinterpret_cast<const uint8_t*>(contents.data());
+  for (int64_t offset = 0, size = 0; offset < kFileSize;
+       offset += size, size = size * 3 + 1) {
+    size = std::min(size, kFileSize - offset);
+    buffers.emplace_back(data + offset, size);
+  }
+
+  std::unique_ptr<File> file =
+      file_system.OpenFile("test:/file", kWriteFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->SeekTo(5), 5);
+  EXPECT_EQ(file->WriteV(buffers), kFileSize);
+  EXPECT_EQ(file->GetPosition(), 5 + kFileSize);
+  EXPECT_EQ(file->WriteV({}), 0);
+  file.reset();
+  EXPECT_TRUE(!check_contents ||
+              CheckContents(file_system, "test:/file",
+                            absl::StrCat("12345", contents)));
+}
+
 }  // namespace
 }  // namespace gb
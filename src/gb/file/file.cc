@@ -5,17 +5,65 @@
 
 #include "gb/file/file.h"
 
-#include "absl/strings/str_replace.h"
-#include "absl/strings/str_split.h"
+#include "gb/file/line_reader.h"
 #include "gb/file/raw_file.h"
 
 namespace gb {
 
+namespace {
+
+// Buffers smaller than this are gathered together when emulating vectored
+// writes.
+inline constexpr int64_t kGatherSize = 64 * 1024;
+
+// Emulates a vectored write for raw files that do not support one, by
+// gathering small buffers into larger writes. Returns the number of bytes
+// written.
+int64_t WriteGathered(RawFile* file,
+                      absl::Span<const absl::Span<const uint8_t>> buffers) {
+  std::vector<uint8_t> pending;
+  int64_t total = 0;
+  auto write = [file, &total](const uint8_t* data, int64_t size) {
+    const int64_t written = file->Write(data, size);
+    total += written;
+    return written == size;
+  };
+  for (absl::Span<const uint8_t> buffer : buffers) {
+    const int64_t size = static_cast<int64_t>(buffer.size());
+    if (static_cast<int64_t>(pending.size()) + size > kGatherSize) {
+      if (!pending.empty() && !write(pending.data(), pending.size())) {
+        return total;
+      }
+      pending.clear();
+      if (size >= kGatherSize) {
+        if (!write(buffer.data(), size)) {
+          return total;
+        }
+        continue;
+      }
+    }
+    pending.insert(pending.end(), buffer.begin(), buffer.end());
+  }
+  if (!pending.empty()) {
+    write(pending.data(), pending.size());
+  }
+  return total;
+}
+
+}  // namespace
+
 File::File(std::unique_ptr<RawFile> file, FileFlags flags)
     : file_(std::move(file)), flags_(flags) {}
 
 File::~File() {}
 
+absl::Span<const uint8_t> File::GetMappedView() const {
+  if (!flags_.IsSet(FileFlag::kMapped)) {
+    return {};
+  }
+  return file_->GetMappedView();
+}
+
 int64_t File::SeekEnd() {
   position_ = file_->SeekEnd();
   return position_;
@@ -45,45 +93,33 @@ void File::ReadRemainingString(std::string* buffer) {
 }
 
 bool File::ReadLine(std::string* line) {
-  ReadLineState state;
-  if (!DoReadLine(&state, line)) {
+  LineReader reader(this, kLineBufferSize);
+  std::string_view line_view;
+  if (!reader.ReadLine(&line_view)) {
     line->clear();
     return false;
   }
-  if (state.pos < state.buffer.size()) {
-    SeekBy(-static_cast<int64_t>(state.buffer.size() - state.pos));
-  }
+  line->assign(line_view);
   return true;
 }
 
 int64_t File::ReadLines(int64_t count, std::vector<std::string>* lines) {
   lines->clear();
   lines->reserve(count);
-  ReadLineState state;
-  for (; count > 0; --count) {
-    std::string line;
-    if (!DoReadLine(&state, &line)) {
-      return static_cast<int64_t>(lines->size());
-    }
-    lines->emplace_back(std::move(line));
-  }
-  if (state.pos < state.buffer.size()) {
-    SeekBy(-static_cast<int64_t>(state.buffer.size() - state.pos));
+  LineReader reader(this, kLineBufferSize);
+  std::string_view line;
+  for (; count > 0 && reader.ReadLine(&line); --count) {
+    lines->emplace_back(line);
   }
   return static_cast<int64_t>(lines->size());
 }
 
 int64_t File::ReadRemainingLines(std::vector<std::string>* lines) {
-  std::string text;
-  ReadRemainingString(&text);
-  if (text.empty()) {
-    lines->clear();
-    return 0;
-  }
-  text = absl::StrReplaceAll(text, {{"\r\n", "\n"}, {"\r", "\n"}});
-  *lines = absl::StrSplit(text, "\n");
-  if (text.back() == '\n') {
-    lines->pop_back();
+  lines->clear();
+  LineReader reader(this);
+  std::string_view line;
+  while (reader.ReadLine(&line)) {
+    lines->emplace_back(line);
   }
   return static_cast<int64_t>(lines->size());
 }
@@ -125,6 +161,18 @@ int64_t File::DoWrite(const void* buffer, int64_t size) {
   return actual_size;
 }
 
+int64_t File::WriteV(absl::Span<const absl::Span<const uint8_t>> buffers) {
+  if (position_ < 0 || !flags_.IsSet(FileFlag::kWrite)) {
+    return 0;
+  }
+  int64_t actual_size = file_->WriteV(buffers);
+  if (actual_size < 0) {
+    actual_size = WriteGathered(file_.get(), buffers);
+  }
+  position_ += actual_size;
+  return actual_size;
+}
+
 int64_t File::DoRead(void* buffer, int64_t size) {
   if (position_ < 0 || !flags_.IsSet(FileFlag::kRead)) {
     return 0;
@@ -134,49 +182,25 @@ int64_t File::DoRead(void* buffer, int64_t size) {
   return actual_size;
 }
 
-bool File::DoReadLine(ReadLineState* state, std::string* line) {
-  line->clear();
-  bool skip_linefeed = false;
-  while (true) {
-    if (state->pos >= state->buffer.size()) {
-      state->buffer.resize(kLineBufferSize);
-      int64_t read_bytes = DoRead(&state->buffer[0], kLineBufferSize);
-      if (read_bytes > 0 && skip_linefeed && state->buffer[0] == '\n') {
-        state->pos = 1;
-      } else {
-        state->pos = 0;
-      }
-      state->buffer.resize(static_cast<std::string::size_type>(read_bytes));
-      if (skip_linefeed) {
-        return true;
-      }
-      if (state->pos == state->buffer.size()) {
-        return !line->empty();
-      }
-      skip_linefeed = false;
-    }
-
-    auto pos = state->buffer.find_first_of("\r\n", state->pos, 2);
-    if (pos == std::string::npos) {
-      line->append(state->buffer, state->pos);
-      state->pos = state->buffer.size();
-      continue;
-    }
+int64_t File::ReadAt(int64_t offset, void* buffer, int64_t count) {
+  if (position_ < 0 || !flags_.IsSet(FileFlag::kRead) || offset < 0 ||
+      count <= 0) {
+    return 0;
+  }
+  const int64_t bytes_read = file_->ReadAt(offset, buffer, count);
+  if (bytes_read >= 0) {
+    return bytes_read;
+  }
 
-    line->append(state->buffer.c_str(), state->pos, pos - state->pos);
-    if (state->buffer[pos] == '\r') {
-      if (state->buffer.size() == pos + 1) {
-        skip_linefeed = true;
-      } else if (state->buffer[pos + 1] == '\n') {
-        ++pos;
-      }
-    }
-    state->pos = pos + 1;
-    if (!skip_linefeed) {
-      break;
-    }
+  // The raw file does not support positional reads, so seek to the requested
+  // offset and back again.
+  absl::MutexLock lock(&read_at_mutex_);
+  int64_t actual_size = 0;
+  if (file_->SeekTo(offset) == offset) {
+    actual_size = file_->Read(buffer, count);
   }
-  return true;
+  file_->SeekTo(position_);
+  return actual_size;
 }
 
 }  // namespace gb
@@ -12,13 +12,16 @@
 #include <type_traits>
 #include <vector>
 
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "gb/file/file_types.h"
 
 namespace gb {
 
 // This class represents an open file returned from a FileSystem.
 //
-// This class is thread-compatible.
+// This class is thread-compatible, except that ReadAt may be called
+// concurrently from multiple threads (see ReadAt for details).
 class File final {
  public:
   File(const File&) = delete;
@@ -42,6 +45,14 @@ class File final {
   // system.
   bool IsValid() const { return position_ >= 0; }
 
+  // Returns a read-only view of the entire file contents.
+  //
+  // This is only available if the file was opened with FileFlag::kMapped and
+  // the underlying protocol supports mapping the file. Otherwise, this returns
+  // an empty span (as it also does for an empty mapped file). The view remains
+  // valid until the file is closed, and is unaffected by the file position.
+  absl::Span<const uint8_t> GetMappedView() const;
+
   //---------------------------------------------------------------------------
   // Position in the file.
 
@@ -74,6 +85,28 @@ class File final {
   // Returns the number of bytes actually written.
   int64_t Write(const void* buffer, int64_t count);
 
+  // Writes a list of untyped buffers into the file in order, as if they were a
+  // single contiguous buffer.
+  //
+  // Protocols that support vectored writes write all buffers with a single
+  // operation. Otherwise, small buffers are gathered into larger writes.
+  //
+  // Returns the total number of bytes actually written.
+  int64_t WriteV(absl::Span<const absl::Span<const uint8_t>> buffers);
+
+  // Reads the requested number of bytes starting at 'offset' into a
+  // pre-allocated untyped buffer, without using or changing the current
+  // position.
+  //
+  // This may be called concurrently from multiple threads, as long as no other
+  // functions are called on the file at the same time, so a single open file
+  // can be shared by parallel readers. Protocols that support positional reads
+  // directly do not serialize these calls.
+  //
+  // Returns the number of bytes actually read. If the number of bytes read is
+  // less than 'count', it usually means end-of-file was reached.
+  int64_t ReadAt(int64_t offset, void* buffer, int64_t count);
+
   //---------------------------------------------------------------------------
   // Typed buffer read/write
 
@@ -165,6 +198,9 @@ class File final {
   // end-of-file occurs immediately after a line ending, it is not considered an
   // additional blank line.
   //
+  // These functions are implemented with LineReader, which may be used directly
+  // to read lines as views without allocating a string for each one.
+  //
   // These functions do not validate that the file is valid ASCII or UTF-8, and
   // will read all byte values, only taking into account line endings. This is
   // meaningless for binary files, and will produce invalid results on other
@@ -218,30 +254,27 @@ class File final {
   template <typename Container>
   int64_t WriteLines(const Container& lines, std::string_view line_end = "\n");
 
-  // Number of bytes that are buffered when reading lines from the file. This is
-  // an internal constant made public for unit tests only. It is not meaningful
-  // for general use.
+  // Number of bytes that are buffered when reading individual lines from the
+  // file (ReadRemainingLines reads in larger blocks). This is an internal
+  // constant made public for unit tests only. It is not meaningful for general
+  // use.
   inline static constexpr int64_t kLineBufferSize = 256;
 
  private:
   friend class FileSystem;
 
-  struct ReadLineState {
-    ReadLineState() = default;
-    std::string buffer;
-    std::string::size_type pos = 0;
-  };
-
   File(std::unique_ptr<RawFile> file, FileFlags flags);
 
   int64_t CalculateRemaining();
   int64_t DoWrite(const void* buffer, int64_t size);
   int64_t DoRead(void* buffer, int64_t size);
-  bool DoReadLine(ReadLineState* state, std::string* line);
 
   const std::unique_ptr<RawFile> file_;
   const FileFlags flags_;
   int64_t position_ = 0;
+
+  // Serializes ReadAt calls that are emulated with SeekTo and Read.
+  absl::Mutex read_at_mutex_;
 };
 
 inline int64_t File::Read(void* buffer, int64_t size) {
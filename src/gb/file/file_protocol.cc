@@ -5,6 +5,9 @@
 
 #include "gb/file/file_protocol.h"
 
+#include <atomic>
+#include <utility>
+
 #include "absl/log/log.h"
 #include "gb/container/queue.h"
 #include "gb/file/path.h"
@@ -12,6 +15,13 @@
 
 namespace gb {
 
+namespace {
+
+// Next watch identifier, shared by all protocols so identifiers are unique.
+std::atomic<WatchId> next_watch_id = kNoWatchId + 1;
+
+}  // namespace
+
 std::vector<std::string> FileProtocol::GetDefaultNames() const { return {}; }
 
 void FileProtocol::Lock(LockType type) {}
@@ -92,6 +102,29 @@ std::unique_ptr<RawFile> FileProtocol::OpenFile(std::string_view protocol_name,
   return result;
 }
 
+void FileProtocol::ReadFileAsync(std::string_view protocol_name,
+                                 std::string_view path, int64_t offset,
+                                 void* buffer, int64_t size,
+                                 ReadFileCallback callback) {
+  DoReadFileAsync(protocol_name, path, offset, buffer, size,
+                  std::move(callback));
+}
+
+WatchId FileProtocol::Watch(std::string_view protocol_name,
+                            std::string_view path, WatchCallback callback) {
+  const WatchId id = next_watch_id++;
+  if (!DoWatch(protocol_name, path, id, std::move(callback))) {
+    return kNoWatchId;
+  }
+  return id;
+}
+
+void FileProtocol::Unwatch(WatchId id) {
+  if (id != kNoWatchId) {
+    DoUnwatch(id);
+  }
+}
+
 std::string FileProtocol::GetCurrentPath(std::string_view protocol_name) {
   Lock(LockType::kQuery);
   auto result = DoGetCurrentPath(protocol_name);
@@ -309,6 +342,30 @@ std::unique_ptr<RawFile> FileProtocol::DoOpenFile(
   return BasicOpenFile(protocol_name, path, flags);
 }
 
+void FileProtocol::DoReadFileAsync(std::string_view protocol_name,
+                                   std::string_view path, int64_t offset,
+                                   void* buffer, int64_t size,
+                                   ReadFileCallback callback) {
+  auto file = OpenFile(protocol_name, path, kReadFileFlags);
+  if (file == nullptr || file->SeekTo(offset) < 0) {
+    file.reset();
+    callback(-1);
+    return;
+  }
+  const int64_t bytes_read = (size > 0 ? file->Read(buffer, size) : 0);
+  file.reset();
+  callback(bytes_read);
+}
+
+bool FileProtocol::DoWatch(std::string_view protocol_name,
+                           std::string_view path, WatchId id,
+                           WatchCallback callback) {
+  LOG(ERROR) << "FileProtocol::DoWatch not implemented.";
+  return false;
+}
+
+void FileProtocol::DoUnwatch(WatchId id) {}
+
 std::string FileProtocol::DoGetCurrentPath(std::string_view protocol_name) {
   LOG(ERROR) << "FileProtocol::DoGetCurrentPath not implemented.";
   return {};
@@ -125,6 +125,34 @@ class FileProtocol {
   std::unique_ptr<RawFile> OpenFile(std::string_view protocol_name,
                                     std::string_view path, FileFlags flags);
 
+  // Reads part of a file asynchronously into the provided buffer.
+  //
+  // Derived classes may optionally override DoReadFileAsync to implement this
+  // if FileProtocolFlag::kFileRead is supported. OpenFile is called if
+  // DoReadFileAsync is not implemented, in which case the read completes before
+  // this returns.
+  //
+  // Unlike all other operations, this does not call Lock/Unlock, as the read
+  // may complete on another thread.
+  void ReadFileAsync(std::string_view protocol_name, std::string_view path,
+                     int64_t offset, void* buffer, int64_t size,
+                     ReadFileCallback callback);
+
+  // Watches a file or folder for changes (see FileSystem::Watch).
+  //
+  // Derived classes must override DoWatch and DoUnwatch to implement this if
+  // FileProtocolFlag::kWatch is supported. The returned identifier is unique
+  // across all protocols, or kNoWatchId if the watch could not be started.
+  //
+  // Like ReadFileAsync, this does not call Lock/Unlock, as changes may be
+  // reported on another thread.
+  WatchId Watch(std::string_view protocol_name, std::string_view path,
+                WatchCallback callback);
+
+  // Stops watching for changes. This does nothing if the watch was not started
+  // by this protocol.
+  void Unwatch(WatchId id);
+
   // Returns the current path for the protocol.
   //
   // Derived classes must override DoGetCurrentPath to implement this if
@@ -290,6 +318,47 @@ class FileProtocol {
                                               std::string_view path,
                                               FileFlags flags);
 
+  // Reads part of a file asynchronously into the provided buffer.
+  //
+  // A protocol may implement this if reads can be overlapped with other work
+  // (for instance, by completing them on other threads). It is not necessary
+  // for a protocol to implement this however, as a default synchronous
+  // implementation exists.
+  //
+  // The callback must be called exactly once with the number of bytes read
+  // (which may be less than 'size' at the end of the file), or -1 if the file
+  // could not be opened. This is not called within Lock/Unlock, so the protocol
+  // must call them itself as needed, and the callback must never be called
+  // while the protocol is locked.
+  //
+  // ReadFileAsync is only called if FileProtocolFlag::kFileRead is supported,
+  // and 'offset' and 'size' are not negative. The protocol is responsible for
+  // all further validation.
+  virtual void DoReadFileAsync(std::string_view protocol_name,
+                               std::string_view path, int64_t offset,
+                               void* buffer, int64_t size,
+                               ReadFileCallback callback);
+
+  // Starts watching a file or folder for changes.
+  //
+  // A protocol must override this and DoUnwatch if FileProtocolFlag::kWatch is
+  // supported. The callback must be called with the full path (prefixed with
+  // 'protocol_name') for changes to the path itself, and to any file or folder
+  // directly within it if it is a folder. The callback must never be called
+  // while the protocol is locked, or after DoUnwatch returns for the watch.
+  //
+  // DoWatch is only called if FileProtocolFlag::kWatch is supported. On error
+  // (for instance, if the path does not exist) this should return false.
+  virtual bool DoWatch(std::string_view protocol_name, std::string_view path,
+                       WatchId id, WatchCallback callback);
+
+  // Stops a watch started by DoWatch.
+  //
+  // A protocol must override this if FileProtocolFlag::kWatch is supported. It
+  // may be called with identifiers for watches that belong to other protocols,
+  // which must be ignored.
+  virtual void DoUnwatch(WatchId id);
+
   // Returns the current path associated with the protocol.
   //
   // A protocol must override this if FileProtocolFlag::kCurrentPath is
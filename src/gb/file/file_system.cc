@@ -119,7 +119,9 @@ std::string FileSystem::GetCurrentFolder(std::string_view protocol_name) {
 }
 
 bool FileSystem::SetCurrentFolder(std::string_view path) {
-  auto [normalized_path, protocol_name, protocol] = GetNormalizedPath(path);
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
   if (normalized_path.empty()) {
     return false;
   }
@@ -129,7 +131,9 @@ bool FileSystem::SetCurrentFolder(std::string_view path) {
 std::vector<std::string> FileSystem::List(std::string_view path,
                                           std::string_view pattern,
                                           FolderMode mode) {
-  auto [normalized_path, protocol_name, protocol] = GetNormalizedPath(path);
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
   if (normalized_path.empty()) {
     return {};
   }
@@ -144,7 +148,9 @@ std::vector<std::string> FileSystem::List(std::string_view path,
 std::vector<std::string> FileSystem::ListFolders(std::string_view path,
                                                  std::string_view pattern,
                                                  FolderMode mode) {
-  auto [normalized_path, protocol_name, protocol] = GetNormalizedPath(path);
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
   if (normalized_path.empty()) {
     return {};
   }
@@ -158,7 +164,9 @@ std::vector<std::string> FileSystem::ListFolders(std::string_view path,
 std::vector<std::string> FileSystem::ListFiles(std::string_view path,
                                                std::string_view pattern,
                                                FolderMode mode) {
-  auto [normalized_path, protocol_name, protocol] = GetNormalizedPath(path);
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
   if (normalized_path.empty()) {
     return {};
   }
@@ -170,7 +178,9 @@ std::vector<std::string> FileSystem::ListFiles(std::string_view path,
 }
 
 bool FileSystem::CreateFolder(std::string_view path, FolderMode mode) {
-  auto [normalized_path, protocol_name, protocol] = GetNormalizedPath(path);
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
   if (normalized_path.empty()) {
     return false;
   }
@@ -182,7 +192,9 @@ bool FileSystem::CreateFolder(std::string_view path, FolderMode mode) {
 }
 
 bool FileSystem::DeleteFolder(std::string_view path, FolderMode mode) {
-  auto [normalized_path, protocol_name, protocol] = GetNormalizedPath(path);
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
   if (normalized_path.empty()) {
     return false;
   }
@@ -194,7 +206,9 @@ bool FileSystem::DeleteFolder(std::string_view path, FolderMode mode) {
 }
 
 bool FileSystem::DeleteFile(std::string_view path) {
-  auto [normalized_path, protocol_name, protocol] = GetNormalizedPath(path);
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
   if (normalized_path.empty()) {
     return false;
   }
@@ -207,10 +221,11 @@ bool FileSystem::DeleteFile(std::string_view path) {
 
 bool FileSystem::CopyFolder(std::string_view from_path,
                             std::string_view to_path) {
+  std::string from_buffer, to_buffer;
   auto [normalized_from_path, from_protocol_name, from_protocol] =
-      GetNormalizedPath(from_path);
+      GetNormalizedPath(from_path, &from_buffer);
   auto [normalized_to_path, to_protocol_name, to_protocol] =
-      GetNormalizedPath(to_path);
+      GetNormalizedPath(to_path, &to_buffer);
   if (normalized_from_path.empty() || normalized_to_path.empty()) {
     return false;
   }
@@ -245,10 +260,11 @@ bool FileSystem::CopyFolder(std::string_view from_path,
 
 bool FileSystem::CopyFile(std::string_view from_path,
                           std::string_view to_path) {
+  std::string from_buffer, to_buffer;
   auto [normalized_from_path, from_protocol_name, from_protocol] =
-      GetNormalizedPath(from_path);
+      GetNormalizedPath(from_path, &from_buffer);
   auto [normalized_to_path, to_protocol_name, to_protocol] =
-      GetNormalizedPath(to_path);
+      GetNormalizedPath(to_path, &to_buffer);
   if (normalized_from_path.empty() || normalized_to_path.empty()) {
     return false;
   }
@@ -274,11 +290,28 @@ bool FileSystem::CopyFile(std::string_view from_path,
 }
 
 PathInfo FileSystem::GetPathInfo(std::string_view path) {
-  auto [normalized_path, protocol_name, protocol] = GetNormalizedPath(path);
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
   if (normalized_path.empty()) {
     return {};
   }
-  path = normalized_path;
+  return DoGetPathInfo(protocol_name, protocol, normalized_path);
+}
+
+PathInfo FileSystem::GetPathInfo(const Path& path) {
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
+  if (normalized_path.empty()) {
+    return {};
+  }
+  return DoGetPathInfo(protocol_name, protocol, normalized_path);
+}
+
+PathInfo FileSystem::DoGetPathInfo(std::string_view protocol_name,
+                                   FileProtocol* protocol,
+                                   std::string_view path) {
   if (!protocol->GetFlags().IsSet(FileProtocolFlag::kInfo)) {
     return {};
   }
@@ -287,11 +320,30 @@ PathInfo FileSystem::GetPathInfo(std::string_view path) {
 
 std::unique_ptr<File> FileSystem::OpenFile(std::string_view path,
                                            FileFlags flags) {
-  auto [normalized_path, protocol_name, protocol] = GetNormalizedPath(path);
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
   if (normalized_path.empty()) {
     return nullptr;
   }
-  path = normalized_path;
+  return DoOpenFile(protocol_name, protocol, normalized_path, flags);
+}
+
+std::unique_ptr<File> FileSystem::OpenFile(const Path& path,
+                                           FileFlags flags) {
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
+  if (normalized_path.empty()) {
+    return nullptr;
+  }
+  return DoOpenFile(protocol_name, protocol, normalized_path, flags);
+}
+
+std::unique_ptr<File> FileSystem::DoOpenFile(std::string_view protocol_name,
+                                             FileProtocol* protocol,
+                                             std::string_view path,
+                                             FileFlags flags) {
   if (!flags.Intersects({FileFlag::kRead, FileFlag::kWrite})) {
     return nullptr;
   }
@@ -299,6 +351,10 @@ std::unique_ptr<File> FileSystem::OpenFile(std::string_view path,
       !flags.IsSet(FileFlag::kWrite)) {
     return nullptr;
   }
+  if (flags.IsSet(FileFlag::kMapped) &&
+      (!flags.IsSet(FileFlag::kRead) || flags.IsSet(FileFlag::kWrite))) {
+    return nullptr;
+  }
   auto protocol_flags = protocol->GetFlags();
   if (flags.IsSet(FileFlag::kRead) &&
       !protocol_flags.IsSet(FileProtocolFlag::kFileRead)) {
@@ -319,18 +375,81 @@ std::unique_ptr<File> FileSystem::OpenFile(std::string_view path,
   return absl::WrapUnique(new File(std::move(raw_file), flags));
 }
 
-std::tuple<std::string, std::string, FileProtocol*>
-FileSystem::GetNormalizedPath(std::string_view path) {
-  std::string normalized_path = NormalizePath(path);
-  FileProtocol* protocol = nullptr;
-  std::string protocol_name;
+bool FileSystem::ReadFileAsync(std::string_view path, int64_t offset,
+                               void* buffer, int64_t size,
+                               ReadFileCallback callback) {
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
+  if (normalized_path.empty()) {
+    return false;
+  }
+  if (offset < 0 || size < 0 || (size > 0 && buffer == nullptr)) {
+    return false;
+  }
+  if (!protocol->GetFlags().IsSet(FileProtocolFlag::kFileRead)) {
+    return false;
+  }
+  protocol->ReadFileAsync(protocol_name, normalized_path, offset, buffer, size,
+                          std::move(callback));
+  return true;
+}
+
+WatchId FileSystem::Watch(std::string_view path, WatchCallback callback) {
+  std::string path_buffer;
+  auto [normalized_path, protocol_name, protocol] =
+      GetNormalizedPath(path, &path_buffer);
+  if (normalized_path.empty() || callback == nullptr) {
+    return kNoWatchId;
+  }
+  if (!protocol->GetFlags().IsSet(FileProtocolFlag::kWatch)) {
+    return kNoWatchId;
+  }
+  return protocol->Watch(protocol_name, normalized_path, std::move(callback));
+}
+
+void FileSystem::Unwatch(WatchId id) {
+  // Watch identifiers are unique across protocols, so only the protocol that
+  // owns the watch does anything.
+  for (const auto& protocol : protocols_) {
+    if (protocol->GetFlags().IsSet(FileProtocolFlag::kWatch)) {
+      protocol->Unwatch(id);
+    }
+  }
+}
+
+std::tuple<std::string_view, std::string_view, FileProtocol*>
+FileSystem::GetNormalizedPath(std::string_view path, std::string* buffer) {
+  std::string_view normalized_path = NormalizePath(path, buffer);
+  std::string_view protocol_name;
   normalized_path = RemoveProtocol(normalized_path, &protocol_name);
+  return ResolvePath(normalized_path, protocol_name, buffer);
+}
+
+std::tuple<std::string_view, std::string_view, FileProtocol*>
+FileSystem::GetNormalizedPath(const Path& path, std::string* buffer) {
+  // Interned paths are already normalized and split, so only the protocol
+  // needs to be looked up.
+  if (path.IsEmpty()) {
+    return {};
+  }
+  return ResolvePath(path.GetPath(), path.GetProtocolName(), buffer);
+}
+
+std::tuple<std::string_view, std::string_view, FileProtocol*>
+FileSystem::ResolvePath(std::string_view normalized_path,
+                        std::string_view protocol_name, std::string* buffer) {
+  FileProtocol* protocol = nullptr;
+
+  // The returned protocol name always refers to a name owned by the file
+  // system, so it remains valid if the buffer is reused below.
   if (protocol_name.empty()) {
     protocol = default_protocol_;
     protocol_name = default_protocol_name_;
   } else if (auto it = protocol_map_.find(protocol_name);
              it != protocol_map_.end()) {
     protocol = it->second;
+    protocol_name = it->first;
   }
   if (protocol == nullptr) {
     return {{}, protocol_name, protocol};
@@ -345,7 +464,8 @@ FileSystem::GetNormalizedPath(std::string_view path) {
   if (current_path.empty()) {
     return {{}, protocol_name, protocol};
   }
-  return {JoinPath(current_path, normalized_path), protocol_name, protocol};
+  *buffer = JoinPath(current_path, normalized_path);
+  return {*buffer, protocol_name, protocol};
 }
 
 bool FileSystem::GenericCopyFolder(std::string_view from_protocol_name,
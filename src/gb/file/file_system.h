@@ -14,6 +14,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "gb/file/file.h"
 #include "gb/file/file_types.h"
+#include "gb/file/interned_path.h"
 
 namespace gb {
 
@@ -195,6 +196,15 @@ class FileSystem final {
   bool IsValidFile(std::string_view path) {
     return GetPathInfo(path).type == PathType::kFile;
   }
+  bool IsValidPath(const Path& path) {
+    return GetPathInfo(path).type != PathType::kInvalid;
+  }
+  bool IsValidFolder(const Path& path) {
+    return GetPathInfo(path).type == PathType::kFolder;
+  }
+  bool IsValidFile(const Path& path) {
+    return GetPathInfo(path).type == PathType::kFile;
+  }
 
   // Returns information about the specified path.
   //
@@ -207,6 +217,7 @@ class FileSystem final {
   // if they contain files) may choose to always succeed on a CreateFolder
   // call, but may return an invalid path if the empty folder is queried.
   PathInfo GetPathInfo(std::string_view path);
+  PathInfo GetPathInfo(const Path& path);
 
   // Opens a file given a path and specified file flags.
   //
@@ -215,8 +226,13 @@ class FileSystem final {
   // of a copy operation while a file is open.
   //
   // If the file cannot be opened with the requested flags, this will return
-  // nullptr.
+  // nullptr. FileFlag::kMapped is a request only: if the protocol does not
+  // support mapping files, the file is opened normally.
+  //
+  // Opening an interned Path skips normalizing and parsing the path, which
+  // makes it cheaper for paths that are opened repeatedly.
   std::unique_ptr<File> OpenFile(std::string_view path, FileFlags flags);
+  std::unique_ptr<File> OpenFile(const Path& path, FileFlags flags);
 
   // Writes a file from a string or vector of trivially copyable types.
   //
@@ -235,6 +251,50 @@ class FileSystem final {
   bool ReadFile(std::string_view path, std::string* buffer);
   template <typename Type>
   bool ReadFile(std::string_view path, std::vector<Type>* buffer);
+  bool ReadFile(const Path& path, std::string* buffer);
+  template <typename Type>
+  bool ReadFile(const Path& path, std::vector<Type>* buffer);
+
+  // Reads up to 'size' bytes from a file starting at 'offset' into a
+  // pre-allocated buffer, without blocking the caller on the read (if the
+  // protocol supports it).
+  //
+  // The callback is called exactly once when the read completes, with the
+  // number of bytes read (which is less than 'size' if the end-of-file was
+  // reached), or -1 if the file could not be opened. It may be called on any
+  // thread, including the calling thread before ReadFileAsync returns. The
+  // buffer must remain valid until the callback is called.
+  //
+  // It is undefined behavior if the file is written, deleted, or is the
+  // destination of a copy operation while an asynchronous read is pending.
+  //
+  // Returns false if the read could not be started (for instance, the path is
+  // invalid or the protocol does not support reading files), in which case the
+  // callback is not called.
+  bool ReadFileAsync(std::string_view path, int64_t offset, void* buffer,
+                     int64_t size, ReadFileCallback callback);
+
+  // Watches a file or folder for changes, so they can be reacted to without
+  // polling.
+  //
+  // The callback is called with the full path of what changed: the watched
+  // path itself, or any file or folder directly within it if it is a folder
+  // (watches are not recursive). When and on which thread the callback is
+  // called depends on the protocol. Callbacks must not call Watch or Unwatch.
+  //
+  // Depending on the protocol, a watch may end when the watched path is
+  // deleted, after kDeleted is reported for it. The watch must then be added
+  // again (from outside the callback) once the path is recreated. Protocols may
+  // report kModified for a watched path if they lose track of changes, so it
+  // should be treated as a request to rescan it.
+  //
+  // Returns kNoWatchId if the path does not exist, or the protocol does not
+  // support watching (see FileProtocolFlag::kWatch).
+  WatchId Watch(std::string_view path, WatchCallback callback);
+
+  // Stops watching for changes. Once this returns, the callback for the watch
+  // is not called again.
+  void Unwatch(WatchId id);
 
   // Number of bytes copied at a time when copying files across protocols.
   inline static constexpr int64_t kCopyBufferSize = 32 * 1024;
@@ -245,8 +305,27 @@ class FileSystem final {
 
   // Returns the normalized path, the protocol name, and the protocol for the
   // path. If the path is invalid, the normalized path will be empty.
-  std::tuple<std::string, std::string, FileProtocol*> GetNormalizedPath(
-      std::string_view path);
+  //
+  // The normalized path may refer to 'path' or 'buffer', so it is only valid as
+  // long as both are unchanged. Already normalized absolute paths are returned
+  // without allocating.
+  std::tuple<std::string_view, std::string_view, FileProtocol*>
+  GetNormalizedPath(std::string_view path, std::string* buffer);
+  std::tuple<std::string_view, std::string_view, FileProtocol*>
+  GetNormalizedPath(const Path& path, std::string* buffer);
+
+  // Resolves a normalized path with its protocol removed against the named
+  // protocol (or the default protocol if the name is empty). This is the
+  // common part of GetNormalizedPath.
+  std::tuple<std::string_view, std::string_view, FileProtocol*> ResolvePath(
+      std::string_view normalized_path, std::string_view protocol_name,
+      std::string* buffer);
+
+  PathInfo DoGetPathInfo(std::string_view protocol_name,
+                         FileProtocol* protocol, std::string_view path);
+  std::unique_ptr<File> DoOpenFile(std::string_view protocol_name,
+                                   FileProtocol* protocol,
+                                   std::string_view path, FileFlags flags);
   bool GenericCopyFolder(std::string_view from_protocol_name,
                          FileProtocol* from_protocol,
                          std::string_view from_path,
@@ -311,6 +390,25 @@ inline bool FileSystem::ReadFile(std::string_view path,
   return true;
 }
 
+inline bool FileSystem::ReadFile(const Path& path, std::string* buffer) {
+  auto file = OpenFile(path, kReadFileFlags);
+  if (file == nullptr) {
+    return false;
+  }
+  file->ReadRemainingString(buffer);
+  return true;
+}
+
+template <typename Type>
+inline bool FileSystem::ReadFile(const Path& path, std::vector<Type>* buffer) {
+  auto file = OpenFile(path, kReadFileFlags);
+  if (file == nullptr) {
+    return false;
+  }
+  file->ReadRemaining(buffer);
+  return true;
+}
+
 }  // namespace gb
 
 #endif  // GB_FILE_FILE_SYSTEM_H_
@@ -648,6 +648,11 @@ TEST(FileSystemTest, OpenFile) {
   EXPECT_EQ(
       file_system.OpenFile("test:/file", {FileFlag::kRead, FileFlag::kCreate}),
       nullptr);
+  EXPECT_EQ(file_system.OpenFile("test:/file", FileFlag::kMapped), nullptr);
+  EXPECT_EQ(file_system.OpenFile("test:/file",
+                                 {FileFlag::kRead, FileFlag::kWrite,
+                                  FileFlag::kMapped}),
+            nullptr);
 
   state.flags -= FileProtocolFlag::kFileRead;
   EXPECT_EQ(file_system.OpenFile("test:/file", FileFlag::kRead), nullptr);
@@ -670,6 +675,14 @@ TEST(FileSystemTest, OpenFile) {
   state.flags = {FileProtocolFlag::kInfo, FileProtocolFlag::kFileRead};
   EXPECT_NE(file_system.OpenFile("test:/file", FileFlag::kRead), nullptr);
 
+  // Protocols which do not support mapping open the file normally.
+  auto file =
+      file_system.OpenFile("test:/file", {FileFlag::kRead, FileFlag::kMapped});
+  ASSERT_NE(file, nullptr);
+  EXPECT_TRUE(file->GetMappedView().empty());
+  EXPECT_EQ(file->ReadRemainingString(), "1234567890");
+  file.reset();
+
   state.flags = {FileProtocolFlag::kInfo, FileProtocolFlag::kFileWrite};
   EXPECT_NE(
       file_system.OpenFile("test:/file", {FileFlag::kReset, FileFlag::kWrite}),
@@ -683,5 +696,99 @@ TEST(FileSystemTest, OpenFile) {
       nullptr);
 }
 
+TEST(FileSystemTest, InternedPaths) {
+  TestProtocol::State state;
+  state.paths["/file"] = TestProtocol::PathState::NewFile("1234567890");
+  state.paths["/folder"] = TestProtocol::PathState::NewFolder();
+  FileSystem file_system;
+  file_system.Register(std::make_unique<TestProtocol>(&state), "test");
+
+  EXPECT_EQ(file_system.GetPathInfo(Path()).type, PathType::kInvalid);
+  EXPECT_EQ(file_system.GetPathInfo(Path("test:file")).type,
+            PathType::kInvalid);
+  EXPECT_EQ(file_system.GetPathInfo(Path("foo:/file")).type,
+            PathType::kInvalid);
+  EXPECT_EQ(file_system.GetPathInfo(Path("/file")).type, PathType::kInvalid);
+  EXPECT_TRUE(file_system.IsValidFile(Path("test:/file")));
+  EXPECT_TRUE(file_system.IsValidFolder(Path("TEST:/.\\abc///..\\folder")));
+  EXPECT_FALSE(file_system.IsValidPath(Path("test:/missing")));
+
+  EXPECT_EQ(file_system.OpenFile(Path("test:/file"), {}), nullptr);
+  EXPECT_EQ(file_system.OpenFile(Path("test:/missing"), FileFlag::kRead),
+            nullptr);
+  std::string buffer;
+  EXPECT_TRUE(file_system.ReadFile(Path("test:/file"), &buffer));
+  EXPECT_EQ(buffer, "1234567890");
+
+  // Paths without a protocol use the default protocol.
+  file_system.SetDefaultProtocol("test");
+  std::vector<char> chars;
+  EXPECT_TRUE(file_system.ReadFile(Path("/file"), &chars));
+  EXPECT_EQ(std::string(chars.begin(), chars.end()), "1234567890");
+
+  state.flags -= FileProtocolFlag::kInfo;
+  EXPECT_FALSE(file_system.IsValidFile(Path("test:/file")));
+  EXPECT_EQ(state.invalid_call_count, 0);
+}
+
+TEST(FileSystemTest, ReadFileAsync) {
+  TestProtocol::State state;
+  FileSystem file_system;
+  file_system.Register(std::make_unique<TestProtocol>(&state), "test");
+
+  state.paths["/file"] = TestProtocol::PathState::NewFile("1234567890");
+
+  std::string buffer(4, '\0');
+  int64_t result = -2;
+  auto callback = [&result](int64_t bytes_read) { result = bytes_read; };
+  EXPECT_FALSE(file_system.ReadFileAsync("test:file", 0, buffer.data(), 4,
+                                         ReadFileCallback(callback)));
+  EXPECT_FALSE(file_system.ReadFileAsync("foo:/file", 0, buffer.data(), 4,
+                                         ReadFileCallback(callback)));
+  EXPECT_FALSE(file_system.ReadFileAsync("test:/file", -1, buffer.data(), 4,
+                                         ReadFileCallback(callback)));
+  EXPECT_FALSE(file_system.ReadFileAsync("test:/file", 0, buffer.data(), -1,
+                                         ReadFileCallback(callback)));
+  EXPECT_FALSE(file_system.ReadFileAsync("test:/file", 0, nullptr, 4,
+                                         ReadFileCallback(callback)));
+  state.flags -= FileProtocolFlag::kFileRead;
+  EXPECT_FALSE(file_system.ReadFileAsync("test:/file", 0, buffer.data(), 4,
+                                         ReadFileCallback(callback)));
+  state.flags += FileProtocolFlag::kFileRead;
+  EXPECT_EQ(result, -2);
+
+  // The default protocol implementation completes the read immediately.
+  EXPECT_TRUE(file_system.ReadFileAsync("test:/file", 3, buffer.data(), 4,
+                                        ReadFileCallback(callback)));
+  EXPECT_EQ(result, 4);
+  EXPECT_EQ(buffer, "4567");
+
+  EXPECT_TRUE(file_system.ReadFileAsync("test:/file", 8, buffer.data(), 4,
+                                        ReadFileCallback(callback)));
+  EXPECT_EQ(result, 2);
+
+  EXPECT_TRUE(file_system.ReadFileAsync("test:/missing", 0, buffer.data(), 4,
+                                        ReadFileCallback(callback)));
+  EXPECT_EQ(result, -1);
+}
+
+TEST(FileSystemTest, WatchUnsupported) {
+  TestProtocol::State state;
+  FileSystem file_system;
+  file_system.Register(std::make_unique<TestProtocol>(&state), "test");
+  state.paths["/file"] = TestProtocol::PathState::NewFile("1234567890");
+
+  auto callback = [](std::string_view path, PathChange change) {};
+  EXPECT_EQ(file_system.Watch("test:/file", WatchCallback(callback)),
+            kNoWatchId);
+  EXPECT_EQ(file_system.Watch("foo:/file", WatchCallback(callback)),
+            kNoWatchId);
+  EXPECT_EQ(file_system.Watch("test:/file", nullptr), kNoWatchId);
+
+  // Unknown watches are ignored.
+  file_system.Unwatch(kNoWatchId);
+  file_system.Unwatch(1);
+}
+
 }  // namespace
 }  // namespace gb
@@ -207,6 +207,51 @@ TEST(FileTest, Write) {
   EXPECT_EQ(file->GetPosition(), 0);
 }
 
+TEST(FileTest, WriteV) {
+  TestProtocol::State state;
+  FileSystem file_system;
+  file_system.Register(std::make_unique<TestProtocol>(&state), "test");
+
+  state.paths["/file"] = TestProtocol::PathState::NewFile("1234567890");
+  auto* file_state = state.paths["/file"].GetFile();
+  auto file = file_system.OpenFile("test:/file", FileFlag::kWrite);
+  ASSERT_NE(file, nullptr);
+  const std::string large(100000, 'x');
+  auto span = [](std::string_view text) {
+    return absl::Span<const uint8_t>(
+        reinterpret_cast<const uint8_t*>(text.data()), text.size());
+  };
+
+  // The test protocol does not support vectored writes directly, so small
+  // buffers are gathered into a single write.
+  file_state->ResetCounts();
+  EXPECT_EQ(file->WriteV({span("ab"), span(""), span("cd"), span("e")}), 5);
+  EXPECT_EQ(file->GetPosition(), 5);
+  EXPECT_EQ(file_state->contents, "abcde67890");
+  EXPECT_EQ(file_state->write_count, 1);
+
+  // Large buffers are written directly.
+  file_state->ResetCounts();
+  EXPECT_EQ(file->WriteV({span("f"), span(large), span("g")}),
+            large.size() + 2);
+  EXPECT_EQ(file->GetPosition(), large.size() + 7);
+  EXPECT_EQ(file_state->contents, absl::StrCat("abcdef", large, "g"));
+  EXPECT_EQ(file_state->write_count, 3);
+
+  // Writes stop at the first partial write.
+  file_state->ResetCounts();
+  file_state->fail_write_after = 3;
+  EXPECT_EQ(file->SeekBegin(), 0);
+  EXPECT_EQ(file->WriteV({span("hi"), span(large), span("j")}), 3);
+  EXPECT_EQ(file->GetPosition(), 3);
+  EXPECT_EQ(file_state->write_count, 2);
+
+  file.reset();
+  file = file_system.OpenFile("test:/file", FileFlag::kRead);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->WriteV({span("abc")}), 0);
+}
+
 TEST(FileTest, Read) {
   TestProtocol::State state;
   FileSystem file_system;
@@ -284,6 +329,43 @@ TEST(FileTest, Read) {
   EXPECT_EQ(file->GetPosition(), 0);
 }
 
+TEST(FileTest, ReadAt) {
+  TestProtocol::State state;
+  FileSystem file_system;
+  file_system.Register(std::make_unique<TestProtocol>(&state), "test");
+
+  state.paths["/file"] = TestProtocol::PathState::NewFile("1234567890");
+  auto* file_state = state.paths["/file"].GetFile();
+  auto file = file_system.OpenFile("test:/file", FileFlag::kRead);
+  ASSERT_NE(file, nullptr);
+  char buffer[20];
+
+  // The test protocol does not support positional reads directly, so File
+  // seeks to the offset and restores the position afterward.
+  EXPECT_EQ(file->SeekTo(2), 2);
+  std::memset(buffer, 0, sizeof(buffer));
+  EXPECT_EQ(file->ReadAt(5, buffer, 4), 4);
+  EXPECT_STREQ(buffer, "6789");
+  EXPECT_EQ(file->GetPosition(), 2);
+  EXPECT_EQ(file_state->position, 2);
+
+  std::memset(buffer, 0, sizeof(buffer));
+  EXPECT_EQ(file->ReadAt(8, buffer, sizeof(buffer)), 2);
+  EXPECT_STREQ(buffer, "90");
+  EXPECT_EQ(file->ReadAt(20, buffer, 4), 0);
+  EXPECT_EQ(file->ReadAt(-1, buffer, 4), 0);
+  EXPECT_EQ(file_state->position, 2);
+
+  std::memset(buffer, 0, sizeof(buffer));
+  EXPECT_EQ(file->Read(buffer, 3), 3);
+  EXPECT_STREQ(buffer, "345");
+
+  file.reset();
+  file = file_system.OpenFile("test:/file", FileFlag::kWrite);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->ReadAt(0, buffer, 4), 0);
+}
+
 TEST(FileTest, ReadString) {
   TestProtocol::State state;
   FileSystem file_system;
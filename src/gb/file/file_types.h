@@ -10,6 +10,7 @@
 
 #include <string_view>
 
+#include "gb/base/callback.h"
 #include "gb/base/flags.h"
 
 namespace gb {
@@ -40,6 +41,8 @@ enum class FileProtocolFlag {
   kCurrentPath,   // Supports getting and setting the current path. If this is
                   // supported, then the FileSystem will support relative paths
                   // with this protocol.
+  kWatch,         // Supports watching files and folders for changes. If this is
+                  // supported, kInfo must also be supported.
 };
 using FileProtocolFlags = Flags<FileProtocolFlag>;
 
@@ -70,6 +73,8 @@ enum class FileFlag {
   kWrite,   // Opens file for write access.
   kReset,   // Clears file after opening, only valid with kWrite.
   kCreate,  // Creates file if it does not exist, only valid with kWrite.
+  kMapped,  // Maps the file into memory if supported by the protocol, only
+            // valid with kRead and without kWrite (see File::GetMappedView).
 };
 using FileFlags = Flags<FileFlag>;
 inline constexpr FileFlags kReadFileFlags = {
@@ -117,6 +122,29 @@ inline constexpr PathTypes kAllPathTypes = {
     PathType::kFolder,
 };
 
+// Callback called when an asynchronous read completes (see
+// FileSystem::ReadFileAsync). It is passed the number of bytes read, or -1 if
+// the file could not be read.
+using ReadFileCallback = Callback<void(int64_t bytes_read)>;
+
+// Identifies a watch on a file or folder (see FileSystem::Watch). Watch
+// identifiers are unique across all protocols, and kNoWatchId is never used for
+// a valid watch.
+using WatchId = uint64_t;
+inline constexpr WatchId kNoWatchId = 0;
+
+// Describes how a watched file or folder changed.
+enum class PathChange {
+  kCreated,   // The file or folder was created.
+  kModified,  // The file was written.
+  kDeleted,   // The file or folder was deleted.
+};
+
+// Callback called when a watched file or folder changes (see
+// FileSystem::Watch). It is passed the full path (including the protocol) of
+// the file or folder that changed.
+using WatchCallback = Callback<void(std::string_view path, PathChange change)>;
+
 struct PathInfo {
   PathInfo() = default;
   PathInfo(PathType type, int64_t size = 0) : type(type), size(size) {}
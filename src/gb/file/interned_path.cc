@@ -0,0 +1,118 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/interned_path.h"
+
+#include <deque>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "gb/file/path.h"
+
+namespace gb {
+
+//==============================================================================
+// Path::Table
+//==============================================================================
+
+// Global table of all interned paths.
+class Path::Table {
+ public:
+  static Table& Get() {
+    static Table* const table = new Table;
+    return *table;
+  }
+
+  const Entry* GetEmpty() const { return &empty_; }
+  const Entry* Find(PathId id);
+  const Entry* Intern(std::string_view path);
+
+ private:
+  // Interned path string and its entry, which refers to the string.
+  struct Node {
+    std::string path;
+    Entry entry;
+  };
+
+  Table() = default;
+
+  const Entry empty_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string_view, const Entry*> entries_
+      ABSL_GUARDED_BY(mutex_);
+  std::deque<Node> nodes_ ABSL_GUARDED_BY(mutex_);  // Indexed by id - 1.
+};
+
+const Path::Entry* Path::Table::Find(PathId id) {
+  absl::ReaderMutexLock lock(&mutex_);
+  if (id == kNoPathId || id > nodes_.size()) {
+    return &empty_;
+  }
+  return &nodes_[id - 1].entry;
+}
+
+const Path::Entry* Path::Table::Intern(std::string_view path) {
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end()) {
+      return it->second;
+    }
+  }
+
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(path);
+  if (it != entries_.end()) {
+    return it->second;
+  }
+  Node& node = nodes_.emplace_back();
+  node.path = std::string(path);
+
+  // Nodes never move once added, so the entry can refer to the node's string.
+  Entry& entry = node.entry;
+  entry.path = node.path;
+  entry.id = static_cast<PathId>(nodes_.size());
+  const std::string_view local_path = RemoveProtocol(entry.path);
+  entry.protocol_end = static_cast<uint32_t>(path.size() - local_path.size());
+  const std::string_view host = gb::GetHostName(entry.path);
+  if (!host.empty()) {
+    entry.host_begin = static_cast<uint32_t>(host.data() - entry.path.data());
+    entry.host_end = static_cast<uint32_t>(entry.host_begin + host.size());
+  }
+  const std::string_view filename = RemoveFolder(entry.path);
+  entry.filename_begin = static_cast<uint32_t>(path.size() - filename.size());
+  entry.is_absolute = IsPathAbsolute(entry.path);
+  entries_[entry.path] = &entry;
+  return &entry;
+}
+
+//==============================================================================
+// Path
+//==============================================================================
+
+Path::Path() : entry_(Table::Get().GetEmpty()) {}
+
+Path::Path(std::string_view path) : Path() {
+  std::string buffer;
+  path = NormalizePath(path, &buffer);
+  if (!path.empty()) {
+    entry_ = Table::Get().Intern(path);
+  }
+}
+
+Path Path::FromId(PathId id) { return Path(Table::Get().Find(id)); }
+
+Path Path::GetParent() const {
+  return Path(RemoveFilename(GetString()));
+}
+
+Path Path::Join(std::string_view path) const {
+  std::string buffer;
+  path = NormalizePath(path, &buffer);
+  return Path(JoinPath(GetString(), path));
+}
+
+}  // namespace gb
@@ -0,0 +1,147 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_FILE_INTERNED_PATH_H_
+#define GB_FILE_INTERNED_PATH_H_
+
+#include <stdint.h>
+
+#include <string_view>
+#include <utility>
+
+namespace gb {
+
+// Identifier for an interned path (see Path).
+//
+// Each distinct normalized path is assigned a unique non-zero identifier the
+// first time it is interned, which stays the same for the lifetime of the
+// process. The empty path always has the identifier kNoPathId.
+using PathId = uint32_t;
+inline constexpr PathId kNoPathId = 0;
+
+// This class is a compact handle to an interned, normalized path.
+//
+// Paths are normalized with kGenericPathFlags (see NormalizePath) when they are
+// created, and the result is stored once in a global intern table, together
+// with where its protocol, host, and filename are. A Path is a single pointer,
+// so it is cheap to copy, compare, and hash, and none of the accessors parse
+// the path or allocate. Creating a Path from an already normalized string that
+// was interned before does not allocate either.
+//
+// Interned paths are never released, so this is intended for the bounded set
+// of paths a program refers to repeatedly (like resource files), and not for
+// arbitrary paths that are used once.
+//
+// This class is thread-safe.
+class Path final {
+ public:
+  //----------------------------------------------------------------------------
+  // Construction / Destruction
+  //----------------------------------------------------------------------------
+
+  // Constructs an empty path.
+  Path();
+
+  // Constructs a path from a string, normalizing it first. If the path cannot
+  // be normalized, this is an empty path.
+  explicit Path(std::string_view path);
+
+  Path(const Path&) = default;
+  Path& operator=(const Path&) = default;
+  ~Path() = default;
+
+  // Returns the previously interned path with the specified identifier, or the
+  // empty path if there is none.
+  static Path FromId(PathId id);
+
+  //----------------------------------------------------------------------------
+  // Properties
+  //----------------------------------------------------------------------------
+
+  // Returns the unique identifier for the path.
+  PathId GetId() const { return entry_->id; }
+
+  // Returns true if this is the empty path.
+  bool IsEmpty() const { return entry_->id == kNoPathId; }
+
+  // Returns the full normalized path, including any protocol.
+  std::string_view GetString() const { return entry_->path; }
+
+  // Returns the protocol name, or an empty string if there is no protocol.
+  std::string_view GetProtocolName() const {
+    return entry_->path.substr(0, entry_->protocol_end == 0
+                                      ? 0
+                                      : entry_->protocol_end - 1);
+  }
+
+  // Returns the host name, or an empty string if there is no host.
+  std::string_view GetHostName() const {
+    return entry_->path.substr(entry_->host_begin,
+                               entry_->host_end - entry_->host_begin);
+  }
+
+  // Returns the path without the protocol (see RemoveProtocol).
+  std::string_view GetPath() const {
+    return entry_->path.substr(entry_->protocol_end);
+  }
+
+  // Returns the filename (the last segment of the path), or an empty string if
+  // this is a root path.
+  std::string_view GetFilename() const {
+    return entry_->path.substr(entry_->filename_begin);
+  }
+
+  // Returns true if the path is absolute (see IsPathAbsolute).
+  bool IsAbsolute() const { return entry_->is_absolute; }
+
+  //----------------------------------------------------------------------------
+  // Operations
+  //----------------------------------------------------------------------------
+
+  // Returns the folder containing this path (see RemoveFilename).
+  Path GetParent() const;
+
+  // Returns this path joined with a relative path (see JoinPath).
+  Path Join(std::string_view path) const;
+
+  //----------------------------------------------------------------------------
+  // Comparison and hashing
+  //----------------------------------------------------------------------------
+
+  friend bool operator==(const Path& a, const Path& b) {
+    return a.entry_ == b.entry_;
+  }
+  friend bool operator!=(const Path& a, const Path& b) {
+    return a.entry_ != b.entry_;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const Path& path) {
+    return H::combine(std::move(h), path.entry_->id);
+  }
+
+ private:
+  class Table;
+
+  // Interned path and the positions of its components. All positions are
+  // offsets into the path.
+  struct Entry {
+    std::string_view path;
+    PathId id = kNoPathId;
+    uint32_t protocol_end = 0;  // After the ':', or 0 if there is no protocol.
+    uint32_t host_begin = 0;    // Start and end of any host name.
+    uint32_t host_end = 0;
+    uint32_t filename_begin = 0;
+    bool is_absolute = false;
+  };
+
+  explicit Path(const Entry* entry) : entry_(entry) {}
+
+  const Entry* entry_;
+};
+
+}  // namespace gb
+
+#endif  // GB_FILE_INTERNED_PATH_H_
@@ -0,0 +1,112 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/interned_path.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+TEST(InternedPathTest, EmptyPath) {
+  Path path;
+  EXPECT_TRUE(path.IsEmpty());
+  EXPECT_EQ(path.GetId(), kNoPathId);
+  EXPECT_EQ(path.GetString(), "");
+  EXPECT_EQ(path.GetProtocolName(), "");
+  EXPECT_EQ(path.GetHostName(), "");
+  EXPECT_EQ(path.GetPath(), "");
+  EXPECT_EQ(path.GetFilename(), "");
+  EXPECT_FALSE(path.IsAbsolute());
+  EXPECT_EQ(Path(""), path);
+  EXPECT_EQ(Path(":a"), path);
+  EXPECT_EQ(Path::FromId(kNoPathId), path);
+}
+
+TEST(InternedPathTest, Components) {
+  Path path("Mem://host/folder/file.txt");
+  EXPECT_FALSE(path.IsEmpty());
+  EXPECT_NE(path.GetId(), kNoPathId);
+  EXPECT_EQ(path.GetString(), "mem://host/folder/file.txt");
+  EXPECT_EQ(path.GetProtocolName(), "mem");
+  EXPECT_EQ(path.GetHostName(), "host");
+  EXPECT_EQ(path.GetPath(), "//host/folder/file.txt");
+  EXPECT_EQ(path.GetFilename(), "file.txt");
+  EXPECT_TRUE(path.IsAbsolute());
+
+  Path relative("folder\\.\\file");
+  EXPECT_EQ(relative.GetString(), "folder/file");
+  EXPECT_EQ(relative.GetProtocolName(), "");
+  EXPECT_EQ(relative.GetHostName(), "");
+  EXPECT_EQ(relative.GetPath(), "folder/file");
+  EXPECT_EQ(relative.GetFilename(), "file");
+  EXPECT_FALSE(relative.IsAbsolute());
+
+  Path root("mem:/");
+  EXPECT_EQ(root.GetProtocolName(), "mem");
+  EXPECT_EQ(root.GetPath(), "/");
+  EXPECT_EQ(root.GetFilename(), "");
+  EXPECT_TRUE(root.IsAbsolute());
+}
+
+TEST(InternedPathTest, Interning) {
+  Path path("mem:/a/b");
+  EXPECT_EQ(Path("mem:/a/b"), path);
+  EXPECT_EQ(Path("MEM:/a//b/"), path);
+  EXPECT_EQ(Path("mem:/a/c/../b"), path);
+  EXPECT_EQ(Path("mem:/a/b").GetId(), path.GetId());
+  EXPECT_EQ(Path("mem:/a/b").GetString().data(), path.GetString().data());
+  EXPECT_NE(Path("mem:/a/B"), path);
+  EXPECT_NE(Path("/a/b"), path);
+  EXPECT_EQ(Path::FromId(path.GetId()), path);
+  EXPECT_TRUE(Path::FromId(path.GetId() + 1000000).IsEmpty());
+
+  absl::flat_hash_set<Path> paths = {path, Path("MEM:/a/b"), Path("/a/b")};
+  EXPECT_EQ(paths.size(), 2);
+  EXPECT_TRUE(paths.contains(Path("mem:/a/b")));
+}
+
+TEST(InternedPathTest, ParentAndJoin) {
+  Path path("mem:/a/b/c");
+  EXPECT_EQ(path.GetParent(), Path("mem:/a/b"));
+  EXPECT_EQ(path.GetParent().GetParent().GetParent(), Path("mem:/"));
+  EXPECT_EQ(Path("mem:/").GetParent(), Path("mem:/"));
+  EXPECT_EQ(Path("mem:/a").Join("b\\c"), path);
+  EXPECT_EQ(Path("mem:/a/x").Join("../b/c"), path);
+  EXPECT_EQ(Path("a").Join("b"), Path("a/b"));
+  EXPECT_TRUE(Path("mem:/a").Join("other:b").IsEmpty());
+}
+
+TEST(InternedPathTest, ThreadSafe) {
+  constexpr int kThreadCount = 4;
+  constexpr int kPathCount = 1000;
+  std::vector<std::vector<Path>> paths(kThreadCount);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([i, &paths] {
+      for (int j = 0; j < kPathCount; ++j) {
+        paths[i].emplace_back(absl::StrCat("thread:/", j));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int j = 0; j < kPathCount; ++j) {
+    for (int i = 1; i < kThreadCount; ++i) {
+      EXPECT_EQ(paths[i][j], paths[0][j]);
+    }
+    EXPECT_EQ(paths[0][j].GetString(), absl::StrCat("thread:/", j));
+  }
+}
+
+}  // namespace
+}  // namespace gb
@@ -0,0 +1,106 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/line_reader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "gb/file/file.h"
+
+namespace gb {
+
+LineReader::LineReader(File* file, int64_t block_size)
+    : file_(file),
+      block_size_(static_cast<size_t>(std::max<int64_t>(block_size, 1))),
+      position_(file->GetPosition()) {}
+
+LineReader::~LineReader() {
+  if (begin_ < end_ && file_->IsValid()) {
+    file_->SeekTo(position_);
+  }
+}
+
+bool LineReader::ReadLine(std::string_view* line) {
+  size_t scan = begin_;
+  while (true) {
+    const size_t line_end = FindLineEnd(scan);
+    if (line_end < end_) {
+      size_t next = line_end + 1;
+      if (buffer_[line_end] == '\r') {
+        if (next == end_ && !eof_) {
+          // The next block is needed to tell if this is a "\r\n" line ending.
+          scan = line_end - begin_;
+          Fill();
+          scan += begin_;
+          continue;
+        }
+        if (next < end_ && buffer_[next] == '\n') {
+          ++next;
+        }
+      }
+      *line = std::string_view(buffer_.data() + begin_, line_end - begin_);
+      position_ += static_cast<int64_t>(next - begin_);
+      begin_ = next;
+      return true;
+    }
+    if (eof_) {
+      if (begin_ == end_) {
+        *line = {};
+        return false;
+      }
+      *line = std::string_view(buffer_.data() + begin_, end_ - begin_);
+      position_ += static_cast<int64_t>(end_ - begin_);
+      begin_ = end_;
+      return true;
+    }
+    scan = end_ - begin_;
+    Fill();
+    scan += begin_;
+  }
+}
+
+size_t LineReader::FindLineEnd(size_t from) {
+  if (next_lf_ == kUnknown || next_lf_ < from) {
+    const void* found = std::memchr(buffer_.data() + from, '\n', end_ - from);
+    next_lf_ = (found != nullptr
+                    ? static_cast<size_t>(static_cast<const char*>(found) -
+                                          buffer_.data())
+                    : end_);
+  }
+  if (next_cr_ == kUnknown || next_cr_ < from) {
+    const void* found = std::memchr(buffer_.data() + from, '\r', end_ - from);
+    next_cr_ = (found != nullptr
+                    ? static_cast<size_t>(static_cast<const char*>(found) -
+                                          buffer_.data())
+                    : end_);
+  }
+  return std::min(next_lf_, next_cr_);
+}
+
+void LineReader::Fill() {
+  // Move any partial line to the front of the buffer, and grow it if the
+  // partial line fills it.
+  if (begin_ > 0) {
+    std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+    end_ -= begin_;
+    begin_ = 0;
+  }
+  if (buffer_.size() - end_ < block_size_) {
+    buffer_.resize(end_ + block_size_);
+  }
+  next_lf_ = kUnknown;
+  next_cr_ = kUnknown;
+
+  const int64_t bytes_read = file_->Read(buffer_.data() + end_,
+                                        static_cast<int64_t>(block_size_));
+  if (bytes_read <= 0) {
+    eof_ = true;
+    return;
+  }
+  end_ += static_cast<size_t>(bytes_read);
+}
+
+}  // namespace gb
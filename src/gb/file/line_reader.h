@@ -0,0 +1,86 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_FILE_LINE_READER_H_
+#define GB_FILE_LINE_READER_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+
+#include "gb/file/file_types.h"
+
+namespace gb {
+
+// This class reads lines of ASCII or UTF-8 text from a File.
+//
+// The file is read in large blocks, and lines are returned as views into the
+// reader's buffer, so no allocation is done per line. Line endings follow the
+// same rules as File::ReadLine: lines are terminated by "\r", "\n", "\r\n", or
+// end-of-file, and end-of-file immediately after a line ending is not an
+// additional blank line.
+//
+// The reader reads ahead of the lines it has returned, so the file must not be
+// used directly while the reader exists. When the reader is destroyed, the
+// file position is restored to just after the last line returned.
+//
+// Example:
+//
+//   LineReader reader(file.get());
+//   std::string_view line;
+//   while (reader.ReadLine(&line)) {
+//     ParseLine(line);
+//   }
+//
+// This class is thread-compatible.
+class LineReader final {
+ public:
+  // Default number of bytes read from the file at a time.
+  inline static constexpr int64_t kDefaultBlockSize = 64 * 1024;
+
+  // Creates a line reader that starts at the current position of the file.
+  //
+  // The block size is the number of bytes read from the file at a time. The
+  // buffer grows beyond this only if a single line does not fit within it.
+  explicit LineReader(File* file, int64_t block_size = kDefaultBlockSize);
+  LineReader(const LineReader&) = delete;
+  LineReader& operator=(const LineReader&) = delete;
+  ~LineReader();
+
+  // Returns the position in the file just after the last line returned.
+  int64_t GetPosition() const { return position_; }
+
+  // Reads the next line from the file, without its line ending.
+  //
+  // The returned view remains valid until the next call to ReadLine, or the
+  // reader is destroyed. This returns false if there are no more lines (most
+  // likely the end-of-file was reached).
+  bool ReadLine(std::string_view* line);
+
+ private:
+  inline static constexpr size_t kUnknown = ~size_t{0};
+
+  size_t FindLineEnd(size_t from);
+  void Fill();
+
+  File* const file_;
+  const size_t block_size_;
+  int64_t position_;
+  std::string buffer_;
+  size_t begin_ = 0;  // Start of unread text in buffer_.
+  size_t end_ = 0;    // End of text read from the file in buffer_.
+  bool eof_ = false;
+
+  // Cached positions of the next '\n' and '\r' in buffer_ (or end_ if there
+  // are none), so text is not rescanned for one character when lines end with
+  // the other.
+  size_t next_lf_ = kUnknown;
+  size_t next_cr_ = kUnknown;
+};
+
+}  // namespace gb
+
+#endif  // GB_FILE_LINE_READER_H_
@@ -0,0 +1,122 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/line_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "gb/file/file.h"
+#include "gb/file/file_system.h"
+#include "gb/file/memory_file_protocol.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+using ::testing::ElementsAre;
+
+class LineReaderTest : public ::testing::Test {
+ protected:
+  LineReaderTest() {
+    file_system_.Register(std::make_unique<MemoryFileProtocol>());
+  }
+
+  std::unique_ptr<File> OpenFile(std::string_view contents) {
+    EXPECT_TRUE(file_system_.WriteFile("mem:/file", contents));
+    return file_system_.OpenFile("mem:/file", kReadFileFlags);
+  }
+
+  std::vector<std::string> ReadAllLines(File* file, int64_t block_size) {
+    std::vector<std::string> lines;
+    LineReader reader(file, block_size);
+    std::string_view line;
+    while (reader.ReadLine(&line)) {
+      lines.emplace_back(line);
+    }
+    EXPECT_FALSE(reader.ReadLine(&line));
+    EXPECT_TRUE(line.empty());
+    return lines;
+  }
+
+  FileSystem file_system_;
+};
+
+TEST_F(LineReaderTest, EmptyFile) {
+  auto file = OpenFile("");
+  ASSERT_NE(file, nullptr);
+  EXPECT_TRUE(ReadAllLines(file.get(), 4).empty());
+}
+
+TEST_F(LineReaderTest, LineEndings) {
+  const std::string contents = "a\nbc\rdef\r\n\n\r\r\nlast";
+  for (int64_t block_size : {1, 2, 3, 4, 5, 64}) {
+    SCOPED_TRACE(absl::StrCat("block_size=", block_size));
+    auto file = OpenFile(contents);
+    ASSERT_NE(file, nullptr);
+    EXPECT_THAT(ReadAllLines(file.get(), block_size),
+                ElementsAre("a", "bc", "def", "", "", "", "last"));
+  }
+}
+
+TEST_F(LineReaderTest, TrailingLineEndIsNotBlankLine) {
+  for (const char* line_end : {"\n", "\r", "\r\n"}) {
+    SCOPED_TRACE(absl::StrCat("line_end=", absl::CEscape(line_end)));
+    for (int64_t block_size : {1, 2, 3, 64}) {
+      auto file = OpenFile(absl::StrCat("one", line_end, "two", line_end));
+      ASSERT_NE(file, nullptr);
+      EXPECT_THAT(ReadAllLines(file.get(), block_size),
+                  ElementsAre("one", "two"));
+    }
+  }
+}
+
+TEST_F(LineReaderTest, LongLines) {
+  const std::string long_line(1000, 'x');
+  auto file = OpenFile(absl::StrCat("a\n", long_line, "\r\nb"));
+  ASSERT_NE(file, nullptr);
+  EXPECT_THAT(ReadAllLines(file.get(), 16), ElementsAre("a", long_line, "b"));
+}
+
+TEST_F(LineReaderTest, RestoresPosition) {
+  auto file = OpenFile("line1\r\nline2\nline3");
+  ASSERT_NE(file, nullptr);
+  {
+    LineReader reader(file.get(), 64);
+    std::string_view line;
+    EXPECT_EQ(reader.GetPosition(), 0);
+    ASSERT_TRUE(reader.ReadLine(&line));
+    EXPECT_EQ(line, "line1");
+    EXPECT_EQ(reader.GetPosition(), 7);
+  }
+  EXPECT_EQ(file->GetPosition(), 7);
+  EXPECT_EQ(file->ReadRemainingString(), "line2\nline3");
+
+  EXPECT_EQ(file->SeekTo(7), 7);
+  {
+    LineReader reader(file.get(), 64);
+    std::string_view line;
+    ASSERT_TRUE(reader.ReadLine(&line));
+    EXPECT_EQ(line, "line2");
+    ASSERT_TRUE(reader.ReadLine(&line));
+    EXPECT_EQ(line, "line3");
+    EXPECT_EQ(reader.GetPosition(), 18);
+  }
+  EXPECT_EQ(file->GetPosition(), 18);
+}
+
+TEST_F(LineReaderTest, WriteOnlyFile) {
+  ASSERT_TRUE(file_system_.WriteFile("mem:/file", "line"));
+  auto file = file_system_.OpenFile("mem:/file", kWriteFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_TRUE(ReadAllLines(file.get(), 64).empty());
+  EXPECT_EQ(file->GetPosition(), 0);
+}
+
+}  // namespace
+}  // namespace gb
@@ -5,14 +5,38 @@
 
 #include "gb/file/local_file_protocol.h"
 
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif  // __linux__
+
+#include <climits>
+
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "gb/base/context_builder.h"
 #include "gb/file/path.h"
 #include "gb/file/raw_file.h"
@@ -23,6 +47,9 @@ namespace {
 
 namespace fs = std::filesystem;
 
+#ifdef _WIN32
+
+// Windows file implemented with std::fstream.
 class LocalFile : public RawFile {
  public:
   explicit LocalFile(std::fstream file) : file_(std::move(file)) {}
@@ -95,6 +122,343 @@ int64_t LocalFile::Read(void* buffer, int64_t size) {
   return size;
 }
 
+#else  // _WIN32
+
+// POSIX file implemented directly on a file descriptor.
+//
+// All reads and writes are positional (pread/pwrite), and are buffered in a
+// single user-space buffer which is used for either reading or writing at any
+// given time. Reads and writes that are at least as large as the buffer bypass
+// it entirely. Buffer refills after a seek are limited to kSeekReadSize, so
+// small random reads do not pay for reading ahead a full buffer.
+//
+// As files may not be opened more than once, the file size is only queried
+// when the file is opened, and is tracked from then on.
+class LocalFile : public RawFile {
+ public:
+  static constexpr int64_t kSeekReadSize = 4096;
+
+  LocalFile(int fd, int64_t size, int64_t buffer_size)
+      : fd_(fd),
+        end_(size),
+        buffer_(static_cast<size_t>(std::max<int64_t>(buffer_size, 0))) {}
+  ~LocalFile() override;
+
+  int64_t SeekEnd() override;
+  int64_t SeekTo(int64_t position) override;
+  int64_t Write(const void* buffer, int64_t size) override;
+  int64_t WriteV(absl::Span<const absl::Span<const uint8_t>> buffers) override;
+  int64_t Read(void* buffer, int64_t size) override;
+  int64_t ReadAt(int64_t offset, void* buffer, int64_t size) override;
+
+ private:
+  int64_t GetCapacity() const { return static_cast<int64_t>(buffer_.size()); }
+  bool Flush();
+  int64_t WriteAt(const void* buffer, int64_t size, int64_t offset);
+
+  const int fd_;
+  int64_t position_ = 0;
+  int64_t end_ = 0;
+  std::vector<uint8_t> buffer_;
+
+  // File contents in buffer_ starting at read_offset_, when reading.
+  int64_t read_offset_ = 0;
+  int64_t read_size_ = 0;
+
+  // Pending contents in buffer_ to write at write_offset_, when writing.
+  int64_t write_offset_ = 0;
+  int64_t write_size_ = 0;
+};
+
+LocalFile::~LocalFile() {
+  Flush();
+  close(fd_);
+}
+
+int64_t LocalFile::SeekEnd() {
+  position_ = end_;
+  return position_;
+}
+
+int64_t LocalFile::SeekTo(int64_t position) {
+  position_ = std::clamp<int64_t>(position, 0, end_);
+  return position_;
+}
+
+bool LocalFile::Flush() {
+  if (write_size_ == 0) {
+    return true;
+  }
+  const int64_t size = std::exchange(write_size_, 0);
+  return WriteAt(buffer_.data(), size, write_offset_) == size;
+}
+
+// Reads up to 'size' bytes at 'offset' from a file descriptor, retrying
+// partial and interrupted reads. Returns the number of bytes read.
+int64_t ReadFully(int fd, void* buffer, int64_t size, int64_t offset) {
+  auto* data = static_cast<uint8_t*>(buffer);
+  int64_t total = 0;
+  while (total < size) {
+    const ssize_t result = pread(fd, data + total,
+                                 static_cast<size_t>(size - total),
+                                 static_cast<off_t>(offset + total));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      break;
+    }
+    total += result;
+  }
+  return total;
+}
+
+int64_t LocalFile::ReadAt(int64_t offset, void* buffer, int64_t size) {
+  // Files opened only for reading never have pending writes, so this only
+  // touches the file descriptor and is safe to call concurrently.
+  if (!Flush()) {
+    return 0;
+  }
+  return ReadFully(fd_, buffer, size, offset);
+}
+
+int64_t LocalFile::WriteAt(const void* buffer, int64_t size, int64_t offset) {
+  const auto* data = static_cast<const uint8_t*>(buffer);
+  int64_t total = 0;
+  while (total < size) {
+    const ssize_t result = pwrite(fd_, data + total,
+                                  static_cast<size_t>(size - total),
+                                  static_cast<off_t>(offset + total));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      break;
+    }
+    total += result;
+  }
+  return total;
+}
+
+int64_t LocalFile::Write(const void* buffer, int64_t size) {
+  read_size_ = 0;
+  if (write_size_ > 0 && (write_offset_ + write_size_ != position_ ||
+                          write_size_ + size > GetCapacity())) {
+    if (!Flush()) {
+      return 0;
+    }
+  }
+  if (size >= GetCapacity()) {
+    size = WriteAt(buffer, size, position_);
+  } else {
+    if (write_size_ == 0) {
+      write_offset_ = position_;
+    }
+    std::memcpy(buffer_.data() + write_size_, buffer,
+                static_cast<size_t>(size));
+    write_size_ += size;
+  }
+  position_ += size;
+  end_ = std::max(end_, position_);
+  return size;
+}
+
+int64_t LocalFile::WriteV(
+    absl::Span<const absl::Span<const uint8_t>> buffers) {
+  std::vector<iovec> iov;
+  iov.reserve(buffers.size());
+  int64_t size = 0;
+  for (absl::Span<const uint8_t> buffer : buffers) {
+    if (!buffer.empty()) {
+      iov.push_back({const_cast<uint8_t*>(buffer.data()), buffer.size()});
+      size += static_cast<int64_t>(buffer.size());
+    }
+  }
+
+  // Small writes are cheaper to gather in the write buffer.
+  if (size < GetCapacity()) {
+    int64_t total = 0;
+    for (const iovec& entry : iov) {
+      total += Write(entry.iov_base, static_cast<int64_t>(entry.iov_len));
+    }
+    return total;
+  }
+
+  read_size_ = 0;
+  if (!Flush()) {
+    return 0;
+  }
+  int64_t total = 0;
+  size_t index = 0;
+  while (index < iov.size()) {
+    const int count = static_cast<int>(std::min<size_t>(
+        iov.size() - index, static_cast<size_t>(IOV_MAX)));
+    const ssize_t result = pwritev(fd_, iov.data() + index, count,
+                                   static_cast<off_t>(position_ + total));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      break;
+    }
+    total += result;
+
+    // Skip past the buffers that were written, which may end partway through
+    // a buffer.
+    size_t written = static_cast<size_t>(result);
+    while (index < iov.size() && written >= iov[index].iov_len) {
+      written -= iov[index++].iov_len;
+    }
+    if (written > 0) {
+      iov[index].iov_base =
+          static_cast<uint8_t*>(iov[index].iov_base) + written;
+      iov[index].iov_len -= written;
+    }
+  }
+  position_ += total;
+  end_ = std::max(end_, position_);
+  return total;
+}
+
+int64_t LocalFile::Read(void* buffer, int64_t size) {
+  if (!Flush()) {
+    return 0;
+  }
+  auto* data = static_cast<uint8_t*>(buffer);
+  int64_t total = 0;
+  while (size > 0) {
+    if (position_ >= read_offset_ && position_ < read_offset_ + read_size_) {
+      const int64_t count =
+          std::min(size, read_offset_ + read_size_ - position_);
+      std::memcpy(data + total, buffer_.data() + (position_ - read_offset_),
+                  static_cast<size_t>(count));
+      total += count;
+      position_ += count;
+      size -= count;
+      continue;
+    }
+    if (size >= GetCapacity()) {
+      const int64_t count = ReadFully(fd_, data + total, size, position_);
+      total += count;
+      position_ += count;
+      break;
+    }
+    int64_t fill_size = GetCapacity();
+    if (position_ != read_offset_ + read_size_) {
+      fill_size = std::min(std::max(size, kSeekReadSize), fill_size);
+    }
+    read_size_ = ReadFully(fd_, buffer_.data(), fill_size, position_);
+    read_offset_ = position_;
+    if (read_size_ == 0) {
+      break;
+    }
+  }
+  return total;
+}
+
+#endif  // _WIN32
+
+// Read-only file which is mapped into memory in its entirety.
+class LocalMappedFile : public RawFile {
+ public:
+  // Maps the specified file, returning null if it cannot be mapped.
+  static std::unique_ptr<LocalMappedFile> Open(const fs::path& path);
+
+  ~LocalMappedFile() override;
+
+  int64_t SeekEnd() override;
+  int64_t SeekTo(int64_t position) override;
+  int64_t Write(const void* buffer, int64_t size) override;
+  int64_t Read(void* buffer, int64_t size) override;
+  int64_t ReadAt(int64_t offset, void* buffer, int64_t size) override;
+  absl::Span<const uint8_t> GetMappedView() override;
+
+ private:
+  LocalMappedFile(const uint8_t* data, int64_t size)
+      : data_(data), size_(size) {}
+
+  const uint8_t* const data_;
+  const int64_t size_;
+  int64_t position_ = 0;
+};
+
+std::unique_ptr<LocalMappedFile> LocalMappedFile::Open(const fs::path& path) {
+#ifdef _WIN32
+  // Memory mapping is not implemented for Windows yet, so these files are
+  // opened as regular files instead.
+  return nullptr;
+#else   // _WIN32
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+    close(fd);
+    return nullptr;
+  }
+
+  // Empty files cannot be mapped, but are trivially represented with no data.
+  const int64_t size = static_cast<int64_t>(file_stat.st_size);
+  void* data = nullptr;
+  if (size > 0) {
+    data = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, fd,
+                0);
+  }
+
+  // The mapping remains valid after the file descriptor is closed.
+  close(fd);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+  return absl::WrapUnique(
+      new LocalMappedFile(static_cast<const uint8_t*>(data), size));
+#endif  // _WIN32
+}
+
+LocalMappedFile::~LocalMappedFile() {
+#ifndef _WIN32
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+  }
+#endif  // _WIN32
+}
+
+int64_t LocalMappedFile::SeekEnd() {
+  position_ = size_;
+  return position_;
+}
+
+int64_t LocalMappedFile::SeekTo(int64_t position) {
+  position_ = std::clamp<int64_t>(position, 0, size_);
+  return position_;
+}
+
+int64_t LocalMappedFile::Write(const void* buffer, int64_t size) { return 0; }
+
+int64_t LocalMappedFile::Read(void* buffer, int64_t size) {
+  size = std::min(size, size_ - position_);
+  if (size <= 0) {
+    return 0;
+  }
+  std::memcpy(buffer, data_ + position_, static_cast<size_t>(size));
+  position_ += size;
+  return size;
+}
+
+int64_t LocalMappedFile::ReadAt(int64_t offset, void* buffer, int64_t size) {
+  size = std::min(size, size_ - offset);
+  if (size <= 0) {
+    return 0;
+  }
+  std::memcpy(buffer, data_ + offset, static_cast<size_t>(size));
+  return size;
+}
+
+absl::Span<const uint8_t> LocalMappedFile::GetMappedView() {
+  return absl::Span<const uint8_t>(data_, static_cast<size_t>(size_));
+}
+
 std::string ToString(const fs::path& path) {
   return NormalizePath(path.generic_string());
 }
@@ -103,6 +467,40 @@ fs::path ToPath(std::string_view path) {
   return fs::path(path, fs::path::generic_format);
 }
 
+// Reads part of a local file for an asynchronous read. Returns the number of
+// bytes read, or -1 if the file could not be opened.
+int64_t ReadLocalFile(const fs::path& path, int64_t offset, void* buffer,
+                      int64_t size) {
+#ifdef _WIN32
+  std::error_code error;
+  if (!fs::is_regular_file(path, error)) {
+    return -1;
+  }
+  std::ifstream file(path, std::ios::binary);
+  if (file.fail()) {
+    return -1;
+  }
+  file.seekg(offset);
+  file.read(static_cast<char*>(buffer), size);
+  return static_cast<int64_t>(file.gcount());
+#else   // _WIN32
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+
+  // Folders can be opened for reading, but are not files.
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+    close(fd);
+    return -1;
+  }
+  const int64_t bytes_read = ReadFully(fd, buffer, size, offset);
+  close(fd);
+  return bytes_read;
+#endif  // _WIN32
+}
+
 }  // namespace
 
 std::unique_ptr<LocalFileProtocol> LocalFileProtocol::Create(
@@ -254,9 +652,45 @@ LocalFileProtocol::LocalFileProtocol(std::string_view root,
     : flags_(context.GetValue<FileProtocolFlags>()),
       root_(root.data(), root.size()),
       unique_root_(context.GetValue<bool>(kKeyUniqueRoot)),
-      delete_at_exit_(context.GetValue<bool>(kKeyDeleteAtExit)) {}
+      delete_at_exit_(context.GetValue<bool>(kKeyDeleteAtExit)),
+      buffer_size_(context.GetValue<int>(kKeyBufferSize)),
+      async_thread_count_(context.GetValue<int>(kKeyAsyncThreadCount)),
+      folder_thread_count_(context.GetValue<int>(kKeyFolderThreadCount)) {}
 
 LocalFileProtocol::~LocalFileProtocol() {
+#ifdef __linux__
+  // Stop reporting changes before anything is deleted.
+  std::thread watch_thread;
+  int watch_fd = -1;
+  int wake_fds[2] = {-1, -1};
+  {
+    absl::MutexLock lock(&watch_mutex_);
+    watch_thread.swap(watch_thread_);
+    std::swap(watch_fd, watch_fd_);
+    std::swap(wake_fds, wake_fds_);
+  }
+  if (watch_thread.joinable()) {
+    const char wake = 0;
+    while (write(wake_fds[1], &wake, 1) < 0 && errno == EINTR) {
+    }
+    watch_thread.join();
+    close(watch_fd);
+    close(wake_fds[0]);
+    close(wake_fds[1]);
+  }
+#endif  // __linux__
+
+  // Complete all pending asynchronous reads before anything is deleted.
+  std::vector<std::thread> async_threads;
+  {
+    absl::MutexLock lock(&async_mutex_);
+    async_exit_ = true;
+    async_threads.swap(async_threads_);
+  }
+  for (auto& thread : async_threads) {
+    thread.join();
+  }
+
   if (!delete_at_exit_) {
     return;
   }
@@ -351,9 +785,240 @@ std::vector<std::string> ListFolder(Iterator& it, fs::path& path,
   return entries;
 }
 
+#ifndef _WIN32
+
+namespace {
+
+// Entry found while walking a folder.
+struct FolderEntry {
+  std::string path;  // Relative to the folder being walked.
+  PathType type;     // Either PathType::kFile or PathType::kFolder.
+  bool is_link;      // True if this is a symbolic link to the file or folder.
+};
+
+// Reads the entries of a single folder, appending them to 'entries'. The
+// entry paths are prefixed with 'relative_path', if it is not empty.
+//
+// Entries are read with readdir, which fetches them from the operating system
+// in large batches (with getdents on Linux). The entry type comes from the
+// directory entry itself where possible, so only symbolic links (and entries
+// on file systems that do not report types) are queried separately. Anything
+// that is not a folder or regular file is skipped.
+//
+// Returns false if the folder could not be read.
+bool ReadFolderEntries(const std::string& full_path,
+                       std::string_view relative_path,
+                       std::vector<FolderEntry>* entries) {
+  DIR* dir = opendir(full_path.c_str());
+  if (dir == nullptr) {
+    return false;
+  }
+  const int dir_fd = dirfd(dir);
+  while (const dirent* entry = readdir(dir)) {
+    const std::string_view name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    PathType type = PathType::kInvalid;
+    bool is_link = false;
+    if (entry->d_type == DT_DIR) {
+      type = PathType::kFolder;
+    } else if (entry->d_type == DT_REG) {
+      type = PathType::kFile;
+    } else if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+      struct stat status;
+      if (fstatat(dir_fd, entry->d_name, &status, 0) == 0) {
+        if (S_ISDIR(status.st_mode)) {
+          type = PathType::kFolder;
+        } else if (S_ISREG(status.st_mode)) {
+          type = PathType::kFile;
+        }
+      }
+      is_link = (entry->d_type == DT_LNK);
+    }
+    if (type == PathType::kInvalid) {
+      continue;
+    }
+    entries->push_back({relative_path.empty()
+                            ? std::string(name)
+                            : absl::StrCat(relative_path, "/", name),
+                        type, is_link});
+  }
+  closedir(dir);
+  return true;
+}
+
+// State shared by all threads walking a folder recursively.
+class FolderWalk {
+ public:
+  FolderWalk(std::string_view full_path, std::vector<FolderEntry>* entries)
+      : full_path_(full_path), entries_(entries) {
+    absl::MutexLock lock(&mutex_);
+    AddFolders(*entries);
+  }
+
+  // Returns true if there are sub-folders left to read.
+  bool HasPendingFolders() {
+    absl::MutexLock lock(&mutex_);
+    return !pending_.empty();
+  }
+
+  // Reads pending sub-folders until all have been read by all threads.
+  void Run();
+
+ private:
+  void AddFolders(absl::Span<const FolderEntry> entries)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    // Symbolic links to folders are listed, but never followed.
+    for (const FolderEntry& entry : entries) {
+      if (entry.type == PathType::kFolder && !entry.is_link) {
+        pending_.push_back(entry.path);
+      }
+    }
+  }
+
+  bool IsDone() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return pending_.empty() && active_ == 0;
+  }
+
+  const std::string full_path_;
+  absl::Mutex mutex_;
+  std::vector<FolderEntry>* const entries_ ABSL_PT_GUARDED_BY(mutex_);
+  std::vector<std::string> pending_ ABSL_GUARDED_BY(mutex_);
+  int active_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+void FolderWalk::Run() {
+  std::vector<FolderEntry> folder_entries;
+  while (true) {
+    std::string folder;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(
+          +[](FolderWalk* walk) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+            return !walk->pending_.empty() || walk->IsDone();
+          },
+          this));
+      if (pending_.empty()) {
+        return;
+      }
+      folder = std::move(pending_.back());
+      pending_.pop_back();
+      ++active_;
+    }
+
+    // Folders that cannot be read are skipped, like any other inaccessible
+    // entry.
+    folder_entries.clear();
+    ReadFolderEntries(absl::StrCat(full_path_, "/", folder), folder,
+                      &folder_entries);
+
+    absl::MutexLock lock(&mutex_);
+    AddFolders(folder_entries);
+    entries_->insert(entries_->end(),
+                     std::make_move_iterator(folder_entries.begin()),
+                     std::make_move_iterator(folder_entries.end()));
+    --active_;
+  }
+}
+
+// Walks a folder, storing its entries in 'entries' sorted by path, so folders
+// always come before their contents. If the mode is FolderMode::kRecursive,
+// sub-folders are read on up to 'thread_count' threads (including the calling
+// thread).
+//
+// Returns false if the folder itself could not be read. Sub-folders that cannot
+// be read are skipped.
+bool WalkFolder(const std::string& full_path, FolderMode mode,
+                int thread_count, std::vector<FolderEntry>* entries) {
+  if (!ReadFolderEntries(full_path, {}, entries)) {
+    return false;
+  }
+  if (mode == FolderMode::kRecursive) {
+    FolderWalk walk(full_path, entries);
+    std::vector<std::thread> threads;
+    if (walk.HasPendingFolders()) {
+      for (int i = 1; i < thread_count; ++i) {
+        threads.emplace_back([&walk] { walk.Run(); });
+      }
+    }
+    walk.Run();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  std::sort(entries->begin(), entries->end(),
+            [](const FolderEntry& a, const FolderEntry& b) {
+              return a.path < b.path;
+            });
+  return true;
+}
+
+// Copies files from one folder to another, on up to 'thread_count' threads
+// (including the calling thread). The destination folders must already exist.
+//
+// Returns false if any file could not be copied.
+bool CopyFolderFiles(const fs::path& from_path, const fs::path& to_path,
+                     absl::Span<const FolderEntry* const> files,
+                     int thread_count) {
+  std::atomic<int> next_file = 0;
+  std::atomic<bool> success = true;
+  auto copy_files = [&] {
+    std::error_code error;
+    for (int i = next_file++; i < static_cast<int>(files.size()) && success;
+         i = next_file++) {
+      if (!fs::copy_file(from_path / files[i]->path, to_path / files[i]->path,
+                         fs::copy_options::overwrite_existing, error)) {
+        success = false;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  const int extra_threads =
+      std::min(thread_count, static_cast<int>(files.size())) - 1;
+  for (int i = 0; i < extra_threads; ++i) {
+    threads.emplace_back(copy_files);
+  }
+  copy_files();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return success;
+}
+
+}  // namespace
+
+#endif  // _WIN32
+
 std::vector<std::string> LocalFileProtocol::DoList(
     std::string_view protocol_name, std::string_view path,
     std::string_view pattern, FolderMode mode, PathTypes types) {
+#ifndef _WIN32
+  std::vector<FolderEntry> entries;
+  if (!WalkFolder(JoinPath(root_, path), mode, folder_thread_count_,
+                  &entries)) {
+    return {};
+  }
+  const std::string prefix =
+      (IsRootPath(path) ? absl::StrCat(protocol_name, ":/")
+                        : absl::StrCat(protocol_name, ":", path, "/"));
+  std::vector<std::string> result;
+  result.reserve(entries.size());
+  for (const FolderEntry& entry : entries) {
+    if (!types.IsSet(entry.type)) {
+      continue;
+    }
+    if (!pattern.empty()) {
+      std::string_view filename = entry.path;
+      filename.remove_prefix(filename.find_last_of('/') + 1);
+      if (!PathMatchesPattern(filename, pattern)) {
+        continue;
+      }
+    }
+    result.emplace_back(absl::StrCat(prefix, entry.path));
+  }
+  return result;
+#else   // _WIN32
   std::error_code error;
   fs::path full_path = ToPath(JoinPath(root_, path));
 
@@ -372,6 +1037,7 @@ std::vector<std::string> LocalFileProtocol::DoList(
     }
     return ListFolder(it, full_path, root_, protocol_name, pattern, types);
   }
+#endif  // _WIN32
 }
 
 bool LocalFileProtocol::DoCreateFolder(std::string_view protocol_name,
@@ -414,10 +1080,38 @@ bool LocalFileProtocol::DoCopyFolder(std::string_view protocol_name,
     return false;
   }
 
+#ifndef _WIN32
+  std::vector<FolderEntry> entries;
+  if (!WalkFolder(full_from_path.native(), FolderMode::kRecursive,
+                  folder_thread_count_, &entries)) {
+    return false;
+  }
+
+  // Folders are created first (entries are sorted, so parents are always
+  // created before their children), and then the files are copied in parallel.
+  fs::create_directory(full_to_path, error);
+  if (error) {
+    return false;
+  }
+  std::vector<const FolderEntry*> files;
+  for (const FolderEntry& entry : entries) {
+    if (entry.type == PathType::kFile) {
+      files.push_back(&entry);
+      continue;
+    }
+    fs::create_directory(full_to_path / entry.path, error);
+    if (error) {
+      return false;
+    }
+  }
+  return CopyFolderFiles(full_from_path, full_to_path, files,
+                         folder_thread_count_);
+#else   // _WIN32
   auto options =
       fs::copy_options::overwrite_existing | fs::copy_options::recursive;
   fs::copy(full_from_path, full_to_path, options, error);
   return !error;
+#endif  // _WIN32
 }
 
 bool LocalFileProtocol::DoDeleteFolder(std::string_view protocol_name,
@@ -477,6 +1171,14 @@ std::unique_ptr<RawFile> LocalFileProtocol::DoOpenFile(
     return nullptr;
   }
 
+  if (flags.IsSet(FileFlag::kMapped) && !flags.IsSet(FileFlag::kWrite)) {
+    if (auto mapped_file = LocalMappedFile::Open(full_path);
+        mapped_file != nullptr) {
+      return mapped_file;
+    }
+  }
+
+#ifdef _WIN32
   std::fstream::openmode mode = std::fstream::binary;
   if (flags.IsSet(FileFlag::kRead)) {
     mode |= std::fstream::in;
@@ -496,8 +1198,276 @@ std::unique_ptr<RawFile> LocalFileProtocol::DoOpenFile(
     return nullptr;
   }
   return std::make_unique<LocalFile>(std::move(file));
+#else   // _WIN32
+  int open_flags = O_CLOEXEC;
+  if (flags.IsSet(FileFlag::kRead) && flags.IsSet(FileFlag::kWrite)) {
+    open_flags |= O_RDWR;
+  } else if (flags.IsSet(FileFlag::kWrite)) {
+    open_flags |= O_WRONLY;
+  } else {
+    open_flags |= O_RDONLY;
+  }
+  if (!file_exists) {
+    open_flags |= O_CREAT;
+  }
+  if (flags.IsSet(FileFlag::kReset) || !file_exists) {
+    open_flags |= O_TRUNC;
+  }
+  const int fd = open(full_path.c_str(), open_flags, 0666);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return nullptr;
+  }
+  const int64_t size = static_cast<int64_t>(file_stat.st_size);
+
+  // Read-only files never need a buffer larger than the file itself.
+  int64_t buffer_size = buffer_size_;
+  if (!flags.IsSet(FileFlag::kWrite)) {
+    buffer_size = std::min(buffer_size, size);
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif  // POSIX_FADV_SEQUENTIAL
+  }
+  return std::make_unique<LocalFile>(fd, size, buffer_size);
+#endif  // _WIN32
 }
 
+void LocalFileProtocol::DoReadFileAsync(std::string_view protocol_name,
+                                        std::string_view path, int64_t offset,
+                                        void* buffer, int64_t size,
+                                        ReadFileCallback callback) {
+  std::string full_path = JoinPath(root_, path);
+  if (async_thread_count_ <= 0) {
+    callback(ReadLocalFile(ToPath(full_path), offset, buffer, size));
+    return;
+  }
+  absl::MutexLock lock(&async_mutex_);
+  async_reads_.push_back(
+      {std::move(full_path), offset, buffer, size, std::move(callback)});
+  if (async_threads_.empty()) {
+    async_threads_.reserve(async_thread_count_);
+    for (int i = 0; i < async_thread_count_; ++i) {
+      async_threads_.emplace_back([this] { AsyncReadThread(); });
+    }
+  }
+}
+
+void LocalFileProtocol::AsyncReadThread() {
+  while (true) {
+    AsyncRead read;
+    {
+      absl::MutexLock lock(&async_mutex_);
+      async_mutex_.Await(absl::Condition(
+          +[](LocalFileProtocol* protocol) {
+            return protocol->async_exit_ || !protocol->async_reads_.empty();
+          },
+          this));
+      if (async_reads_.empty()) {
+        return;
+      }
+      read = std::move(async_reads_.front());
+      async_reads_.pop_front();
+    }
+    read.callback(
+        ReadLocalFile(ToPath(read.path), read.offset, read.buffer, read.size));
+  }
+}
+
+#ifdef __linux__
+
+namespace {
+
+inline constexpr uint32_t kWatchMask =
+    IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO |
+    IN_DELETE_SELF | IN_MOVE_SELF;
+
+}  // namespace
+
+bool LocalFileProtocol::DoWatch(std::string_view protocol_name,
+                                std::string_view path, WatchId id,
+                                WatchCallback callback) {
+  // Files are watched through the folder containing them, so the watch
+  // survives the file being deleted and recreated, or replaced by a rename
+  // (which is how many editors save files).
+  struct stat path_stat;
+  if (stat(JoinPath(root_, path).c_str(), &path_stat) != 0) {
+    return false;
+  }
+  std::string_view folder = path;
+  std::string_view name;
+  if (!S_ISDIR(path_stat.st_mode)) {
+    folder = RemoveFilename(path, &name);
+  }
+  const std::string full_path = JoinPath(root_, folder);
+
+  absl::MutexLock lock(&watch_mutex_);
+  if (watch_fd_ < 0) {
+    watch_fd_ = inotify_init1(IN_CLOEXEC);
+    if (watch_fd_ < 0) {
+      LOG(ERROR) << "Failed to initialize inotify: " << std::strerror(errno);
+      return false;
+    }
+    if (pipe2(wake_fds_, O_CLOEXEC) != 0) {
+      LOG(ERROR) << "Failed to create watch pipe: " << std::strerror(errno);
+      close(watch_fd_);
+      watch_fd_ = -1;
+      return false;
+    }
+    watch_thread_ = std::thread(
+        [this, watch_fd = watch_fd_, wake_fd = wake_fds_[0]] {
+          WatchThread(watch_fd, wake_fd);
+        });
+  }
+
+  // Watching the same folder again returns the same watch descriptor.
+  const int wd = inotify_add_watch(watch_fd_, full_path.c_str(), kWatchMask);
+  if (wd < 0) {
+    return false;
+  }
+  WatchedPath& watched = watched_paths_[wd];
+  if (watched.watches.empty()) {
+    watched.path = std::string(folder);
+  }
+  watched.watches.push_back(absl::WrapUnique(
+      new Watch{id, std::string(protocol_name), std::string(path),
+                std::string(name), std::move(callback)}));
+  watch_descriptors_[id] = wd;
+  return true;
+}
+
+void LocalFileProtocol::DoUnwatch(WatchId id) {
+  absl::MutexLock dispatch_lock(&dispatch_mutex_);
+  absl::MutexLock lock(&watch_mutex_);
+  auto wd_it = watch_descriptors_.find(id);
+  if (wd_it == watch_descriptors_.end()) {
+    return;
+  }
+  const int wd = wd_it->second;
+  watch_descriptors_.erase(wd_it);
+  auto it = watched_paths_.find(wd);
+  auto& watches = it->second.watches;
+  watches.erase(std::find_if(
+      watches.begin(), watches.end(),
+      [id](const std::unique_ptr<Watch>& watch) { return watch->id == id; }));
+  if (watches.empty()) {
+    inotify_rm_watch(watch_fd_, wd);
+    watched_paths_.erase(it);
+  }
+}
+
+void LocalFileProtocol::WatchThread(int watch_fd, int wake_fd) {
+  alignas(inotify_event) char buffer[16 * 1024];
+  pollfd fds[2] = {{watch_fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+  std::vector<std::tuple<const Watch*, std::string, PathChange>> calls;
+  std::vector<std::unique_ptr<Watch>> ended_watches;
+  while (true) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG(ERROR) << "Failed to wait for file changes: "
+                 << std::strerror(errno);
+      return;
+    }
+    if (fds[1].revents != 0) {
+      return;
+    }
+    const ssize_t size = read(watch_fd, buffer, sizeof(buffer));
+    if (size <= 0) {
+      continue;
+    }
+
+    absl::MutexLock dispatch_lock(&dispatch_mutex_);
+    {
+      absl::MutexLock lock(&watch_mutex_);
+      for (ssize_t offset = 0; offset < size;) {
+        const auto* event =
+            reinterpret_cast<const inotify_event*>(buffer + offset);
+        offset += sizeof(inotify_event) + event->len;
+        if ((event->mask & IN_Q_OVERFLOW) != 0) {
+          // Events were dropped, so every watched path may have changed.
+          for (const auto& [wd, watched] : watched_paths_) {
+            for (const auto& watch : watched.watches) {
+              calls.emplace_back(watch.get(), watch->path,
+                                 PathChange::kModified);
+            }
+          }
+          continue;
+        }
+        auto it = watched_paths_.find(event->wd);
+        if (it == watched_paths_.end()) {
+          continue;
+        }
+        auto& watches = it->second.watches;
+        if ((event->mask & IN_IGNORED) != 0) {
+          // The watched folder is gone, so its watches have ended. They are
+          // kept until any calls already queued for them are made.
+          for (auto& watch : watches) {
+            watch_descriptors_.erase(watch->id);
+            ended_watches.push_back(std::move(watch));
+          }
+          watched_paths_.erase(it);
+          continue;
+        }
+        if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0) {
+          // A moved folder is still watched by inotify, which would report
+          // the wrong paths, so its watch is removed (resulting in IN_IGNORED).
+          if ((event->mask & IN_MOVE_SELF) != 0) {
+            inotify_rm_watch(watch_fd, event->wd);
+          }
+          for (const auto& watch : watches) {
+            calls.emplace_back(watch.get(), watch->path, PathChange::kDeleted);
+          }
+          continue;
+        }
+        PathChange change;
+        if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+          change = PathChange::kCreated;
+        } else if ((event->mask & IN_CLOSE_WRITE) != 0) {
+          change = PathChange::kModified;
+        } else {
+          change = PathChange::kDeleted;
+        }
+        const std::string_view name =
+            event->len > 0 ? std::string_view(event->name) : std::string_view();
+        const std::string path = JoinPath(it->second.path, name);
+        for (const auto& watch : watches) {
+          if (watch->name.empty() || watch->name == name) {
+            calls.emplace_back(watch.get(), path, change);
+          }
+        }
+      }
+    }
+
+    // Watches cannot be removed while the dispatch lock is held, so they can
+    // be called without holding the watch lock.
+    for (const auto& [watch, path, change] : calls) {
+      watch->callback(absl::StrCat(watch->protocol_name, ":", path), change);
+    }
+    calls.clear();
+    ended_watches.clear();
+  }
+}
+
+#else  // __linux__
+
+bool LocalFileProtocol::DoWatch(std::string_view protocol_name,
+                                std::string_view path, WatchId id,
+                                WatchCallback callback) {
+  return false;
+}
+
+void LocalFileProtocol::DoUnwatch(WatchId id) {}
+
+void LocalFileProtocol::WatchThread(int watch_fd, int wake_fd) {}
+
+#endif  // __linux__
+
 std::string LocalFileProtocol::DoGetCurrentPath(
     std::string_view protocol_name) {
   std::error_code error;
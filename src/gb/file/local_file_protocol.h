@@ -6,8 +6,15 @@
 #ifndef GB_FILE_LOCAL_FILE_PROTOCOL_H_
 #define GB_FILE_LOCAL_FILE_PROTOCOL_H_
 
+#include <deque>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "gb/base/validated_context.h"
 #include "gb/file/file_protocol.h"
 
@@ -25,11 +32,47 @@ namespace gb {
 // invalid when queried with GetPathInfo(). The existence of these types of
 // files can interfere with folder copying and deletion.
 //
+// On POSIX platforms, files are accessed directly via file descriptors with
+// positional reads and writes, and buffered in user-space (see
+// kConstraintBufferSize). Files opened for reading are hinted to the operating
+// system as being read sequentially.
+//
+// Files opened with FileFlag::kMapped are memory mapped in their entirety (on
+// platforms that support it), so reads are served directly from the operating
+// system's page cache.
+//
+// On POSIX platforms, listing and copying folders reads each folder's entries
+// in large batches without querying every entry separately. Recursive listing
+// and folder copies walk sub-folders and copy files on several threads at once
+// (see kConstraintFolderThreadCount).
+//
+// Asynchronous reads (see FileSystem::ReadFileAsync) are completed by a small
+// pool of threads owned by the protocol (see kConstraintAsyncThreadCount), so
+// disk latency can overlap with work on the calling thread. Pending reads are
+// always completed before the protocol is destroyed.
+//
+// On Linux, watches (see FileSystem::Watch) are implemented with inotify, so
+// no polling is done. Callbacks are called on a thread owned by the protocol,
+// which is started when the first watch is added. Writes are reported when the
+// written file is closed. Files are watched through the folder containing them,
+// so a watch on a file continues when the file is deleted and recreated, or
+// replaced by renaming another file over it. A watch ends once its folder (or
+// the folder containing the watched file) is deleted or moved, which is
+// reported as kDeleted for the watched path. If the operating system drops
+// events, kModified is reported for every watched path, so anything depending
+// on them can be rescanned. Watching is not supported on other platforms.
+//
 // This class is thread-safe.
 class LocalFileProtocol : public FileProtocol {
  public:
+#ifdef __linux__
+  static constexpr FileProtocolFlags kDefaultFlags = {
+      kReadWriteFileProtocolFlags, FileProtocolFlag::kCurrentPath,
+      FileProtocolFlag::kWatch};
+#else
   static constexpr FileProtocolFlags kDefaultFlags = {
       kReadWriteFileProtocolFlags, FileProtocolFlag::kCurrentPath};
+#endif  // __linux__
 
   // Flags can be set to limit what operations are allowed when this protocol is
   // added to a FileSystem. By default, all operations are supported.
@@ -63,10 +106,44 @@ class LocalFileProtocol : public FileProtocol {
   static GB_CONTEXT_CONSTRAINT_NAMED(kConstraintDeleteAtExit, kInOptional, bool,
                                      kKeyDeleteAtExit);
 
+  // Size in bytes of the user-space buffer used for each open file. Files
+  // opened only for reading use a smaller buffer if the file is smaller. This
+  // may be set to zero to disable buffering. This is ignored on Windows.
+  static inline constexpr const char* kKeyBufferSize = "buffer_size";
+  static inline constexpr int kDefaultBufferSize = 64 * 1024;
+  static GB_CONTEXT_CONSTRAINT_NAMED_DEFAULT(kConstraintBufferSize, kInOptional,
+                                             int, kKeyBufferSize,
+                                             kDefaultBufferSize);
+
+  // Number of threads used to complete asynchronous reads. The threads are
+  // started on the first asynchronous read. This may be set to zero, in which
+  // case asynchronous reads complete on the calling thread.
+  static inline constexpr const char* kKeyAsyncThreadCount =
+      "async_thread_count";
+  static inline constexpr int kDefaultAsyncThreadCount = 2;
+  static GB_CONTEXT_CONSTRAINT_NAMED_DEFAULT(kConstraintAsyncThreadCount,
+                                             kInOptional, int,
+                                             kKeyAsyncThreadCount,
+                                             kDefaultAsyncThreadCount);
+
+  // Number of threads (including the calling thread) used to walk folders
+  // when listing recursively or copying folders. This may be set to one, in
+  // which case folders are only walked on the calling thread. This is ignored
+  // on Windows.
+  static inline constexpr const char* kKeyFolderThreadCount =
+      "folder_thread_count";
+  static inline constexpr int kDefaultFolderThreadCount = 4;
+  static GB_CONTEXT_CONSTRAINT_NAMED_DEFAULT(kConstraintFolderThreadCount,
+                                             kInOptional, int,
+                                             kKeyFolderThreadCount,
+                                             kDefaultFolderThreadCount);
+
   // Contract for creating a new LocalFileProtocol.
   using Contract =
       ContextContract<kConstraintFlags, kConstraintRoot, kConstraintUniqueRoot,
-                      kConstraintDeleteAtExit>;
+                      kConstraintDeleteAtExit, kConstraintBufferSize,
+                      kConstraintAsyncThreadCount,
+                      kConstraintFolderThreadCount>;
 
   // Creates a new LocalFileProtocol.
   //
@@ -111,18 +188,70 @@ class LocalFileProtocol : public FileProtocol {
   std::unique_ptr<RawFile> DoOpenFile(std::string_view protocol_name,
                                       std::string_view path,
                                       FileFlags flags) override;
+  void DoReadFileAsync(std::string_view protocol_name, std::string_view path,
+                       int64_t offset, void* buffer, int64_t size,
+                       ReadFileCallback callback) override;
+  bool DoWatch(std::string_view protocol_name, std::string_view path,
+               WatchId id, WatchCallback callback) override;
+  void DoUnwatch(WatchId id) override;
   std::string DoGetCurrentPath(std::string_view protocol_name) override;
   bool DoSetCurrentPath(std::string_view protocol_name,
                         std::string_view path) override;
 
  private:
+  struct AsyncRead {
+    std::string path;  // Full local path to the file.
+    int64_t offset;
+    void* buffer;
+    int64_t size;
+    ReadFileCallback callback;
+  };
+
+  struct Watch {
+    WatchId id;
+    std::string protocol_name;
+    std::string path;  // Watched path within the protocol.
+    std::string name;  // Filename of a watched file, or empty for a folder.
+    WatchCallback callback;
+  };
+
+  // All watches within the same folder, which share an operating system watch.
+  struct WatchedPath {
+    std::string path;  // Folder path within the protocol.
+    std::vector<std::unique_ptr<Watch>> watches;
+  };
+
   explicit LocalFileProtocol(std::string_view root,
                              const ValidatedContext& context);
 
+  void AsyncReadThread();
+  void WatchThread(int watch_fd, int wake_fd);
+
   const FileProtocolFlags flags_;
   const std::string root_;
   const bool unique_root_;
   const bool delete_at_exit_;
+  const int64_t buffer_size_;
+  const int async_thread_count_;
+  const int folder_thread_count_;
+
+  absl::Mutex async_mutex_;
+  std::deque<AsyncRead> async_reads_ ABSL_GUARDED_BY(async_mutex_);
+  std::vector<std::thread> async_threads_ ABSL_GUARDED_BY(async_mutex_);
+  bool async_exit_ ABSL_GUARDED_BY(async_mutex_) = false;
+
+  // Held while watch callbacks are called, so watches are only removed when
+  // they are not in use.
+  absl::Mutex dispatch_mutex_;
+
+  absl::Mutex watch_mutex_ ABSL_ACQUIRED_AFTER(dispatch_mutex_);
+  int watch_fd_ ABSL_GUARDED_BY(watch_mutex_) = -1;
+  int wake_fds_[2] ABSL_GUARDED_BY(watch_mutex_) = {-1, -1};
+  std::thread watch_thread_ ABSL_GUARDED_BY(watch_mutex_);
+  absl::flat_hash_map<int, WatchedPath> watched_paths_
+      ABSL_GUARDED_BY(watch_mutex_);  // By operating system watch.
+  absl::flat_hash_map<WatchId, int> watch_descriptors_
+      ABSL_GUARDED_BY(watch_mutex_);
 };
 
 }  // namespace gb
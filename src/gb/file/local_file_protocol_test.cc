@@ -5,17 +5,26 @@
 
 #include "gb/file/local_file_protocol.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "absl/log/log.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "gb/base/context_builder.h"
 #include "gb/base/scoped_call.h"
 #include "gb/file/common_protocol_test.h"
 #include "gb/file/file_system.h"
 #include "gb/file/path.h"
 #include "gb/test/test_util.h"
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
 namespace gb {
@@ -23,6 +32,10 @@ namespace {
 
 namespace fs = std::filesystem;
 
+using ::testing::Contains;
+using ::testing::Not;
+using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
 using ::testing::Values;
 
 std::unique_ptr<FileProtocol> LocalFileProtocolFactory(
@@ -228,5 +241,431 @@ TEST(LocalFileProtocolTest, DeleteAtExit) {
   EXPECT_FALSE(fs::is_directory(unique_dir, error));
 }
 
+TEST(LocalFileProtocolTest, MappedFile) {
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(LocalFileProtocol::CreateTemp("gbtest")));
+  ASSERT_TRUE(file_system.WriteFile("file:/file", "0123456789"));
+  ASSERT_TRUE(file_system.WriteFile("file:/empty", ""));
+
+  EXPECT_EQ(file_system.OpenFile("file:/file",
+                                 {FileFlag::kWrite, FileFlag::kMapped}),
+            nullptr);
+
+  auto file =
+      file_system.OpenFile("file:/file", {FileFlag::kRead, FileFlag::kMapped});
+  ASSERT_NE(file, nullptr);
+  auto view = file->GetMappedView();
+  EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(view.data()),
+                             view.size()),
+            "0123456789");
+
+  // Regular reads and seeks still work as expected.
+  EXPECT_EQ(file->ReadString(4), "0123");
+  EXPECT_EQ(file->SeekTo(8), 8);
+  EXPECT_EQ(file->ReadString(4), "89");
+  EXPECT_EQ(file->SeekBy(-5), 5);
+  EXPECT_EQ(file->ReadRemainingString(), "56789");
+  char buffer[4] = {};
+  EXPECT_EQ(file->ReadAt(7, buffer, 4), 3);
+  EXPECT_EQ(std::string_view(buffer, 3), "789");
+  EXPECT_EQ(file->SeekTo(100), 10);
+  EXPECT_EQ(file->WriteString("abc"), 0);
+  EXPECT_EQ(file->GetMappedView().data(), view.data());
+  file.reset();
+
+  file =
+      file_system.OpenFile("file:/empty", {FileFlag::kRead, FileFlag::kMapped});
+  ASSERT_NE(file, nullptr);
+  EXPECT_TRUE(file->GetMappedView().empty());
+  EXPECT_EQ(file->ReadRemainingString(), "");
+  file.reset();
+
+  // Files not opened for mapping do not return a view.
+  file = file_system.OpenFile("file:/file", kReadFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_TRUE(file->GetMappedView().empty());
+}
+
+TEST(LocalFileProtocolTest, BufferedReadWrite) {
+  for (int buffer_size : {0, 1, 4, LocalFileProtocol::kDefaultBufferSize}) {
+    SCOPED_TRACE(absl::StrCat("buffer_size=", buffer_size));
+    FileSystem file_system;
+    auto temp = LocalFileProtocol::CreateTemp("gbtest");
+    ASSERT_NE(temp, nullptr);
+    auto protocol = LocalFileProtocol::Create(
+        ContextBuilder()
+            .SetValue<std::string>(LocalFileProtocol::kKeyRoot,
+                                   temp->GetRoot())
+            .SetValue<int>(LocalFileProtocol::kKeyBufferSize, buffer_size)
+            .Build());
+    ASSERT_TRUE(file_system.Register(std::move(protocol)));
+
+    auto file = file_system.OpenFile("file:/file",
+                                     kNewFileFlags + FileFlag::kRead);
+    ASSERT_NE(file, nullptr);
+    EXPECT_EQ(file->WriteString("0123"), 4);
+    EXPECT_EQ(file->WriteString("456789"), 6);
+    EXPECT_EQ(file->SeekEnd(), 10);
+    EXPECT_EQ(file->SeekTo(2), 2);
+    EXPECT_EQ(file->ReadString(3), "234");
+    EXPECT_EQ(file->WriteString("ab"), 2);
+    EXPECT_EQ(file->SeekBegin(), 0);
+    EXPECT_EQ(file->ReadString(20), "01234ab789");
+    EXPECT_EQ(file->SeekTo(100), 10);
+    EXPECT_EQ(file->WriteString("cd"), 2);
+    EXPECT_EQ(file->SeekTo(8), 8);
+    EXPECT_EQ(file->ReadRemainingString(), "89cd");
+
+    // Positional reads see pending writes and do not change the position.
+    EXPECT_EQ(file->WriteString("ef"), 2);
+    std::string buffer(4, '\0');
+    EXPECT_EQ(file->ReadAt(10, buffer.data(), 4), 4);
+    EXPECT_EQ(buffer, "cdef");
+    EXPECT_EQ(file->GetPosition(), 14);
+
+    // Vectored writes are written in order after pending writes.
+    EXPECT_EQ(file->WriteString("g"), 1);
+    const std::string_view parts[] = {"hi", "", "jkl"};
+    std::vector<absl::Span<const uint8_t>> buffers;
+    for (std::string_view part : parts) {
+      buffers.emplace_back(reinterpret_cast<const uint8_t*>(part.data()),
+                           part.size());
+    }
+    EXPECT_EQ(file->WriteV(buffers), 5);
+    EXPECT_EQ(file->GetPosition(), 20);
+    EXPECT_EQ(file->SeekTo(12), 12);
+    EXPECT_EQ(file->ReadRemainingString(), "efghijkl");
+    file.reset();
+
+    std::string contents;
+    EXPECT_TRUE(file_system.ReadFile("file:/file", &contents));
+    EXPECT_EQ(contents, "01234ab789cdefghijkl");
+  }
+}
+
+TEST(LocalFileProtocolTest, ReadFileAsyncThreads) {
+  for (int thread_count : {0, 1, LocalFileProtocol::kDefaultAsyncThreadCount}) {
+    SCOPED_TRACE(absl::StrCat("thread_count=", thread_count));
+    auto file_system = std::make_unique<FileSystem>();
+    auto temp = LocalFileProtocol::CreateTemp("gbtest");
+    ASSERT_NE(temp, nullptr);
+    auto protocol = LocalFileProtocol::Create(
+        ContextBuilder()
+            .SetValue<std::string>(LocalFileProtocol::kKeyRoot,
+                                   temp->GetRoot())
+            .SetValue<int>(LocalFileProtocol::kKeyAsyncThreadCount,
+                           thread_count)
+            .Build());
+    ASSERT_TRUE(file_system->Register(std::move(protocol)));
+    ASSERT_TRUE(file_system->WriteFile("file:/file", "0123456789"));
+
+    // Reads still pending are completed when the protocol is destroyed.
+    static constexpr int kReadCount = 10;
+    std::vector<std::string> buffers(kReadCount, std::string(4, '\0'));
+    std::vector<int64_t> results(kReadCount, -2);
+    std::vector<std::thread::id> thread_ids(kReadCount);
+    for (int i = 0; i < kReadCount; ++i) {
+      EXPECT_TRUE(file_system->ReadFileAsync(
+          "file:/file", i, buffers[i].data(), 4,
+          [&results, &thread_ids, i](int64_t bytes_read) {
+            results[i] = bytes_read;
+            thread_ids[i] = std::this_thread::get_id();
+          }));
+    }
+    file_system.reset();
+    for (int i = 0; i < kReadCount; ++i) {
+      EXPECT_EQ(results[i], std::min(4, 10 - i));
+      EXPECT_EQ(buffers[i].substr(0, results[i]),
+                std::string("0123456789").substr(i, 4));
+      if (thread_count == 0) {
+        EXPECT_EQ(thread_ids[i], std::this_thread::get_id());
+      } else {
+        EXPECT_NE(thread_ids[i], std::this_thread::get_id());
+      }
+    }
+  }
+}
+
+// Records changes reported to watch callbacks on the watch thread.
+class WatchRecorder {
+ public:
+  WatchCallback Callback() {
+    return [this](std::string_view path, PathChange change) {
+      absl::MutexLock lock(&mutex_);
+      changes_.emplace_back(path, change);
+    };
+  }
+
+  // Waits until the change has been reported, returning false on timeout.
+  bool WaitFor(std::string_view path, PathChange change) {
+    const std::pair<std::string, PathChange> expected(path, change);
+    auto has_change = [this, &expected]() ABSL_NO_THREAD_SAFETY_ANALYSIS {
+      return std::find(changes_.begin(), changes_.end(), expected) !=
+             changes_.end();
+    };
+    absl::MutexLock lock(&mutex_);
+    return mutex_.AwaitWithTimeout(absl::Condition(&has_change),
+                                   absl::Seconds(10));
+  }
+
+  std::vector<std::pair<std::string, PathChange>> TakeChanges() {
+    absl::MutexLock lock(&mutex_);
+    return std::move(changes_);
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::pair<std::string, PathChange>> changes_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+TEST(LocalFileProtocolTest, Watch) {
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(LocalFileProtocol::CreateTemp("gbtest")));
+  if (!file_system.GetFlags("file").IsSet(FileProtocolFlag::kWatch)) {
+    GTEST_SKIP() << "Watching is not supported on this platform";
+  }
+  ASSERT_TRUE(file_system.CreateFolder("file:/folder", FolderMode::kNormal));
+  ASSERT_TRUE(file_system.WriteFile("file:/folder/file", "contents"));
+  ASSERT_TRUE(file_system.WriteFile("file:/other", "other"));
+
+  WatchRecorder recorder;
+  EXPECT_EQ(file_system.Watch("file:/missing", recorder.Callback()),
+            kNoWatchId);
+  const WatchId folder_id =
+      file_system.Watch("file:/folder", recorder.Callback());
+  ASSERT_NE(folder_id, kNoWatchId);
+  const WatchId other_id =
+      file_system.Watch("file:/other", recorder.Callback());
+  ASSERT_NE(other_id, kNoWatchId);
+
+  ASSERT_TRUE(file_system.WriteFile("file:/folder/new", "new"));
+  EXPECT_TRUE(recorder.WaitFor("file:/folder/new", PathChange::kCreated));
+  EXPECT_TRUE(recorder.WaitFor("file:/folder/new", PathChange::kModified));
+  ASSERT_TRUE(file_system.WriteFile("file:/folder/file", "changed"));
+  EXPECT_TRUE(recorder.WaitFor("file:/folder/file", PathChange::kModified));
+  ASSERT_TRUE(file_system.DeleteFile("file:/folder/new"));
+  EXPECT_TRUE(recorder.WaitFor("file:/folder/new", PathChange::kDeleted));
+
+  // Changes are reported in order, so once the other file change is seen, any
+  // change to the unwatched folder would have been seen as well.
+  file_system.Unwatch(folder_id);
+  recorder.TakeChanges();
+  ASSERT_TRUE(file_system.WriteFile("file:/folder/file", "unwatched"));
+  ASSERT_TRUE(file_system.WriteFile("file:/other", "changed"));
+  EXPECT_TRUE(recorder.WaitFor("file:/other", PathChange::kModified));
+  for (const auto& [path, change] : recorder.TakeChanges()) {
+    EXPECT_EQ(path, "file:/other");
+  }
+  file_system.Unwatch(other_id);
+}
+
+TEST(LocalFileProtocolTest, WatchFile) {
+  FileSystem file_system;
+  auto protocol = LocalFileProtocol::CreateTemp("gbtest");
+  ASSERT_NE(protocol, nullptr);
+  const fs::path root = protocol->GetRoot();
+  ASSERT_TRUE(file_system.Register(std::move(protocol)));
+  if (!file_system.GetFlags("file").IsSet(FileProtocolFlag::kWatch)) {
+    GTEST_SKIP() << "Watching is not supported on this platform";
+  }
+  ASSERT_TRUE(file_system.CreateFolder("file:/folder", FolderMode::kNormal));
+  ASSERT_TRUE(file_system.WriteFile("file:/folder/watched", "contents"));
+
+  WatchRecorder recorder;
+  const WatchId id =
+      file_system.Watch("file:/folder/watched", recorder.Callback());
+  ASSERT_NE(id, kNoWatchId);
+
+  // The watch continues when the file is deleted and recreated, and only the
+  // watched file is reported.
+  ASSERT_TRUE(file_system.DeleteFile("file:/folder/watched"));
+  EXPECT_TRUE(recorder.WaitFor("file:/folder/watched", PathChange::kDeleted));
+  ASSERT_TRUE(file_system.WriteFile("file:/folder/other", "other"));
+  ASSERT_TRUE(file_system.WriteFile("file:/folder/watched", "recreated"));
+  EXPECT_TRUE(recorder.WaitFor("file:/folder/watched", PathChange::kCreated));
+  EXPECT_TRUE(recorder.WaitFor("file:/folder/watched", PathChange::kModified));
+
+  // Saving by writing a temporary file and renaming it over the watched file
+  // is reported as the file being created.
+  recorder.TakeChanges();
+  ASSERT_TRUE(file_system.WriteFile("file:/folder/watched.tmp", "saved"));
+  std::error_code error;
+  fs::rename(root / "folder" / "watched.tmp", root / "folder" / "watched",
+             error);
+  ASSERT_FALSE(error) << error.message();
+  EXPECT_TRUE(recorder.WaitFor("file:/folder/watched", PathChange::kCreated));
+  for (const auto& [path, change] : recorder.TakeChanges()) {
+    EXPECT_EQ(path, "file:/folder/watched");
+  }
+
+  // Deleting the folder ends the watch, after reporting the file as deleted.
+  ASSERT_TRUE(file_system.DeleteFolder("file:/folder", FolderMode::kRecursive));
+  EXPECT_TRUE(recorder.WaitFor("file:/folder/watched", PathChange::kDeleted));
+  file_system.Unwatch(id);
+}
+
+//------------------------------------------------------------------------------
+// Benchmark
+//------------------------------------------------------------------------------
+
+// Reads the file in "read_size" chunks at each offset with the provided read
+// function, returning the time taken.
+template <typename ReadFunction>
+absl::Duration RunReadBenchmark(const std::vector<int64_t>& offsets,
+                                int64_t read_size, ReadFunction read) {
+  std::vector<char> buffer(static_cast<size_t>(read_size));
+  int64_t total = 0;
+  const absl::Time start_time = absl::Now();
+  for (int64_t offset : offsets) {
+    total += read(offset, buffer.data(), read_size);
+  }
+  const absl::Duration duration = absl::Now() - start_time;
+  EXPECT_EQ(total, static_cast<int64_t>(offsets.size()) * read_size);
+  return duration;
+}
+
+TEST(LocalFileProtocolTest, FolderThreads) {
+  for (int thread_count : {1, LocalFileProtocol::kDefaultFolderThreadCount}) {
+    SCOPED_TRACE(absl::StrCat("thread_count=", thread_count));
+    FileSystem file_system;
+    auto temp = LocalFileProtocol::CreateTemp("gbtest");
+    ASSERT_NE(temp, nullptr);
+    auto protocol = LocalFileProtocol::Create(
+        ContextBuilder()
+            .SetValue<std::string>(LocalFileProtocol::kKeyRoot,
+                                   temp->GetRoot())
+            .SetValue<int>(LocalFileProtocol::kKeyFolderThreadCount,
+                           thread_count)
+            .Build());
+    ASSERT_TRUE(file_system.Register(std::move(protocol)));
+
+    // Build a tree of folders, each with a few files.
+    std::vector<std::string> folders, files;
+    for (int i = 0; i < 4; ++i) {
+      folders.push_back(absl::StrCat("file:/tree/", i));
+      for (int j = 0; j < 4; ++j) {
+        folders.push_back(absl::StrCat("file:/tree/", i, "/", j));
+      }
+    }
+    for (const std::string& folder : folders) {
+      ASSERT_TRUE(file_system.CreateFolder(folder, FolderMode::kRecursive));
+      for (int k = 0; k < 3; ++k) {
+        files.push_back(absl::StrCat(folder, "/file", k, ".txt"));
+        ASSERT_TRUE(file_system.WriteFile(files.back(), files.back()));
+      }
+    }
+
+    std::vector<std::string> expected = folders;
+    expected.insert(expected.end(), files.begin(), files.end());
+    EXPECT_THAT(file_system.List("file:/tree", FolderMode::kRecursive),
+                UnorderedElementsAreArray(expected));
+    EXPECT_THAT(file_system.ListFiles("file:/tree", FolderMode::kRecursive),
+                UnorderedElementsAreArray(files));
+    EXPECT_EQ(
+        file_system.List("file:/tree", "file1.*", FolderMode::kRecursive)
+            .size(),
+        folders.size());
+    EXPECT_THAT(file_system.List("file:/tree/0"),
+                UnorderedElementsAre("file:/tree/0/0", "file:/tree/0/1",
+                                     "file:/tree/0/2", "file:/tree/0/3",
+                                     "file:/tree/0/file0.txt",
+                                     "file:/tree/0/file1.txt",
+                                     "file:/tree/0/file2.txt"));
+
+    ASSERT_TRUE(file_system.CopyFolder("file:/tree", "file:/copy"));
+    EXPECT_EQ(file_system.List("file:/copy", FolderMode::kRecursive).size(),
+              expected.size());
+    for (const std::string& file : files) {
+      std::string contents;
+      std::string copy = absl::StrCat("file:/copy", file.substr(10));
+      EXPECT_TRUE(file_system.ReadFile(copy, &contents)) << copy;
+      EXPECT_EQ(contents, file);
+    }
+
+#ifndef _WIN32
+    // Symbolic links to folders are listed, but not followed.
+    std::error_code error;
+    fs::create_directory_symlink(fs::path(temp->GetRoot()) / "tree" / "0",
+                                 fs::path(temp->GetRoot()) / "link", error);
+    ASSERT_FALSE(error);
+    EXPECT_EQ(file_system.GetPathInfo("file:/link").type, PathType::kFolder);
+    EXPECT_THAT(file_system.ListFolders("file:/", FolderMode::kRecursive),
+                Contains("file:/link"));
+    EXPECT_THAT(file_system.List("file:/", FolderMode::kRecursive),
+                Not(Contains("file:/link/file0.txt")));
+#endif  // _WIN32
+  }
+}
+
+TEST(LocalFileProtocolTest, ReadBenchmark) {
+  static constexpr int64_t kFileSize = 16 * 1024 * 1024;
+  FileSystem file_system;
+  auto protocol = LocalFileProtocol::CreateTemp("gbtest");
+  ASSERT_NE(protocol, nullptr);
+  const fs::path file_path = fs::path(JoinPath(protocol->GetRoot(), "file"));
+  ASSERT_TRUE(file_system.Register(std::move(protocol)));
+  ASSERT_TRUE(file_system.WriteFile(
+      "file:/file", std::string(static_cast<size_t>(kFileSize), 'x')));
+
+  struct Pattern {
+    const char* name;
+    int64_t read_size;
+    bool random;
+  };
+  for (const Pattern& pattern : {Pattern{"sequential", 4096, false},
+                                 Pattern{"random", 16, true}}) {
+    std::vector<int64_t> offsets;
+    std::mt19937 generator(1234);
+    std::uniform_int_distribution<int64_t> random(
+        0, kFileSize - pattern.read_size);
+    const int64_t count =
+        pattern.random ? 100000 : kFileSize / pattern.read_size;
+    for (int64_t i = 0; i < count; ++i) {
+      offsets.push_back(pattern.random ? random(generator)
+                                       : i * pattern.read_size);
+    }
+
+    std::fstream stream(file_path, std::fstream::binary | std::fstream::in);
+    ASSERT_TRUE(stream.good());
+    const absl::Duration fstream_time = RunReadBenchmark(
+        offsets, pattern.read_size,
+        [&stream](int64_t offset, char* buffer, int64_t size) -> int64_t {
+          if (stream.tellg() != offset) {
+            stream.seekg(offset);
+          }
+          stream.read(buffer, size);
+          return stream.gcount();
+        });
+
+    auto file = file_system.OpenFile("file:/file", kReadFileFlags);
+    ASSERT_NE(file, nullptr);
+    const absl::Duration file_time = RunReadBenchmark(
+        offsets, pattern.read_size,
+        [&file](int64_t offset, char* buffer, int64_t size) {
+          if (file->GetPosition() != offset) {
+            file->SeekTo(offset);
+          }
+          return file->Read(buffer, size);
+        });
+
+    auto mapped_file = file_system.OpenFile(
+        "file:/file", {FileFlag::kRead, FileFlag::kMapped});
+    ASSERT_NE(mapped_file, nullptr);
+    const absl::Duration mapped_time = RunReadBenchmark(
+        offsets, pattern.read_size,
+        [&mapped_file](int64_t offset, char* buffer, int64_t size) {
+          if (mapped_file->GetPosition() != offset) {
+            mapped_file->SeekTo(offset);
+          }
+          return mapped_file->Read(buffer, size);
+        });
+
+    LOG(INFO) << pattern.name << " " << count << " x " << pattern.read_size
+              << " byte reads: fstream=" << fstream_time
+              << ", file=" << file_time << ", mapped=" << mapped_time;
+  }
+}
+
 }  // namespace
 }  // namespace gb
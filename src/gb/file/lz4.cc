@@ -0,0 +1,216 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/lz4.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gb {
+
+namespace {
+
+// Block format constants defined by the LZ4 block format specification.
+inline constexpr int64_t kMinMatch = 4;
+inline constexpr int64_t kLastLiterals = 5;  // Blocks end with 5 literals.
+inline constexpr int64_t kMatchStartLimit = 12;  // Last match start from end.
+inline constexpr int64_t kMaxOffset = 65535;
+inline constexpr int64_t kMaxTokenLength = 15;
+
+// Number of bits in the hash table used to find matches.
+inline constexpr int kHashLog = 12;
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t value) {
+  return (value * 2654435761u) >> (32 - kHashLog);
+}
+
+int64_t GetLengthSize(int64_t length) {
+  return length >= kMaxTokenLength ? (length - kMaxTokenLength) / 255 + 1 : 0;
+}
+
+uint8_t* WriteLength(uint8_t* out, int64_t length) {
+  length -= kMaxTokenLength;
+  while (length >= 255) {
+    *out++ = 255;
+    length -= 255;
+  }
+  *out++ = static_cast<uint8_t>(length);
+  return out;
+}
+
+// Writes a sequence of literals followed by a match. If match_length is zero,
+// this is the final sequence of the block, which only contains literals.
+//
+// Returns null if the sequence does not fit in the output.
+uint8_t* WriteSequence(uint8_t* out, uint8_t* out_end, const uint8_t* literals,
+                       int64_t literal_length, int64_t offset,
+                       int64_t match_length) {
+  if (match_length > 0) {
+    match_length -= kMinMatch;
+  }
+  int64_t size = 1 + GetLengthSize(literal_length) + literal_length;
+  if (offset > 0) {
+    size += 2 + GetLengthSize(match_length);
+  }
+  if (size > out_end - out) {
+    return nullptr;
+  }
+
+  uint8_t* token = out++;
+  *token = static_cast<uint8_t>(std::min(literal_length, kMaxTokenLength) << 4);
+  if (literal_length >= kMaxTokenLength) {
+    out = WriteLength(out, literal_length);
+  }
+  std::memcpy(out, literals, static_cast<size_t>(literal_length));
+  out += literal_length;
+  if (offset == 0) {
+    return out;
+  }
+  *out++ = static_cast<uint8_t>(offset & 0xFF);
+  *out++ = static_cast<uint8_t>(offset >> 8);
+  *token |= static_cast<uint8_t>(std::min(match_length, kMaxTokenLength));
+  if (match_length >= kMaxTokenLength) {
+    out = WriteLength(out, match_length);
+  }
+  return out;
+}
+
+// Reads a length extension, adding it to "length". Returns false if the input
+// ends before the length does.
+bool ReadLength(const uint8_t** in, const uint8_t* in_end, int64_t* length) {
+  uint8_t value;
+  do {
+    if (*in == in_end) {
+      return false;
+    }
+    value = *(*in)++;
+    *length += value;
+  } while (value == 255);
+  return true;
+}
+
+}  // namespace
+
+int64_t Lz4CompressBound(int64_t size) { return size + size / 255 + 16; }
+
+int64_t Lz4Compress(const void* src, int64_t src_size, void* dst,
+                    int64_t dst_capacity) {
+  const uint8_t* const begin = static_cast<const uint8_t*>(src);
+  const uint8_t* const end = begin + src_size;
+  uint8_t* out = static_cast<uint8_t*>(dst);
+  uint8_t* const out_end = out + dst_capacity;
+  const uint8_t* anchor = begin;
+
+  if (src_size > kMatchStartLimit) {
+    const uint8_t* const match_start_limit = end - kMatchStartLimit;
+    const uint8_t* const match_end_limit = end - kLastLiterals;
+    const uint8_t* table[1 << kHashLog] = {};
+    const uint8_t* in = begin;
+    int64_t misses = 0;
+    while (in < match_start_limit) {
+      const uint32_t value = Read32(in);
+      const uint8_t*& entry = table[Hash(value)];
+      const uint8_t* match = entry;
+      entry = in;
+      if (match == nullptr || in - match > kMaxOffset ||
+          Read32(match) != value) {
+        // Step faster through data that is not compressing well.
+        in += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+
+      while (in > anchor && match > begin && in[-1] == match[-1]) {
+        --in;
+        --match;
+      }
+      int64_t length = kMinMatch;
+      while (in + length < match_end_limit && in[length] == match[length]) {
+        ++length;
+      }
+      out = WriteSequence(out, out_end, anchor, in - anchor, in - match,
+                          length);
+      if (out == nullptr) {
+        return 0;
+      }
+      in += length;
+      anchor = in;
+      if (in < match_start_limit) {
+        table[Hash(Read32(in - 2))] = in - 2;
+      }
+    }
+  }
+
+  out = WriteSequence(out, out_end, anchor, end - anchor, 0, 0);
+  if (out == nullptr) {
+    return 0;
+  }
+  return out - static_cast<uint8_t*>(dst);
+}
+
+int64_t Lz4Decompress(const void* src, int64_t src_size, void* dst,
+                      int64_t dst_capacity) {
+  const uint8_t* in = static_cast<const uint8_t*>(src);
+  const uint8_t* const in_end = in + src_size;
+  uint8_t* const begin = static_cast<uint8_t*>(dst);
+  uint8_t* out = begin;
+  uint8_t* const out_end = out + dst_capacity;
+
+  while (in < in_end) {
+    const uint8_t token = *in++;
+    int64_t literal_length = token >> 4;
+    if (literal_length == kMaxTokenLength &&
+        !ReadLength(&in, in_end, &literal_length)) {
+      return -1;
+    }
+    if (literal_length > in_end - in || literal_length > out_end - out) {
+      return -1;
+    }
+    std::memcpy(out, in, static_cast<size_t>(literal_length));
+    in += literal_length;
+    out += literal_length;
+    if (in == in_end) {
+      // The final sequence only contains literals.
+      break;
+    }
+
+    if (in_end - in < 2) {
+      return -1;
+    }
+    const int64_t offset = in[0] | (in[1] << 8);
+    in += 2;
+    if (offset == 0 || offset > out - begin) {
+      return -1;
+    }
+    int64_t match_length = token & 0xF;
+    if (match_length == kMaxTokenLength &&
+        !ReadLength(&in, in_end, &match_length)) {
+      return -1;
+    }
+    match_length += kMinMatch;
+    if (match_length > out_end - out) {
+      return -1;
+    }
+    const uint8_t* match = out - offset;
+    if (offset >= match_length) {
+      std::memcpy(out, match, static_cast<size_t>(match_length));
+      out += match_length;
+    } else {
+      // Overlapping matches repeat the most recent output.
+      for (int64_t i = 0; i < match_length; ++i) {
+        *out++ = *match++;
+      }
+    }
+  }
+  return out - begin;
+}
+
+}  // namespace gb
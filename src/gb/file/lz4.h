@@ -0,0 +1,42 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_FILE_LZ4_H_
+#define GB_FILE_LZ4_H_
+
+#include <stdint.h>
+
+namespace gb {
+
+// Minimal implementation of the LZ4 block format, used for compressing chunks
+// in chunk files (see ChunkCompression).
+//
+// This only implements raw blocks (not the LZ4 frame format), and favors
+// decompression speed and simplicity over compression ratio. Compressed blocks
+// can be decompressed by any conforming LZ4 block decoder, and vice versa.
+
+// Returns the maximum compressed size for a block of "size" bytes.
+int64_t Lz4CompressBound(int64_t size);
+
+// Compresses "src_size" bytes from "src" into "dst", which can hold up to
+// "dst_capacity" bytes.
+//
+// Returns the size of the compressed data, or zero if it did not fit in "dst"
+// (this never happens if dst_capacity is at least Lz4CompressBound(src_size)).
+int64_t Lz4Compress(const void* src, int64_t src_size, void* dst,
+                    int64_t dst_capacity);
+
+// Decompresses an entire compressed block of "src_size" bytes from "src" into
+// "dst", which can hold up to "dst_capacity" bytes.
+//
+// Returns the size of the decompressed data, or -1 if the compressed data is
+// invalid or does not fit in "dst". This never reads or writes outside of the
+// provided buffers, even for invalid data.
+int64_t Lz4Decompress(const void* src, int64_t src_size, void* dst,
+                      int64_t dst_capacity);
+
+}  // namespace gb
+
+#endif  // GB_FILE_LZ4_H_
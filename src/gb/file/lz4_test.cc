@@ -0,0 +1,132 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/lz4.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+std::string Compress(std::string_view data) {
+  std::string compressed(Lz4CompressBound(data.size()), 0);
+  const int64_t size = Lz4Compress(data.data(), data.size(), compressed.data(),
+                                   compressed.size());
+  EXPECT_GT(size, 0);
+  compressed.resize(size);
+  return compressed;
+}
+
+std::string Decompress(std::string_view compressed, int64_t capacity) {
+  std::string data(capacity, 0);
+  const int64_t size = Lz4Decompress(compressed.data(), compressed.size(),
+                                     data.data(), data.size());
+  EXPECT_GE(size, 0);
+  data.resize(std::max<int64_t>(size, 0));
+  return data;
+}
+
+std::string RandomString(int64_t size, int max_value = 255) {
+  std::mt19937 random(42);
+  std::uniform_int_distribution<int> distribution(0, max_value);
+  std::string result(size, 0);
+  for (char& ch : result) {
+    ch = static_cast<char>(distribution(random));
+  }
+  return result;
+}
+
+std::string TextString(int64_t size) {
+  std::string text;
+  for (int i = 0; static_cast<int64_t>(text.size()) < size; ++i) {
+    absl::StrAppend(&text, "vertex ", i % 97, " position=(", i * 3, ", ",
+                    i % 13, ", 0) normal=(0, 1, 0)\n");
+  }
+  text.resize(size);
+  return text;
+}
+
+TEST(Lz4Test, EmptyBlock) {
+  const std::string compressed = Compress("");
+  EXPECT_EQ(compressed, std::string(1, '\0'));
+  EXPECT_EQ(Decompress(compressed, 0), "");
+}
+
+TEST(Lz4Test, RoundTrip) {
+  const std::vector<std::string> tests = {
+      "a",
+      "short literal only",
+      std::string(100, 'x'),
+      std::string(1000, '\0'),
+      "abcabcabcabcabcabcabcabcabcabcabcabcabcabc",
+      RandomString(1000),
+      RandomString(10000, 3),
+      TextString(100000),
+      absl::StrCat(RandomString(300), std::string(300, 'y'), RandomString(20)),
+  };
+  for (const std::string& data : tests) {
+    SCOPED_TRACE(absl::StrCat("size=", data.size()));
+    const std::string compressed = Compress(data);
+    EXPECT_LE(compressed.size(), Lz4CompressBound(data.size()));
+    EXPECT_EQ(Decompress(compressed, data.size()), data);
+  }
+}
+
+TEST(Lz4Test, CompressesRepetitiveData) {
+  const std::string data = TextString(100000);
+  EXPECT_LT(Compress(data).size(), data.size() / 4);
+  EXPECT_LT(Compress(std::string(100000, 'z')).size(), 500);
+}
+
+TEST(Lz4Test, CompressFailsIfOutputTooSmall) {
+  const std::string data = RandomString(1000);
+  std::string compressed(data.size() - 1, 0);
+  EXPECT_EQ(Lz4Compress(data.data(), data.size(), compressed.data(),
+                        compressed.size()),
+            0);
+}
+
+TEST(Lz4Test, DecompressStandardBlock) {
+  // One literal 'a', a match of 15 at offset 1, and five final literals.
+  const std::string compressed = {0x1B, 'a', 0x01, 0x00, 0x50,
+                                  'a',  'a', 'a',  'a',  'a'};
+  EXPECT_EQ(Decompress(compressed, 100), std::string(21, 'a'));
+}
+
+TEST(Lz4Test, DecompressInvalidData) {
+  const std::string data = TextString(1000);
+  const std::string compressed = Compress(data);
+  std::string output(data.size(), 0);
+
+  // Output is too small.
+  EXPECT_EQ(Lz4Decompress(compressed.data(), compressed.size(), output.data(),
+                          data.size() - 1),
+            -1);
+
+  // Truncated input must never read or write out of bounds.
+  for (size_t size = 0; size < compressed.size(); ++size) {
+    EXPECT_LT(Lz4Decompress(compressed.data(), size, output.data(),
+                            output.size()),
+              static_cast<int64_t>(data.size()));
+  }
+
+  // Match offset is before the start of the output.
+  const std::string bad_offset = {0x10, 'a', 0x02, 0x00, 0x00};
+  EXPECT_EQ(Lz4Decompress(bad_offset.data(), bad_offset.size(), output.data(),
+                          output.size()),
+            -1);
+  const std::string zero_offset = {0x10, 'a', 0x00, 0x00, 0x00};
+  EXPECT_EQ(Lz4Decompress(zero_offset.data(), zero_offset.size(),
+                          output.data(), output.size()),
+            -1);
+}
+
+}  // namespace
+}  // namespace gb
@@ -5,116 +5,422 @@
 
 #include "gb/file/memory_file_protocol.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
+#include <utility>
 #include <vector>
 
+#include "absl/hash/hash.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
-#include "gb/base/weak_ptr.h"
+#include "gb/file/path.h"
 #include "gb/file/raw_file.h"
 
 namespace gb {
 
-struct MemoryFileProtocol::Node final : WeakScope<MemoryFileProtocol::Node> {
-  Node(PathType type)
-      : WeakScope<Node>(this), type(type), open(false), size(0) {}
-  ~Node() { InvalidateWeakPtrs(); }
+namespace {
+
+using Contents = std::vector<uint8_t>;
+
+// Returns the folder containing the path, or an empty string for the root
+// folder (whose entry is stored as the only content of this empty folder).
+std::string_view GetParentFolder(std::string_view path) {
+  if (path == "/") {
+    return {};
+  }
+  return RemoveFilename(path);
+}
+
+// Returns the prefix of all paths contained in the folder.
+std::string GetContentsPrefix(std::string_view folder) {
+  if (folder == "/") {
+    return "/";
+  }
+  return absl::StrCat(folder, "/");
+}
+
+}  // namespace
+
+//==============================================================================
+// Node
+//==============================================================================
+
+struct MemoryFileProtocol::Node final {
+  explicit Node(PathType type) : type(type) {
+    if (type == PathType::kFile) {
+      contents = std::make_shared<Contents>();
+    }
+  }
 
   const PathType type;
-  std::atomic<bool> open;
-  std::atomic<int64_t> size;
-  std::vector<uint8_t> contents;
+  std::atomic<bool> valid = true;  // Cleared when the protocol is destroyed.
+  std::atomic<int64_t> size = 0;
+
+  absl::Mutex mutex;
+  int readers ABSL_GUARDED_BY(mutex) = 0;
+  bool writer ABSL_GUARDED_BY(mutex) = false;
+
+  // Contents may be shared with copies of the file and with files open for
+  // reading, so they are only modified in place when they are not shared.
+  std::shared_ptr<Contents> contents ABSL_GUARDED_BY(mutex);
 };
 
-class MemoryFileProtocol::MemoryFile : public RawFile {
+//==============================================================================
+// ShardLock
+//==============================================================================
+
+// Locks the shard with the entry for a folder, and the shard with the contents
+// of the folder. Shards are always locked in the same order, so operations that
+// need both cannot deadlock.
+class MemoryFileProtocol::ShardLock final {
  public:
-  explicit MemoryFile(Node* node);
+  ShardLock(MemoryFileProtocol* protocol, std::string_view folder)
+      ABSL_NO_THREAD_SAFETY_ANALYSIS
+      : folder_(folder),
+        entry_shard_(protocol->GetShard(GetParentFolder(folder))),
+        contents_shard_(protocol->GetShard(folder)) {
+    Shard* first = std::min(entry_shard_, contents_shard_);
+    Shard* second = std::max(entry_shard_, contents_shard_);
+    first->mutex.Lock();
+    if (second != first) {
+      second->mutex.Lock();
+    }
+  }
+  ShardLock(const ShardLock&) = delete;
+  ShardLock& operator=(const ShardLock&) = delete;
+  ~ShardLock() ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    if (contents_shard_ != entry_shard_) {
+      contents_shard_->mutex.Unlock();
+    }
+    entry_shard_->mutex.Unlock();
+  }
+
+  // Returns the nodes that include the entry for the folder.
+  Nodes& GetEntries() const ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    return entry_shard_->nodes;
+  }
+
+  // Returns the nodes that include the contents of the folder.
+  Nodes& GetContents() const ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    return contents_shard_->nodes;
+  }
+
+  // Returns true if the folder exists.
+  bool IsFolder() const {
+    auto it = GetEntries().find(folder_);
+    return it != GetEntries().end() && it->second->type == PathType::kFolder;
+  }
+
+  // Returns true if the folder contains any files or folders.
+  bool HasContents() const {
+    const std::string prefix = GetContentsPrefix(folder_);
+    for (auto it = GetContents().lower_bound(prefix);
+         it != GetContents().end() && absl::StartsWith(it->first, prefix);
+         ++it) {
+      std::string_view item_path = it->first;
+      item_path.remove_prefix(prefix.size());
+      if (!item_path.empty() &&
+          item_path.find_first_of('/') == std::string_view::npos) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  const std::string_view folder_;
+  Shard* const entry_shard_;
+  Shard* const contents_shard_;
+};
+
+//==============================================================================
+// MemoryFile
+//==============================================================================
+
+// File opened for writing (and optionally reading), which has exclusive access
+// to the node while it is open.
+class MemoryFileProtocol::MemoryFile final : public RawFile {
+ public:
+  MemoryFile(MemoryFileProtocol* protocol, std::string_view path,
+             std::shared_ptr<Node> node, bool modified)
+      : protocol_(protocol),
+        path_(path),
+        node_(std::move(node)),
+        modified_(modified) {}
   ~MemoryFile() override;
 
   // Public overrides for RawFile.
   int64_t SeekEnd() override;
   int64_t SeekTo(int64_t position) override;
   int64_t Write(const void* buffer, int64_t size) override;
+  int64_t WriteV(absl::Span<const absl::Span<const uint8_t>> buffers) override;
   int64_t Read(void* buffer, int64_t size) override;
+  int64_t ReadAt(int64_t offset, void* buffer, int64_t size) override;
 
  private:
-  WeakPtr<Node> node_;
+  // Returns the contents for modification, copying them first if they are
+  // shared.
+  Contents& GetWritableContents() ABSL_EXCLUSIVE_LOCKS_REQUIRED(node_->mutex);
+
+  MemoryFileProtocol* const protocol_;
+  const std::string path_;
+  const std::shared_ptr<Node> node_;
   int64_t position_ = 0;
+  bool modified_;
 };
 
-MemoryFileProtocol::MemoryFile::MemoryFile(Node* node) : node_(node) {
-  node->open = true;
+MemoryFileProtocol::MemoryFile::~MemoryFile() {
+  {
+    absl::MutexLock lock(&node_->mutex);
+    node_->writer = false;
+  }
+  if (modified_ && node_->valid) {
+    protocol_->NotifyChange(path_, PathChange::kModified);
+  }
 }
 
-MemoryFileProtocol::MemoryFile::~MemoryFile() {
-  WeakLock<Node> lock(&node_);
-  Node* node = lock.Get();
-  if (node != nullptr) {
-    node->open = false;
+Contents& MemoryFileProtocol::MemoryFile::GetWritableContents() {
+  if (node_->contents.use_count() > 1) {
+    node_->contents = std::make_shared<Contents>(*node_->contents);
   }
+  return *node_->contents;
 }
 
 int64_t MemoryFileProtocol::MemoryFile::SeekEnd() {
-  WeakLock<Node> lock(&node_);
-  Node* node = lock.Get();
-  if (node == nullptr) {
+  absl::MutexLock lock(&node_->mutex);
+  if (!node_->valid) {
     position_ = -1;
   } else {
-    position_ = static_cast<int64_t>(node->contents.size());
+    position_ = static_cast<int64_t>(node_->contents->size());
   }
   return position_;
 }
 
 int64_t MemoryFileProtocol::MemoryFile::SeekTo(int64_t position) {
-  WeakLock<Node> lock(&node_);
-  Node* node = lock.Get();
-  if (node == nullptr) {
+  absl::MutexLock lock(&node_->mutex);
+  if (!node_->valid) {
     position_ = -1;
   } else {
-    position_ =
-        std::clamp(position, 0LL, static_cast<int64_t>(node->contents.size()));
+    position_ = std::clamp(position, int64_t{0},
+                           static_cast<int64_t>(node_->contents->size()));
   }
   return position_;
 }
 
 int64_t MemoryFileProtocol::MemoryFile::Write(const void* buffer,
                                               int64_t size) {
-  WeakLock<Node> lock(&node_);
-  Node* node = lock.Get();
-  if (node == nullptr) {
+  const absl::Span<const uint8_t> span(static_cast<const uint8_t*>(buffer),
+                                       static_cast<size_t>(size));
+  return WriteV(absl::MakeConstSpan(&span, 1));
+}
+
+int64_t MemoryFileProtocol::MemoryFile::WriteV(
+    absl::Span<const absl::Span<const uint8_t>> buffers) {
+  absl::MutexLock lock(&node_->mutex);
+  if (!node_->valid) {
     position_ = -1;
     return 0;
   }
-  if (position_ + size > static_cast<int64_t>(node->contents.size())) {
-    node->contents.resize(position_ + size);
-    node->size = position_ + size;
+  int64_t size = 0;
+  for (absl::Span<const uint8_t> buffer : buffers) {
+    size += static_cast<int64_t>(buffer.size());
+  }
+  Contents& contents = GetWritableContents();
+  modified_ = true;
+  if (position_ + size > static_cast<int64_t>(contents.size())) {
+    contents.resize(position_ + size);
+    node_->size = position_ + size;
+  }
+  for (absl::Span<const uint8_t> buffer : buffers) {
+    if (!buffer.empty()) {
+      std::memcpy(contents.data() + position_, buffer.data(), buffer.size());
+      position_ += static_cast<int64_t>(buffer.size());
+    }
   }
-  std::memcpy(node->contents.data() + position_, buffer, size);
-  position_ += size;
   return size;
 }
 
 int64_t MemoryFileProtocol::MemoryFile::Read(void* buffer, int64_t size) {
-  WeakLock<Node> lock(&node_);
-  Node* node = lock.Get();
-  if (node == nullptr) {
+  absl::MutexLock lock(&node_->mutex);
+  if (!node_->valid) {
     position_ = -1;
     return 0;
   }
-  if (position_ + size > static_cast<int64_t>(node->contents.size())) {
-    size = static_cast<int64_t>(node->contents.size()) - position_;
+  const Contents& contents = *node_->contents;
+  if (position_ + size > static_cast<int64_t>(contents.size())) {
+    size = static_cast<int64_t>(contents.size()) - position_;
   }
-  std::memcpy(buffer, node->contents.data() + position_, size);
+  std::memcpy(buffer, contents.data() + position_, size);
   position_ += size;
   return size;
 }
 
+int64_t MemoryFileProtocol::MemoryFile::ReadAt(int64_t offset, void* buffer,
+                                               int64_t size) {
+  absl::MutexLock lock(&node_->mutex);
+  if (!node_->valid) {
+    return 0;
+  }
+  const Contents& contents = *node_->contents;
+  const int64_t file_size = static_cast<int64_t>(contents.size());
+  if (offset >= file_size) {
+    return 0;
+  }
+  size = std::min(size, file_size - offset);
+  std::memcpy(buffer, contents.data() + offset, size);
+  return size;
+}
+
+//==============================================================================
+// SnapshotFile
+//==============================================================================
+
+// File opened for reading only, which reads from a snapshot of the contents
+// taken when it was opened. As the snapshot never changes, reads do not lock.
+class MemoryFileProtocol::SnapshotFile final : public RawFile {
+ public:
+  SnapshotFile(std::shared_ptr<Node> node,
+               std::shared_ptr<const Contents> contents)
+      : node_(std::move(node)), contents_(std::move(contents)) {}
+  ~SnapshotFile() override;
+
+  // Public overrides for RawFile.
+  int64_t SeekEnd() override;
+  int64_t SeekTo(int64_t position) override;
+  int64_t Write(const void* buffer, int64_t size) override { return 0; }
+  int64_t Read(void* buffer, int64_t size) override;
+  int64_t ReadAt(int64_t offset, void* buffer, int64_t size) override;
+  absl::Span<const uint8_t> GetMappedView() override;
+
+ private:
+  const std::shared_ptr<Node> node_;
+  const std::shared_ptr<const Contents> contents_;
+  int64_t position_ = 0;
+};
+
+MemoryFileProtocol::SnapshotFile::~SnapshotFile() {
+  absl::MutexLock lock(&node_->mutex);
+  --node_->readers;
+}
+
+int64_t MemoryFileProtocol::SnapshotFile::SeekEnd() {
+  if (!node_->valid) {
+    position_ = -1;
+  } else {
+    position_ = static_cast<int64_t>(contents_->size());
+  }
+  return position_;
+}
+
+int64_t MemoryFileProtocol::SnapshotFile::SeekTo(int64_t position) {
+  if (!node_->valid) {
+    position_ = -1;
+  } else {
+    position_ = std::clamp(position, int64_t{0},
+                           static_cast<int64_t>(contents_->size()));
+  }
+  return position_;
+}
+
+int64_t MemoryFileProtocol::SnapshotFile::Read(void* buffer, int64_t size) {
+  if (!node_->valid) {
+    position_ = -1;
+    return 0;
+  }
+  if (position_ + size > static_cast<int64_t>(contents_->size())) {
+    size = static_cast<int64_t>(contents_->size()) - position_;
+  }
+  std::memcpy(buffer, contents_->data() + position_, size);
+  position_ += size;
+  return size;
+}
+
+int64_t MemoryFileProtocol::SnapshotFile::ReadAt(int64_t offset, void* buffer,
+                                                 int64_t size) {
+  if (!node_->valid) {
+    return 0;
+  }
+  const int64_t file_size = static_cast<int64_t>(contents_->size());
+  if (offset >= file_size) {
+    return 0;
+  }
+  size = std::min(size, file_size - offset);
+  std::memcpy(buffer, contents_->data() + offset, size);
+  return size;
+}
+
+absl::Span<const uint8_t> MemoryFileProtocol::SnapshotFile::GetMappedView() {
+  if (!node_->valid) {
+    return {};
+  }
+  return absl::MakeConstSpan(*contents_);
+}
+
+//==============================================================================
+// MemoryFileProtocol
+//==============================================================================
+
+void MemoryFileProtocol::DispatchChanges() {
+  absl::MutexLock dispatch_lock(&dispatch_mutex_);
+  std::vector<Change> changes;
+  std::vector<std::pair<const Watch*, const Change*>> calls;
+  {
+    absl::MutexLock lock(&watch_mutex_);
+    changes.swap(changes_);
+    for (const Change& change : changes) {
+      for (std::string_view path :
+           {std::string_view(change.path), GetParentFolder(change.path)}) {
+        auto it = watches_.find(path);
+        if (it == watches_.end()) {
+          continue;
+        }
+        for (const auto& watch : it->second) {
+          calls.emplace_back(watch.get(), &change);
+        }
+      }
+    }
+  }
+
+  // Watches cannot be removed while the dispatch lock is held, so they can be
+  // called without holding the watch lock. This allows callbacks to modify
+  // files.
+  for (const auto& [watch, change] : calls) {
+    watch->callback(absl::StrCat(watch->protocol_name, ":", change->path),
+                    change->change);
+  }
+}
+
+void MemoryFileProtocol::NotifyChange(std::string_view path,
+                                      PathChange change) {
+  if (watch_count_ == 0) {
+    return;
+  }
+  absl::MutexLock lock(&watch_mutex_);
+  if (!watches_.contains(path) && !watches_.contains(GetParentFolder(path))) {
+    return;
+  }
+  changes_.push_back({std::string(path), change});
+}
+
 MemoryFileProtocol::MemoryFileProtocol(FileProtocolFlags flags)
     : flags_(flags) {
-  nodes_["/"] = std::make_unique<Node>(PathType::kFolder);
+  Shard* shard = GetShard(GetParentFolder("/"));
+  absl::MutexLock lock(&shard->mutex);
+  shard->nodes["/"] = std::make_shared<Node>(PathType::kFolder);
 }
 
-MemoryFileProtocol::~MemoryFileProtocol() {}
+MemoryFileProtocol::~MemoryFileProtocol() {
+  // Open files keep their nodes alive, so they need to be told explicitly that
+  // the protocol is gone.
+  for (Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex);
+    for (auto& [path, node] : shard.nodes) {
+      node->valid = false;
+    }
+  }
+}
 
 FileProtocolFlags MemoryFileProtocol::GetFlags() const { return flags_; }
 
@@ -122,26 +428,56 @@ std::vector<std::string> MemoryFileProtocol::GetDefaultNames() const {
   return {"mem"};
 }
 
-void MemoryFileProtocol::Lock(LockType type) ABSL_NO_THREAD_SAFETY_ANALYSIS {
-  if (type == LockType::kQuery) {
-    mutex_.ReaderLock();
-  } else {
-    mutex_.WriterLock();
+MemoryFileProtocol::Shard* MemoryFileProtocol::GetShard(
+    std::string_view folder) {
+  return &shards_[absl::Hash<std::string_view>()(folder) % kShardCount];
+}
+
+std::shared_ptr<MemoryFileProtocol::Node> MemoryFileProtocol::FindNode(
+    std::string_view path) {
+  Shard* shard = GetShard(GetParentFolder(path));
+  absl::ReaderMutexLock lock(&shard->mutex);
+  auto it = shard->nodes.find(path);
+  if (it == shard->nodes.end()) {
+    return nullptr;
   }
+  return it->second;
 }
 
-void MemoryFileProtocol::Unlock(LockType type) ABSL_NO_THREAD_SAFETY_ANALYSIS {
-  if (type == LockType::kQuery) {
-    mutex_.ReaderUnlock();
-  } else {
-    mutex_.WriterUnlock();
+std::unique_ptr<RawFile> MemoryFileProtocol::OpenNode(
+    std::string_view path, std::shared_ptr<Node> node, FileFlags flags) {
+  if (node == nullptr || node->type != PathType::kFile) {
+    return nullptr;
+  }
+  absl::MutexLock lock(&node->mutex);
+  if (node->writer) {
+    return nullptr;
+  }
+  if (!flags.IsSet(FileFlag::kWrite)) {
+    ++node->readers;
+    std::shared_ptr<const Contents> contents = node->contents;
+    return std::make_unique<SnapshotFile>(std::move(node),
+                                          std::move(contents));
   }
+  if (node->readers > 0) {
+    return nullptr;
+  }
+  const bool reset = flags.IsSet(FileFlag::kReset);
+  if (reset) {
+    // Any copies still refer to the old contents.
+    node->contents = std::make_shared<Contents>();
+    node->size = 0;
+  }
+  node->writer = true;
+  return std::make_unique<MemoryFile>(this, path, std::move(node), reset);
 }
 
 PathInfo MemoryFileProtocol::DoGetPathInfo(std::string_view protocol_name,
                                            std::string_view path) {
-  auto it = nodes_.find(path);
-  if (it == nodes_.end()) {
+  Shard* shard = GetShard(GetParentFolder(path));
+  absl::ReaderMutexLock lock(&shard->mutex);
+  auto it = shard->nodes.find(path);
+  if (it == shard->nodes.end()) {
     return {};
   }
   Node* node = it->second.get();
@@ -153,15 +489,12 @@ PathInfo MemoryFileProtocol::DoGetPathInfo(std::string_view protocol_name,
 
 std::vector<std::string> MemoryFileProtocol::BasicList(
     std::string_view protocol_name, std::string_view path) {
-  std::string prefix;
-  if (path == "/") {
-    prefix = "/";
-  } else {
-    prefix = absl::StrCat(path, "/");
-  }
+  const std::string prefix = GetContentsPrefix(path);
+  Shard* shard = GetShard(path);
+  absl::ReaderMutexLock lock(&shard->mutex);
   std::vector<std::string> paths;
-  for (auto it = nodes_.lower_bound(prefix);
-       it != nodes_.end() && absl::StartsWith(it->first, prefix); ++it) {
+  for (auto it = shard->nodes.lower_bound(prefix);
+       it != shard->nodes.end() && absl::StartsWith(it->first, prefix); ++it) {
     std::string_view item_path = it->first;
     item_path.remove_prefix(prefix.size());
     if (item_path.empty() ||
@@ -175,42 +508,153 @@ std::vector<std::string> MemoryFileProtocol::BasicList(
 
 bool MemoryFileProtocol::BasicCreateFolder(std::string_view protocol_name,
                                            std::string_view path) {
-  nodes_[absl::StrCat(path)] = std::make_unique<Node>(PathType::kFolder);
+  // Preconditions are checked again, as there is no protocol-wide lock that
+  // would keep them true since they were checked by DoCreateFolder.
+  ShardLock lock(this, GetParentFolder(path));
+  if (!lock.IsFolder()) {
+    return false;
+  }
+  auto [it, added] = lock.GetContents().try_emplace(std::string(path));
+  if (!added) {
+    return it->second->type == PathType::kFolder;
+  }
+  it->second = std::make_shared<Node>(PathType::kFolder);
+  NotifyChange(path, PathChange::kCreated);
   return true;
 }
 
 bool MemoryFileProtocol::BasicDeleteFolder(std::string_view protocol_name,
                                            std::string_view path) {
-  nodes_.erase(absl::StrCat(path));
+  ShardLock lock(this, path);
+  auto it = lock.GetEntries().find(path);
+  if (it == lock.GetEntries().end()) {
+    return true;
+  }
+  if (it->second->type != PathType::kFolder || lock.HasContents()) {
+    return false;
+  }
+  lock.GetEntries().erase(it);
+  NotifyChange(path, PathChange::kDeleted);
+  return true;
+}
+
+bool MemoryFileProtocol::BasicCopyFile(std::string_view protocol_name,
+                                       std::string_view from_path,
+                                       std::string_view to_path) {
+  std::shared_ptr<Node> from_node = FindNode(from_path);
+  if (from_node == nullptr || from_node->type != PathType::kFile) {
+    return false;
+  }
+  std::shared_ptr<Contents> contents;
+  {
+    absl::MutexLock lock(&from_node->mutex);
+    if (from_node->writer) {
+      return false;
+    }
+    contents = from_node->contents;
+  }
+
+  ShardLock lock(this, GetParentFolder(to_path));
+  if (!lock.IsFolder()) {
+    return false;
+  }
+  auto [it, added] = lock.GetContents().try_emplace(std::string(to_path));
+  if (added) {
+    it->second = std::make_shared<Node>(PathType::kFile);
+  } else if (it->second->type != PathType::kFile) {
+    return false;
+  }
+  Node* to_node = it->second.get();
+  absl::MutexLock node_lock(&to_node->mutex);
+  if (to_node->writer || to_node->readers > 0) {
+    return false;
+  }
+  to_node->size = static_cast<int64_t>(contents->size());
+  to_node->contents = std::move(contents);
+  NotifyChange(to_path, added ? PathChange::kCreated : PathChange::kModified);
   return true;
 }
 
 bool MemoryFileProtocol::BasicDeleteFile(std::string_view protocol_name,
                                          std::string_view path) {
-  auto it = nodes_.find(path);
-  if (it->second->open) {
+  Shard* shard = GetShard(GetParentFolder(path));
+  absl::MutexLock lock(&shard->mutex);
+  auto it = shard->nodes.find(path);
+  if (it == shard->nodes.end()) {
+    return true;
+  }
+  Node* node = it->second.get();
+  if (node->type != PathType::kFile) {
     return false;
   }
-  nodes_.erase(it);
+  {
+    // Files can only be opened with the shard locked, so this stays true.
+    absl::MutexLock node_lock(&node->mutex);
+    if (node->writer || node->readers > 0) {
+      return false;
+    }
+  }
+  shard->nodes.erase(it);
+  NotifyChange(path, PathChange::kDeleted);
   return true;
 }
 
 std::unique_ptr<RawFile> MemoryFileProtocol::BasicOpenFile(
     std::string_view protocol_name, std::string_view path, FileFlags flags) {
-  if (flags.IsSet(FileFlag::kCreate)) {
-    auto& new_node = nodes_[absl::StrCat(path)];
-    new_node = std::make_unique<Node>(PathType::kFile);
-    return std::make_unique<MemoryFile>(new_node.get());
+  const std::string_view folder = GetParentFolder(path);
+  if (!flags.IsSet(FileFlag::kCreate)) {
+    Shard* shard = GetShard(folder);
+    absl::ReaderMutexLock lock(&shard->mutex);
+    auto it = shard->nodes.find(path);
+    if (it == shard->nodes.end()) {
+      return nullptr;
+    }
+    return OpenNode(path, it->second, flags);
   }
 
-  Node* node = nodes_.find(path)->second.get();
-  if (node->open) {
+  ShardLock lock(this, folder);
+  if (!lock.IsFolder()) {
     return nullptr;
   }
-  if (flags.IsSet(FileFlag::kReset)) {
-    node->contents.clear();
+  auto [it, added] = lock.GetContents().try_emplace(std::string(path));
+  if (added) {
+    it->second = std::make_shared<Node>(PathType::kFile);
+    NotifyChange(path, PathChange::kCreated);
+  }
+  return OpenNode(path, it->second, flags);
+}
+
+bool MemoryFileProtocol::DoWatch(std::string_view protocol_name,
+                                 std::string_view path, WatchId id,
+                                 WatchCallback callback) {
+  if (DoGetPathInfo(protocol_name, path).type == PathType::kInvalid) {
+    return false;
+  }
+  absl::MutexLock lock(&watch_mutex_);
+  watches_[path].push_back(absl::WrapUnique(
+      new Watch{id, std::string(protocol_name), std::move(callback)}));
+  watch_paths_[id] = std::string(path);
+  ++watch_count_;
+  return true;
+}
+
+void MemoryFileProtocol::DoUnwatch(WatchId id) {
+  absl::MutexLock dispatch_lock(&dispatch_mutex_);
+  absl::MutexLock lock(&watch_mutex_);
+  auto path_it = watch_paths_.find(id);
+  if (path_it == watch_paths_.end()) {
+    return;
+  }
+  auto it = watches_.find(path_it->second);
+  watch_paths_.erase(path_it);
+  Watches& watches = it->second;
+  watches.erase(std::find_if(
+      watches.begin(), watches.end(),
+      [id](const std::unique_ptr<Watch>& watch) { return watch->id == id; }));
+  if (watches.empty()) {
+    watches_.erase(it);
   }
-  return std::make_unique<MemoryFile>(node);
+  --watch_count_;
 }
 
 }  // namespace gb
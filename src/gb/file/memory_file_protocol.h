@@ -6,9 +6,12 @@
 #ifndef GB_FILE_MEMORY_FILE_PROTOCOL_H_
 #define GB_FILE_MEMORY_FILE_PROTOCOL_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "gb/base/string_util.h"
 #include "gb/file/file_protocol.h"
@@ -20,21 +23,44 @@ namespace gb {
 // This class supports all file system operations, allocating memory as needed
 // from the heap. By default, it will register under the "mem" protocol name.
 //
+// Paths are split across a fixed number of shards by their parent folder, each
+// with its own lock, so operations on different folders do not contend with
+// each other. There is no protocol-wide lock.
+//
+// File contents are reference counted and copy-on-write: CopyFile shares the
+// contents of the source file, and files opened for reading share a snapshot of
+// the contents as of when they were opened. Any number of files may be open
+// for reading at once, and they support FileFlag::kMapped with a view of the
+// snapshot. A file open for writing excludes all other opens of the same file.
+//
+// Watches (see FileSystem::Watch) are triggered manually: changes to watched
+// paths are queued as they happen, and the callbacks are only called from
+// DispatchChanges on the calling thread. Writes are reported when the file is
+// closed.
+//
 // This class is thread-safe.
 class MemoryFileProtocol : public FileProtocol {
  public:
-  explicit MemoryFileProtocol(
-      FileProtocolFlags flags = kReadWriteFileProtocolFlags);
+  static constexpr FileProtocolFlags kDefaultFlags = {
+      kReadWriteFileProtocolFlags, FileProtocolFlag::kWatch};
+
+  // Number of shards paths are divided between.
+  static constexpr int kShardCount = 16;
+
+  explicit MemoryFileProtocol(FileProtocolFlags flags = kDefaultFlags);
   ~MemoryFileProtocol() override;
 
+  // Calls the watch callbacks for all changes to watched paths since the last
+  // call, in the order they happened. This must not be called from a watch
+  // callback.
+  void DispatchChanges();
+
   // Public overrides for FileProtocol.
   FileProtocolFlags GetFlags() const override;
   std::vector<std::string> GetDefaultNames() const override;
 
  protected:
   // Protected overrides for FileProtocol.
-  void Lock(LockType type) override;
-  void Unlock(LockType type) override;
   PathInfo DoGetPathInfo(std::string_view protocol_name,
                          std::string_view path) override;
   std::vector<std::string> BasicList(std::string_view protocol_name,
@@ -43,21 +69,75 @@ class MemoryFileProtocol : public FileProtocol {
                          std::string_view path) override;
   bool BasicDeleteFolder(std::string_view protocol_name,
                          std::string_view path) override;
+  bool BasicCopyFile(std::string_view protocol_name, std::string_view from_path,
+                     std::string_view to_path) override;
   bool BasicDeleteFile(std::string_view protocol_name,
                        std::string_view path) override;
   std::unique_ptr<RawFile> BasicOpenFile(std::string_view protocol_name,
                                          std::string_view path,
                                          FileFlags flags) override;
+  bool DoWatch(std::string_view protocol_name, std::string_view path,
+               WatchId id, WatchCallback callback) override;
+  void DoUnwatch(WatchId id) override;
 
  private:
   class MemoryFile;
+  class ShardLock;
+  class SnapshotFile;
   struct Node;
-  using Nodes = std::map<std::string, std::unique_ptr<Node>, StringKeyCompare>;
+  using Nodes = std::map<std::string, std::shared_ptr<Node>, StringKeyCompare>;
+
+  // Paths whose parent folder hashes to the same shard. As all paths in a
+  // folder are in the same shard, listing a folder only locks one shard.
+  struct Shard {
+    absl::Mutex mutex;
+    Nodes nodes ABSL_GUARDED_BY(mutex);
+  };
+
+  // Returns the shard containing the contents of the specified folder.
+  Shard* GetShard(std::string_view folder);
+
+  // Returns the node for the path, or null if it does not exist.
+  std::shared_ptr<Node> FindNode(std::string_view path);
+
+  struct Watch {
+    WatchId id;
+    std::string protocol_name;
+    WatchCallback callback;
+  };
+  using Watches = std::vector<std::unique_ptr<Watch>>;
+
+  struct Change {
+    std::string path;
+    PathChange change;
+  };
+
+  // Opens a file node as requested by the flags, or returns null if the node
+  // is not a file or it is already open in a conflicting way.
+  std::unique_ptr<RawFile> OpenNode(std::string_view path,
+                                    std::shared_ptr<Node> node,
+                                    FileFlags flags);
+
+  // Queues a change to the path, if it or its parent folder is watched.
+  void NotifyChange(std::string_view path, PathChange change);
 
   const FileProtocolFlags flags_;
+  Shard shards_[kShardCount];
+
+  // Number of watches, so changes can be ignored without locking when there
+  // are none.
+  std::atomic<int> watch_count_ = 0;
+
+  // Held while watch callbacks are called, so watches are only removed when
+  // they are not in use.
+  absl::Mutex dispatch_mutex_;
 
-  absl::Mutex mutex_;
-  Nodes nodes_;
+  absl::Mutex watch_mutex_ ABSL_ACQUIRED_AFTER(dispatch_mutex_);
+  absl::flat_hash_map<std::string, Watches> watches_
+      ABSL_GUARDED_BY(watch_mutex_);  // By path.
+  absl::flat_hash_map<WatchId, std::string> watch_paths_
+      ABSL_GUARDED_BY(watch_mutex_);
+  std::vector<Change> changes_ ABSL_GUARDED_BY(watch_mutex_);
 };
 
 }  // namespace gb
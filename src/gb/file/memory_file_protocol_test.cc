@@ -5,6 +5,11 @@
 
 #include "gb/file/memory_file_protocol.h"
 
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include "absl/strings/str_cat.h"
 #include "gb/file/common_protocol_test.h"
 #include "gb/file/file_system.h"
@@ -15,7 +20,9 @@ namespace gb {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::Pair;
 using ::testing::IsEmpty;
+using ::testing::SizeIs;
 using ::testing::Values;
 
 std::unique_ptr<FileProtocol> MemoryFileProtocolFactory(
@@ -28,7 +35,7 @@ INSTANTIATE_TEST_SUITE_P(MemoryFileProtocolTest, CommonProtocolTest,
 
 TEST(MemoryFileProtocolTest, Construct) {
   MemoryFileProtocol protocol;
-  EXPECT_EQ(protocol.GetFlags(), kReadWriteFileProtocolFlags);
+  EXPECT_EQ(protocol.GetFlags(), MemoryFileProtocol::kDefaultFlags);
   EXPECT_THAT(protocol.GetDefaultNames(), ElementsAre("mem"));
 
   const FileProtocolFlags flags = {FileProtocolFlag::kInfo,
@@ -78,5 +85,179 @@ TEST(MemoryFileProtocolTest, FileInvalidAfterClose) {
   EXPECT_EQ(files[3]->WriteString("abcdefghij"), 0);
 }
 
+TEST(MemoryFileProtocolTest, MultipleReaders) {
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(std::make_unique<MemoryFileProtocol>()));
+  ASSERT_TRUE(file_system.WriteFile("mem:/file", "contents"));
+
+  auto reader_1 = file_system.OpenFile("mem:/file", kReadFileFlags);
+  ASSERT_NE(reader_1, nullptr);
+  auto reader_2 = file_system.OpenFile("mem:/file", kReadFileFlags);
+  ASSERT_NE(reader_2, nullptr);
+  EXPECT_EQ(file_system.OpenFile("mem:/file", kWriteFileFlags), nullptr);
+  EXPECT_FALSE(file_system.DeleteFile("mem:/file"));
+  EXPECT_EQ(reader_1->ReadString(8), "contents");
+  EXPECT_EQ(reader_2->ReadString(8), "contents");
+  EXPECT_EQ(reader_1->WriteString("abc"), 0);
+
+  reader_1.reset();
+  reader_2.reset();
+  EXPECT_NE(file_system.OpenFile("mem:/file", kWriteFileFlags), nullptr);
+}
+
+TEST(MemoryFileProtocolTest, MappedView) {
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(std::make_unique<MemoryFileProtocol>()));
+  ASSERT_TRUE(file_system.WriteFile("mem:/file", "contents"));
+
+  auto file =
+      file_system.OpenFile("mem:/file", kReadFileFlags + FileFlag::kMapped);
+  ASSERT_NE(file, nullptr);
+  auto view = file->GetMappedView();
+  EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(view.data()),
+                             view.size()),
+            "contents");
+}
+
+TEST(MemoryFileProtocolTest, CopyIsCopyOnWrite) {
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(std::make_unique<MemoryFileProtocol>()));
+  ASSERT_TRUE(file_system.WriteFile("mem:/file", "original"));
+  ASSERT_TRUE(file_system.CopyFile("mem:/file", "mem:/copy"));
+
+  // Copies share their contents until one of them is written.
+  {
+    auto file =
+        file_system.OpenFile("mem:/file", kReadFileFlags + FileFlag::kMapped);
+    auto copy =
+        file_system.OpenFile("mem:/copy", kReadFileFlags + FileFlag::kMapped);
+    ASSERT_NE(file, nullptr);
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(file->GetMappedView().data(), copy->GetMappedView().data());
+  }
+
+  auto file = file_system.OpenFile("mem:/file", kWriteFileFlags);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->SeekTo(4), 4);
+  EXPECT_EQ(file->WriteString("INAL"), 4);
+  file.reset();
+
+  std::string contents;
+  EXPECT_TRUE(file_system.ReadFile("mem:/file", &contents));
+  EXPECT_EQ(contents, "origINAL");
+  EXPECT_TRUE(file_system.ReadFile("mem:/copy", &contents));
+  EXPECT_EQ(contents, "original");
+
+  // Resetting the file does not affect the copy either.
+  ASSERT_TRUE(file_system.CopyFile("mem:/copy", "mem:/file"));
+  ASSERT_TRUE(file_system.WriteFile("mem:/copy", "new"));
+  EXPECT_TRUE(file_system.ReadFile("mem:/file", &contents));
+  EXPECT_EQ(contents, "original");
+  EXPECT_EQ(file_system.GetPathInfo("mem:/copy").size, 3);
+}
+
+TEST(MemoryFileProtocolTest, ConcurrentAccess) {
+  constexpr int kThreadCount = 8;
+  constexpr int kFileCount = 50;
+  FileSystem file_system;
+  ASSERT_TRUE(file_system.Register(std::make_unique<MemoryFileProtocol>()));
+  ASSERT_TRUE(file_system.WriteFile("mem:/shared", "shared"));
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([i, &file_system] {
+      const std::string folder = absl::StrCat("mem:/thread-", i);
+      EXPECT_TRUE(file_system.CreateFolder(absl::StrCat(folder, "/sub"),
+                                           FolderMode::kRecursive));
+      std::string contents;
+      for (int j = 0; j < kFileCount; ++j) {
+        const std::string path = absl::StrCat(folder, "/file-", j);
+        const std::string expected = absl::StrCat(i, ":", j);
+        EXPECT_TRUE(file_system.WriteFile(path, expected));
+        EXPECT_TRUE(file_system.CopyFile(
+            path, absl::StrCat(folder, "/sub/file-", j)));
+        EXPECT_TRUE(file_system.ReadFile(path, &contents));
+        EXPECT_EQ(contents, expected);
+        EXPECT_TRUE(file_system.ReadFile("mem:/shared", &contents));
+        EXPECT_EQ(contents, "shared");
+        EXPECT_TRUE(file_system.WriteFile(
+            absl::StrCat("mem:/root-", i, "-", j), expected));
+      }
+      for (int j = 0; j < kFileCount; j += 2) {
+        EXPECT_TRUE(
+            file_system.DeleteFile(absl::StrCat(folder, "/file-", j)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kThreadCount; ++i) {
+    const std::string folder = absl::StrCat("mem:/thread-", i);
+    EXPECT_THAT(file_system.ListFiles(folder), SizeIs(kFileCount / 2));
+    EXPECT_THAT(file_system.ListFiles(absl::StrCat(folder, "/sub")),
+                SizeIs(kFileCount));
+    EXPECT_TRUE(file_system.DeleteFolder(folder, FolderMode::kRecursive));
+  }
+  EXPECT_THAT(file_system.ListFiles("mem:/"),
+              SizeIs(kThreadCount * kFileCount + 1));
+  EXPECT_THAT(file_system.ListFolders("mem:/"), IsEmpty());
+}
+
+TEST(MemoryFileProtocolTest, Watch) {
+  FileSystem file_system;
+  auto protocol = std::make_unique<MemoryFileProtocol>();
+  MemoryFileProtocol* memory = protocol.get();
+  ASSERT_TRUE(file_system.Register(std::move(protocol)));
+  ASSERT_TRUE(file_system.CreateFolder("mem:/folder", FolderMode::kNormal));
+  ASSERT_TRUE(file_system.WriteFile("mem:/folder/file", "contents"));
+
+  std::vector<std::pair<std::string, PathChange>> changes;
+  auto callback = [&changes](std::string_view path, PathChange change) {
+    changes.emplace_back(path, change);
+  };
+  EXPECT_EQ(file_system.Watch("mem:/missing", callback), kNoWatchId);
+  const WatchId folder_id = file_system.Watch("mem:/folder", callback);
+  EXPECT_NE(folder_id, kNoWatchId);
+  const WatchId file_id = file_system.Watch("mem:/folder/file", callback);
+  EXPECT_NE(file_id, kNoWatchId);
+  EXPECT_NE(file_id, folder_id);
+
+  ASSERT_TRUE(file_system.WriteFile("mem:/folder/new", "new"));
+  ASSERT_TRUE(file_system.CopyFile("mem:/folder/new", "mem:/folder/file"));
+  ASSERT_TRUE(file_system.CreateFolder("mem:/folder/sub", FolderMode::kNormal));
+  ASSERT_TRUE(file_system.WriteFile("mem:/folder/sub/ignored", "ignored"));
+  ASSERT_TRUE(file_system.DeleteFile("mem:/folder/new"));
+  std::string contents;
+  ASSERT_TRUE(file_system.ReadFile("mem:/folder/file", &contents));
+
+  // Nothing is reported until changes are dispatched.
+  EXPECT_THAT(changes, IsEmpty());
+  memory->DispatchChanges();
+  EXPECT_THAT(
+      changes,
+      ElementsAre(Pair("mem:/folder/new", PathChange::kCreated),
+                  Pair("mem:/folder/new", PathChange::kModified),
+                  Pair("mem:/folder/file", PathChange::kModified),
+                  Pair("mem:/folder/file", PathChange::kModified),
+                  Pair("mem:/folder/sub", PathChange::kCreated),
+                  Pair("mem:/folder/new", PathChange::kDeleted)));
+
+  changes.clear();
+  file_system.Unwatch(folder_id);
+  ASSERT_TRUE(file_system.WriteFile("mem:/folder/other", "other"));
+  ASSERT_TRUE(file_system.DeleteFile("mem:/folder/file"));
+  memory->DispatchChanges();
+  EXPECT_THAT(changes,
+              ElementsAre(Pair("mem:/folder/file", PathChange::kDeleted)));
+
+  changes.clear();
+  file_system.Unwatch(file_id);
+  ASSERT_TRUE(file_system.WriteFile("mem:/folder/file", "contents"));
+  memory->DispatchChanges();
+  EXPECT_THAT(changes, IsEmpty());
+}
+
 }  // namespace
 }  // namespace gb
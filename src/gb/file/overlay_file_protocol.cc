@@ -0,0 +1,369 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/overlay_file_protocol.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "gb/file/path.h"
+#include "gb/file/raw_file.h"
+
+namespace gb {
+
+namespace {
+
+// Protocol name passed to layers when building the index. Layers never see the
+// name the overlay is registered under, so this only needs to be valid.
+inline constexpr std::string_view kLayerProtocolName = "layer";
+
+// Returns true if "path" is "folder" or anything under it.
+bool IsInFolder(std::string_view path, std::string_view folder) {
+  if (IsRootPath(folder, {})) {
+    return true;
+  }
+  return absl::StartsWith(path, folder) &&
+         (path.size() == folder.size() || path[folder.size()] == '/');
+}
+
+}  // namespace
+
+std::unique_ptr<OverlayFileProtocol> OverlayFileProtocol::Create(
+    std::vector<std::unique_ptr<FileProtocol>> layers) {
+  if (layers.empty()) {
+    LOG(ERROR) << "Overlay has no layers";
+    return nullptr;
+  }
+  for (const auto& layer : layers) {
+    if (layer == nullptr ||
+        !layer->GetFlags().IsSet(
+            {FileProtocolFlag::kList, FileProtocolFlag::kFileRead})) {
+      LOG(ERROR) << "Overlay layers must support listing and reading files";
+      return nullptr;
+    }
+  }
+  return absl::WrapUnique(new OverlayFileProtocol(std::move(layers)));
+}
+
+OverlayFileProtocol::OverlayFileProtocol(
+    std::vector<std::unique_ptr<FileProtocol>> layers)
+    : layers_(std::move(layers)) {
+  Refresh();
+}
+
+OverlayFileProtocol::~OverlayFileProtocol() {
+  absl::MutexLock lock(&refresh_mutex_);
+  for (int layer = 0; layer < static_cast<int>(watches_.size()); ++layer) {
+    for (const auto& [folder, id] : watches_[layer]) {
+      layers_[layer]->Unwatch(id);
+    }
+  }
+}
+
+void OverlayFileProtocol::Refresh() {
+  absl::MutexLock refresh_lock(&refresh_mutex_);
+  absl::flat_hash_set<std::string> deleted;
+  {
+    absl::MutexLock lock(&change_mutex_);
+    changed_ = false;
+    changed_paths_.clear();
+    deleted.swap(deleted_);
+  }
+  UpdateIndex("/", deleted);
+}
+
+void OverlayFileProtocol::UpdateChanges() {
+  if (!changed_) {
+    return;
+  }
+  absl::MutexLock refresh_lock(&refresh_mutex_);
+  absl::flat_hash_set<std::string> changed_paths;
+  absl::flat_hash_set<std::string> deleted;
+  {
+    absl::MutexLock lock(&change_mutex_);
+    if (!changed_) {
+      // Another lookup already applied the changes while this one waited.
+      return;
+    }
+    changed_ = false;
+    changed_paths.swap(changed_paths_);
+    deleted.swap(deleted_);
+  }
+
+  // Paths under another changed folder are rebuilt along with it.
+  for (const std::string& path : changed_paths) {
+    std::string_view folder = path;
+    bool in_changed_folder = false;
+    while (!in_changed_folder && !IsRootPath(folder, {})) {
+      folder = RemoveFilename(folder);
+      in_changed_folder = changed_paths.contains(folder);
+    }
+    if (!in_changed_folder) {
+      UpdateIndex(path, deleted);
+    }
+  }
+}
+
+void OverlayFileProtocol::OnLayerChange(std::string_view path,
+                                        PathChange change) {
+  path = RemoveProtocol(path);
+  absl::MutexLock lock(&change_mutex_);
+  changed_paths_.emplace(path);
+
+  // A watch may end when its folder is deleted, so it is watched again if it
+  // still exists on update.
+  if (change == PathChange::kDeleted) {
+    deleted_.emplace(path);
+  }
+  changed_ = true;
+}
+
+void OverlayFileProtocol::UpdateIndex(
+    std::string_view root, const absl::flat_hash_set<std::string>& deleted) {
+  if (!IsRootPath(root, {})) {
+    // Nothing is visible at the path unless its parent is a folder, otherwise
+    // it is hidden by a file in a higher priority layer, or its parent was
+    // deleted as well (and the parent's change removes it).
+    absl::ReaderMutexLock lock(&mutex_);
+    auto parent = index_.find(RemoveFilename(root));
+    if (parent == index_.end() ||
+        parent->second.info.type != PathType::kFolder) {
+      return;
+    }
+  }
+
+  LayerFolders layer_folders(layers_.size());
+  Index entries = BuildIndex(root, &layer_folders);
+  std::vector<std::string> watched =
+      UpdateWatches(root, layer_folders, deleted);
+
+  // Anything created in a new folder before it was watched is not in the
+  // index, so new folders are checked again on the next lookup.
+  if (refreshed_ && !watched.empty()) {
+    absl::MutexLock lock(&change_mutex_);
+    for (std::string& folder : watched) {
+      changed_paths_.emplace(std::move(folder));
+    }
+    changed_ = true;
+  }
+  refreshed_ = true;
+
+  absl::MutexLock lock(&mutex_);
+  ReplaceEntries(root, std::move(entries));
+}
+
+void OverlayFileProtocol::ReplaceEntries(std::string_view root,
+                                         Index entries) {
+  if (IsRootPath(root, {})) {
+    index_ = std::move(entries);
+    return;
+  }
+  EraseEntries(root);
+  auto parent = index_.find(RemoveFilename(root));
+  if (parent == index_.end()) {
+    return;
+  }
+  auto& children = parent->second.children;
+  children.erase(std::remove(children.begin(), children.end(), root),
+                 children.end());
+  if (entries.contains(root)) {
+    children.emplace_back(root);
+  }
+  index_.merge(entries);
+}
+
+void OverlayFileProtocol::EraseEntries(std::string_view root) {
+  auto it = index_.find(root);
+  if (it == index_.end()) {
+    return;
+  }
+  for (const std::string& child : it->second.children) {
+    EraseEntries(child);
+  }
+  index_.erase(it);
+}
+
+std::vector<std::string> OverlayFileProtocol::UpdateWatches(
+    std::string_view root, const LayerFolders& layer_folders,
+    const absl::flat_hash_set<std::string>& deleted) {
+  watches_.resize(layers_.size());
+  std::vector<std::string> added;
+  for (int layer = 0; layer < static_cast<int>(layers_.size()); ++layer) {
+    FileProtocol* protocol = layers_[layer].get();
+    const auto& folders = layer_folders[layer];
+    LayerWatches& watches = watches_[layer];
+    for (auto it = watches.begin(); it != watches.end();) {
+      if (IsInFolder(it->first, root) &&
+          (!folders.contains(it->first) || deleted.contains(it->first))) {
+        protocol->Unwatch(it->second);
+        watches.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    for (const std::string& folder : folders) {
+      if (watches.contains(folder)) {
+        continue;
+      }
+      const WatchId id =
+          protocol->Watch(kLayerProtocolName, folder,
+                          [this](std::string_view path, PathChange change) {
+                            OnLayerChange(path, change);
+                          });
+      if (id != kNoWatchId) {
+        watches[folder] = id;
+        added.push_back(folder);
+      }
+    }
+  }
+  return added;
+}
+
+OverlayFileProtocol::Index OverlayFileProtocol::BuildIndex(
+    std::string_view root, LayerFolders* layer_folders) const {
+  // The parent of the root is added first, so the root is added to the index
+  // like anything else.
+  const bool is_root = IsRootPath(root, {});
+  const std::string root_parent(is_root ? root : RemoveFilename(root));
+  Index index;
+  index[root_parent].info = PathInfo(PathType::kFolder);
+
+  std::vector<std::pair<std::string, PathType>> paths;
+  for (int layer = 0; layer < static_cast<int>(layers_.size()); ++layer) {
+    FileProtocol* protocol = layers_[layer].get();
+    paths.clear();
+    if (!is_root) {
+      const PathType root_type =
+          protocol->GetPathInfo(kLayerProtocolName, root).type;
+      if (root_type != PathType::kFile && root_type != PathType::kFolder) {
+        continue;
+      }
+      paths.emplace_back(std::string(root), root_type);
+    }
+    if (is_root || paths.back().second == PathType::kFolder) {
+      for (PathType type : {PathType::kFolder, PathType::kFile}) {
+        for (std::string& path :
+             protocol->List(kLayerProtocolName, root, {},
+                            FolderMode::kRecursive, type)) {
+          paths.emplace_back(RemoveProtocol(path), type);
+        }
+      }
+    }
+    if (protocol->GetFlags().IsSet(FileProtocolFlag::kWatch)) {
+      auto& folders = (*layer_folders)[layer];
+      if (is_root) {
+        folders.emplace(root);
+      }
+      for (const auto& [path, type] : paths) {
+        if (type == PathType::kFolder) {
+          folders.emplace(path);
+        }
+      }
+    }
+
+    // Sorting guarantees parent folders are visited before their contents.
+    std::sort(paths.begin(), paths.end());
+    for (auto& [path, type] : paths) {
+      // A missing parent means it was hidden by a file in a higher priority
+      // layer, and so is everything in it.
+      auto parent = index.find(RemoveFilename(std::string_view(path)));
+      if (parent == index.end() ||
+          parent->second.info.type != PathType::kFolder) {
+        continue;
+      }
+      auto it = index.find(path);
+      if (it != index.end()) {
+        // Higher priority layers win. Matching folders are merged by virtue of
+        // their contents being added individually.
+        continue;
+      }
+      PathInfo info(type);
+      if (type == PathType::kFile) {
+        info = protocol->GetPathInfo(kLayerProtocolName, path);
+        if (info.type != PathType::kFile) {
+          continue;
+        }
+      }
+      parent->second.children.push_back(path);
+      Entry& entry = index[std::move(path)];
+      entry.info = info;
+      entry.layer = layer;
+    }
+  }
+  if (!is_root) {
+    index.erase(root_parent);
+  }
+  return index;
+}
+
+FileProtocol* OverlayFileProtocol::FindFileLayer(std::string_view path) {
+  UpdateChanges();
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = index_.find(path);
+  if (it == index_.end() || it->second.info.type != PathType::kFile) {
+    return nullptr;
+  }
+  return layers_[it->second.layer].get();
+}
+
+FileProtocolFlags OverlayFileProtocol::GetFlags() const {
+  return kReadOnlyFileProtocolFlags;
+}
+
+PathInfo OverlayFileProtocol::DoGetPathInfo(std::string_view protocol_name,
+                                            std::string_view path) {
+  UpdateChanges();
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = index_.find(path);
+  if (it == index_.end()) {
+    return {};
+  }
+  return it->second.info;
+}
+
+void OverlayFileProtocol::DoReadFileAsync(std::string_view protocol_name,
+                                          std::string_view path,
+                                          int64_t offset, void* buffer,
+                                          int64_t size,
+                                          ReadFileCallback callback) {
+  FileProtocol* layer = FindFileLayer(path);
+  if (layer == nullptr) {
+    callback(-1);
+    return;
+  }
+  layer->ReadFileAsync(protocol_name, path, offset, buffer, size,
+                       std::move(callback));
+}
+
+std::vector<std::string> OverlayFileProtocol::BasicList(
+    std::string_view protocol_name, std::string_view path) {
+  UpdateChanges();
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = index_.find(path);
+  if (it == index_.end()) {
+    return {};
+  }
+  std::vector<std::string> paths;
+  paths.reserve(it->second.children.size());
+  for (const std::string& child : it->second.children) {
+    paths.emplace_back(absl::StrCat(protocol_name, ":", child));
+  }
+  return paths;
+}
+
+std::unique_ptr<RawFile> OverlayFileProtocol::BasicOpenFile(
+    std::string_view protocol_name, std::string_view path, FileFlags flags) {
+  FileProtocol* layer = FindFileLayer(path);
+  if (layer == nullptr) {
+    return nullptr;
+  }
+  return layer->OpenFile(protocol_name, path, flags);
+}
+
+}  // namespace gb
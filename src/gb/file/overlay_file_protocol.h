@@ -0,0 +1,157 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_FILE_OVERLAY_FILE_PROTOCOL_H_
+#define GB_FILE_OVERLAY_FILE_PROTOCOL_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "gb/file/file_protocol.h"
+
+namespace gb {
+
+// This class implements a read-only FileProtocol that merges an ordered list of
+// layer protocols into a single view.
+//
+// Layers are in priority order: a file in an earlier layer hides a file (or
+// folder) at the same path in all later layers. Folders that exist in more than
+// one layer are merged, so listing them returns the contents of all layers. A
+// typical use is to put patch or mod folders before the base content.
+//
+// All layers are listed when the protocol is created, building a merged index
+// of every path, so path lookups, listing and opening files are done with a
+// single hash table lookup instead of probing each layer.
+//
+// Layers that support FileProtocolFlag::kWatch are watched (every folder in
+// them, as watches are not recursive). On the next lookup after changes are
+// reported, only the index entries for the changed paths (and anything under
+// them) are rebuilt, once for all the changes. Changes are only visible once
+// the layer reports them (for instance, MemoryFileProtocol only does so from
+// DispatchChanges), and changes to layers that cannot be watched are not
+// visible until Refresh is called. As a result, the file size returned by
+// GetPathInfo (which is recorded in the index) may be stale until then, while
+// reading the file always returns its current contents. Lookups must not be
+// done from within a layer's watch callback.
+//
+// As overlays are often registered under different names, this protocol has no
+// default protocol names.
+//
+// This class is thread-safe if all layers are thread-safe.
+class OverlayFileProtocol : public FileProtocol {
+ public:
+  // Creates a new OverlayFileProtocol over the specified layers, in priority
+  // order.
+  //
+  // Returns null if there are no layers, or any layer does not support
+  // FileProtocolFlag::kList and FileProtocolFlag::kFileRead.
+  static std::unique_ptr<OverlayFileProtocol> Create(
+      std::vector<std::unique_ptr<FileProtocol>> layers);
+
+  ~OverlayFileProtocol() override;
+
+  // Returns the layers of the overlay, in priority order.
+  int GetLayerCount() const { return static_cast<int>(layers_.size()); }
+  FileProtocol* GetLayer(int index) const { return layers_[index].get(); }
+
+  // Rebuilds the merged index from the current contents of all layers.
+  //
+  // This must be called after a layer that cannot be watched is modified for
+  // the change to be visible through the overlay.
+  void Refresh();
+
+  // Public overrides for FileProtocol.
+  FileProtocolFlags GetFlags() const override;
+
+ protected:
+  // Protected overrides for FileProtocol.
+  PathInfo DoGetPathInfo(std::string_view protocol_name,
+                         std::string_view path) override;
+  void DoReadFileAsync(std::string_view protocol_name, std::string_view path,
+                       int64_t offset, void* buffer, int64_t size,
+                       ReadFileCallback callback) override;
+  std::vector<std::string> BasicList(std::string_view protocol_name,
+                                     std::string_view path) override;
+  std::unique_ptr<RawFile> BasicOpenFile(std::string_view protocol_name,
+                                         std::string_view path,
+                                         FileFlags flags) override;
+
+ private:
+  struct Entry {
+    PathInfo info;
+    int layer = 0;                      // Highest priority layer with the path.
+    std::vector<std::string> children;  // Set only for PathType::kFolder.
+  };
+  using Index = absl::flat_hash_map<std::string, Entry>;
+  using LayerFolders = std::vector<absl::flat_hash_set<std::string>>;
+  using LayerWatches = absl::flat_hash_map<std::string, WatchId>;
+
+  explicit OverlayFileProtocol(
+      std::vector<std::unique_ptr<FileProtocol>> layers);
+
+  // Builds the merged index entries for "root" and everything under it, and
+  // returns all folders there in each layer that supports watching in
+  // "layer_folders". If "root" is not the root folder, its parent must be a
+  // folder in the index, and is not included in the result.
+  Index BuildIndex(std::string_view root, LayerFolders* layer_folders) const;
+
+  // Rebuilds the index entries for "root" and everything under it, and
+  // updates the watches on all folders there.
+  void UpdateIndex(std::string_view root,
+                   const absl::flat_hash_set<std::string>& deleted)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(refresh_mutex_);
+
+  // Replaces the entries for "root" and everything under it with "entries".
+  void ReplaceEntries(std::string_view root, Index entries)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void EraseEntries(std::string_view root)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Updates the watches under "root", so exactly the folders there in
+  // "layer_folders" are watched. Folders in "deleted" are watched again, as
+  // their watch may have ended. Returns the folders that were newly watched.
+  std::vector<std::string> UpdateWatches(
+      std::string_view root, const LayerFolders& layer_folders,
+      const absl::flat_hash_set<std::string>& deleted)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(refresh_mutex_);
+
+  // Watch callback for all layers.
+  void OnLayerChange(std::string_view path, PathChange change);
+
+  // Updates the index for all paths reported changed since the last update.
+  void UpdateChanges();
+
+  // Returns the layer the file at "path" is read from, or null if the path is
+  // not a file.
+  FileProtocol* FindFileLayer(std::string_view path);
+
+  const std::vector<std::unique_ptr<FileProtocol>> layers_;
+  mutable absl::Mutex mutex_;
+  Index index_ ABSL_GUARDED_BY(mutex_);
+
+  // Serializes index updates, and guards the watches on each layer.
+  absl::Mutex refresh_mutex_;
+  std::vector<LayerWatches> watches_ ABSL_GUARDED_BY(refresh_mutex_);
+  bool refreshed_ ABSL_GUARDED_BY(refresh_mutex_) = false;
+
+  // Paths reported changed by watch callbacks since the last update.
+  // Callbacks only record changes, so they never wait on an update. "changed_"
+  // is only written with change_mutex_ held, but may be read without it.
+  std::atomic<bool> changed_ = false;
+  absl::Mutex change_mutex_;
+  absl::flat_hash_set<std::string> changed_paths_
+      ABSL_GUARDED_BY(change_mutex_);
+  absl::flat_hash_set<std::string> deleted_ ABSL_GUARDED_BY(change_mutex_);
+};
+
+}  // namespace gb
+
+#endif  // GB_FILE_OVERLAY_FILE_PROTOCOL_H_
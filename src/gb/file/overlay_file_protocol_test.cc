@@ -0,0 +1,336 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/file/overlay_file_protocol.h"
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gb/file/common_protocol_test.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gb/file/file_system.h"
+#include "gb/file/local_file_protocol.h"
+#include "gb/file/memory_file_protocol.h"
+#include "gb/file/raw_file.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::Each;
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::UnorderedElementsAre;
+using ::testing::Values;
+
+std::unique_ptr<FileProtocol> OverlayFileProtocolFactory(
+    const CommonProtocolTestInit& init) {
+  // Folders are created in both layers, and files alternate between them, so
+  // the common tests exercise the merged index.
+  CommonProtocolTestInit top_init, bottom_init;
+  top_init.folders = init.folders;
+  bottom_init.folders = init.folders;
+  for (int i = 0; i < static_cast<int>(init.files.size()); ++i) {
+    (i % 2 == 0 ? top_init : bottom_init).files.push_back(init.files[i]);
+  }
+  std::vector<std::unique_ptr<FileProtocol>> layers;
+  layers.push_back(
+      top_init.DefaultInit(std::make_unique<MemoryFileProtocol>()));
+  layers.push_back(
+      bottom_init.DefaultInit(std::make_unique<MemoryFileProtocol>()));
+  return OverlayFileProtocol::Create(std::move(layers));
+}
+
+INSTANTIATE_TEST_SUITE_P(OverlayFileProtocolTest, CommonProtocolTest,
+                         Values(OverlayFileProtocolFactory));
+
+// Memory protocol that records which folders are listed.
+class ListRecordingProtocol : public MemoryFileProtocol {
+ public:
+  std::vector<std::string> TakeListedFolders() {
+    absl::MutexLock lock(&mutex_);
+    return std::exchange(listed_folders_, {});
+  }
+
+ protected:
+  std::vector<std::string> BasicList(std::string_view protocol_name,
+                                     std::string_view path) override {
+    {
+      absl::MutexLock lock(&mutex_);
+      listed_folders_.emplace_back(path);
+    }
+    return MemoryFileProtocol::BasicList(protocol_name, path);
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::string> listed_folders_ ABSL_GUARDED_BY(mutex_);
+};
+
+class OverlayFileProtocolTest : public ::testing::Test {
+ protected:
+  OverlayFileProtocolTest() {
+    auto top = std::make_unique<ListRecordingProtocol>();
+    auto bottom = std::make_unique<ListRecordingProtocol>();
+    top_ = top.get();
+    bottom_ = bottom.get();
+    layers_.push_back(std::move(top));
+    layers_.push_back(std::move(bottom));
+  }
+
+  // Moves the layers into an overlay registered as "overlay".
+  void Init() {
+    auto protocol = OverlayFileProtocol::Create(std::move(layers_));
+    ASSERT_NE(protocol, nullptr);
+    protocol_ = protocol.get();
+    ASSERT_TRUE(file_system_.Register(std::move(protocol), "overlay"));
+  }
+
+  // Writes a file directly to a layer.
+  void WriteLayer(FileProtocol* layer, std::string_view path,
+                  std::string_view contents) {
+    auto file = layer->OpenFile("mem", path, kNewFileFlags);
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(file->Write(contents.data(), contents.size()), contents.size());
+  }
+
+  std::string Read(std::string_view path) {
+    std::string contents;
+    EXPECT_TRUE(file_system_.ReadFile(path, &contents));
+    return contents;
+  }
+
+  std::vector<std::unique_ptr<FileProtocol>> layers_;
+  ListRecordingProtocol* top_ = nullptr;
+  ListRecordingProtocol* bottom_ = nullptr;
+  FileSystem file_system_;
+  OverlayFileProtocol* protocol_ = nullptr;
+};
+
+TEST_F(OverlayFileProtocolTest, CreateFailsWithInvalidLayers) {
+  EXPECT_EQ(OverlayFileProtocol::Create({}), nullptr);
+  layers_.push_back(nullptr);
+  EXPECT_EQ(OverlayFileProtocol::Create(std::move(layers_)), nullptr);
+}
+
+TEST_F(OverlayFileProtocolTest, Construct) {
+  Init();
+  EXPECT_EQ(protocol_->GetFlags(), kReadOnlyFileProtocolFlags);
+  EXPECT_THAT(protocol_->GetDefaultNames(), IsEmpty());
+  EXPECT_EQ(protocol_->GetLayerCount(), 2);
+  EXPECT_EQ(protocol_->GetLayer(0), top_);
+  EXPECT_EQ(protocol_->GetLayer(1), bottom_);
+}
+
+TEST_F(OverlayFileProtocolTest, HigherPriorityLayerWins) {
+  WriteLayer(top_, "/shared", "top");
+  WriteLayer(bottom_, "/shared", "bottom");
+  WriteLayer(bottom_, "/base", "base content");
+  Init();
+  EXPECT_EQ(Read("overlay:/shared"), "top");
+  EXPECT_EQ(Read("overlay:/base"), "base content");
+  EXPECT_EQ(file_system_.GetPathInfo("overlay:/base").size, 12);
+  EXPECT_EQ(file_system_.GetPathInfo("overlay:/shared").size, 3);
+
+  std::string buffer(4, '\0');
+  int64_t result = -2;
+  file_system_.ReadFileAsync("overlay:/base", 5, buffer.data(), 4,
+                             [&result](int64_t bytes) { result = bytes; });
+  EXPECT_EQ(result, 4);
+  EXPECT_EQ(buffer, "cont");
+  protocol_->ReadFileAsync("overlay", "/missing", 0, buffer.data(), 4,
+                           [&result](int64_t bytes) { result = bytes; });
+  EXPECT_EQ(result, -1);
+}
+
+TEST_F(OverlayFileProtocolTest, FoldersAreMerged) {
+  ASSERT_TRUE(
+      top_->CreateFolder("mem", "/folder/sub", FolderMode::kRecursive));
+  WriteLayer(top_, "/folder/a", "top a");
+  WriteLayer(top_, "/folder/sub/c", "c");
+  ASSERT_TRUE(bottom_->CreateFolder("mem", "/folder", FolderMode::kNormal));
+  WriteLayer(bottom_, "/folder/a", "bottom a");
+  WriteLayer(bottom_, "/folder/b", "b");
+  Init();
+  EXPECT_THAT(file_system_.List("overlay:/folder"),
+              UnorderedElementsAre("overlay:/folder/a", "overlay:/folder/b",
+                                   "overlay:/folder/sub"));
+  EXPECT_THAT(file_system_.ListFiles("overlay:/", FolderMode::kRecursive),
+              UnorderedElementsAre("overlay:/folder/a", "overlay:/folder/b",
+                                   "overlay:/folder/sub/c"));
+  EXPECT_EQ(Read("overlay:/folder/a"), "top a");
+  EXPECT_EQ(Read("overlay:/folder/b"), "b");
+}
+
+TEST_F(OverlayFileProtocolTest, FileHidesFolder) {
+  WriteLayer(top_, "/path", "file");
+  ASSERT_TRUE(top_->CreateFolder("mem", "/folder", FolderMode::kNormal));
+  ASSERT_TRUE(
+      bottom_->CreateFolder("mem", "/path/sub", FolderMode::kRecursive));
+  WriteLayer(bottom_, "/path/sub/file", "hidden");
+  WriteLayer(bottom_, "/folder", "hidden");
+  Init();
+  EXPECT_EQ(file_system_.GetPathInfo("overlay:/path").type, PathType::kFile);
+  EXPECT_EQ(Read("overlay:/path"), "file");
+  EXPECT_FALSE(file_system_.IsValidPath("overlay:/path/sub"));
+  EXPECT_FALSE(file_system_.IsValidPath("overlay:/path/sub/file"));
+  EXPECT_EQ(file_system_.GetPathInfo("overlay:/folder").type,
+            PathType::kFolder);
+  EXPECT_EQ(file_system_.OpenFile("overlay:/folder", kReadFileFlags), nullptr);
+}
+
+TEST_F(OverlayFileProtocolTest, Refresh) {
+  WriteLayer(bottom_, "/file", "old");
+  Init();
+  EXPECT_EQ(Read("overlay:/file"), "old");
+
+  // Changes to the layers are not visible until the index is refreshed.
+  WriteLayer(top_, "/file", "new");
+  WriteLayer(top_, "/added", "added");
+  EXPECT_EQ(Read("overlay:/file"), "old");
+  EXPECT_FALSE(file_system_.IsValidPath("overlay:/added"));
+  protocol_->Refresh();
+  EXPECT_EQ(Read("overlay:/file"), "new");
+  EXPECT_THAT(file_system_.List("overlay:/"),
+              UnorderedElementsAre("overlay:/added", "overlay:/file"));
+}
+
+TEST_F(OverlayFileProtocolTest, RefreshOnWatchedChange) {
+  WriteLayer(bottom_, "/file", "old");
+  Init();
+  EXPECT_EQ(Read("overlay:/file"), "old");
+
+  WriteLayer(top_, "/file", "new");
+  ASSERT_TRUE(bottom_->CreateFolder("mem", "/folder", FolderMode::kNormal));
+  top_->DispatchChanges();
+  bottom_->DispatchChanges();
+  EXPECT_EQ(Read("overlay:/file"), "new");
+  EXPECT_EQ(file_system_.GetPathInfo("overlay:/file").size, 3);
+  EXPECT_EQ(file_system_.GetPathInfo("overlay:/folder").type,
+            PathType::kFolder);
+
+  // New folders are watched as well.
+  WriteLayer(bottom_, "/folder/file", "in folder");
+  bottom_->DispatchChanges();
+  EXPECT_EQ(Read("overlay:/folder/file"), "in folder");
+
+  ASSERT_TRUE(top_->DeleteFile("mem", "/file"));
+  ASSERT_TRUE(bottom_->DeleteFolder("mem", "/folder", FolderMode::kRecursive));
+  top_->DispatchChanges();
+  bottom_->DispatchChanges();
+  EXPECT_EQ(Read("overlay:/file"), "old");
+  EXPECT_THAT(file_system_.List("overlay:/"),
+              UnorderedElementsAre("overlay:/file"));
+}
+
+TEST_F(OverlayFileProtocolTest, WatchedChangeOnlyUpdatesChangedPaths) {
+  ASSERT_TRUE(top_->CreateFolder("mem", "/top", FolderMode::kNormal));
+  ASSERT_TRUE(bottom_->CreateFolder("mem", "/folder", FolderMode::kNormal));
+  WriteLayer(bottom_, "/folder/file", "old");
+  Init();
+  top_->TakeListedFolders();
+  bottom_->TakeListedFolders();
+
+  // Changing a file does not list any folders, however many changes there
+  // are and lookups see them.
+  WriteLayer(bottom_, "/folder/file", "new contents");
+  WriteLayer(bottom_, "/folder/other", "other");
+  bottom_->DispatchChanges();
+  EXPECT_EQ(file_system_.GetPathInfo("overlay:/folder/file").size, 12);
+  EXPECT_THAT(file_system_.List("overlay:/folder"),
+              UnorderedElementsAre("overlay:/folder/file",
+                                   "overlay:/folder/other"));
+  EXPECT_THAT(top_->TakeListedFolders(), IsEmpty());
+  EXPECT_THAT(bottom_->TakeListedFolders(), IsEmpty());
+
+  // Only the new folder is listed.
+  ASSERT_TRUE(bottom_->CreateFolder("mem", "/folder/sub", FolderMode::kNormal));
+  WriteLayer(bottom_, "/folder/sub/file", "sub");
+  bottom_->DispatchChanges();
+  EXPECT_EQ(Read("overlay:/folder/sub/file"), "sub");
+  EXPECT_EQ(Read("overlay:/folder/file"), "new contents");
+  EXPECT_THAT(bottom_->TakeListedFolders(),
+              AllOf(Not(IsEmpty()), Each("/folder/sub")));
+  EXPECT_THAT(top_->TakeListedFolders(), IsEmpty());
+}
+
+TEST_F(OverlayFileProtocolTest, ConcurrentLookupsUpdateOnce) {
+  Init();
+  ASSERT_TRUE(bottom_->CreateFolder("mem", "/folder", FolderMode::kNormal));
+  WriteLayer(bottom_, "/folder/file", "file");
+  bottom_->DispatchChanges();
+  bottom_->TakeListedFolders();
+
+  // The new folder is listed once for folders and once for files, and then
+  // again as it was not watched when it was first listed.
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([this] {
+      EXPECT_TRUE(file_system_.IsValidFile("overlay:/folder/file"));
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(file_system_.IsValidFile("overlay:/folder/file"));
+  EXPECT_EQ(bottom_->TakeListedFolders().size(), 4);
+}
+
+TEST_F(OverlayFileProtocolTest, WatchedChangeHidesAndRevealsFolder) {
+  ASSERT_TRUE(
+      bottom_->CreateFolder("mem", "/path/sub", FolderMode::kRecursive));
+  WriteLayer(bottom_, "/path/sub/file", "hidden");
+  Init();
+  EXPECT_EQ(Read("overlay:/path/sub/file"), "hidden");
+
+  WriteLayer(top_, "/path", "file");
+  top_->DispatchChanges();
+  EXPECT_EQ(Read("overlay:/path"), "file");
+  EXPECT_FALSE(file_system_.IsValidPath("overlay:/path/sub"));
+  EXPECT_FALSE(file_system_.IsValidPath("overlay:/path/sub/file"));
+
+  // Changes under the hidden folder stay hidden.
+  WriteLayer(bottom_, "/path/sub/other", "hidden");
+  bottom_->DispatchChanges();
+  EXPECT_FALSE(file_system_.IsValidPath("overlay:/path/sub/other"));
+
+  ASSERT_TRUE(top_->DeleteFile("mem", "/path"));
+  top_->DispatchChanges();
+  EXPECT_EQ(file_system_.GetPathInfo("overlay:/path").type,
+            PathType::kFolder);
+  EXPECT_THAT(file_system_.ListFiles("overlay:/", FolderMode::kRecursive),
+              UnorderedElementsAre("overlay:/path/sub/file",
+                                   "overlay:/path/sub/other"));
+}
+
+TEST_F(OverlayFileProtocolTest, RefreshOnLocalChange) {
+  auto local = LocalFileProtocol::CreateTemp("gbtest");
+  ASSERT_NE(local, nullptr);
+  FileProtocol* layer = local.get();
+  ASSERT_TRUE(layer->CreateFolder("file", "/folder", FolderMode::kNormal));
+  layers_.insert(layers_.begin(), std::move(local));
+  Init();
+
+  auto wait_for_file = [this](std::string_view path) {
+    const absl::Time deadline = absl::Now() + absl::Seconds(10);
+    while (!file_system_.IsValidFile(path) && absl::Now() < deadline) {
+      absl::SleepFor(absl::Milliseconds(1));
+    }
+    return file_system_.IsValidFile(path);
+  };
+  auto file = layer->OpenFile("file", "/folder/file", kNewFileFlags);
+  ASSERT_NE(file, nullptr);
+  file.reset();
+  EXPECT_TRUE(wait_for_file("overlay:/folder/file"));
+}
+
+}  // namespace
+}  // namespace gb
@@ -443,7 +443,10 @@ std::string NormalizePath(std::string_view path, PathFlags flags,
           while (IsSeparator(in, in_end)) {
             ++in;
           }
+          continue;
         }
+        // Any other segment that starts with a dot is a normal segment.
+        break;
       }
       if (!is_dot_path) {
         segments.push_back(out);
@@ -480,4 +483,80 @@ std::string NormalizePath(std::string_view path, PathFlags flags,
   return new_path;
 }
 
+std::string_view NormalizePath(std::string_view path, std::string* buffer,
+                               PathFlags flags, PathFlags* failed_flag) {
+  if (IsNormalizedPath(path, flags)) {
+    if (failed_flag != nullptr) {
+      *failed_flag = {};
+    }
+    return path;
+  }
+  *buffer = NormalizePath(path, flags, failed_flag);
+  return *buffer;
+}
+
+bool IsNormalizedPath(std::string_view path, PathFlags flags) {
+  // Check for a protocol first, if requested.
+  if (flags.Intersects(kProtocolPathFlags)) {
+    const auto protocol_end = path.find_first_of(":/\\");
+    if (protocol_end != std::string_view::npos && path[protocol_end] == ':') {
+      if (!IsValidProtocolName(path.substr(0, protocol_end))) {
+        return false;
+      }
+      path.remove_prefix(protocol_end + 1);
+    } else if (flags.IsSet(PathFlag::kRequireProtocol)) {
+      return false;
+    }
+  }
+  if (path.empty()) {
+    return false;
+  }
+
+  // Validate root.
+  bool segment_is_host = false;
+  if (path[0] != '/') {
+    if (flags.Intersects({PathFlag::kRequireHost, PathFlag::kRequireRoot})) {
+      return false;
+    }
+  } else if (path.size() > 1 && path[1] == '/') {
+    if (!flags.Intersects(kHostPathFlags)) {
+      return false;
+    }
+    path.remove_prefix(2);
+    segment_is_host = true;
+  } else if (flags.IsSet(PathFlag::kRequireHost)) {
+    return false;
+  } else {
+    path.remove_prefix(1);
+    if (path.empty()) {
+      return true;
+    }
+  }
+
+  // Check each segment.
+  const bool require_lowercase = flags.IsSet(PathFlag::kRequireLowercase);
+  while (true) {
+    const auto segment_end = path.find('/');
+    const std::string_view segment = path.substr(0, segment_end);
+    if (segment.empty()) {
+      // Either a redundant separator, or a trailing separator (or no host).
+      return !segment_is_host && segment_end == std::string_view::npos &&
+             flags.IsSet(PathFlag::kAllowTrailingSlash);
+    }
+    if (!segment_is_host && (segment == "." || segment == "..")) {
+      return false;
+    }
+    for (char ch : segment) {
+      if (ch == '\\' || (require_lowercase && absl::ascii_isupper(ch))) {
+        return false;
+      }
+    }
+    if (segment_end == std::string_view::npos) {
+      return true;
+    }
+    path.remove_prefix(segment_end + 1);
+    segment_is_host = false;
+  }
+}
+
 }  // namespace gb
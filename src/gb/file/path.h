@@ -297,6 +297,27 @@ inline std::string NormalizePath(std::string_view path,
   return NormalizePath(path, kGenericPathFlags, failed_flag);
 }
 
+// Normalizes the path as NormalizePath above, but avoids allocating if the path
+// is already normalized.
+//
+// If the path is already normalized (see IsNormalizedPath), this returns the
+// path itself. Otherwise, the normalized path is stored in 'buffer' and a view
+// of it is returned. Either way, the result is only valid as long as both
+// 'path' and 'buffer' are unchanged.
+std::string_view NormalizePath(std::string_view path, std::string* buffer,
+                               PathFlags flags = kGenericPathFlags,
+                               PathFlags* failed_flag = nullptr);
+
+// Returns true if the path is already normalized according to the specified
+// flags, such that NormalizePath would return it unchanged.
+//
+// This is a fast check that does not allocate. It conservatively returns false
+// for some unusual paths that are already normalized (for instance, relative
+// paths that start with ".." segments), and for paths that cannot be
+// normalized with the flags.
+bool IsNormalizedPath(std::string_view path,
+                      PathFlags flags = kGenericPathFlags);
+
 }  // namespace gb
 
 #endif  // GB_FILE_PATH_H_
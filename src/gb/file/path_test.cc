@@ -946,6 +946,17 @@ bool TestNormalize(std::string_view path, PathFlags flags,
   auto normalized_path = NormalizePath(path, flags, &failed_flag);
   EXPECT_EQ(normalized_path, expected_path);
   EXPECT_EQ(failed_flag, expected_failed_flag);
+
+  // The non-allocating version must always match.
+  std::string buffer;
+  PathFlags view_failed_flag;
+  view_failed_flag += PathFlag::kRequireLowercase;
+  EXPECT_EQ(NormalizePath(path, &buffer, flags, &view_failed_flag),
+            expected_path);
+  EXPECT_EQ(view_failed_flag, expected_failed_flag);
+  if (IsNormalizedPath(path, flags)) {
+    EXPECT_EQ(path, expected_path);
+  }
   return normalized_path == expected_path &&
          failed_flag == expected_failed_flag;
 }
@@ -998,6 +1009,8 @@ TEST(PathTest, NormalizePath) {
   EXPECT_TRUE(TestNormalize("/.", {}, "/", {}));
   EXPECT_TRUE(TestNormalize("/./", {}, "/", {}));
   EXPECT_TRUE(TestNormalize("/..", {}, "/..", {}));
+  EXPECT_TRUE(TestNormalize("a/.hidden", {}, "a/.hidden", {}));
+  EXPECT_TRUE(TestNormalize("./.a/..b/...", {}, ".a/..b/...", {}));
   EXPECT_TRUE(TestNormalize("/../", {}, "/..", {}));
   EXPECT_TRUE(TestNormalize("/a/..", {}, "/", {}));
   EXPECT_TRUE(TestNormalize("/a/../", {}, "/", {}));
@@ -1355,5 +1368,33 @@ TEST(PathTest, NormalizePath) {
   // clang-format on
 }
 
+TEST(PathTest, IsNormalizedPath) {
+  EXPECT_TRUE(IsNormalizedPath("/"));
+  EXPECT_TRUE(IsNormalizedPath("a"));
+  EXPECT_TRUE(IsNormalizedPath("/a/b.txt"));
+  EXPECT_TRUE(IsNormalizedPath("/a/.hidden"));
+  EXPECT_TRUE(IsNormalizedPath("protocol:/a/b"));
+  EXPECT_TRUE(IsNormalizedPath("protocol:a"));
+  EXPECT_TRUE(IsNormalizedPath("//host/a"));
+  EXPECT_TRUE(IsNormalizedPath("a/b/", PathFlag::kAllowTrailingSlash));
+  EXPECT_TRUE(IsNormalizedPath("PROTOCOL:a", kLocalPathFlags));
+  EXPECT_TRUE(IsNormalizedPath("/a/b", PathFlag::kRequireLowercase));
+
+  EXPECT_FALSE(IsNormalizedPath(""));
+  EXPECT_FALSE(IsNormalizedPath("protocol:"));
+  EXPECT_FALSE(IsNormalizedPath("PROTOCOL:/a"));
+  EXPECT_FALSE(IsNormalizedPath("a/"));
+  EXPECT_FALSE(IsNormalizedPath("a//b"));
+  EXPECT_FALSE(IsNormalizedPath("a\\b"));
+  EXPECT_FALSE(IsNormalizedPath("a/./b"));
+  EXPECT_FALSE(IsNormalizedPath("a/../b"));
+  EXPECT_FALSE(IsNormalizedPath("//"));
+  EXPECT_FALSE(IsNormalizedPath("//a", kLocalPathFlags));
+  EXPECT_FALSE(IsNormalizedPath("/A", PathFlag::kRequireLowercase));
+  EXPECT_FALSE(IsNormalizedPath("a", kUrlPathFlags));
+  EXPECT_FALSE(IsNormalizedPath("protocol:/a", kUrlPathFlags));
+  EXPECT_FALSE(IsNormalizedPath("a", PathFlag::kRequireRoot));
+}
+
 }  // namespace
 }  // namespace gb
@@ -6,6 +6,10 @@
 #ifndef GB_BASE_FILE_RAW_FILE_H_
 #define GB_BASE_FILE_RAW_FILE_H_
 
+#include <stdint.h>
+
+#include "absl/types/span.h"
+
 namespace gb {
 
 // Raw file to underlying file protocol file.
@@ -14,7 +18,8 @@ namespace gb {
 // buffered. If it is buffered, then all remaining contents should be flushed
 // when the RawFile is destroyed.
 //
-// Derived class of RawFile must be thread-compatible.
+// Derived class of RawFile must be thread-compatible, except for ReadAt (see
+// below).
 class RawFile {
  public:
   RawFile(const RawFile&) = delete;
@@ -35,11 +40,38 @@ class RawFile {
   // opened for writing.
   virtual int64_t Write(const void* buffer, int64_t size) = 0;
 
+  // Writes all of the buffers to the file in order, as if they were a single
+  // contiguous buffer. This should return the total number of bytes actually
+  // written, or -1 if vectored writes are not supported (in which case File
+  // gathers the buffers into larger calls to Write). This is only called if the
+  // file was opened for writing.
+  virtual int64_t WriteV(absl::Span<const absl::Span<const uint8_t>> buffers) {
+    return -1;
+  }
+
   // Reads the requested number of bytes from the file, returning the total
   // number of bytes actually read. This is only called if the file was open for
   // reading.
   virtual int64_t Read(void* buffer, int64_t size) = 0;
 
+  // Reads the requested number of bytes starting at 'offset', without using or
+  // changing the current position. This should return the total number of
+  // bytes actually read, or -1 if positional reads are not supported (in which
+  // case File emulates them with SeekTo and Read). This is only called if the
+  // file was open for reading.
+  //
+  // If implemented, this must be thread-safe relative to other ReadAt calls as
+  // long as the file is not being written.
+  virtual int64_t ReadAt(int64_t offset, void* buffer, int64_t size) {
+    return -1;
+  }
+
+  // Returns the entire contents of the file, if the file is mapped into memory.
+  // This is only called if the file was opened with FileFlag::kMapped, and the
+  // view must remain valid until the RawFile is destroyed. By default, files
+  // are not mapped and this returns an empty span.
+  virtual absl::Span<const uint8_t> GetMappedView() { return {}; }
+
  protected:
   RawFile() = default;
 };
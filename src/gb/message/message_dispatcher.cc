@@ -29,14 +29,39 @@ bool MessageDispatcher::SetSystem(MessageInternal, MessageSystem* new_system) {
   return true;
 }
 
+void MessageDispatcher::SetMetrics(MessageMetrics* metrics,
+                                   std::string_view name) {
+  metrics_ = metrics;
+  metrics_name_.assign(name.data(), name.size());
+}
+
 void MessageDispatcher::Dispatch(const Message& message) {
   WeakLock<MessageSystem> system(&system_);
   if (system == nullptr) {
-    message.type->Destroy(message.message);
+    message.envelope->Release();
     return;
   }
-  system->DoDispatch({}, this, message.from, message.to, message.type,
-                     message.message);
+  system->DoDispatch({}, this, message.from, message.to, message.envelope);
+}
+
+std::vector<MessageEndpointId> MessageDispatcher::GetRecipients(
+    const Message& message) {
+  WeakLock<MessageSystem> system(&system_);
+  if (system == nullptr) {
+    return {};
+  }
+  return system->GetRecipientIds({}, this, message.to);
+}
+
+void MessageDispatcher::DispatchToRecipient(const Message& message,
+                                            MessageEndpointId recipient) {
+  WeakLock<MessageSystem> system(&system_);
+  if (system == nullptr) {
+    message.envelope->Release();
+    return;
+  }
+  system->DoDispatchRecipient({}, this, message.from, recipient,
+                              message.envelope);
 }
 
 //------------------------------------------------------------------------------
@@ -50,7 +75,7 @@ PollingMessageDispatcher::~PollingMessageDispatcher() {
     messages.swap(messages_);
   }
   for (const auto& message : messages) {
-    message.type->Destroy(message.message);
+    message.envelope->Release();
   }
 }
 
@@ -58,6 +83,7 @@ void PollingMessageDispatcher::AddMessage(MessageInternal,
                                           const Message& message) {
   absl::MutexLock lock(&mutex_);
   messages_.emplace_back(message);
+  RecordQueueDepth(messages_.size());
 }
 
 void PollingMessageDispatcher::Update() {
@@ -103,6 +129,7 @@ void ThreadMessageDispatcher::Cancel() {
       return;
     }
     exit_thread_ = true;
+    thread_cv_.Signal();
   }
   thread_.join();
   std::vector<Message> messages;
@@ -119,29 +146,33 @@ void ThreadMessageDispatcher::AddMessage(MessageInternal,
                                          const Message& message) {
   absl::MutexLock lock(&thread_mutex_);
   if (exit_thread_) {
-    message.type->Destroy(message.message);
+    message.envelope->Release();
     return;
   }
   messages_.emplace_back(message);
-}
+  RecordQueueDepth(messages_.size());
 
-bool ThreadMessageDispatcher::ProcessMessagesReady() {
-  return exit_thread_ || !messages_.empty();
+  // The worker thread only waits when the queue is empty, so it only needs to
+  // be woken for the first message.
+  if (messages_.size() == 1) {
+    thread_cv_.Signal();
+  }
 }
 
 void ThreadMessageDispatcher::ProcessMessages() {
   absl::MutexLock lock(&thread_mutex_);
   while (!exit_thread_) {
-    thread_mutex_.Await(
-        absl::Condition(this, &ThreadMessageDispatcher::ProcessMessagesReady));
+    while (!exit_thread_ && messages_.empty()) {
+      thread_cv_.Wait(&thread_mutex_);
+    }
 
-    std::vector<Message> messages;
-    messages.swap(messages_);
+    dispatch_messages_.swap(messages_);
 
     thread_mutex_.Unlock();
-    for (const auto& message : messages) {
+    for (const auto& message : dispatch_messages_) {
       Dispatch(message);
     }
+    dispatch_messages_.clear();
     thread_mutex_.Lock();
   }
 }
@@ -6,11 +6,16 @@
 #ifndef GB_BASE_MESSAGE_DISPATCHER_H_
 #define GB_BASE_MESSAGE_DISPATCHER_H_
 
+#include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 
 #include "absl/synchronization/mutex.h"
 #include "gb/base/weak_ptr.h"
 #include "gb/message/message_endpoint.h"
+#include "gb/message/message_envelope.h"
+#include "gb/message/message_metrics.h"
 
 namespace gb {
 
@@ -35,13 +40,22 @@ class MessageDispatcher {
 
   const WeakPtr<MessageSystem>& GetSystem() const { return system_; }
 
+  // Enables recording of queue depth metrics under the specified name.
+  //
+  // Metrics are disabled by default. This must be called before the
+  // dispatcher is passed to a MessageSystem, and "metrics" must outlive the
+  // dispatcher.
+  void SetMetrics(MessageMetrics* metrics, std::string_view name);
+
  public:
   // This struct describes a message in transit.
+  //
+  // Each Message owns one reference to its envelope, which may be shared with
+  // other dispatchers the same message was sent to.
   struct Message {
     MessageEndpointId from = kNoMessageEndpointId;
     MessageEndpointId to = kNoMessageEndpointId;
-    TypeInfo* type = nullptr;
-    void* message = nullptr;
+    MessageEnvelope* envelope = nullptr;
   };
 
   // Adds a message to the dispatcher.
@@ -50,7 +64,8 @@ class MessageDispatcher {
   // message is actually dispatched. When the derived class is ready to dispatch
   // the message to all receiving endpoints, it must call Dispatch with the
   // message. After calling Dispatch the message is invalid and must be
-  // discarded.
+  // discarded. If the message is never dispatched, the derived class must call
+  // Release on the envelope instead.
   virtual void AddMessage(MessageInternal, const Message& message) = 0;
 
   // Updates the internal system pointer.
@@ -68,8 +83,29 @@ class MessageDispatcher {
   // AddMessage for more details.
   void Dispatch(const Message& message);
 
+  // Called by derived classes to get the endpoints that receive the message,
+  // so they can be dispatched to separately with DispatchToRecipient. Returns
+  // an empty list if there are no recipients.
+  std::vector<MessageEndpointId> GetRecipients(const Message& message);
+
+  // Called by derived classes to dispatch the message to a single recipient
+  // returned by GetRecipients. Like Dispatch, "message" is considered invalid
+  // after this call completes.
+  void DispatchToRecipient(const Message& message,
+                           MessageEndpointId recipient);
+
+  // Called by derived classes to record the current number of queued messages
+  // when metrics are enabled.
+  void RecordQueueDepth(size_t depth) {
+    if (metrics_ != nullptr) {
+      metrics_->RecordQueueDepth(metrics_name_, static_cast<int>(depth));
+    }
+  }
+
  private:
   WeakPtr<MessageSystem> system_;
+  MessageMetrics* metrics_ = nullptr;
+  std::string metrics_name_;
 };
 
 //------------------------------------------------------------------------------
@@ -115,6 +151,10 @@ class PollingMessageDispatcher : public MessageDispatcher {
 // be faster, as the worker thread is notified as soon as a new message arrives.
 // However, this dispatcher does require that all handlers that are called be
 // thread-safe.
+//
+// Messages are double-buffered: producers append to a queue whose capacity is
+// retained across dispatches, and the worker thread is only signaled when the
+// queue goes from empty to non-empty.
 class ThreadMessageDispatcher : public MessageDispatcher {
  public:
   ThreadMessageDispatcher();
@@ -131,13 +171,17 @@ class ThreadMessageDispatcher : public MessageDispatcher {
   void AddMessage(MessageInternal, const Message& message) override;
 
  private:
-  bool ProcessMessagesReady() ABSL_SHARED_LOCKS_REQUIRED(thread_mutex_);
   void ProcessMessages();
 
   std::thread thread_;
   mutable absl::Mutex thread_mutex_;
+  absl::CondVar thread_cv_;
   bool exit_thread_ ABSL_GUARDED_BY(thread_mutex_) = false;
   std::vector<Message> messages_ ABSL_GUARDED_BY(thread_mutex_);
+
+  // Messages currently being dispatched. This is only accessed by the worker
+  // thread, and is swapped with messages_ to retain the capacity of both.
+  std::vector<Message> dispatch_messages_;
 };
 
 }  // namespace gb
@@ -60,37 +60,48 @@ bool MessageEndpoint::IsSubscribed(MessageEndpointId endpoint) const {
 }
 
 void MessageEndpoint::Receive(MessageInternal, MessageEndpointId from,
-                              TypeInfo* type, const void* message) {
-  auto key = type->Key();
+                              TypeInfo* type, const void* messages, int count,
+                              MessageEnvelope* envelope) {
   int queue_index = 0;
 
   // Find the handler.
   absl::WriterMutexLock lock(&handler_mutex_);
   if (calling_handler_) {
-    queued_messages_.emplace_back(from, type, type->Clone(message));
+    if (envelope != nullptr) {
+      envelope->AddRef();
+    } else {
+      envelope = MessageEnvelope::Create(type, messages, count);
+    }
+    queued_messages_.emplace_back(from, envelope);
     return;
   }
   while (true) {
-    auto it = handlers_.find(key);
-    if (it == handlers_.end()) {
-      return;
-    }
-
-    // In order to allow handlers to unregister themselves from within their
-    // callback, we need to temporarily move the handler out of the map and
-    // release the lock, to make the call.
-    GenericHandler handler = std::move(it->second);
-    calling_handler_ = true;
-    calling_thread_ = std::this_thread::get_id();
-    handler_mutex_.Unlock();
-    handler(from, message);
-    handler_mutex_.Lock();
-    calling_handler_ = false;
-
-    // Reset the handler in the map.
-    it = handlers_.find(key);
-    if (it != handlers_.end()) {
-      it->second = std::move(handler);
+    // Messages without a handler are dropped.
+    auto key = type->Key();
+    if (auto it = handlers_.find(key); it != handlers_.end()) {
+      // In order to allow handlers to unregister themselves from within their
+      // callback, we need to temporarily move the handler out of the map and
+      // release the lock, to make the call. A batch of messages is delivered
+      // in its entirety to the handler that was registered at the start of the
+      // batch.
+      GenericHandler handler = std::move(it->second);
+      calling_handler_ = true;
+      calling_thread_ = std::this_thread::get_id();
+      handler_mutex_.Unlock();
+      const size_t message_size = type->GetSize();
+      const auto* message = static_cast<const std::byte*>(messages);
+      for (int i = 0; i < count; ++i) {
+        handler(from, message);
+        message += message_size;
+      }
+      handler_mutex_.Lock();
+      calling_handler_ = false;
+
+      // Reset the handler in the map.
+      it = handlers_.find(key);
+      if (it != handlers_.end()) {
+        it->second = std::move(handler);
+      }
     }
 
     if (queue_index >= static_cast<int>(queued_messages_.size())) {
@@ -99,24 +110,24 @@ void MessageEndpoint::Receive(MessageInternal, MessageEndpointId from,
 
     const auto& queued_message = queued_messages_[queue_index++];
     from = queued_message.from;
-    type = queued_message.type;
-    key = type->Key();
-    message = queued_message.message;
+    type = queued_message.envelope->GetType();
+    messages = queued_message.envelope->GetMessageData();
+    count = queued_message.envelope->GetCount();
   }
 
   for (auto& queued_message : queued_messages_) {
-    queued_message.type->Destroy(queued_message.message);
+    queued_message.envelope->Release();
   }
   queued_messages_.clear();
 }
 
 bool MessageEndpoint::DoSend(MessageEndpointId to, TypeInfo* type,
-                             const void* message) {
+                             const void* messages, int count) {
   WeakLock<MessageSystem> system(&system_);
   if (system == nullptr) {
     return false;
   }
-  return system->DoSend({}, id_, to, type, message);
+  return system->DoSend({}, id_, to, type, messages, count);
 }
 
 }  // namespace gb
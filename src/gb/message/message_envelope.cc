@@ -0,0 +1,112 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/message/message_envelope.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+
+#include "absl/log/check.h"
+#include "gb/alloc/pool_allocator.h"
+
+namespace gb {
+
+namespace {
+
+// Number of allocations in each pool bucket.
+inline constexpr size_t kPoolBucketSize = 64;
+
+// Allocation size of each pool, in increasing order. Envelopes that do not fit
+// in the largest pool are allocated from the default allocator.
+inline constexpr size_t kPoolSizes[] = {64, 128, 256, 512};
+inline constexpr int kPoolCount = static_cast<int>(std::size(kPoolSizes));
+inline constexpr size_t kPoolAlign = alignof(std::max_align_t);
+static_assert(kPoolCount == 4, "EnvelopePools constructor must match");
+
+class EnvelopePools {
+ public:
+  EnvelopePools()
+      : pools_{TsPoolAllocator(kPoolBucketSize, kPoolSizes[0], kPoolAlign),
+               TsPoolAllocator(kPoolBucketSize, kPoolSizes[1], kPoolAlign),
+               TsPoolAllocator(kPoolBucketSize, kPoolSizes[2], kPoolAlign),
+               TsPoolAllocator(kPoolBucketSize, kPoolSizes[3], kPoolAlign)} {}
+
+  // Returns the allocator to use for an envelope of the specified total size
+  // and alignment.
+  Allocator* Get(size_t size, size_t align) {
+    if (align <= kPoolAlign) {
+      for (int i = 0; i < kPoolCount; ++i) {
+        if (size <= kPoolSizes[i]) {
+          return &pools_[i];
+        }
+      }
+    }
+    return GetDefaultAllocator();
+  }
+
+ private:
+  TsPoolAllocator pools_[kPoolCount];
+};
+
+EnvelopePools& GetPools() {
+  // Intentionally leaked, as envelopes may outlive static destruction order.
+  static EnvelopePools* pools = new EnvelopePools;
+  return *pools;
+}
+
+size_t AlignUp(size_t size, size_t align) {
+  return (size + align - 1) & ~(align - 1);
+}
+
+}  // namespace
+
+MessageEnvelope* MessageEnvelope::Create(TypeInfo* type, const void* message,
+                                         int count) {
+  DCHECK(count > 0);
+  if (!type->CanClone()) {
+    return nullptr;
+  }
+  const size_t message_size = type->GetSize();
+  const size_t message_align = std::max<size_t>(type->GetAlign(), 1);
+  const size_t message_offset =
+      AlignUp(sizeof(MessageEnvelope), message_align);
+  const size_t size = message_offset + message_size * count;
+  const size_t align = std::max(alignof(MessageEnvelope), message_align);
+
+  Allocator* allocator = GetPools().Get(size, align);
+  void* memory = allocator->Alloc(size, align);
+  if (memory == nullptr && allocator != GetDefaultAllocator()) {
+    allocator = GetDefaultAllocator();
+    memory = allocator->Alloc(size, align);
+  }
+  CHECK(memory != nullptr) << "Failed to allocate message envelope";
+
+  auto* envelope = new (memory) MessageEnvelope(type, count, allocator);
+  auto* dst = static_cast<std::byte*>(memory) + message_offset;
+  auto* src = static_cast<const std::byte*>(message);
+  envelope->message_ = dst;
+  for (int i = 0; i < count; ++i) {
+    type->CloneAt(dst, src);
+    dst += message_size;
+    src += message_size;
+  }
+  return envelope;
+}
+
+void MessageEnvelope::Release() {
+  if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  for (int i = 0; i < count_; ++i) {
+    type_->DestroyAt(const_cast<void*>(GetMessageData(i)));
+  }
+  Allocator* allocator = allocator_;
+  this->~MessageEnvelope();
+  allocator->Free(this);
+}
+
+}  // namespace gb
@@ -0,0 +1,81 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_MESSAGE_MESSAGE_ENVELOPE_H_
+#define GB_MESSAGE_MESSAGE_ENVELOPE_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "gb/base/allocator.h"
+#include "gb/base/type_info.h"
+
+namespace gb {
+
+// A MessageEnvelope holds a single reference counted copy of a message (or a
+// batch of messages of the same type) in transit.
+//
+// When a message is sent, exactly one envelope is created for it, and that
+// envelope is shared by every dispatcher and endpoint that needs to hold on to
+// the message. Broadcasting to N endpoints on N different dispatchers is
+// therefore a single allocation and a single copy of the message.
+//
+// The envelope header and the messages are stored contiguously in one
+// allocation. Small envelopes are allocated out of a set of size-segregated
+// pools, while large or over-aligned envelopes fall back to the default
+// allocator.
+//
+// This class is thread-safe.
+class MessageEnvelope final {
+ public:
+  MessageEnvelope(const MessageEnvelope&) = delete;
+  MessageEnvelope& operator=(const MessageEnvelope&) = delete;
+
+  // Creates a new envelope holding a copy of the message, with a reference
+  // count of one.
+  //
+  // If count is greater than one, then "message" must point to an array of
+  // "count" messages, which are all copied into the envelope in order.
+  //
+  // Returns null if the message type cannot be copied.
+  static MessageEnvelope* Create(TypeInfo* type, const void* message,
+                                 int count = 1);
+
+  // Returns the type of the messages in the envelope.
+  TypeInfo* GetType() const { return type_; }
+
+  // Returns the number of messages in the envelope.
+  int GetCount() const { return count_; }
+
+  // Returns the messages in the envelope. The messages are stored contiguously
+  // as an array. Messages are immutable once sent.
+  const void* GetMessageData() const { return message_; }
+  const void* GetMessageData(int index) const {
+    return static_cast<const std::byte*>(message_) + index * type_->GetSize();
+  }
+
+  // Adds a reference to the envelope. Every reference must be matched by a call
+  // to Release.
+  void AddRef() { ref_count_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Releases a reference to the envelope. When the last reference is released,
+  // the message is destroyed and the envelope is freed.
+  void Release();
+
+ private:
+  MessageEnvelope(TypeInfo* type, int count, Allocator* allocator)
+      : type_(type), count_(count), allocator_(allocator) {}
+  ~MessageEnvelope() = default;
+
+  TypeInfo* const type_;
+  const int count_;
+  Allocator* const allocator_;
+  void* message_ = nullptr;
+  std::atomic<int> ref_count_ = 1;
+};
+
+}  // namespace gb
+
+#endif  // GB_MESSAGE_MESSAGE_ENVELOPE_H_
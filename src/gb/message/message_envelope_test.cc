@@ -0,0 +1,161 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/message/message_envelope.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+struct Counts {
+  int construct = 0;
+  int destruct = 0;
+};
+
+class TestMessage {
+ public:
+  TestMessage(Counts* counts, int value) : counts_(counts), value_(value) {
+    counts_->construct += 1;
+  }
+  TestMessage(const TestMessage& other)
+      : counts_(other.counts_), value_(other.value_) {
+    counts_->construct += 1;
+  }
+  TestMessage& operator=(const TestMessage&) = delete;
+  ~TestMessage() { counts_->destruct += 1; }
+
+  int GetValue() const { return value_; }
+
+ private:
+  Counts* const counts_;
+  const int value_;
+};
+
+class NoCopyMessage {
+ public:
+  NoCopyMessage() = default;
+  NoCopyMessage(const NoCopyMessage&) = delete;
+  NoCopyMessage& operator=(const NoCopyMessage&) = delete;
+};
+
+struct LargeMessage {
+  char data[4096];
+};
+
+struct alignas(64) AlignedMessage {
+  int value;
+};
+
+TEST(MessageEnvelopeTest, CreateCopiesMessage) {
+  Counts counts;
+  TestMessage message(&counts, 42);
+  MessageEnvelope* envelope =
+      MessageEnvelope::Create(TypeInfo::Get<TestMessage>(), &message);
+  ASSERT_NE(envelope, nullptr);
+  EXPECT_EQ(envelope->GetType(), TypeInfo::Get<TestMessage>());
+  EXPECT_NE(envelope->GetMessageData(), &message);
+  EXPECT_EQ(
+      static_cast<const TestMessage*>(envelope->GetMessageData())->GetValue(),
+      42);
+  EXPECT_EQ(counts.construct, 2);
+  EXPECT_EQ(counts.destruct, 0);
+  envelope->Release();
+  EXPECT_EQ(counts.destruct, 1);
+}
+
+TEST(MessageEnvelopeTest, LastReleaseDestroysMessage) {
+  Counts counts;
+  TestMessage message(&counts, 42);
+  MessageEnvelope* envelope =
+      MessageEnvelope::Create(TypeInfo::Get<TestMessage>(), &message);
+  envelope->AddRef();
+  envelope->AddRef();
+  envelope->Release();
+  envelope->Release();
+  EXPECT_EQ(counts.construct, 2);
+  EXPECT_EQ(counts.destruct, 0);
+  envelope->Release();
+  EXPECT_EQ(counts.destruct, 1);
+}
+
+TEST(MessageEnvelopeTest, CreateBatch) {
+  Counts counts;
+  std::vector<TestMessage> messages;
+  messages.reserve(3);
+  for (int i = 0; i < 3; ++i) {
+    messages.emplace_back(&counts, i);
+  }
+  MessageEnvelope* envelope = MessageEnvelope::Create(
+      TypeInfo::Get<TestMessage>(), messages.data(), 3);
+  ASSERT_NE(envelope, nullptr);
+  EXPECT_EQ(envelope->GetCount(), 3);
+  EXPECT_EQ(envelope->GetMessageData(), envelope->GetMessageData(0));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(static_cast<const TestMessage*>(envelope->GetMessageData(i))
+                  ->GetValue(),
+              i);
+  }
+  EXPECT_EQ(counts.construct, 6);
+  envelope->Release();
+  EXPECT_EQ(counts.destruct, 3);
+}
+
+TEST(MessageEnvelopeTest, NoCopyMessageFails) {
+  NoCopyMessage message;
+  EXPECT_EQ(MessageEnvelope::Create(TypeInfo::Get<NoCopyMessage>(), &message),
+            nullptr);
+}
+
+TEST(MessageEnvelopeTest, LargeMessage) {
+  LargeMessage message;
+  for (size_t i = 0; i < sizeof(message.data); ++i) {
+    message.data[i] = static_cast<char>(i);
+  }
+  MessageEnvelope* envelope =
+      MessageEnvelope::Create(TypeInfo::Get<LargeMessage>(), &message);
+  ASSERT_NE(envelope, nullptr);
+  const auto* copy =
+      static_cast<const LargeMessage*>(envelope->GetMessageData());
+  for (size_t i = 0; i < sizeof(message.data); ++i) {
+    ASSERT_EQ(copy->data[i], static_cast<char>(i));
+  }
+  envelope->Release();
+}
+
+TEST(MessageEnvelopeTest, AlignedMessage) {
+  AlignedMessage message = {42};
+  MessageEnvelope* envelope =
+      MessageEnvelope::Create(TypeInfo::Get<AlignedMessage>(), &message);
+  ASSERT_NE(envelope, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(envelope->GetMessageData()) %
+                alignof(AlignedMessage),
+            0);
+  EXPECT_EQ(
+      static_cast<const AlignedMessage*>(envelope->GetMessageData())->value,
+      42);
+  envelope->Release();
+}
+
+TEST(MessageEnvelopeTest, ManySmallMessages) {
+  std::vector<MessageEnvelope*> envelopes;
+  for (int i = 0; i < 1000; ++i) {
+    std::string message = std::to_string(i);
+    envelopes.push_back(
+        MessageEnvelope::Create(TypeInfo::Get<std::string>(), &message));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(*static_cast<const std::string*>(envelopes[i]->GetMessageData()),
+              std::to_string(i));
+    envelopes[i]->Release();
+  }
+}
+
+}  // namespace
+}  // namespace gb
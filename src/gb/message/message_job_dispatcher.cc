@@ -0,0 +1,107 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/message/message_job_dispatcher.h"
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/log.h"
+
+namespace gb {
+
+JobMessageDispatcher::JobMessageDispatcher(JobSystem* job_system)
+    : job_system_(job_system) {}
+
+JobMessageDispatcher::~JobMessageDispatcher() {
+  {
+    WeakLock<MessageSystem> system(&GetSystem());
+    absl::MutexLock lock(&mutex_);
+    LOG_IF(WARNING, system != nullptr && !queues_.empty())
+        << "JobMessageDispatcher was still dispatching messages and "
+           "associated with a MessageSystem at destruction.";
+  }
+  Flush();
+}
+
+void JobMessageDispatcher::Flush() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(
+      +[](absl::flat_hash_map<MessageEndpointId, Messages>* queues) {
+        return queues->empty();
+      },
+      &queues_));
+}
+
+void JobMessageDispatcher::AddMessage(MessageInternal,
+                                      const Message& message) {
+  const std::vector<MessageEndpointId> recipients = GetRecipients(message);
+  if (recipients.empty()) {
+    message.envelope->Release();
+    return;
+  }
+
+  // Each recipient's queue owns a reference to the shared envelope.
+  for (size_t i = 1; i < recipients.size(); ++i) {
+    message.envelope->AddRef();
+  }
+  absl::InlinedVector<MessageEndpointId, 8> new_queues;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (MessageEndpointId recipient : recipients) {
+      auto [it, added] = queues_.try_emplace(recipient);
+      it->second.emplace_back(message);
+      if (added) {
+        new_queues.push_back(recipient);
+      }
+    }
+    queued_count_ += recipients.size();
+    RecordQueueDepth(queued_count_);
+  }
+
+  for (MessageEndpointId recipient : new_queues) {
+    if (job_system_->Run("JobMessageDispatcher", [this, recipient] {
+          ProcessMessages(recipient);
+        })) {
+      continue;
+    }
+
+    LOG(ERROR) << "JobMessageDispatcher failed to run dispatch job, "
+                  "discarding messages to endpoint "
+               << recipient;
+    Messages messages;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = queues_.find(recipient);
+      messages.swap(it->second);
+      queued_count_ -= messages.size();
+      queues_.erase(it);
+    }
+    for (const auto& queued_message : messages) {
+      queued_message.envelope->Release();
+    }
+  }
+}
+
+void JobMessageDispatcher::ProcessMessages(MessageEndpointId recipient) {
+  Messages messages;
+  absl::MutexLock lock(&mutex_);
+  while (true) {
+    auto it = queues_.find(recipient);
+    if (it->second.empty()) {
+      queues_.erase(it);
+      return;
+    }
+    messages.swap(it->second);
+    queued_count_ -= messages.size();
+
+    mutex_.Unlock();
+    for (const auto& message : messages) {
+      DispatchToRecipient(message, recipient);
+    }
+    messages.clear();
+    mutex_.Lock();
+  }
+}
+
+}  // namespace gb
@@ -0,0 +1,72 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_MESSAGE_MESSAGE_JOB_DISPATCHER_H_
+#define GB_MESSAGE_MESSAGE_JOB_DISPATCHER_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "gb/job/job_system.h"
+#include "gb/message/message_dispatcher.h"
+
+namespace gb {
+
+// The JobMessageDispatcher dispatches messages from jobs run in a JobSystem.
+//
+// Messages are queued per receiving endpoint, so a message sent to a channel
+// (or the broadcast channel) is queued separately for each endpoint that
+// receives it. Recipients are determined when the message is queued. Each queue
+// is drained by at most one job at a time, so every endpoint receives its
+// messages in the order they were sent, while handlers for different endpoints
+// are called in parallel across all of the job system's threads.
+//
+// Like the ThreadMessageDispatcher, handlers are free to use the message system
+// in any way they like (short of deleting the MessageSystem instance or their
+// own endpoint), but all handlers that are called must be thread-safe. Handlers
+// for a single endpoint are never called concurrently (see MessageEndpoint).
+//
+// This class is thread-safe.
+class JobMessageDispatcher : public MessageDispatcher {
+ public:
+  // Creates a dispatcher that runs jobs in the specified job system, which must
+  // outlive the dispatcher.
+  explicit JobMessageDispatcher(JobSystem* job_system);
+  ~JobMessageDispatcher() override;
+
+  // Returns the job system used to dispatch messages.
+  JobSystem* GetJobSystem() const { return job_system_; }
+
+  // Blocks until all currently queued messages (and any messages they cause to
+  // be queued on this dispatcher) are dispatched.
+  //
+  // This must not be called from within a handler called by this dispatcher.
+  void Flush();
+
+ public:
+  void AddMessage(MessageInternal, const Message& message) override;
+
+ private:
+  using Messages = std::vector<Message>;
+
+  void ProcessMessages(MessageEndpointId recipient);
+
+  JobSystem* const job_system_;
+  mutable absl::Mutex mutex_;
+
+  // Queued messages per receiving endpoint. A queue exists in this map only
+  // while a job is scheduled or running to process it.
+  absl::flat_hash_map<MessageEndpointId, Messages> queues_
+      ABSL_GUARDED_BY(mutex_);
+
+  // Total number of messages across all queues that are not yet being
+  // dispatched.
+  size_t queued_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace gb
+
+#endif  // GB_MESSAGE_MESSAGE_JOB_DISPATCHER_H_
@@ -0,0 +1,265 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/message/message_job_dispatcher.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "gb/message/message_system.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+// Minimal thread pool based job system, as fibers are not supported on all
+// platforms. It does not support job counters.
+class TestJobSystem : public JobSystem {
+ public:
+  explicit TestJobSystem(int thread_count) {
+    for (int i = 0; i < thread_count; ++i) {
+      threads_.emplace_back([this] { RunJobs(); });
+    }
+  }
+  ~TestJobSystem() override { Stop(); }
+
+  // Finishes all running jobs and stops the worker threads. Any further jobs
+  // will fail to run.
+  void Stop() {
+    {
+      absl::MutexLock lock(&mutex_);
+      exit_ = true;
+    }
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    threads_.clear();
+  }
+
+  int GetJobCount() const {
+    absl::MutexLock lock(&mutex_);
+    return job_count_;
+  }
+
+ protected:
+  bool DoRun(std::string_view name, JobCounter* counter, Context* context,
+             Callback<void()> callback) override {
+    EXPECT_EQ(counter, nullptr);
+    absl::MutexLock lock(&mutex_);
+    if (exit_) {
+      return false;
+    }
+    ++job_count_;
+    jobs_.emplace_back(std::move(callback));
+    return true;
+  }
+  void DoWait(JobCounter* counter) override {
+    ADD_FAILURE() << "Wait is not supported";
+  }
+  Context& DoGetContext() override {
+    thread_local Context context;
+    return context;
+  }
+  JobData& DoGetJobData() override {
+    thread_local JobData job_data;
+    return job_data;
+  }
+
+ private:
+  void RunJobs() {
+    SetThreadState();
+    absl::MutexLock lock(&mutex_);
+    while (true) {
+      mutex_.Await(absl::Condition(
+          +[](TestJobSystem* self) {
+            return self->exit_ || !self->jobs_.empty();
+          },
+          this));
+      if (jobs_.empty()) {
+        return;
+      }
+      Callback<void()> job = std::move(jobs_.front());
+      jobs_.pop_front();
+      mutex_.Unlock();
+      job();
+      mutex_.Lock();
+    }
+  }
+
+  mutable absl::Mutex mutex_;
+  bool exit_ ABSL_GUARDED_BY(mutex_) = false;
+  int job_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::deque<Callback<void()>> jobs_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::thread> threads_;
+};
+
+TEST(JobMessageDispatcherTest, SendMessage) {
+  TestJobSystem job_system(2);
+  JobMessageDispatcher dispatcher(&job_system);
+  EXPECT_EQ(dispatcher.GetJobSystem(), &job_system);
+  auto message_system = MessageSystem::Create(&dispatcher);
+  auto endpoint = message_system->CreateEndpoint();
+  std::atomic<int> value = 0;
+  std::atomic<bool> in_job = false;
+  endpoint->SetHandler<int>(
+      [&value, &in_job](MessageEndpointId, const int& message) {
+        in_job = (JobSystem::Get() != nullptr);
+        value = message;
+      });
+  EXPECT_TRUE(message_system->Send(endpoint->GetId(), 42));
+  dispatcher.Flush();
+  EXPECT_EQ(value, 42);
+  EXPECT_TRUE(in_job);
+}
+
+TEST(JobMessageDispatcherTest, PerEndpointOrderIsPreserved) {
+  static constexpr int kEndpointCount = 4;
+  static constexpr int kMessageCount = 1000;
+  TestJobSystem job_system(4);
+  JobMessageDispatcher dispatcher(&job_system);
+  auto message_system = MessageSystem::Create(&dispatcher);
+  std::vector<std::unique_ptr<MessageEndpoint>> endpoints;
+  std::vector<std::vector<int>> received(kEndpointCount);
+  for (int i = 0; i < kEndpointCount; ++i) {
+    auto& endpoint = endpoints.emplace_back(message_system->CreateEndpoint());
+    endpoint->SetHandler<int>(
+        [&received, i](MessageEndpointId, const int& message) {
+          received[i].push_back(message);
+        });
+  }
+  for (int i = 0; i < kMessageCount; ++i) {
+    for (int j = 0; j < kEndpointCount; ++j) {
+      EXPECT_TRUE(message_system->Send(endpoints[j]->GetId(), i));
+    }
+  }
+  dispatcher.Flush();
+  for (int i = 0; i < kEndpointCount; ++i) {
+    ASSERT_EQ(received[i].size(), kMessageCount);
+    for (int j = 0; j < kMessageCount; ++j) {
+      ASSERT_EQ(received[i][j], j);
+    }
+  }
+}
+
+TEST(JobMessageDispatcherTest, DifferentEndpointsRunInParallel) {
+  TestJobSystem job_system(2);
+  JobMessageDispatcher dispatcher(&job_system);
+  auto message_system = MessageSystem::Create(&dispatcher);
+  auto endpoint_1 = message_system->CreateEndpoint();
+  auto endpoint_2 = message_system->CreateEndpoint();
+
+  // Each handler waits for the other to start, which can only complete if the
+  // handlers are called concurrently.
+  absl::Mutex mutex;
+  int started = 0;
+  auto handler = [&mutex, &started](MessageEndpointId, const int&) {
+    absl::MutexLock lock(&mutex);
+    ++started;
+    EXPECT_TRUE(mutex.AwaitWithTimeout(
+        absl::Condition(
+            +[](int* started) { return *started == 2; }, &started),
+        absl::Seconds(10)));
+  };
+  endpoint_1->SetHandler<int>(handler);
+  endpoint_2->SetHandler<int>(handler);
+  EXPECT_TRUE(message_system->Send(endpoint_1->GetId(), 1));
+  EXPECT_TRUE(message_system->Send(endpoint_2->GetId(), 2));
+  dispatcher.Flush();
+  EXPECT_EQ(started, 2);
+}
+
+TEST(JobMessageDispatcherTest, BroadcastRecipientsRunInParallel) {
+  TestJobSystem job_system(2);
+  JobMessageDispatcher dispatcher(&job_system);
+  auto message_system = MessageSystem::Create(&dispatcher);
+  auto blocked = message_system->CreateEndpoint();
+  auto other = message_system->CreateEndpoint();
+
+  // The blocked handler waits until the other endpoint has handled both
+  // broadcasts, which can only happen if they are dispatched separately.
+  absl::Notification release;
+  std::vector<int> blocked_received, other_received;
+  blocked->SetHandler<int>([&release, &blocked_received](MessageEndpointId,
+                                                         const int& message) {
+    EXPECT_TRUE(release.WaitForNotificationWithTimeout(absl::Seconds(10)));
+    blocked_received.push_back(message);
+  });
+  other->SetHandler<int>(
+      [&release, &other_received](MessageEndpointId, const int& message) {
+        other_received.push_back(message);
+        if (other_received.size() == 2) {
+          release.Notify();
+        }
+      });
+  EXPECT_TRUE(message_system->Send(kBroadcastMessageEndpointId, 1));
+  EXPECT_TRUE(message_system->Send(kBroadcastMessageEndpointId, 2));
+  dispatcher.Flush();
+  EXPECT_TRUE(release.HasBeenNotified());
+  EXPECT_EQ(blocked_received, std::vector<int>({1, 2}));
+  EXPECT_EQ(other_received, std::vector<int>({1, 2}));
+}
+
+TEST(JobMessageDispatcherTest, OneJobPerQueuedEndpoint) {
+  TestJobSystem job_system(1);
+  JobMessageDispatcher dispatcher(&job_system);
+  auto message_system = MessageSystem::Create(&dispatcher);
+  auto endpoint = message_system->CreateEndpoint();
+  absl::Notification release;
+  std::atomic<int> count = 0;
+  endpoint->SetHandler<int>(
+      [&release, &count](MessageEndpointId, const int&) {
+        release.WaitForNotification();
+        ++count;
+      });
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(message_system->Send(endpoint->GetId(), i));
+  }
+  EXPECT_EQ(job_system.GetJobCount(), 1);
+  release.Notify();
+  dispatcher.Flush();
+  EXPECT_EQ(count, 100);
+}
+
+TEST(JobMessageDispatcherTest, SendInsideHandler) {
+  TestJobSystem job_system(2);
+  JobMessageDispatcher dispatcher(&job_system);
+  auto message_system = MessageSystem::Create(&dispatcher);
+  auto endpoint = message_system->CreateEndpoint();
+  std::atomic<int> count = 0;
+  endpoint->SetHandler<int>(
+      [&message_system, &endpoint, &count](MessageEndpointId,
+                                           const int& message) {
+        ++count;
+        if (message > 0) {
+          message_system->Send(endpoint->GetId(), message - 1);
+        }
+      });
+  EXPECT_TRUE(message_system->Send(endpoint->GetId(), 10));
+  dispatcher.Flush();
+  EXPECT_EQ(count, 11);
+}
+
+TEST(JobMessageDispatcherTest, FailedRunDiscardsMessages) {
+  TestJobSystem job_system(1);
+  JobMessageDispatcher dispatcher(&job_system);
+  auto message_system = MessageSystem::Create(&dispatcher);
+  auto endpoint = message_system->CreateEndpoint();
+  int count = 0;
+  endpoint->SetHandler<int>(
+      [&count](MessageEndpointId, const int&) { ++count; });
+  job_system.Stop();
+  EXPECT_TRUE(message_system->Send(endpoint->GetId(), 1));
+  dispatcher.Flush();
+  EXPECT_EQ(count, 0);
+}
+
+}  // namespace
+}  // namespace gb
@@ -0,0 +1,134 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/message/message_metrics.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+
+namespace gb {
+
+absl::Duration MessageMetrics::GetBucketLimit(int bucket) {
+  if (bucket >= kHistogramBucketCount - 1) {
+    return absl::InfiniteDuration();
+  }
+  return absl::Microseconds(int64_t{1} << std::max(bucket, 0));
+}
+
+int MessageMetrics::GetBucket(absl::Duration time) {
+  int64_t micros = absl::ToInt64Microseconds(time);
+  int bucket = 0;
+  while (micros > 0 && bucket < kHistogramBucketCount - 1) {
+    micros >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+void MessageMetrics::RecordSend(TypeKey* key, int count) {
+  absl::MutexLock lock(&mutex_);
+  send_counts_[key] += count;
+}
+
+void MessageMetrics::RecordQueueDepth(std::string_view dispatcher_name,
+                                      int depth) {
+  absl::MutexLock lock(&mutex_);
+  auto it = queue_depths_.find(dispatcher_name);
+  if (it == queue_depths_.end()) {
+    queue_depths_.emplace(dispatcher_name, depth);
+  } else if (depth > it->second) {
+    it->second = depth;
+  }
+}
+
+void MessageMetrics::RecordHandlerTime(std::string_view endpoint_name,
+                                       absl::Duration time) {
+  const int bucket = GetBucket(time);
+  absl::MutexLock lock(&mutex_);
+  auto it = handler_stats_.find(endpoint_name);
+  if (it == handler_stats_.end()) {
+    it = handler_stats_.emplace(endpoint_name, HandlerStats{}).first;
+  }
+  HandlerStats& stats = it->second;
+  stats.count += 1;
+  stats.total_time += time;
+  stats.max_time = std::max(stats.max_time, time);
+  stats.histogram[bucket] += 1;
+}
+
+int64_t MessageMetrics::GetSendCount(TypeKey* key) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = send_counts_.find(key);
+  return it != send_counts_.end() ? it->second : 0;
+}
+
+int MessageMetrics::GetQueueHighWaterMark(
+    std::string_view dispatcher_name) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = queue_depths_.find(dispatcher_name);
+  return it != queue_depths_.end() ? it->second : 0;
+}
+
+MessageMetrics::HandlerStats MessageMetrics::GetHandlerStats(
+    std::string_view endpoint_name) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = handler_stats_.find(endpoint_name);
+  return it != handler_stats_.end() ? it->second : HandlerStats{};
+}
+
+void MessageMetrics::Reset() {
+  absl::MutexLock lock(&mutex_);
+  send_counts_.clear();
+  queue_depths_.clear();
+  handler_stats_.clear();
+}
+
+std::string MessageMetrics::ToString() const {
+  std::vector<std::pair<std::string, int64_t>> send_counts;
+  std::vector<std::pair<std::string, int>> queue_depths;
+  std::vector<std::pair<std::string, HandlerStats>> handler_stats;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (const auto& [key, count] : send_counts_) {
+      send_counts.emplace_back(key->GetTypeName(), count);
+    }
+    queue_depths.assign(queue_depths_.begin(), queue_depths_.end());
+    handler_stats.assign(handler_stats_.begin(), handler_stats_.end());
+  }
+  std::sort(send_counts.begin(), send_counts.end());
+  std::sort(queue_depths.begin(), queue_depths.end());
+  std::sort(handler_stats.begin(), handler_stats.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::string result = "Sends:\n";
+  for (const auto& [name, count] : send_counts) {
+    absl::StrAppend(&result, "  ", name, ": ", count, "\n");
+  }
+  absl::StrAppend(&result, "Queue high-water marks:\n");
+  for (const auto& [name, depth] : queue_depths) {
+    absl::StrAppend(&result, "  ", name, ": ", depth, "\n");
+  }
+  absl::StrAppend(&result, "Handlers:\n");
+  for (const auto& [name, stats] : handler_stats) {
+    absl::StrAppend(&result, "  ", name, ": count=", stats.count,
+                    " total=", absl::FormatDuration(stats.total_time),
+                    " mean=",
+                    absl::FormatDuration(stats.total_time / stats.count),
+                    " max=", absl::FormatDuration(stats.max_time), "\n");
+    for (int i = 0; i < kHistogramBucketCount; ++i) {
+      if (stats.histogram[i] == 0) {
+        continue;
+      }
+      absl::StrAppend(&result, "    <", absl::FormatDuration(GetBucketLimit(i)),
+                      ": ", stats.histogram[i], "\n");
+    }
+  }
+  return result;
+}
+
+}  // namespace gb
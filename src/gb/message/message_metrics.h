@@ -0,0 +1,97 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_MESSAGE_MESSAGE_METRICS_H_
+#define GB_MESSAGE_MESSAGE_METRICS_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "gb/base/type_info.h"
+
+namespace gb {
+
+// This class collects optional runtime metrics about message traffic.
+//
+// Metrics are opt-in: nothing is recorded unless a MessageMetrics instance is
+// set on a MessageSystem (see MessageSystem::SetMetrics) and/or on individual
+// dispatchers (see MessageDispatcher::SetMetrics). The following is recorded:
+//   - Send counts per message type (TypeKey), counting each message in a batch.
+//   - Queue depth high-water marks per dispatcher name.
+//   - Handler execution time histograms per endpoint name. Time is measured for
+//     each delivery to an endpoint, which includes all messages in a batch and
+//     any messages the endpoint queued while it was handling them.
+//
+// Endpoints and dispatchers that share a name share their metrics.
+//
+// This class is thread-safe.
+class MessageMetrics final {
+ public:
+  // Number of buckets in a handler time histogram. Bucket zero contains all
+  // times less than 1us, and each subsequent bucket is double the size of the
+  // previous one. The last bucket contains all remaining times.
+  static constexpr int kHistogramBucketCount = 24;
+
+  // Handler execution time statistics for an endpoint name.
+  struct HandlerStats {
+    int64_t count = 0;
+    absl::Duration total_time;
+    absl::Duration max_time;
+    std::array<int64_t, kHistogramBucketCount> histogram = {};
+  };
+
+  MessageMetrics() = default;
+  MessageMetrics(const MessageMetrics&) = delete;
+  MessageMetrics& operator=(const MessageMetrics&) = delete;
+  ~MessageMetrics() = default;
+
+  // Returns the exclusive upper bound for times in the specified histogram
+  // bucket. The last bucket returns absl::InfiniteDuration().
+  static absl::Duration GetBucketLimit(int bucket);
+
+  // Returns the bucket that a handler execution time is recorded in.
+  static int GetBucket(absl::Duration time);
+
+  // Records that "count" messages of the specified type were sent.
+  void RecordSend(TypeKey* key, int count);
+
+  // Records the current queue depth of a named dispatcher.
+  void RecordQueueDepth(std::string_view dispatcher_name, int depth);
+
+  // Records a single handler execution for a named endpoint.
+  void RecordHandlerTime(std::string_view endpoint_name, absl::Duration time);
+
+  // Returns the number of messages sent of the specified type.
+  int64_t GetSendCount(TypeKey* key) const;
+
+  // Returns the largest queue depth recorded for the named dispatcher.
+  int GetQueueHighWaterMark(std::string_view dispatcher_name) const;
+
+  // Returns the handler execution statistics for the named endpoint.
+  HandlerStats GetHandlerStats(std::string_view endpoint_name) const;
+
+  // Clears all recorded metrics. This may be called periodically (for
+  // instance, once per frame) to compute rates.
+  void Reset();
+
+  // Returns a human readable dump of all recorded metrics, sorted by name.
+  std::string ToString() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<TypeKey*, int64_t> send_counts_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, int> queue_depths_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, HandlerStats> handler_stats_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace gb
+
+#endif  // GB_MESSAGE_MESSAGE_METRICS_H_
@@ -0,0 +1,138 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/message/message_metrics.h"
+
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "gb/message/message_dispatcher.h"
+#include "gb/message/message_system.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+struct NamedMessage {};
+
+TEST(MessageMetricsTest, HistogramBuckets) {
+  EXPECT_EQ(MessageMetrics::GetBucket(absl::ZeroDuration()), 0);
+  EXPECT_EQ(MessageMetrics::GetBucket(absl::Nanoseconds(999)), 0);
+  EXPECT_EQ(MessageMetrics::GetBucket(absl::Microseconds(1)), 1);
+  EXPECT_EQ(MessageMetrics::GetBucket(absl::Microseconds(3)), 2);
+  EXPECT_EQ(MessageMetrics::GetBucket(absl::Microseconds(4)), 3);
+  EXPECT_EQ(MessageMetrics::GetBucket(absl::Hours(1)),
+            MessageMetrics::kHistogramBucketCount - 1);
+  for (int i = 0; i < MessageMetrics::kHistogramBucketCount - 1; ++i) {
+    absl::Duration limit = MessageMetrics::GetBucketLimit(i);
+    EXPECT_EQ(MessageMetrics::GetBucket(limit - absl::Nanoseconds(1)), i);
+    EXPECT_EQ(MessageMetrics::GetBucket(limit), i + 1);
+  }
+  EXPECT_EQ(MessageMetrics::GetBucketLimit(
+                MessageMetrics::kHistogramBucketCount - 1),
+            absl::InfiniteDuration());
+}
+
+TEST(MessageMetricsTest, RecordDirectly) {
+  MessageMetrics metrics;
+  metrics.RecordSend(TypeKey::Get<int>(), 1);
+  metrics.RecordSend(TypeKey::Get<int>(), 5);
+  metrics.RecordQueueDepth("dispatcher", 3);
+  metrics.RecordQueueDepth("dispatcher", 10);
+  metrics.RecordQueueDepth("dispatcher", 2);
+  metrics.RecordHandlerTime("endpoint", absl::Microseconds(3));
+  metrics.RecordHandlerTime("endpoint", absl::Microseconds(5));
+
+  EXPECT_EQ(metrics.GetSendCount(TypeKey::Get<int>()), 6);
+  EXPECT_EQ(metrics.GetSendCount(TypeKey::Get<float>()), 0);
+  EXPECT_EQ(metrics.GetQueueHighWaterMark("dispatcher"), 10);
+  EXPECT_EQ(metrics.GetQueueHighWaterMark("other"), 0);
+  auto stats = metrics.GetHandlerStats("endpoint");
+  EXPECT_EQ(stats.count, 2);
+  EXPECT_EQ(stats.total_time, absl::Microseconds(8));
+  EXPECT_EQ(stats.max_time, absl::Microseconds(5));
+  EXPECT_EQ(stats.histogram[2], 1);
+  EXPECT_EQ(stats.histogram[3], 1);
+  EXPECT_EQ(metrics.GetHandlerStats("other").count, 0);
+
+  metrics.Reset();
+  EXPECT_EQ(metrics.GetSendCount(TypeKey::Get<int>()), 0);
+  EXPECT_EQ(metrics.GetQueueHighWaterMark("dispatcher"), 0);
+  EXPECT_EQ(metrics.GetHandlerStats("endpoint").count, 0);
+}
+
+TEST(MessageMetricsTest, DisabledByDefault) {
+  auto message_system = MessageSystem::Create();
+  EXPECT_EQ(message_system->GetMetrics(), nullptr);
+  auto endpoint = message_system->CreateEndpoint("endpoint");
+  endpoint->SetHandler<int>([](MessageEndpointId, const int&) {});
+  EXPECT_TRUE(message_system->Send(endpoint->GetId(), 1));
+}
+
+TEST(MessageMetricsTest, SystemRecordsSendsAndHandlers) {
+  MessageMetrics metrics;
+  auto message_system = MessageSystem::Create();
+  message_system->SetMetrics(&metrics);
+  EXPECT_EQ(message_system->GetMetrics(), &metrics);
+  auto endpoint_1 = message_system->CreateEndpoint("endpoint_1");
+  auto endpoint_2 = message_system->CreateEndpoint("endpoint_2");
+  endpoint_1->SetHandler<int>([](MessageEndpointId, const int&) {
+    absl::SleepFor(absl::Milliseconds(1));
+  });
+  endpoint_2->SetHandler<int>([](MessageEndpointId, const int&) {});
+
+  EXPECT_TRUE(message_system->Send(endpoint_1->GetId(), 1));
+  EXPECT_TRUE(message_system->Send(kBroadcastMessageEndpointId, 2.0f));
+  std::vector<int> batch = {1, 2, 3};
+  EXPECT_TRUE(message_system->SendBatch<int>(kBroadcastMessageEndpointId,
+                                             batch));
+
+  EXPECT_EQ(metrics.GetSendCount(TypeKey::Get<int>()), 4);
+  EXPECT_EQ(metrics.GetSendCount(TypeKey::Get<float>()), 1);
+  auto stats_1 = metrics.GetHandlerStats("endpoint_1");
+  EXPECT_EQ(stats_1.count, 3);
+  EXPECT_GE(stats_1.max_time, absl::Milliseconds(1));
+  EXPECT_GE(stats_1.total_time, absl::Milliseconds(4));
+  EXPECT_EQ(metrics.GetHandlerStats("endpoint_2").count, 2);
+
+  message_system->SetMetrics(nullptr);
+  EXPECT_TRUE(message_system->Send(endpoint_1->GetId(), 1));
+  EXPECT_EQ(metrics.GetSendCount(TypeKey::Get<int>()), 4);
+}
+
+TEST(MessageMetricsTest, DispatcherRecordsQueueDepth) {
+  MessageMetrics metrics;
+  PollingMessageDispatcher dispatcher;
+  dispatcher.SetMetrics(&metrics, "polling");
+  auto message_system = MessageSystem::Create(&dispatcher);
+  message_system->SetMetrics(&metrics);
+  auto endpoint = message_system->CreateEndpoint("endpoint");
+  endpoint->SetHandler<int>([](MessageEndpointId, const int&) {});
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(message_system->Send(endpoint->GetId(), i));
+  }
+  dispatcher.Update();
+  EXPECT_TRUE(message_system->Send(endpoint->GetId(), 5));
+  dispatcher.Update();
+  EXPECT_EQ(metrics.GetQueueHighWaterMark("polling"), 5);
+  EXPECT_EQ(metrics.GetSendCount(TypeKey::Get<int>()), 6);
+  EXPECT_EQ(metrics.GetHandlerStats("endpoint").count, 6);
+}
+
+TEST(MessageMetricsTest, ToString) {
+  MessageMetrics metrics;
+  TypeKey::Get<NamedMessage>()->SetTypeName("NamedMessage");
+  metrics.RecordSend(TypeKey::Get<NamedMessage>(), 2);
+  metrics.RecordQueueDepth("dispatcher", 7);
+  metrics.RecordHandlerTime("endpoint", absl::Microseconds(3));
+  const std::string text = metrics.ToString();
+  EXPECT_NE(text.find("NamedMessage: 2"), std::string::npos) << text;
+  EXPECT_NE(text.find("dispatcher: 7"), std::string::npos) << text;
+  EXPECT_NE(text.find("endpoint: count=1"), std::string::npos) << text;
+  EXPECT_NE(text.find("<4us: 1"), std::string::npos) << text;
+}
+
+}  // namespace
+}  // namespace gb
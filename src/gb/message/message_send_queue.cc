@@ -0,0 +1,32 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/message/message_send_queue.h"
+
+namespace gb {
+
+int MessageSendQueue::Flush() {
+  int failed_count = 0;
+  for (int index : active_) {
+    auto& info = groups_[index];
+    if (!info.group->Send(system_, endpoint_, info.to)) {
+      ++failed_count;
+    }
+    info.group->Clear();
+  }
+  active_.clear();
+  message_count_ = 0;
+  return failed_count;
+}
+
+void MessageSendQueue::Clear() {
+  for (int index : active_) {
+    groups_[index].group->Clear();
+  }
+  active_.clear();
+  message_count_ = 0;
+}
+
+}  // namespace gb
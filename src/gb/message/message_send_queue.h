@@ -0,0 +1,138 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#ifndef GB_MESSAGE_MESSAGE_SEND_QUEUE_H_
+#define GB_MESSAGE_MESSAGE_SEND_QUEUE_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "gb/base/type_info.h"
+#include "gb/message/message_endpoint.h"
+#include "gb/message/message_system.h"
+
+namespace gb {
+
+// This class accumulates messages for high-rate producers, and sends them in
+// batches.
+//
+// Messages are stored contiguously per destination endpoint and message type
+// (TypeKey), and each group is sent with a single SendBatch call when Flush is
+// called. This amortizes the locking and dispatch overhead of sending many
+// small messages (for instance input, network replication, or physics events)
+// down to once per group.
+//
+// Messages within a group are received in the order they were added. However,
+// ordering between different groups is only preserved in terms of when each
+// group was first added to since the last flush.
+//
+// This class is thread-compatible.
+class MessageSendQueue final {
+ public:
+  // Creates a queue which sends messages anonymously via the message system.
+  // The system must outlive the queue.
+  explicit MessageSendQueue(MessageSystem* system) : system_(system) {}
+
+  // Creates a queue which sends messages from the specified endpoint. The
+  // endpoint must outlive the queue.
+  explicit MessageSendQueue(MessageEndpoint* endpoint) : endpoint_(endpoint) {}
+
+  MessageSendQueue(const MessageSendQueue&) = delete;
+  MessageSendQueue& operator=(const MessageSendQueue&) = delete;
+  ~MessageSendQueue() = default;
+
+  // Returns true if there are no queued messages.
+  bool IsEmpty() const { return message_count_ == 0; }
+
+  // Returns the total number of queued messages.
+  int GetMessageCount() const { return message_count_; }
+
+  // Queues a message to be sent to the specified endpoint on the next Flush.
+  template <typename Message>
+  void Add(MessageEndpointId to, const Message& message);
+
+  // Sends all queued messages.
+  //
+  // Returns the number of groups which could not be sent (see
+  // MessageSystem::SendBatch). Queue storage is retained for reuse. The queue
+  // must not be modified by any handler called synchronously from Flush.
+  int Flush();
+
+  // Discards all queued messages without sending them.
+  void Clear();
+
+ private:
+  class Group {
+   public:
+    virtual ~Group() = default;
+    virtual bool Send(MessageSystem* system, MessageEndpoint* endpoint,
+                      MessageEndpointId to) = 0;
+    virtual void Clear() = 0;
+  };
+
+  template <typename Message>
+  class TypedGroup final : public Group {
+   public:
+    bool Send(MessageSystem* system, MessageEndpoint* endpoint,
+              MessageEndpointId to) override;
+    void Clear() override { messages.clear(); }
+
+    std::vector<Message> messages;
+  };
+
+  struct GroupInfo {
+    MessageEndpointId to;
+    TypeKey* key;
+    std::unique_ptr<Group> group;
+  };
+  using GroupIndex =
+      absl::flat_hash_map<std::pair<MessageEndpointId, TypeKey*>, int>;
+
+  MessageSystem* const system_ = nullptr;
+  MessageEndpoint* const endpoint_ = nullptr;
+  int message_count_ = 0;
+
+  // All groups ever added, in the order they were first added. "active_" are
+  // the indices of groups with messages since the last flush, in the order they
+  // were added.
+  std::vector<GroupInfo> groups_;
+  std::vector<int> active_;
+  GroupIndex index_;
+};
+
+template <typename Message>
+bool MessageSendQueue::TypedGroup<Message>::Send(MessageSystem* system,
+                                                 MessageEndpoint* endpoint,
+                                                 MessageEndpointId to) {
+  absl::Span<const Message> span(messages);
+  if (endpoint != nullptr) {
+    return endpoint->SendBatch(to, span);
+  }
+  return system->SendBatch(to, span);
+}
+
+template <typename Message>
+void MessageSendQueue::Add(MessageEndpointId to, const Message& message) {
+  TypeKey* key = TypeKey::Get<Message>();
+  auto [it, added] =
+      index_.try_emplace({to, key}, static_cast<int>(groups_.size()));
+  if (added) {
+    groups_.push_back({to, key, std::make_unique<TypedGroup<Message>>()});
+  }
+  auto* group =
+      static_cast<TypedGroup<Message>*>(groups_[it->second].group.get());
+  if (group->messages.empty()) {
+    active_.push_back(it->second);
+  }
+  group->messages.push_back(message);
+  ++message_count_;
+}
+
+}  // namespace gb
+
+#endif  // GB_MESSAGE_MESSAGE_SEND_QUEUE_H_
@@ -0,0 +1,130 @@
+// Copyright (c) 2026 John Pursey
+//
+// Use of this source code is governed by an MIT-style License that can be found
+// in the LICENSE file or at https://opensource.org/licenses/MIT.
+
+#include "gb/message/message_send_queue.h"
+
+#include <string>
+#include <vector>
+
+#include "gb/message/message_dispatcher.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace gb {
+namespace {
+
+using ::testing::ElementsAre;
+
+class CountingDispatcher : public PollingMessageDispatcher {
+ public:
+  void AddMessage(MessageInternal internal,
+                  const MessageDispatcher::Message& message) override {
+    add_message_count += 1;
+    PollingMessageDispatcher::AddMessage(internal, message);
+  }
+
+  int add_message_count = 0;
+};
+
+TEST(MessageSendQueueTest, EmptyFlush) {
+  auto message_system = MessageSystem::Create();
+  MessageSendQueue queue(message_system.get());
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ(queue.Flush(), 0);
+}
+
+TEST(MessageSendQueueTest, FlushSendsBatchPerGroup) {
+  CountingDispatcher dispatcher;
+  auto message_system = MessageSystem::Create(&dispatcher);
+  auto endpoint_1 = message_system->CreateEndpoint();
+  auto endpoint_2 = message_system->CreateEndpoint();
+  std::vector<int> ints_1, ints_2;
+  std::vector<std::string> strings_1;
+  std::vector<MessageEndpointId> from_1;
+  endpoint_1->SetHandler<int>(
+      [&ints_1, &from_1](MessageEndpointId from, const int& message) {
+        ints_1.push_back(message);
+        from_1.push_back(from);
+      });
+  endpoint_1->SetHandler<std::string>(
+      [&strings_1](MessageEndpointId, const std::string& message) {
+        strings_1.push_back(message);
+      });
+  endpoint_2->SetHandler<int>([&ints_2](MessageEndpointId, const int& message) {
+    ints_2.push_back(message);
+  });
+
+  MessageSendQueue queue(endpoint_2.get());
+  queue.Add(endpoint_1->GetId(), 1);
+  queue.Add(endpoint_1->GetId(), std::string("one"));
+  queue.Add(endpoint_2->GetId(), 10);
+  queue.Add(endpoint_1->GetId(), 2);
+  queue.Add(endpoint_1->GetId(), std::string("two"));
+  queue.Add(endpoint_2->GetId(), 20);
+  queue.Add(endpoint_1->GetId(), 3);
+  EXPECT_FALSE(queue.IsEmpty());
+  EXPECT_EQ(queue.GetMessageCount(), 7);
+  EXPECT_EQ(queue.Flush(), 0);
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ(dispatcher.add_message_count, 3);
+  dispatcher.Update();
+  EXPECT_THAT(ints_1, ElementsAre(1, 2, 3));
+  EXPECT_THAT(strings_1, ElementsAre("one", "two"));
+  EXPECT_THAT(ints_2, ElementsAre(10, 20));
+  EXPECT_THAT(from_1, ElementsAre(endpoint_2->GetId(), endpoint_2->GetId(),
+                                  endpoint_2->GetId()));
+
+  // Storage is reused, and only groups with new messages are sent.
+  queue.Add(endpoint_2->GetId(), 30);
+  EXPECT_EQ(queue.Flush(), 0);
+  EXPECT_EQ(dispatcher.add_message_count, 4);
+  dispatcher.Update();
+  EXPECT_THAT(ints_1, ElementsAre(1, 2, 3));
+  EXPECT_THAT(ints_2, ElementsAre(10, 20, 30));
+}
+
+TEST(MessageSendQueueTest, AnonymousSend) {
+  auto message_system = MessageSystem::Create();
+  auto endpoint = message_system->CreateEndpoint();
+  std::vector<int> values;
+  endpoint->SetHandler<int>(
+      [&values](MessageEndpointId from, const int& message) {
+        EXPECT_EQ(from, kNoMessageEndpointId);
+        values.push_back(message);
+      });
+  MessageSendQueue queue(message_system.get());
+  queue.Add(endpoint->GetId(), 1);
+  queue.Add(endpoint->GetId(), 2);
+  EXPECT_EQ(queue.Flush(), 0);
+  EXPECT_THAT(values, ElementsAre(1, 2));
+}
+
+TEST(MessageSendQueueTest, FlushToInvalidEndpoint) {
+  auto message_system = MessageSystem::Create();
+  auto endpoint = message_system->CreateEndpoint();
+  MessageEndpointId endpoint_id = endpoint->GetId();
+  MessageSendQueue queue(message_system.get());
+  queue.Add(endpoint_id, 1);
+  queue.Add(endpoint_id, 2.0f);
+  endpoint.reset();
+  EXPECT_EQ(queue.Flush(), 2);
+}
+
+TEST(MessageSendQueueTest, Clear) {
+  auto message_system = MessageSystem::Create();
+  auto endpoint = message_system->CreateEndpoint();
+  int call_count = 0;
+  endpoint->SetHandler<int>(
+      [&call_count](MessageEndpointId, const int&) { call_count += 1; });
+  MessageSendQueue queue(message_system.get());
+  queue.Add(endpoint->GetId(), 1);
+  queue.Clear();
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ(queue.Flush(), 0);
+  EXPECT_EQ(call_count, 0);
+}
+
+}  // namespace
+}  // namespace gb
@@ -8,6 +8,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "gb/base/weak_ptr.h"
 #include "gb/message/message_dispatcher.h"
 #include "gb/message/message_endpoint.h"
@@ -128,6 +129,10 @@ class MessageStackEndpoint final {
   bool Send(MessageEndpointId to, const Message& message) {
     return endpoint_->Send(to, message);
   }
+  template <typename Message>
+  bool SendBatch(MessageEndpointId to, absl::Span<const Message> messages) {
+    return endpoint_->SendBatch(to, messages);
+  }
 
   // Pushes the handlers onto the stack.
   //
@@ -5,8 +5,10 @@
 
 #include "gb/message/message_system.h"
 
+#include "absl/container/inlined_vector.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
+#include "absl/time/clock.h"
 #include "gb/message/message_dispatcher.h"
 
 namespace gb {
@@ -76,12 +78,8 @@ std::unique_ptr<MessageEndpoint> MessageSystem::CreateEndpoint(
   endpoint_info->dispatcher = dispatcher;
 
   endpoint_info->subscriptions.insert(kBroadcastMessageEndpointId);
-  auto* broadcast_info = endpoints_[kBroadcastMessageEndpointId].get();
-  if (broadcast_info->dispatch_threads.empty()) {
-    broadcast_info->subscribers.insert(endpoint_id);
-  } else {
-    broadcast_info->add_subscribers.insert(endpoint_id);
-  }
+  endpoints_[kBroadcastMessageEndpointId]->subscribers.insert(endpoint_id);
+  InvalidateRecipients();
 
   return endpoint;
 }
@@ -126,6 +124,7 @@ void MessageSystem::RemoveEndpoint(MessageInternal, MessageEndpoint* endpoint) {
   if (!endpoint_info->erase_after_dispatch) {
     endpoints_.erase(it);
   }
+  InvalidateRecipients();
 }
 
 MessageEndpointId MessageSystem::AddChannel(std::string_view name) {
@@ -157,6 +156,7 @@ bool MessageSystem::RemoveChannel(MessageEndpointId channel_id) {
   } else {
     endpoint_info->erase_after_dispatch = true;
   }
+  InvalidateRecipients();
   return true;
 }
 
@@ -193,16 +193,8 @@ bool MessageSystem::Subscribe(MessageInternal, MessageEndpointId source,
   }
   endpoint_info->subscriptions.insert(source);
 
-  auto* source_info = source_it->second.get();
-  if (source_info->dispatch_threads.empty()) {
-    source_info->subscribers.insert(subscriber);
-  } else if (auto remove_it = source_info->remove_subscribers.find(subscriber);
-             remove_it != source_info->remove_subscribers.end()) {
-    source_info->remove_subscribers.erase(remove_it);
-  } else if (auto current_it = source_info->subscribers.find(subscriber);
-             current_it == source_info->subscribers.end()) {
-    source_info->add_subscribers.insert(subscriber);
-  }
+  source_it->second->subscribers.insert(subscriber);
+  InvalidateRecipients();
   return true;
 }
 
@@ -220,15 +212,8 @@ void MessageSystem::Unsubscribe(MessageInternal, MessageEndpointId source,
   if (source_it == endpoints_.end()) {
     return;
   }
-  auto* source_info = source_it->second.get();
-  if (source_info->dispatch_threads.empty()) {
-    source_info->subscribers.erase(subscriber);
-  } else if (auto add_it = source_info->add_subscribers.find(subscriber);
-             add_it != source_info->add_subscribers.end()) {
-    source_info->add_subscribers.erase(add_it);
-  } else if (auto current_it = source_info->subscribers.find(subscriber);
-             current_it != source_info->subscribers.end()) {
-    source_info->remove_subscribers.insert(subscriber);
+  if (source_it->second->subscribers.erase(subscriber) != 0) {
+    InvalidateRecipients();
   }
 }
 
@@ -250,7 +235,7 @@ bool MessageSystem::IsSubscribed(MessageInternal, MessageEndpointId source,
 
 bool MessageSystem::DoSend(MessageInternal, MessageEndpointId from,
                            MessageEndpointId to, TypeInfo* type,
-                           const void* message) {
+                           const void* messages, int count) {
   MessageDispatcher* dispatcher = nullptr;
   {
     absl::ReaderMutexLock lock(&mutex_);
@@ -269,86 +254,233 @@ bool MessageSystem::DoSend(MessageInternal, MessageEndpointId from,
   if (!type->CanClone()) {
     return false;
   }
+  if (count <= 0) {
+    return true;
+  }
+  if (MessageMetrics* metrics = GetMetrics(); metrics != nullptr) {
+    metrics->RecordSend(type->Key(), count);
+  }
   if (dispatcher != nullptr) {
-    dispatcher->AddMessage({}, {from, to, type, type->Clone(message)});
+    dispatcher->AddMessage(
+        {}, {from, to, MessageEnvelope::Create(type, messages, count)});
   } else {
-    EndpointIdSet visited;
-    // const_cast is ok here as delete_message is false.
-    DispatchImpl(&visited, nullptr, from, to, type, const_cast<void*>(message),
-                 false);
+    // No copy is made unless the messages need to be handed off to another
+    // dispatcher or queued by an endpoint.
+    DispatchState state(from, type, messages, count, nullptr);
+    DispatchImpl(&state, nullptr, to);
+    if (state.envelope != nullptr) {
+      state.envelope->Release();
+    }
   }
   return true;
 }
 
-bool MessageSystem::DispatchImpl(EndpointIdSet* visited,
-                                 MessageDispatcher* dispatcher,
-                                 MessageEndpointId from, MessageEndpointId to,
-                                 TypeInfo* type, void* message,
-                                 bool delete_message) {
-  if (visited->find(to) != visited->end()) {
-    return true;
+void MessageSystem::DoDispatch(MessageInternal, MessageDispatcher* dispatcher,
+                               MessageEndpointId from, MessageEndpointId to,
+                               MessageEnvelope* envelope) {
+  DispatchState state(from, envelope->GetType(), envelope->GetMessageData(),
+                      envelope->GetCount(), envelope);
+  DispatchImpl(&state, dispatcher, to);
+  envelope->Release();
+}
+
+std::vector<MessageEndpointId> MessageSystem::GetRecipientIds(
+    MessageInternal, MessageDispatcher* dispatcher, MessageEndpointId to) {
+  std::vector<MessageEndpointId> recipient_ids;
+  absl::WriterMutexLock lock(&mutex_);
+  auto recipients = GetRecipients(to, dispatcher);
+  if (recipients == nullptr) {
+    return recipient_ids;
+  }
+  recipient_ids.reserve(recipients->size());
+  for (const auto& recipient : *recipients) {
+    recipient_ids.push_back(recipient.id);
   }
-  visited->insert(to);
+  return recipient_ids;
+}
 
-  EndpointInfo* to_info = nullptr;
+void MessageSystem::DoDispatchRecipient(MessageInternal,
+                                        MessageDispatcher* dispatcher,
+                                        MessageEndpointId from,
+                                        MessageEndpointId recipient_id,
+                                        MessageEnvelope* envelope) {
+  Recipient recipient;
   {
-    mutex_.WriterLock();
-    auto to_it = endpoints_.find(to);
-    if (to_it == endpoints_.end() || to_it->second->erase_after_dispatch) {
-      mutex_.WriterUnlock();
-      if (delete_message) {
-        type->Destroy(message);
-      }
-      return false;
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = endpoints_.find(recipient_id);
+    if (it == endpoints_.end()) {
+      envelope->Release();
+      return;
+    }
+    recipient.id = recipient_id;
+    recipient.info = it->second.get();
+    if (recipient.info->dispatcher != dispatcher) {
+      recipient.dispatcher = recipient.info->dispatcher;
     }
-    to_info = to_it->second.get();
-    if (to_info->dispatcher != dispatcher && to_info->dispatcher != nullptr) {
-      auto* dispatcher = to_info->dispatcher;
-      mutex_.WriterUnlock();
-      dispatcher->AddMessage({}, {from, to, type, type->Clone(message)});
-      return true;
+  }
+
+  DispatchState state(from, envelope->GetType(), envelope->GetMessageData(),
+                      envelope->GetCount(), envelope);
+  if (BeginDispatch(recipient)) {
+    DeliverMessage(&state, recipient, GetMetrics());
+    if (recipient.dispatcher == nullptr) {
+      EndDispatch(recipient);
     }
-    to_info->dispatch_threads.insert(std::this_thread::get_id());
-    mutex_.WriterUnlock();
   }
+  envelope->Release();
+}
+
+MessageEnvelope* MessageSystem::DispatchState::ShareEnvelope() {
+  if (envelope == nullptr) {
+    envelope = MessageEnvelope::Create(type, messages, count);
+  }
+  envelope->AddRef();
+  return envelope;
+}
 
-  if (to_info->endpoint != nullptr) {
-    to_info->endpoint->Receive({}, from, type, message);
+std::shared_ptr<const MessageSystem::Recipients> MessageSystem::GetRecipients(
+    MessageEndpointId to, MessageDispatcher* dispatcher) {
+  auto to_it = endpoints_.find(to);
+  if (to_it == endpoints_.end() || to_it->second->erase_after_dispatch) {
+    return nullptr;
+  }
+  auto* to_info = to_it->second.get();
+  if (to_info->recipients_version != recipients_version_) {
+    to_info->recipients.clear();
+    to_info->recipients_version = recipients_version_;
+  }
+  auto& recipients = to_info->recipients[dispatcher];
+  if (recipients == nullptr) {
+    auto new_recipients = std::make_shared<Recipients>();
+    EndpointIdSet visited;
+    BuildRecipients(to, to_info, dispatcher, &visited, new_recipients.get());
+    recipients = std::move(new_recipients);
   }
-  EndpointIdSet deleted_endpoints;
-  for (auto endpoint_id : to_info->subscribers) {
-    if (!DispatchImpl(visited, dispatcher, from, endpoint_id, type, message,
-                      false)) {
-      deleted_endpoints.insert(endpoint_id);
+  return recipients;
+}
+
+void MessageSystem::BuildRecipients(MessageEndpointId id, EndpointInfo* info,
+                                    MessageDispatcher* dispatcher,
+                                    EndpointIdSet* visited,
+                                    Recipients* recipients) {
+  if (!visited->insert(id).second) {
+    return;
+  }
+
+  // Endpoints with a different dispatcher get the message handed off to their
+  // dispatcher, which will then dispatch to their subscribers.
+  if (info->dispatcher != dispatcher && info->dispatcher != nullptr) {
+    recipients->push_back({id, info, info->dispatcher});
+    return;
+  }
+  const int index = static_cast<int>(recipients->size());
+  if (info->endpoint != nullptr) {
+    recipients->push_back({id, info, nullptr});
+  }
+
+  std::vector<MessageEndpointId> deleted_endpoints;
+  for (auto endpoint_id : info->subscribers) {
+    auto it = endpoints_.find(endpoint_id);
+    if (it == endpoints_.end()) {
+      deleted_endpoints.push_back(endpoint_id);
+      continue;
     }
+    if (it->second->erase_after_dispatch) {
+      continue;
+    }
+    BuildRecipients(endpoint_id, it->second.get(), dispatcher, visited,
+                    recipients);
+  }
+  for (auto endpoint_id : deleted_endpoints) {
+    info->subscribers.erase(endpoint_id);
   }
+  if (info->endpoint != nullptr) {
+    (*recipients)[index].subscribers_end =
+        static_cast<int>(recipients->size());
+  }
+}
 
+void MessageSystem::DispatchImpl(DispatchState* state,
+                                 MessageDispatcher* dispatcher,
+                                 MessageEndpointId to) {
+  std::shared_ptr<const Recipients> recipients;
   {
     absl::WriterMutexLock lock(&mutex_);
-    for (auto endpoint_id : deleted_endpoints) {
-      to_info->subscribers.erase(endpoint_id);
+    recipients = GetRecipients(to, dispatcher);
+    if (recipients == nullptr) {
+      return;
     }
-    to_info->dispatch_threads.erase(std::this_thread::get_id());
-    if (to_info->dispatch_threads.empty()) {
-      if (to_info->erase_after_dispatch) {
-        endpoints_.erase(to);
-      } else {
-        for (auto endpoint_id : to_info->add_subscribers) {
-          to_info->subscribers.insert(endpoint_id);
-        }
-        to_info->add_subscribers.clear();
-        for (auto endpoint_id : to_info->remove_subscribers) {
-          to_info->subscribers.erase(endpoint_id);
-        }
-        to_info->remove_subscribers.clear();
+  }
+
+  // Endpoints remain marked as being dispatched to until the recipients they
+  // are subscribed through have been dispatched to as well.
+  MessageMetrics* const metrics = GetMetrics();
+  absl::InlinedVector<const Recipient*, 8> dispatching;
+  const int recipient_count = static_cast<int>(recipients->size());
+  for (int index = 0; index < recipient_count; ++index) {
+    const Recipient& recipient = (*recipients)[index];
+    if (BeginDispatch(recipient)) {
+      if (recipient.dispatcher == nullptr) {
+        dispatching.push_back(&recipient);
       }
+      DeliverMessage(state, recipient, metrics);
+    }
+    while (!dispatching.empty() &&
+           dispatching.back()->subscribers_end == index + 1) {
+      EndDispatch(*dispatching.back());
+      dispatching.pop_back();
     }
   }
+}
 
-  if (delete_message) {
-    type->Destroy(message);
+bool MessageSystem::BeginDispatch(const Recipient& recipient) {
+  absl::WriterMutexLock lock(&mutex_);
+
+  // The recipient list may be out of date, so the recipient is looked up again
+  // before its info is used. The endpoint is null if it was removed by a
+  // handler earlier in this dispatch.
+  auto it = endpoints_.find(recipient.id);
+  if (it == endpoints_.end() || it->second.get() != recipient.info ||
+      recipient.info->endpoint == nullptr) {
+    return false;
+  }
+  if (recipient.dispatcher == nullptr) {
+    ++recipient.info->dispatch_threads[std::this_thread::get_id()];
   }
   return true;
 }
 
+void MessageSystem::EndDispatch(const Recipient& recipient) {
+  absl::WriterMutexLock lock(&mutex_);
+  auto* info = recipient.info;
+  auto it = info->dispatch_threads.find(std::this_thread::get_id());
+  if (--it->second > 0) {
+    return;
+  }
+  info->dispatch_threads.erase(it);
+  if (info->dispatch_threads.empty() && info->erase_after_dispatch) {
+    endpoints_.erase(recipient.id);
+  }
+}
+
+void MessageSystem::DeliverMessage(DispatchState* state,
+                                   const Recipient& recipient,
+                                   MessageMetrics* metrics) {
+  if (recipient.dispatcher != nullptr) {
+    recipient.dispatcher->AddMessage(
+        {}, {state->from, recipient.id, state->ShareEnvelope()});
+    return;
+  }
+  MessageEndpoint* const endpoint = recipient.info->endpoint;
+  if (metrics == nullptr) {
+    endpoint->Receive({}, state->from, state->type, state->messages,
+                      state->count, state->envelope);
+    return;
+  }
+  const absl::Time start_time = absl::Now();
+  endpoint->Receive({}, state->from, state->type, state->messages,
+                    state->count, state->envelope);
+  metrics->RecordHandlerTime(recipient.info->name, absl::Now() - start_time);
+}
+
 }  // namespace gb
@@ -6,15 +6,20 @@
 #ifndef GB_BASE_MESSAGE_MESSAGE_SYSTEM_H_
 #define GB_BASE_MESSAGE_MESSAGE_SYSTEM_H_
 
+#include <atomic>
 #include <memory>
 #include <string_view>
 #include <thread>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "gb/base/type_info.h"
 #include "gb/base/weak_ptr.h"
 #include "gb/message/message_endpoint.h"
+#include "gb/message/message_envelope.h"
+#include "gb/message/message_metrics.h"
 
 namespace gb {
 
@@ -118,6 +123,29 @@ class MessageSystem final : public WeakScope<MessageSystem> {
   template <typename Message>
   bool Send(MessageEndpointId to, const Message& message);
 
+  // Send a batch of anonymous messages of the same type to the specified
+  // endpoint.
+  //
+  // This is equivalent to calling Send for each message in order, except that
+  // the batch is copied, queued and dispatched as a single unit. See
+  // MessageEndpoint::SendBatch for details.
+  template <typename Message>
+  bool SendBatch(MessageEndpointId to, absl::Span<const Message> messages);
+
+  // Enables or disables (if null) recording of send counts and handler
+  // execution times.
+  //
+  // Metrics are disabled by default, and may be changed at any time. The
+  // metrics must outlive the system, or be cleared before being destructed.
+  // Queue depth metrics are enabled separately on each dispatcher (see
+  // MessageDispatcher::SetMetrics).
+  void SetMetrics(MessageMetrics* metrics) {
+    metrics_.store(metrics, std::memory_order_release);
+  }
+  MessageMetrics* GetMetrics() const {
+    return metrics_.load(std::memory_order_acquire);
+  }
+
  public:
   // The following methods are internal to the message system, callable only by
   // other classes that are part of the system.
@@ -150,23 +178,55 @@ class MessageSystem final : public WeakScope<MessageSystem> {
   bool IsSubscribed(MessageInternal, MessageEndpointId source,
                     MessageEndpointId subscriber);
 
-  // Called from an endpoint to send a message. This will add the message to the
-  // appropriate dispatcher, for immediate or deferred execution. Returns true
-  // if the message could be dispatched to a known endpoint.
+  // Called from an endpoint to send an array of one or more messages. This will
+  // add the messages to the appropriate dispatcher, for immediate or deferred
+  // execution. Returns true if the messages could be dispatched to a known
+  // endpoint.
   bool DoSend(MessageInternal, MessageEndpointId from, MessageEndpointId to,
-              TypeInfo* type, const void* message);
+              TypeInfo* type, const void* messages, int count);
 
   // Called from a dispatcher to actually propagate the message to the specified
-  // endpoint.
+  // endpoint. This takes ownership of the dispatcher's reference to the
+  // envelope.
   void DoDispatch(MessageInternal, MessageDispatcher* dispatcher,
-                  MessageEndpointId from, MessageEndpointId to, TypeInfo* type,
-                  void* message) {
-    EndpointIdSet visited;
-    DispatchImpl(&visited, dispatcher, from, to, type, message, true);
-  }
+                  MessageEndpointId from, MessageEndpointId to,
+                  MessageEnvelope* envelope);
+
+  // Called from a dispatcher to get the recipients of a message sent to "to"
+  // and dispatched by "dispatcher", in the order they would be dispatched to.
+  // Each recipient can then be dispatched to separately with
+  // DoDispatchRecipient.
+  std::vector<MessageEndpointId> GetRecipientIds(MessageInternal,
+                                                 MessageDispatcher* dispatcher,
+                                                 MessageEndpointId to);
+
+  // Called from a dispatcher to propagate a message to a single recipient
+  // returned by GetRecipientIds, without forwarding it to endpoints subscribed
+  // to the recipient (they are separate recipients). This takes ownership of
+  // the dispatcher's reference to the envelope.
+  void DoDispatchRecipient(MessageInternal, MessageDispatcher* dispatcher,
+                           MessageEndpointId from, MessageEndpointId recipient,
+                           MessageEnvelope* envelope);
 
  private:
   using EndpointIdSet = absl::flat_hash_set<MessageEndpointId>;
+  struct EndpointInfo;
+
+  // A single recipient in a flattened recipient list.
+  struct Recipient {
+    MessageEndpointId id = kNoMessageEndpointId;
+    EndpointInfo* info = nullptr;
+
+    // Dispatcher the message must be handed off to, or null if the message is
+    // received directly by the endpoint.
+    MessageDispatcher* dispatcher = nullptr;
+
+    // Index in the recipient list after the last recipient that receives the
+    // message because it is subscribed (directly or indirectly) to this one.
+    int subscribers_end = 0;
+  };
+  using Recipients = std::vector<Recipient>;
+
   struct EndpointInfo {
     std::string name;
     MessageEndpoint* endpoint = nullptr;
@@ -174,28 +234,81 @@ class MessageSystem final : public WeakScope<MessageSystem> {
     EndpointIdSet subscribers;    // Endpoints subscribed to this endpoint.
     EndpointIdSet subscriptions;  // Endpoints this endpoint is subscribed to.
 
-    // While handlers are being dispatched, "subscribers" cannot be safely
-    // changed, so modifications are queued up and applied at the end of the
-    // dispatch.
-    absl::flat_hash_set<std::thread::id> dispatch_threads;
-    EndpointIdSet add_subscribers;
-    EndpointIdSet remove_subscribers;
+    // Number of handler calls in progress for this endpoint on each thread.
+    // While this is not empty, the EndpointInfo cannot be erased.
+    absl::flat_hash_map<std::thread::id, int> dispatch_threads;
     bool erase_after_dispatch = false;
+
+    // Cached flattened recipient lists for messages sent to this endpoint,
+    // keyed by the dispatcher doing the dispatch. These are only valid while
+    // recipients_version matches the system's recipients_version_.
+    int64_t recipients_version = -1;
+    absl::flat_hash_map<MessageDispatcher*, std::shared_ptr<const Recipients>>
+        recipients;
   };
   using Endpoints =
       absl::flat_hash_map<MessageEndpointId, std::unique_ptr<EndpointInfo>>;
   using Dispatchers = absl::flat_hash_map<MessageDispatcher*, int64_t>;
 
+  // State for a single message as it is dispatched to all receiving endpoints.
+  struct DispatchState {
+    DispatchState(MessageEndpointId from, TypeInfo* type,
+                  const void* messages, int count, MessageEnvelope* envelope)
+        : from(from),
+          type(type),
+          messages(messages),
+          count(count),
+          envelope(envelope) {}
+
+    // Returns a new reference to the shared envelope for the messages, creating
+    // the envelope if it does not exist yet.
+    MessageEnvelope* ShareEnvelope();
+
+    const MessageEndpointId from;
+    TypeInfo* const type;
+    const void* const messages;
+    const int count;
+    MessageEnvelope* envelope;  // Released when dispatch completes.
+  };
+
   static std::unique_ptr<MessageSystem> DoCreate(
       std::unique_ptr<MessageDispatcher> owned_dispatcher,
       MessageDispatcher* dispatcher);
 
   MessageSystem();
 
-  // Returns false if the "to" endpoint no longer exists.
-  bool DispatchImpl(EndpointIdSet* visited, MessageDispatcher* dispatcher,
-                    MessageEndpointId from, MessageEndpointId to,
-                    TypeInfo* type, void* message, bool delete_message);
+  // Dispatches the message to all recipients of the "to" endpoint.
+  void DispatchImpl(DispatchState* state, MessageDispatcher* dispatcher,
+                    MessageEndpointId to);
+
+  // Called around delivering a message to a recipient. BeginDispatch returns
+  // false if the recipient no longer exists. Otherwise, endpoints that receive
+  // the message directly are marked as being dispatched to on this thread until
+  // EndDispatch is called, so they cannot be erased (see RemoveEndpoint).
+  bool BeginDispatch(const Recipient& recipient);
+  void EndDispatch(const Recipient& recipient);
+
+  // Hands the message off to the recipient's dispatcher, or calls the
+  // recipient's handler if it receives the message directly.
+  void DeliverMessage(DispatchState* state, const Recipient& recipient,
+                      MessageMetrics* metrics);
+
+  // Returns the flattened list of recipients for messages sent to "to" and
+  // dispatched by "dispatcher", building and caching it if necessary. Returns
+  // null if the endpoint does not exist.
+  std::shared_ptr<const Recipients> GetRecipients(MessageEndpointId to,
+                                                  MessageDispatcher* dispatcher)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void BuildRecipients(MessageEndpointId id, EndpointInfo* info,
+                       MessageDispatcher* dispatcher, EndpointIdSet* visited,
+                       Recipients* recipients)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Invalidates all cached recipient lists. This must be called whenever the
+  // set of endpoints or subscriptions changes.
+  void InvalidateRecipients() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    ++recipients_version_;
+  }
 
   mutable absl::Mutex mutex_;
   std::unique_ptr<MessageDispatcher> owned_system_dispatcher_;
@@ -204,12 +317,21 @@ class MessageSystem final : public WeakScope<MessageSystem> {
       2;  // 0 and 1 are reserved.
   Endpoints endpoints_ ABSL_GUARDED_BY(mutex_);
   Dispatchers dispatchers_ ABSL_GUARDED_BY(mutex_);
+  int64_t recipients_version_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::atomic<MessageMetrics*> metrics_ = nullptr;
 };
 
 template <typename Message>
 bool MessageSystem::Send(MessageEndpointId to, const Message& message) {
   return DoSend({}, kNoMessageEndpointId, to, TypeInfo::Get<Message>(),
-                &message);
+                &message, 1);
+}
+
+template <typename Message>
+bool MessageSystem::SendBatch(MessageEndpointId to,
+                              absl::Span<const Message> messages) {
+  return DoSend({}, kNoMessageEndpointId, to, TypeInfo::Get<Message>(),
+                messages.data(), static_cast<int>(messages.size()));
 }
 
 }  // namespace gb
@@ -5,6 +5,15 @@
 
 #include "gb/message/message_system.h"
 
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
 #include "gb/message/message_dispatcher.h"
 #include "gb/message/message_endpoint.h"
 #include "gb/test/thread_tester.h"
@@ -403,19 +412,46 @@ TEST(MessageSystemTest, SwitchDispatchersInSubscription) {
   EXPECT_EQ(counts.destruct, 0);
   EXPECT_EQ(counts.counts[0], 0);
   endpoint_2_dispatcher.Update();
-  EXPECT_EQ(counts.construct, 3);
-  EXPECT_EQ(counts.destruct, 1);
+  EXPECT_EQ(counts.construct, 2);
+  EXPECT_EQ(counts.destruct, 0);
   EXPECT_EQ(counts.counts[0], 0);
   endpoint_2_dispatcher.Update();
-  EXPECT_EQ(counts.construct, 3);
-  EXPECT_EQ(counts.destruct, 1);
+  EXPECT_EQ(counts.construct, 2);
+  EXPECT_EQ(counts.destruct, 0);
   EXPECT_EQ(counts.counts[0], 0);
   endpoint_1_dispatcher.Update();
-  EXPECT_EQ(counts.construct, 3);
-  EXPECT_EQ(counts.destruct, 2);
+  EXPECT_EQ(counts.construct, 2);
+  EXPECT_EQ(counts.destruct, 1);
   EXPECT_EQ(counts.counts[0], 1);
 }
 
+TEST(MessageSystemTest, BroadcastToManyDispatchersCopiesOnce) {
+  static constexpr int kEndpointCount = 5;
+  Counts counts;
+  TestMessage message(&counts, 42);
+  PollingMessageDispatcher dispatchers[kEndpointCount];
+  auto message_system = MessageSystem::Create();
+  std::vector<std::unique_ptr<MessageEndpoint>> endpoints;
+  for (int i = 0; i < kEndpointCount; ++i) {
+    auto& endpoint =
+        endpoints.emplace_back(message_system->CreateEndpoint(&dispatchers[i]));
+    endpoint->SetHandler<TestMessage>(
+        [&counts, i](MessageEndpointId, const TestMessage& message) {
+          EXPECT_EQ(message.GetValue(), 42);
+          counts.counts[i] += 1;
+        });
+  }
+  EXPECT_TRUE(message_system->Send(kBroadcastMessageEndpointId, message));
+  EXPECT_EQ(counts.construct, 2);
+  EXPECT_EQ(counts.destruct, 0);
+  for (int i = 0; i < kEndpointCount; ++i) {
+    dispatchers[i].Update();
+    EXPECT_EQ(counts.counts[i], 1);
+    EXPECT_EQ(counts.construct, 2);
+    EXPECT_EQ(counts.destruct, i + 1 < kEndpointCount ? 0 : 1);
+  }
+}
+
 TEST(MessageSystemTest, EndpointSendMessageNoSystem) {
   int call_count = 0;
   auto message_system = MessageSystem::Create();
@@ -664,6 +700,58 @@ TEST(MessageSystemTest, RecursiveSubscription) {
   EXPECT_EQ(call_count, 4);
 }
 
+TEST(MessageSystemTest, NestedSubscriptionChanges) {
+  Counts counts;
+  auto message_system = MessageSystem::Create();
+  MessageEndpointId channel = message_system->AddChannel();
+  auto endpoint_1 = message_system->CreateEndpoint();
+  endpoint_1->SetHandler<int>(
+      [&counts](MessageEndpointId, const int&) { counts.counts[0] += 1; });
+  auto endpoint_2 = message_system->CreateEndpoint();
+  endpoint_2->SetHandler<int>(
+      [&counts](MessageEndpointId, const int&) { counts.counts[1] += 1; });
+  auto endpoint_3 = message_system->CreateEndpoint();
+  endpoint_3->SetHandler<int>(
+      [&counts](MessageEndpointId, const int&) { counts.counts[2] += 1; });
+
+  // channel -> endpoint_1 -> endpoint_2
+  EXPECT_TRUE(endpoint_1->Subscribe(channel));
+  EXPECT_TRUE(endpoint_2->Subscribe(endpoint_1->GetId()));
+  EXPECT_TRUE(message_system->Send(channel, 1));
+  EXPECT_EQ(counts.counts[0], 1);
+  EXPECT_EQ(counts.counts[1], 1);
+  EXPECT_EQ(counts.counts[2], 0);
+
+  // channel -> endpoint_1 -> endpoint_2 -> endpoint_3
+  EXPECT_TRUE(endpoint_3->Subscribe(endpoint_2->GetId()));
+  EXPECT_TRUE(message_system->Send(channel, 1));
+  EXPECT_EQ(counts.counts[0], 2);
+  EXPECT_EQ(counts.counts[1], 2);
+  EXPECT_EQ(counts.counts[2], 1);
+
+  // channel -> endpoint_1    endpoint_2 -> endpoint_3
+  endpoint_2->Unsubscribe(endpoint_1->GetId());
+  EXPECT_TRUE(message_system->Send(channel, 1));
+  EXPECT_EQ(counts.counts[0], 3);
+  EXPECT_EQ(counts.counts[1], 2);
+  EXPECT_EQ(counts.counts[2], 1);
+
+  // channel -> endpoint_1 -> endpoint_3
+  EXPECT_TRUE(endpoint_3->Subscribe(endpoint_1->GetId()));
+  EXPECT_TRUE(message_system->Send(channel, 1));
+  EXPECT_EQ(counts.counts[0], 4);
+  EXPECT_EQ(counts.counts[1], 2);
+  EXPECT_EQ(counts.counts[2], 2);
+
+  // channel -> (deleted) -> endpoint_3
+  endpoint_1.reset();
+  EXPECT_TRUE(message_system->Send(channel, 1));
+  EXPECT_EQ(counts.counts[2], 2);
+  EXPECT_TRUE(endpoint_3->Subscribe(channel));
+  EXPECT_TRUE(message_system->Send(channel, 1));
+  EXPECT_EQ(counts.counts[2], 3);
+}
+
 TEST(MessageSystemTest, SubscribeToDeletedEndpoint) {
   int call_count = 0;
   auto message_system = MessageSystem::Create();
@@ -749,6 +837,88 @@ TEST(MessageSystemTest, SendMessageWithDispatcherCopies) {
   EXPECT_EQ(counts.destruct, 1);
 }
 
+TEST(MessageSystemTest, SendBatchWithoutDispatcherDoesNotCopy) {
+  Counts counts;
+  std::vector<TestMessage> messages;
+  messages.reserve(3);
+  messages.emplace_back(&counts, 1);
+  messages.emplace_back(&counts, 2);
+  messages.emplace_back(&counts, 3);
+  auto message_system = MessageSystem::Create();
+  auto endpoint = message_system->CreateEndpoint();
+  std::vector<int> values;
+  endpoint->SetHandler<TestMessage>(
+      [&values](MessageEndpointId, const TestMessage& message) {
+        values.push_back(message.GetValue());
+      });
+  EXPECT_TRUE(message_system->SendBatch(endpoint->GetId(),
+                                        absl::MakeConstSpan(messages)));
+  EXPECT_EQ(values, std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(counts.construct, 3);
+  EXPECT_EQ(counts.destruct, 0);
+}
+
+TEST(MessageSystemTest, SendBatchWithDispatcherCopiesOnce) {
+  Counts counts;
+  std::vector<TestMessage> messages;
+  messages.reserve(3);
+  messages.emplace_back(&counts, 1);
+  messages.emplace_back(&counts, 2);
+  messages.emplace_back(&counts, 3);
+  TestDispatcher<PollingMessageDispatcher> dispatcher(&counts);
+  auto message_system = MessageSystem::Create(&dispatcher);
+  std::vector<int> values_1, values_2;
+  auto endpoint_1 = message_system->CreateEndpoint();
+  endpoint_1->SetHandler<TestMessage>(
+      [&values_1](MessageEndpointId, const TestMessage& message) {
+        values_1.push_back(message.GetValue());
+      });
+  auto endpoint_2 = message_system->CreateEndpoint();
+  endpoint_2->SetHandler<TestMessage>(
+      [&values_2](MessageEndpointId, const TestMessage& message) {
+        values_2.push_back(message.GetValue());
+      });
+  EXPECT_TRUE(endpoint_1->SendBatch(kBroadcastMessageEndpointId,
+                                    absl::MakeConstSpan(messages)));
+  EXPECT_EQ(counts.add_message, 1);
+  EXPECT_EQ(counts.construct, 1 + 3 + 3);
+  dispatcher.Update();
+  EXPECT_EQ(values_1, std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(values_2, std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(counts.construct, 1 + 3 + 3);
+  EXPECT_EQ(counts.destruct, 3);
+}
+
+TEST(MessageSystemTest, SendEmptyBatch) {
+  auto message_system = MessageSystem::Create();
+  auto endpoint = message_system->CreateEndpoint();
+  int call_count = 0;
+  endpoint->SetHandler<int>(
+      [&call_count](MessageEndpointId, const int&) { call_count += 1; });
+  EXPECT_TRUE(
+      message_system->SendBatch(endpoint->GetId(), absl::Span<const int>()));
+  EXPECT_EQ(call_count, 0);
+  EXPECT_FALSE(message_system->SendBatch(kNoMessageEndpointId,
+                                         absl::Span<const int>()));
+}
+
+TEST(MessageSystemTest, SendBatchInsideHandlerIsQueued) {
+  auto message_system = MessageSystem::Create();
+  auto endpoint = message_system->CreateEndpoint();
+  std::vector<int> values;
+  endpoint->SetHandler<int>([&](MessageEndpointId, const int& message) {
+    values.push_back(message);
+    if (message == 0) {
+      const int batch[] = {1, 2, 3};
+      EXPECT_TRUE(endpoint->SendBatch(endpoint->GetId(),
+                                      absl::MakeConstSpan(batch)));
+      EXPECT_EQ(values, std::vector<int>({0}));
+    }
+  });
+  EXPECT_TRUE(message_system->Send(endpoint->GetId(), 0));
+  EXPECT_EQ(values, std::vector<int>({0, 1, 2, 3}));
+}
+
 TEST(MessageSystemTest, CreateEndpointInsideHandler) {
   Counts counts;
   auto message_system = MessageSystem::Create();
@@ -1227,5 +1397,107 @@ TEST(MessageSystemTest, EndpointSubscriptionOnDeletedSystem) {
   endpoint->Unsubscribe(channel);
 }
 
+//------------------------------------------------------------------------------
+// Benchmark
+//------------------------------------------------------------------------------
+
+// The original ThreadMessageDispatcher implementation, which evaluates an Await
+// condition on every AddMessage and discards queue capacity on every dispatch.
+class AwaitThreadMessageDispatcher : public MessageDispatcher {
+ public:
+  AwaitThreadMessageDispatcher() {
+    thread_ = std::thread([this]() { ProcessMessages(); });
+  }
+  ~AwaitThreadMessageDispatcher() override {
+    {
+      absl::MutexLock lock(&mutex_);
+      exit_thread_ = true;
+    }
+    thread_.join();
+  }
+
+  void AddMessage(MessageInternal, const Message& message) override {
+    absl::MutexLock lock(&mutex_);
+    messages_.emplace_back(message);
+  }
+
+ private:
+  bool ProcessMessagesReady() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return exit_thread_ || !messages_.empty();
+  }
+  void ProcessMessages() {
+    absl::MutexLock lock(&mutex_);
+    while (!exit_thread_) {
+      mutex_.Await(absl::Condition(
+          this, &AwaitThreadMessageDispatcher::ProcessMessagesReady));
+      std::vector<Message> messages;
+      messages.swap(messages_);
+      mutex_.Unlock();
+      for (const auto& message : messages) {
+        Dispatch(message);
+      }
+      mutex_.Lock();
+    }
+  }
+
+  std::thread thread_;
+  absl::Mutex mutex_;
+  bool exit_thread_ ABSL_GUARDED_BY(mutex_) = false;
+  std::vector<Message> messages_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Sends message_count messages from each of producer_count threads to a single
+// endpoint, and returns the time until all messages are handled.
+template <typename Dispatcher>
+absl::Duration RunThroughputBenchmark(int producer_count, int message_count) {
+  Dispatcher dispatcher;
+  auto message_system = MessageSystem::Create(&dispatcher);
+  std::unique_ptr<MessageEndpoint> endpoint = message_system->CreateEndpoint();
+  const int total_count = producer_count * message_count;
+  int handled_count = 0;
+  absl::Notification done;
+  endpoint->SetHandler<int>(
+      [&handled_count, &done, total_count](MessageEndpointId, const int&) {
+        if (++handled_count == total_count) {
+          done.Notify();
+        }
+      });
+
+  ThreadTester tester;
+  const absl::Time start_time = absl::Now();
+  tester.Run(
+      "producer",
+      [&message_system, &endpoint, message_count] {
+        for (int i = 0; i < message_count; ++i) {
+          if (!message_system->Send(endpoint->GetId(), i)) {
+            return false;
+          }
+        }
+        return true;
+      },
+      producer_count);
+  EXPECT_TRUE(done.WaitForNotificationWithTimeout(absl::Seconds(60)));
+  const absl::Time end_time = absl::Now();
+  EXPECT_TRUE(tester.Complete()) << tester.GetResultString();
+  endpoint.reset();
+  message_system.reset();
+  return end_time - start_time;
+}
+
+TEST(MessageSystemTest, ThreadDispatcherThroughputBenchmark) {
+  static constexpr int kMessageCount = 100000;
+  for (int producer_count : {1, std::max(ThreadTester::MaxConcurrency(), 2)}) {
+    const absl::Duration await_time =
+        RunThroughputBenchmark<AwaitThreadMessageDispatcher>(producer_count,
+                                                             kMessageCount);
+    const absl::Duration thread_time =
+        RunThroughputBenchmark<ThreadMessageDispatcher>(producer_count,
+                                                        kMessageCount);
+    LOG(INFO) << producer_count << " producers x " << kMessageCount
+              << " messages: await=" << await_time
+              << ", double-buffered=" << thread_time;
+  }
+}
+
 }  // namespace
 }  // namespace gb
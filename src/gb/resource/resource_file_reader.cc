@@ -8,8 +8,10 @@
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
 #include "gb/base/scoped_call.h"
+#include "gb/file/chunk_file_index.h"
 #include "gb/file/file.h"
 #include "gb/file/file_system.h"
+#include "gb/file/interned_path.h"
 #include "gb/resource/resource_chunks.h"
 #include "gb/resource/resource_system.h"
 
@@ -51,7 +53,12 @@ void ResourceFileChunks::AddChunk(ResourceInternal, TypeKey* struct_type,
     chunks.emplace_back(chunk_data);
     chunk_data += struct_size;
   }
-  chunk_memory_.emplace_back(chunk_reader->ReleaseChunkData<void>());
+
+  // Chunks read in place are views into a buffer that outlives the chunks, so
+  // there is nothing to take ownership of.
+  if (chunk_reader->OwnsChunkData()) {
+    chunk_memory_.emplace_back(chunk_reader->ReleaseChunkData<void>());
+  }
 }
 
 //==============================================================================
@@ -116,14 +123,25 @@ Resource* ResourceFileReader::Read(TypeKey* type, std::string_view name,
   auto& chunk_types = chunk_types_it->second;
 
   auto* file_system = context_.GetPtr<FileSystem>();
-  auto file = file_system->OpenFile(name, kReadFileFlags);
+  // Resource file names are a bounded set of caller-chosen paths, so they can
+  // be interned to avoid the file system parsing them on every load.
+  auto file = file_system->OpenFile(Path(name), kReadFileFlags);
   if (file == nullptr) {
     LOG(ERROR) << "Could not open resource file: " << name;
     return nullptr;
   }
 
+  // If the file has a table of contents, then only chunks this reader handles
+  // are read from the file. Otherwise, the whole file is read in place into a
+  // single buffer, which must outlive all chunks (including file_chunks).
+  std::optional<ChunkFileIndex> index = ChunkFileIndex::Read(file.get());
   ChunkType file_type;
-  if (!ReadChunkFile(file.get(), &file_type, nullptr)) {
+  std::unique_ptr<uint64_t[]> chunk_buffer;
+  std::vector<ChunkReader> file_chunk_readers;
+  if (index.has_value()) {
+    file_type = index->GetFileType();
+  } else if (!ReadChunkFileInPlace(file.get(), &file_type, &file_chunk_readers,
+                                   &chunk_buffer)) {
     LOG(ERROR) << "Resource file is invalid: " << name;
     return nullptr;
   }
@@ -156,8 +174,27 @@ Resource* ResourceFileReader::Read(TypeKey* type, std::string_view name,
   auto* resource_set = load_context.GetPtr<ResourceSet>();
   auto* resource_system = context_.GetPtr<ResourceSystem>();
   bool has_error = false;
+  int next_index = 0;
+  auto read_next_chunk = [&]() -> std::optional<ChunkReader> {
+    if (!index.has_value()) {
+      if (next_index == static_cast<int>(file_chunk_readers.size())) {
+        return std::nullopt;
+      }
+      return std::move(file_chunk_readers[next_index++]);
+    }
+    const auto entries = index->GetEntries();
+    for (; next_index < static_cast<int>(entries.size()); ++next_index) {
+      const ChunkType& type = entries[next_index].type;
+      if (type == kChunkTypeResourceLoad || chunk_readers_.contains(type)) {
+        auto chunk_reader = index->ReadChunk(next_index++);
+        has_error = !chunk_reader.has_value();
+        return chunk_reader;
+      }
+    }
+    return std::nullopt;
+  };
   while (true) {
-    auto chunk_reader = ChunkReader::Read(file.get(), &has_error);
+    auto chunk_reader = read_next_chunk();
     if (has_error) {
       return nullptr;
     }
@@ -128,7 +128,8 @@ bool ResourceFileWriter::Write(std::string_view name, Resource* resource,
                           &flat_buffers)) {
     return false;
   }
-  success = WriteChunkFile(file.get(), writer_info.chunk_type, chunk_writers);
+  success = WriteChunkFile(file.get(), writer_info.chunk_type, chunk_writers,
+                           /*write_toc=*/true);
   return success;
 }
 